@@ -90,8 +90,13 @@ MEMORY
     //C15 (RWX)        : origin = 0x2002E000, length = 0x2000
     C1415 (RWX)		 : origin = 0x2002C000, length = 0x4000
     
-    CTOMRAM (RX)    : origin = 0x2007F000, length = 0x0800
-    MTOCRAM (RWX)   : origin = 0x2007F800, length = 0x0800
+    /* Top 0x200 bytes of each message RAM hold command ring and stream
+       indexes. C28 linker command file must reserve the same regions, so
+       both firmwares must be updated together. */
+    CTOMRAM (RX)    : origin = 0x2007F000, length = 0x0600
+    CTOMRING (RX)   : origin = 0x2007F600, length = 0x0200
+    MTOCRAM (RWX)   : origin = 0x2007F800, length = 0x0600
+    MTOCRING (RWX)  : origin = 0x2007FE00, length = 0x0200
 	
 	OTPSECLOCK       : origin = 0x00681000, length = 0x0004
     OTP_Reserved1    : origin = 0x00681004, length = 0x0004
@@ -164,6 +169,12 @@ SECTIONS
 
  	MTOC_MSG_RAM : > MTOCRAM
     CTOM_MSG_RAM : TYPE = DSECT > CTOMRAM
+    /* Ring regions hold two objects each, pinned at the offsets checked on
+       ipc_layout.h (LAYOUT_OFFSET_CMD_RING and LAYOUT_OFFSET_STREAM) */
+    MTOC_CMD_RING : > 0x2007FE00    // Command ring, shared with C28
+    CTOM_CMD_RING : TYPE = DSECT > 0x2007F600
+    MTOC_STREAM : > 0x2007FF00      // Scope stream indexes
+    CTOM_STREAM : TYPE = DSECT > 0x2007F700
 /*
     GROUP : > MTOCRAM
     {
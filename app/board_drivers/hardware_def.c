@@ -46,6 +46,13 @@
 
 #include "hardware_def.h"
 
+/******************************************************************************
+ * The control table used by the uDMA controller. This table must be aligned
+ * to a 1024 byte boundary. It's shared by Ethernet, ADCP and RS485 channels.
+ *****************************************************************************/
+#pragma DATA_ALIGN(g_sDMAControlTable, 1024)
+uint8_t g_sDMAControlTable[1024];
+
 /**
 * @brief Enable Concerto Peripherals
 *
@@ -165,9 +172,12 @@ void enable_peripherals(void)
     SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN0);
 
     /***************************************************************************
-     * Enable clock for uDMA
+     * Enable clock for uDMA and set up its control table, so drivers may
+     * configure their channels on initialization.
      **************************************************************************/
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    uDMAEnable();
+    uDMAControlBaseSet(g_sDMAControlTable);
 
     /***************************************************************************
      * Enable clock for ethernet
@@ -138,6 +138,8 @@
 
 #define RS485_UART_BASE		UART1_BASE
 #define RS485_INT			INT_UART1
+#define RS485_UART_RX_UDMA	UDMA_CHANNEL_UART1RX
+#define RS485_UART_TX_UDMA	UDMA_CHANNEL_UART1TX
 
 /******************************************************************************
  * Macros for RS-485 backplane communication
@@ -84,6 +84,7 @@ enum bsmp_err
 #define BSMP_CURVE_LIST_INFO        5
 #define BSMP_CURVE_BLOCK_INFO       3
 #define BSMP_CURVE_CSUM_SIZE        16
+#define BSMP_CURVE_FAST_CSUM_SIZE   4
 
 #define BSMP_FUNC_MAX_INPUT         64//32//15
 #define BSMP_FUNC_MAX_OUTPUT        32//15
@@ -146,6 +147,16 @@ struct bsmp_group_list
 
 /* Curve */
 
+// Checksum algorithms selectable in the curve checksum recalculation command.
+// Only MD5 is kept in the curve info, the others are just returned.
+enum bsmp_curve_csum_algo
+{
+    BSMP_CURVE_CSUM_MD5,            // 16 bytes, default
+    BSMP_CURVE_CSUM_CRC32,          // 4 bytes, IEEE 802.3 CRC-32
+    BSMP_CURVE_CSUM_MURMUR3,        // 4 bytes, MurmurHash3 x86 32-bit, seed 0
+    BSMP_CURVE_CSUM_ALGO_MAX
+};
+
 struct bsmp_curve_info
 {
     uint8_t  id;                    // ID of the curve, used in the protocol.
@@ -156,22 +167,64 @@ struct bsmp_curve_info
 };
 
 struct bsmp_curve;
-
-typedef bool (*bsmp_curve_read_t)  (struct bsmp_curve *curve, uint16_t block,
-                                    uint8_t *data, uint16_t *len);
-typedef bool (*bsmp_curve_write_t) (struct bsmp_curve *curve, uint16_t block,
-                                    uint8_t *data, uint16_t len);
+struct bsmp_curve_state;
+
+// Callbacks of curves and functions receive the context given to
+// bsmp_process_packet() for the request being processed, untouched by BSMP.
+typedef bool (*bsmp_curve_read_t)  (const struct bsmp_curve *curve,
+                                    struct bsmp_curve_state *state,
+                                    uint16_t block, uint8_t *data,
+                                    uint16_t *len, void *ctx);
+typedef bool (*bsmp_curve_write_t) (const struct bsmp_curve *curve,
+                                    struct bsmp_curve_state *state,
+                                    uint16_t block, uint8_t *data,
+                                    uint16_t len, void *ctx);
+// Read up to *len bytes of a block, starting at offset within the block. *len
+// is set with the number of bytes read, which is less than requested only at
+// the end of the block data.
+typedef bool (*bsmp_curve_read_part_t) (const struct bsmp_curve *curve,
+                                        struct bsmp_curve_state *state,
+                                        uint16_t block, uint16_t offset,
+                                        uint8_t *data, uint16_t *len,
+                                        void *ctx);
+
+// Description of a curve. It doesn't change at runtime, so it can be const and
+// shared by several servers. Whatever depends on the server is kept in a
+// struct bsmp_curve_state, given to every read/write function.
 struct bsmp_curve
 {
-    // Info about the curve identification
+    // Info about the curve identification. The id must match the position of
+    // the curve in the table registered and checksum is not used (see
+    // struct bsmp_curve_state).
     struct bsmp_curve_info info;
 
     // Functions to read/write a block
-    bool (*read_block)(struct bsmp_curve *curve, uint16_t block, uint8_t *data,
-                       uint16_t *len);
+    bsmp_curve_read_t  read_block;
+    bsmp_curve_write_t write_block;
+
+    // Optional function to write a block received with delta/run-length
+    // encoding. It must decode data straight into the block memory using
+    // bsmp_curve_decode_block(). NULL if encoded blocks are not supported.
+    bsmp_curve_write_t write_block_encoded;
+
+    // Optional function to read part of a block. Checksums are calculated
+    // over parts read with it, so a whole block is never buffered. Checksum
+    // requests for curves without it are rejected, so it must be NULL for
+    // curves whose reads consume data, such as streams.
+    bsmp_curve_read_part_t read_block_part;
+};
+
+// Data of a curve which belongs to a server
+struct bsmp_curve_state
+{
+    uint8_t checksum[BSMP_CURVE_CSUM_SIZE]; // MD5 checksum of the curve
 
-    bool (*write_block)(struct bsmp_curve *curve, uint16_t block, uint8_t *data,
-                        uint16_t len);
+    // Optional per-block checksums (nblocks entries) and dirty bitmap (one bit
+    // per block). When provided, the checksum of the curve is the MD5 of the
+    // concatenated block checksums and only blocks written since the last
+    // recalculation are hashed again. Otherwise, they must be NULL.
+    uint8_t  (*block_csum)[BSMP_CURVE_CSUM_SIZE];
+    uint32_t *block_dirty;
 
     // The user can make use of this variable as he wishes. It is not touched by
     // BSMP
@@ -184,10 +237,11 @@ struct bsmp_curve_info_list
     struct bsmp_curve_info list[BSMP_MAX_CURVES];
 };
 
-struct bsmp_curve_ptr_list
+struct bsmp_curve_table
 {
     uint32_t count;
-    struct bsmp_curve *list[BSMP_MAX_CURVES];
+    const struct bsmp_curve *const *list;
+    struct bsmp_curve_state *state;         // One for each curve of list
 };
 
 /* Function */
@@ -199,7 +253,7 @@ struct bsmp_func_info
     uint8_t output_size;            // How many bytes of output
 };
 
-typedef uint8_t (*bsmp_func_t) (uint8_t *input, uint8_t *output);
+typedef uint8_t (*bsmp_func_t) (uint8_t *input, uint8_t *output, void *ctx);
 struct bsmp_func
 {
     struct bsmp_func_info info;     // Information about the function
@@ -213,10 +267,10 @@ struct bsmp_func_info_list
     struct bsmp_func_info list[BSMP_MAX_FUNCTIONS];
 };
 
-struct bsmp_func_ptr_list
+struct bsmp_func_table
 {
     uint32_t count;
-    struct bsmp_func *list[BSMP_MAX_FUNCTIONS];
+    const struct bsmp_func *const *list;
 };
 
 /**
@@ -13,19 +13,92 @@ enum bsmp_operation
     BSMP_OP_WRITE,                  // Write command arrived
 };
 typedef bool (*bsmp_hook_t) (enum bsmp_operation op, struct bsmp_var **list);
-typedef bool (*bsmp_custom_md5_t) (struct bsmp_curve *curve, uint8_t *csum);
+typedef bool (*bsmp_custom_md5_t) (const struct bsmp_curve *curve,
+                                   struct bsmp_curve_state *state,
+                                   uint8_t *csum, void *ctx);
+
+// Hook function for batch function execution. Called before each function of
+// a batch to select the server which executes it. Must return NULL if
+// server_id is invalid. If the function must not be executed (e.g., access
+// restrictions), *func_error must be set to the error to be reported as its
+// result. Otherwise, it must be left untouched. The request context may be
+// updated for the function about to be executed.
+// The whole batch is checked before execution, with func_error NULL. Then only
+// the server must be returned, without any side effect.
+typedef struct bsmp_server *(*bsmp_batch_select_t) (uint8_t server_id,
+                                                    uint8_t func_id,
+                                                    uint8_t *func_error,
+                                                    void *ctx);
+
+// Hook function called after each function of a batch is executed, with the
+// error it returned and its output. Must complete whatever the function left
+// pending, and return its final error (e.g., a timeout detected meanwhile),
+// which is reported as its result and checked for stop on error.
+typedef uint8_t (*bsmp_batch_done_t) (uint8_t func_error, uint8_t *output,
+                                      void *ctx);
+
+// Sequence lock guarding variables updated concurrently by other context
+// (e.g., another core). Reads of variables and groups are retried, up to
+// BSMP_MAX_READ_RETRIES times, until begin and retry functions show that no
+// update happened meanwhile. Begin stores the current sequence in seq, waiting
+// for updates in progress, and returns false if they don't finish. Retry
+// returns true if the sequence changed since then. Reads which can't be made
+// consistent are answered with CMD_ERR_RESOURCE_BUSY.
+typedef bool (*bsmp_read_begin_t) (uint32_t *seq);
+typedef bool (*bsmp_read_retry_t) (uint32_t seq);
+
+#define BSMP_MAX_READ_RETRIES   4
+
+// Memory from which the shadows of the groups read with the read changed
+// command are taken. The same pool may be shared by several servers. It's
+// emptied whenever groups are removed, and generation is incremented, so
+// shadows taken before are dropped by all servers.
+struct bsmp_shadow_pool
+{
+    uint8_t  *data;
+    uint16_t size;
+    uint16_t used;
+    uint32_t generation;
+};
+
+// Clients of the read changed command, such as the interfaces a server is
+// reached through, each with its own shadows. Shadow client function gives the
+// client of a request from its context, and must return less than
+// BSMP_MAX_SHADOW_CLIENTS.
+#define BSMP_MAX_SHADOW_CLIENTS 3
+
+typedef uint8_t (*bsmp_shadow_client_t) (void *ctx);
+
+// Copy of the values of a group last sent by the read changed command
+struct bsmp_group_shadow
+{
+    uint8_t  *data;
+    uint16_t capacity;
+    uint32_t generation;    // Pool generation the shadow was taken from
+    bool     valid;
+};
 
 // BSMP instance
 struct bsmp_server
 {
     struct bsmp_var_ptr_list    vars;
     struct bsmp_group_list      groups;
-    struct bsmp_curve_ptr_list  curves;
-    struct bsmp_func_ptr_list   funcs;
+    uint32_t                    groups_fixed;   // Standard and predefined
+    struct bsmp_curve_table     curves;
+    struct bsmp_func_table      funcs;
 
     struct bsmp_var             *modified_list[BSMP_MAX_VARIABLES+1];
     bsmp_hook_t                 hook;
     bsmp_custom_md5_t           custom_md5;
+    bsmp_batch_select_t         batch_select;
+    bsmp_batch_done_t           batch_done;
+    bsmp_read_begin_t           read_begin;
+    bsmp_read_retry_t           read_retry;
+
+    struct bsmp_shadow_pool     *shadow_pool;
+    bsmp_shadow_client_t        shadow_client;
+    struct bsmp_group_shadow    group_shadows[BSMP_MAX_SHADOW_CLIENTS]
+                                             [BSMP_MAX_GROUPS];
 };
 
 // Handle to a server instance
@@ -38,6 +111,7 @@ struct bsmp_raw_packet
 {
     uint8_t *data;
     uint16_t len;
+    uint16_t max_len;   // Capacity of data for responses. 0 if unlimited.
 };
 
 /**
@@ -74,62 +148,80 @@ enum bsmp_err bsmp_register_variable (bsmp_server_t *server,
                                       struct bsmp_var *var);
 
 /**
- * Register a curve with a BSMP instance. The memory pointed by the curve
- * parameter must remain valid throughout the entire lifespan of the server
- * instance. The id field of the curve parameter will be written by the BSMP
- * lib.
+ * Register the table of curves of a BSMP instance. The memory pointed by list
+ * and state must remain valid throughout the entire lifespan of the server
+ * instance. Curves aren't written by the BSMP lib, so the same const table can
+ * be registered with several servers, each one with its own states.
  *
- * The fields writable, nblocks and read_block must be filled correctly.
- * If writable is true, the field write_block must also be filled correctly.
- * Otherwise, write_block must be NULL.
+ * In each curve, the fields info.id, info.writable, info.nblocks,
+ * info.block_size and read_block must be filled correctly, and info.id must be
+ * the position of the curve in list. If writable is true, the field write_block
+ * must also be filled correctly. Checksum of the curve is only available if
+ * read_block_part is filled, since blocks are hashed in parts.
  *
- * The user field is untouched.
+ * In each state, the user field is untouched. The fields block_csum and
+ * block_dirty are optional. If block_csum is not NULL, block_dirty must also
+ * point to a bitmap with at least nblocks bits, and all blocks are marked to be
+ * hashed on the next checksum recalculation.
  *
  * @param server [input] Handle to the server instance.
- * @param curve [input] Pointer to the curve to be registered.
+ * @param list [input] Pointers to the curves, indexed by ID.
+ * @param state [input] States of the curves of this server, indexed by ID.
+ * @param count [input] Number of curves.
  *
  * @return BSMP_SUCCESS or one of the following errors:
  * <ul>
- *   <li>BSMP_ERR_PARAM_INVALID: either server or curve is a NULL pointer.</li>
- *   <li>BSMP_ERR_PARAM_INVALID: curve->info.nblocks less than
- *                               BSMP_CURVE_MIN_BLOCKS or greater than
+ *   <li>BSMP_ERR_PARAM_INVALID: either server, list or state is a NULL
+ *                               pointer.</li>
+ *   <li>BSMP_ERR_PARAM_INVALID: a curve is NULL or its id doesn't match its
+ *                               position.</li>
+ *   <li>BSMP_ERR_PARAM_INVALID: curve->info.nblocks greater than
  *                               BSMP_CURVE_MAX_BLOCKS.</li>
  *   <li>BSMP_ERR_PARAM_INVALID: curve->read_block is NULL.</li>
  *   <li>BSMP_ERR_PARAM_INVALID: curve->writable is true and curve->write_block
  *                               is NULL.</li>
- *   <li>BSMP_ERR_PARAM_INVALID: curve->writable is false and curve->write_block
- *                               is not NULL.</li>
+ *   <li>BSMP_ERR_PARAM_INVALID: state->block_csum is not NULL and
+ *                               state->block_dirty is NULL.</li>
+ *   <li>BSMP_ERR_OUT_OF_MEMORY: count is greater than BSMP_MAX_CURVES.</li>
  * </ul>
  */
-enum bsmp_err bsmp_register_curve (bsmp_server_t *server,
-                                   struct bsmp_curve *curve);
+enum bsmp_err bsmp_register_curve_table (bsmp_server_t *server,
+                                         const struct bsmp_curve *const *list,
+                                         struct bsmp_curve_state *state,
+                                         uint8_t count);
 
 /**
- * Register a function with a BSMP instance. The memory pointed by the func
- * parameter must remain valid throughout the entire lifespan of the server
- * instance. The info.id field of the func parameter will be written by the
- * BSMP lib.
+ * Register the table of functions of a BSMP instance. The memory pointed by
+ * list must remain valid throughout the entire lifespan of the server
+ * instance. Functions aren't written by the BSMP lib, so the same const table
+ * can be registered with several servers.
  *
- * The fields func_p, info.input_size and info.output_size must be filled
- * correctly. info.input_size must be less than or equal to BSMP_FUNC_MAX_INPUT.
- * Likewise, info.output_size must be less than or equal to
- * BSMP_FUNC_MAS_OUTPUT.
+ * The fields info.id, func_p, info.input_size and info.output_size of each
+ * function must be filled correctly, and info.id must be the position of the
+ * function in list. info.input_size must be less than or equal to
+ * BSMP_FUNC_MAX_INPUT. Likewise, info.output_size must be less than or equal
+ * to BSMP_FUNC_MAX_OUTPUT.
  *
  * @param server [input] Handle to the server instance.
- * @param func [input] Pointer to the function to be registered.
+ * @param list [input] Pointers to the functions, indexed by ID.
+ * @param count [input] Number of functions.
  *
  * @return BSMP_SUCCESS or one of the following errors:
  * <ul>
- *   <li>BSMP_ERR_PARAM_INVALID: either server or func is a NULL pointer.</li>
+ *   <li>BSMP_ERR_PARAM_INVALID: either server or list is a NULL pointer.</li>
+ *   <li>BSMP_ERR_PARAM_INVALID: a function is NULL or its id doesn't match its
+ *                               position.</li>
  *   <li>BSMP_ERR_PARAM_INVALID: func->func_p is NULL.</li>
  *   <li>BSMP_ERR_PARAM_OUT_OF_RANGE: info.input_size is greater than
  *                                    BSMP_FUNC_MAX_INPUT.
  *   <li>BSMP_ERR_PARAM_OUT_OF_RANGE: info.output_size is greater than
  *                                    BSMP_FUNC_MAX_OUTPUT.
+ *   <li>BSMP_ERR_OUT_OF_MEMORY: count is greater than BSMP_MAX_FUNCTIONS.</li>
  * </ul>
  */
-enum bsmp_err bsmp_register_function (bsmp_server_t *server,
-                                      struct bsmp_func *func);
+enum bsmp_err bsmp_register_function_table (bsmp_server_t *server,
+                                            const struct bsmp_func *const *list,
+                                            uint8_t count);
 
 /**
  * Register a function that will be called at two moments:
@@ -175,12 +267,144 @@ enum bsmp_err bsmp_register_hook (bsmp_server_t *server, bsmp_hook_t hook);
  */
 enum bsmp_err bsmp_register_md5(bsmp_server_t *server, bsmp_custom_md5_t md5);
 
+/*
+ * Register a function to select the server of each function in a batch
+ * execution command, and an optional one to complete each function. Without
+ * select function, batch execution is not supported.
+ *
+ * A batch carries a flags byte (bit 0: stop on first error) followed by a list
+ * of server ID, function ID and function input. Its answer contains, for each
+ * function executed, a result byte (0 or function error) followed by the
+ * function output (output_size bytes).
+ *
+ * @param server [input] Handle to a server instance
+ * @param select [input] Pointer to the select function
+ * @param done [input] Pointer to the completion function. May be NULL.
+ *
+ * @return BSMP_SUCCESS or one of the following errors:
+ * <ul>
+ *   <li> BSMP_ERR_PARAM_INVALID: Either server or select is a NULL pointer.
+ *   </li>
+ * </ul>
+ */
+enum bsmp_err bsmp_register_batch_select(bsmp_server_t *server,
+                                         bsmp_batch_select_t select,
+                                         bsmp_batch_done_t done);
+
+/*
+ * Register a sequence lock for variable reads, so values read by variable and
+ * group read commands are consistent with each other, even if they are updated
+ * by another context without locking. Reads which stay inconsistent fail with
+ * CMD_ERR_RESOURCE_BUSY. Writes through BSMP aren't guarded.
+ *
+ * @param server [input] Handle to a server instance
+ * @param begin [input] Pointer to function which starts a read
+ * @param retry [input] Pointer to function which checks whether read must be
+ *                      retried
+ *
+ * @return BSMP_SUCCESS or one of the following errors:
+ * <ul>
+ *   <li> BSMP_ERR_PARAM_INVALID: Either server, begin or retry is a NULL
+ *   pointer. </li>
+ * </ul>
+ */
+enum bsmp_err bsmp_register_read_seqlock(bsmp_server_t *server,
+                                         bsmp_read_begin_t begin,
+                                         bsmp_read_retry_t retry);
+
+/**
+ * Register a predefined group with a server instance. Predefined groups follow
+ * the standard ones, are always available and aren't removed by the remove all
+ * groups command. They must be registered after their variables and before any
+ * group is created by a client.
+ *
+ * @param server [input] Handle to a server instance
+ * @param var_ids [input] IDs of the variables of the group, in ascending order
+ * @param count [input] Number of variables of the group
+ *
+ * @return BSMP_SUCCESS or one of the following errors:
+ * <ul>
+ *   <li> BSMP_ERR_PARAM_INVALID: server or var_ids is a NULL pointer, count is
+ *        zero or a group was already created by a client. </li>
+ *   <li> BSMP_ERR_PARAM_OUT_OF_RANGE: a variable ID isn't registered or isn't
+ *        in ascending order. </li>
+ *   <li> BSMP_ERR_OUT_OF_MEMORY: there are already BSMP_MAX_GROUPS groups. </li>
+ * </ul>
+ */
+enum bsmp_err bsmp_register_group (bsmp_server_t *server,
+                                   const uint8_t *var_ids, uint8_t count);
+
+/*
+ * Register the memory pool used to keep the values of the groups read with the
+ * read changed command. Without it, that command is not supported.
+ *
+ * The answer of a read changed command contains a bitmap with one bit per
+ * variable of the group (LSB of the first byte is the first variable), followed
+ * by the values of the variables flagged, in group order. A variable is flagged
+ * if its value differs from the last one sent. The first read of a group, a
+ * read after the group is recreated and a read with bit 0 of the optional flags
+ * byte set return all values. Since the shadow is updated when the answer is
+ * built, a client which misses an answer must request all values again.
+ *
+ * Each client has its own shadow of each group, so the changes sent to one
+ * client are sent to the others as well. Without a client function, all
+ * requests are from the same client, and clients reading the same group
+ * concurrently miss each other's changes. A request whose client is not less
+ * than BSMP_MAX_SHADOW_CLIENTS fails with CMD_ERR_OP_NOT_SUPPORTED.
+ *
+ * The shadow of a group is taken from the pool on its first read by a client
+ * and is kept by its slot. Removing groups empties the pool, so the shadows of
+ * all groups sharing it are taken again, and their next read returns all
+ * values.
+ *
+ * @param server [input] Handle to a server instance
+ * @param pool [input] Pool of memory, which may be shared with other servers
+ * @param client [input] Shadow client function, or NULL if there's a single
+ *        client
+ *
+ * @return BSMP_SUCCESS or one of the following errors:
+ * <ul>
+ *   <li> BSMP_ERR_PARAM_INVALID: Either server or pool is a NULL pointer.
+ *   </li>
+ * </ul>
+ */
+enum bsmp_err bsmp_register_group_shadow(bsmp_server_t *server,
+                                         struct bsmp_shadow_pool *pool,
+                                         bsmp_shadow_client_t client);
+
+/**
+ * Decode a curve block received with delta-of-delta/run-length encoding of
+ * 32-bit words (see src/delta_rle/delta_rle.c). Meant to be used by the
+ * write_block_encoded function of a curve.
+ *
+ * @param dst [output] Word aligned destination of the block. If NULL, the
+ *                     encoded data is only validated.
+ * @param size [input] Maximum size of the decoded block, in bytes.
+ * @param data [input] Encoded block.
+ * @param len [input] Size of the encoded block, in bytes.
+ *
+ * @return Size of the decoded block in bytes, or -1 if data is malformed or
+ *         decodes to more than size bytes.
+ */
+int32_t bsmp_curve_decode_block (uint8_t *dst, uint16_t size, uint8_t *data,
+                                 uint16_t len);
+
 /**
  * Process a received message and prepare an answer.
  *
+ * If response->max_len is not zero, answers which wouldn't fit in it, such as
+ * reading a curve block bigger than that, fail with
+ * CMD_ERR_INSUFFICIENT_MEMORY.
+ *
+ * Nothing but the server instance is shared between requests, so requests
+ * to different servers may be processed concurrently, e.g. by communication
+ * interfaces running at different interrupt priorities.
+ *
  * @param server [input] Handle to a server instance.
  * @param request [input] The message to be processed.
  * @param response [output] The answer to be sent
+ * @param ctx [input] Context of the request (e.g. who sent it), given to every
+ *                    function, curve and batch select callback. May be NULL.
  *
  * @return BSMP_SUCCESS or one of the following errors:
  * <ul>
@@ -190,7 +414,8 @@ enum bsmp_err bsmp_register_md5(bsmp_server_t *server, bsmp_custom_md5_t md5);
  */
 enum bsmp_err bsmp_process_packet (bsmp_server_t *server,
                                    struct bsmp_raw_packet *request,
-                                   struct bsmp_raw_packet *response);
+                                   struct bsmp_raw_packet *response,
+                                   void *ctx);
 
 #endif
 
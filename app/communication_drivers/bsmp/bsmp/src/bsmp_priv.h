@@ -37,6 +37,8 @@ enum command_code
     CMD_VAR_VALUE,
     CMD_GROUP_READ,
     CMD_GROUP_VALUES,
+    CMD_GROUP_READ_CHANGED,
+    CMD_GROUP_CHANGED_VALUES,
 
     // Write commands
     CMD_VAR_WRITE           = 0x20,
@@ -53,11 +55,14 @@ enum command_code
     CMD_CURVE_BLOCK_REQUEST = 0x40,
     CMD_CURVE_BLOCK,
     CMD_CURVE_RECALC_CSUM,
+    CMD_CURVE_BLOCK_ENCODED,
 
     // Function commands
     CMD_FUNC_EXECUTE        = 0x50,
     CMD_FUNC_RETURN,
     CMD_FUNC_ERROR          = 0x53,
+    CMD_FUNC_EXECUTE_BATCH,
+    CMD_FUNC_BATCH_RETURN,
 
     // Error codes
     CMD_OK                  = 0xE0,
@@ -0,0 +1,17 @@
+/* CRC32.H - header file for CRC32.C */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+/* CRC32 context. */
+typedef struct {
+    uint32_t crc; /* running CRC, before final XOR */
+} CRC32_CTX;
+
+void CRC32Init(CRC32_CTX *);
+void CRC32Update(CRC32_CTX *, uint8_t *, unsigned int);
+void CRC32Final(uint8_t [4], CRC32_CTX *);
+
+#endif
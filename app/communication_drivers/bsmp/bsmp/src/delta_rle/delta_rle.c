@@ -0,0 +1,187 @@
+/* DELTA_RLE.C - Delta-of-delta and run-length coding of 32-bit words */
+
+/* Intended for curves of floats, such as waveform references, transferred as
+ * raw little-endian words. Smooth curves have almost constant differences
+ * between the bit patterns of consecutive samples, so the second difference
+ * (residual) is zero or very small.
+ *
+ * Decoder keeps the previous word and the previous difference, both starting
+ * at zero, and for each residual r:
+ *
+ *     diff += r;  word += diff;  output word
+ *
+ * The encoded stream is a sequence of tokens. Each token starts with an
+ * unsigned LEB128 varint u (up to 5 bytes):
+ *
+ *     u == 0          escape: next 4 bytes are the residual (little-endian)
+ *     u odd           run of (u >> 1) + 1 zero residuals
+ *     u even, u != 0  one residual, zigzag encoded as u >> 1
+ *
+ * Small residuals take a single byte and runs of identical differences (e.g.
+ * constant or linear curves) take a byte or two, regardless of length. */
+
+#include "delta_rle.h"
+
+#include <stddef.h>
+
+#define ZIGZAG(r)       (((uint32_t)(r) << 1) ^ (uint32_t)((int32_t)(r) >> 31))
+#define UNZIGZAG(z)     (((z) >> 1) ^ (0 - ((z) & 1)))
+
+static uint32_t put_varint(uint8_t *dst, uint32_t u)
+{
+    uint32_t n = 0;
+
+    while(u >= 0x80)
+    {
+        dst[n++] = (uint8_t) u | 0x80;
+        u >>= 7;
+    }
+    dst[n++] = (uint8_t) u;
+
+    return n;
+}
+
+/* Flush pending run of zero residuals. Returns number of bytes written, or 0
+ * if there is no room for them. */
+static uint32_t put_run(uint8_t *dst, uint32_t room, uint32_t run)
+{
+    uint8_t tmp[5];
+    uint32_t n, i;
+
+    if(!run)
+        return 0;
+
+    n = put_varint(tmp, ((run - 1) << 1) | 1);
+
+    if(n > room)
+        return 0;
+
+    for(i = 0; i < n; i++)
+        dst[i] = tmp[i];
+
+    return n;
+}
+
+/* Encode nwords from src into at most dst_size bytes of dst.
+ * Returns the encoded size, or -1 if it doesn't fit into dst_size. */
+int32_t DeltaRLEEncode(uint8_t *dst, uint32_t dst_size, uint32_t *src,
+                       uint32_t nwords)
+{
+    uint32_t word = 0, diff = 0, run = 0, len = 0, i, k, n;
+    uint8_t tmp[5];
+
+    for(i = 0; i < nwords; i++)
+    {
+        uint32_t new_diff = src[i] - word;
+        uint32_t r        = new_diff - diff;
+
+        word = src[i];
+        diff = new_diff;
+
+        if(!r)
+        {
+            run++;
+            continue;
+        }
+
+        if(run)
+        {
+            if(!(n = put_run(dst + len, dst_size - len, run)))
+                return -1;
+            len += n;
+            run  = 0;
+        }
+
+        uint32_t z = ZIGZAG(r);
+
+        if(z < 0x80000000UL)
+        {
+            n = put_varint(tmp, z << 1);
+            if(len + n > dst_size)
+                return -1;
+            for(k = 0; k < n; k++)
+                dst[len++] = tmp[k];
+        }
+        else
+        {
+            if(len + 5 > dst_size)
+                return -1;
+            dst[len++] = 0;
+            dst[len++] = (uint8_t) r;
+            dst[len++] = (uint8_t) (r >> 8);
+            dst[len++] = (uint8_t) (r >> 16);
+            dst[len++] = (uint8_t) (r >> 24);
+        }
+    }
+
+    if(run)
+    {
+        if(!(n = put_run(dst + len, dst_size - len, run)))
+            return -1;
+        len += n;
+    }
+
+    return (int32_t) len;
+}
+
+/* Decode src_len bytes from src into at most max_words words of dst. If dst
+ * is NULL, the stream is only validated.
+ * Returns number of decoded words, or -1 if the stream is malformed or
+ * doesn't fit into max_words. */
+int32_t DeltaRLEDecode(uint32_t *dst, uint32_t max_words, uint8_t *src,
+                       uint32_t src_len)
+{
+    uint32_t word = 0, diff = 0, nwords = 0, i = 0;
+
+    while(i < src_len)
+    {
+        uint32_t u = 0, shift = 0, count = 1, r;
+        uint8_t b;
+
+        do
+        {
+            if(i >= src_len || shift > 28)
+                return -1;
+            b = src[i++];
+            u |= (uint32_t) (b & 0x7F) << shift;
+            shift += 7;
+        }while(b & 0x80);
+
+        if(!u)
+        {
+            if(i + 4 > src_len)
+                return -1;
+            r  = (uint32_t) src[i] | ((uint32_t) src[i+1] << 8) |
+                 ((uint32_t) src[i+2] << 16) | ((uint32_t) src[i+3] << 24);
+            i += 4;
+        }
+        else if(u & 1)
+        {
+            r     = 0;
+            count = (u >> 1) + 1;
+        }
+        else
+        {
+            r = UNZIGZAG(u >> 1);
+        }
+
+        if(count > max_words - nwords)
+            return -1;
+
+        if(dst == NULL)
+        {
+            nwords += count;
+            continue;
+        }
+
+        diff += r;
+
+        while(count--)
+        {
+            word += diff;
+            dst[nwords++] = word;
+        }
+    }
+
+    return (int32_t) nwords;
+}
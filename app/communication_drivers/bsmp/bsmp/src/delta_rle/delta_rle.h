@@ -0,0 +1,11 @@
+/* DELTA_RLE.H - header file for DELTA_RLE.C */
+
+#ifndef DELTA_RLE_H
+#define DELTA_RLE_H
+
+#include <stdint.h>
+
+int32_t DeltaRLEEncode(uint8_t *, uint32_t, uint32_t *, uint32_t);
+int32_t DeltaRLEDecode(uint32_t *, uint32_t, uint8_t *, uint32_t);
+
+#endif
@@ -0,0 +1,97 @@
+/* MURMUR3.C - MurmurHash3 (x86, 32-bit), seed 0 */
+
+/* Word-wise, non-cryptographic hash by Austin Appleby (public domain). Each
+ * 32-bit word costs two multiplications, a rotation and a few XORs, which is
+ * much cheaper than MD5 on targets without hardware support for either. The
+ * result is the same as the reference implementation for the whole input,
+ * regardless of how it is split into updates. */
+
+#include "murmur3.h"
+
+#define C1  0xCC9E2D51UL
+#define C2  0x1B873593UL
+
+#define ROTL32(x, r)    (((x) << (r)) | ((x) >> (32 - (r))))
+
+static uint32_t mix_k(uint32_t k)
+{
+    k *= C1;
+    k  = ROTL32(k, 15);
+    k *= C2;
+    return k;
+}
+
+static uint32_t mix_h(uint32_t h, uint32_t k)
+{
+    h ^= mix_k(k);
+    h  = ROTL32(h, 13);
+    h  = h*5 + 0xE6546B64UL;
+    return h;
+}
+
+void MURMUR3Init(MURMUR3_CTX *context)
+{
+    context->hash     = 0;
+    context->len      = 0;
+    context->tail     = 0;
+    context->tail_len = 0;
+}
+
+void MURMUR3Update(MURMUR3_CTX *context, uint8_t *input, unsigned int inputLen)
+{
+    uint32_t h = context->hash;
+
+    context->len += inputLen;
+
+    /* Complete word left over from previous update, or reach alignment */
+    while(inputLen && (context->tail_len || ((uintptr_t) input & 3)))
+    {
+        context->tail |= (uint32_t) *input++ << (8*context->tail_len);
+        inputLen--;
+
+        if(++context->tail_len == 4)
+        {
+            h = mix_h(h, context->tail);
+            context->tail     = 0;
+            context->tail_len = 0;
+        }
+    }
+
+    /* Aligned words (little-endian target) */
+    const uint32_t *word = (const uint32_t *) input;
+
+    while(inputLen >= 4)
+    {
+        h = mix_h(h, *word++);
+        inputLen -= 4;
+    }
+
+    /* Keep remaining bytes for next update */
+    input = (uint8_t *) word;
+
+    while(inputLen--)
+        context->tail |= (uint32_t) *input++ << (8*context->tail_len++);
+
+    context->hash = h;
+}
+
+/* Output is big-endian, as the other multi-byte fields of the protocol */
+void MURMUR3Final(uint8_t digest[4], MURMUR3_CTX *context)
+{
+    uint32_t h = context->hash;
+
+    if(context->tail_len)
+        h ^= mix_k(context->tail);
+
+    h ^= context->len;
+    h ^= h >> 16;
+    h *= 0x85EBCA6BUL;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35UL;
+    h ^= h >> 16;
+
+    digest[0] = h >> 24;
+    digest[1] = h >> 16;
+    digest[2] = h >> 8;
+    digest[3] = h;
+}
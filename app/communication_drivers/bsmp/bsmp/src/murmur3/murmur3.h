@@ -0,0 +1,20 @@
+/* MURMUR3.H - header file for MURMUR3.C */
+
+#ifndef MURMUR3_H
+#define MURMUR3_H
+
+#include <stdint.h>
+
+/* MurmurHash3 (x86, 32-bit) context. */
+typedef struct {
+    uint32_t hash;     /* running hash */
+    uint32_t len;      /* number of bytes hashed */
+    uint32_t tail;     /* bytes not yet forming a full word */
+    uint8_t  tail_len; /* number of bytes in tail */
+} MURMUR3_CTX;
+
+void MURMUR3Init(MURMUR3_CTX *);
+void MURMUR3Update(MURMUR3_CTX *, uint8_t *, unsigned int);
+void MURMUR3Final(uint8_t [4], MURMUR3_CTX *);
+
+#endif
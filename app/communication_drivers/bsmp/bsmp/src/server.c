@@ -1,6 +1,7 @@
 #include "../include/server.h"
 #include "server_priv.h"
 #include "bsmp_priv.h"
+#include "delta_rle/delta_rle.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -18,6 +19,7 @@ enum bsmp_err bsmp_server_init (struct bsmp_server *server)
     group_init(&server->groups.list[GROUP_WRITE_ID], GROUP_WRITE_ID);
 
     server->groups.count = GROUP_STANDARD_COUNT;
+    server->groups_fixed = GROUP_STANDARD_COUNT;
 
     return BSMP_SUCCESS;
 }
@@ -50,20 +52,111 @@ enum bsmp_err bsmp_register_variable (bsmp_server_t *server,
     else
         group_add_var(&server->groups.list[GROUP_READ_ID], var);
 
+    // Standard groups changed, so their shadows must be sent again
+    group_shadow_invalidate(server, GROUP_ALL_ID);
+    group_shadow_invalidate(server, GROUP_READ_ID);
+    group_shadow_invalidate(server, GROUP_WRITE_ID);
+
     return BSMP_SUCCESS;
 }
 
-enum bsmp_err bsmp_register_curve (bsmp_server_t *server,
-                                   struct bsmp_curve *curve)
+enum bsmp_err bsmp_register_curve_table (bsmp_server_t *server,
+                                         const struct bsmp_curve *const *list,
+                                         struct bsmp_curve_state *state,
+                                         uint8_t count)
 {
-    SERVER_REGISTER(curve, BSMP_MAX_CURVES);
+    if(!server || !list || !state)
+        return BSMP_ERR_PARAM_INVALID;
+
+    if(count > BSMP_MAX_CURVES)
+        return BSMP_ERR_OUT_OF_MEMORY;
+
+    enum bsmp_err err;
+    unsigned int i;
+    for(i = 0; i < count; ++i)
+    {
+        if((err = curve_check(list[i])))
+            return err;
+
+        if(list[i]->info.id != i)
+            return BSMP_ERR_PARAM_INVALID;
+
+        if(state[i].block_csum && !state[i].block_dirty)
+            return BSMP_ERR_PARAM_INVALID;
+    }
+
+    // Force calculation of every block checksum on first request
+    for(i = 0; i < count; ++i)
+        if(state[i].block_csum)
+            curve_invalidate_blocks(list[i], &state[i]);
+
+    server->curves.list  = list;
+    server->curves.state = state;
+    server->curves.count = count;
+
     return BSMP_SUCCESS;
 }
 
-enum bsmp_err bsmp_register_function (bsmp_server_t *server,
-                                      struct bsmp_func *func)
+enum bsmp_err bsmp_register_function_table (bsmp_server_t *server,
+                                            const struct bsmp_func *const *list,
+                                            uint8_t count)
 {
-    SERVER_REGISTER(func, BSMP_MAX_FUNCTIONS);
+    if(!server || !list)
+        return BSMP_ERR_PARAM_INVALID;
+
+    if(count > BSMP_MAX_FUNCTIONS)
+        return BSMP_ERR_OUT_OF_MEMORY;
+
+    enum bsmp_err err;
+    unsigned int i;
+    for(i = 0; i < count; ++i)
+    {
+        if((err = func_check(list[i])))
+            return err;
+
+        if(list[i]->info.id != i)
+            return BSMP_ERR_PARAM_INVALID;
+    }
+
+    server->funcs.list  = list;
+    server->funcs.count = count;
+
+    return BSMP_SUCCESS;
+}
+
+enum bsmp_err bsmp_register_group (bsmp_server_t *server,
+                                   const uint8_t *var_ids, uint8_t count)
+{
+    if(!server || !var_ids || !count)
+        return BSMP_ERR_PARAM_INVALID;
+
+    // Groups created by clients would be moved by a predefined one
+    if(server->groups.count != server->groups_fixed)
+        return BSMP_ERR_PARAM_INVALID;
+
+    if(server->groups.count >= BSMP_MAX_GROUPS)
+        return BSMP_ERR_OUT_OF_MEMORY;
+
+    unsigned int i;
+    for(i = 0; i < count; ++i)
+    {
+        if(var_ids[i] >= server->vars.count)
+            return BSMP_ERR_PARAM_OUT_OF_RANGE;
+
+        if(i && (var_ids[i] <= var_ids[i-1]))
+            return BSMP_ERR_PARAM_OUT_OF_RANGE;
+    }
+
+    struct bsmp_group *grp = &server->groups.list[server->groups.count];
+
+    group_init(grp, server->groups.count);
+
+    for(i = 0; i < count; ++i)
+        group_add_var(grp, server->vars.list[var_ids[i]]);
+
+    group_shadow_invalidate(server, grp->id);
+    server->groups_fixed = ++server->groups.count;
+
     return BSMP_SUCCESS;
 }
 
@@ -87,6 +180,53 @@ enum bsmp_err bsmp_register_md5(bsmp_server_t *server, bsmp_custom_md5_t md5)
     return BSMP_SUCCESS;
 }
 
+int32_t bsmp_curve_decode_block (uint8_t *dst, uint16_t size, uint8_t *data,
+                                 uint16_t len)
+{
+    int32_t nwords = DeltaRLEDecode((uint32_t *) dst, size >> 2, data, len);
+
+    return nwords < 0 ? -1 : nwords << 2;
+}
+
+enum bsmp_err bsmp_register_batch_select(bsmp_server_t *server,
+                                         bsmp_batch_select_t select,
+                                         bsmp_batch_done_t done)
+{
+    if(!server || !select)
+        return BSMP_ERR_PARAM_INVALID;
+
+    server->batch_select = select;
+    server->batch_done   = done;
+
+    return BSMP_SUCCESS;
+}
+
+enum bsmp_err bsmp_register_read_seqlock(bsmp_server_t *server,
+                                         bsmp_read_begin_t begin,
+                                         bsmp_read_retry_t retry)
+{
+    if(!server || !begin || !retry)
+        return BSMP_ERR_PARAM_INVALID;
+
+    server->read_begin = begin;
+    server->read_retry = retry;
+
+    return BSMP_SUCCESS;
+}
+
+enum bsmp_err bsmp_register_group_shadow(bsmp_server_t *server,
+                                         struct bsmp_shadow_pool *pool,
+                                         bsmp_shadow_client_t client)
+{
+    if(!server || !pool)
+        return BSMP_ERR_PARAM_INVALID;
+
+    server->shadow_pool   = pool;
+    server->shadow_client = client;
+
+    return BSMP_SUCCESS;
+}
+
 struct raw_message
 {
     uint8_t command_code;
@@ -109,6 +249,7 @@ static command_function_t command[256] =
     [CMD_GROUP_QUERY_LIST]      = group_query_list,
     [CMD_GROUP_QUERY]           = group_query,
     [CMD_GROUP_READ]            = group_read,
+    [CMD_GROUP_READ_CHANGED]    = group_read_changed,
     [CMD_GROUP_WRITE]           = group_write,
     [CMD_GROUP_BIN_OP]          = group_bin_op,
     [CMD_GROUP_CREATE]          = group_create,
@@ -120,15 +261,18 @@ static command_function_t command[256] =
     [CMD_CURVE_BLOCK_REQUEST]   = curve_block_request,
     [CMD_CURVE_BLOCK]           = curve_block,
     [CMD_CURVE_RECALC_CSUM]     = curve_recalc_csum,
+    [CMD_CURVE_BLOCK_ENCODED]   = curve_block_encoded,
 
     // Function's functions
     [CMD_FUNC_QUERY_LIST]       = func_query_list,
-    [CMD_FUNC_EXECUTE]          = func_execute
+    [CMD_FUNC_EXECUTE]          = func_execute,
+    [CMD_FUNC_EXECUTE_BATCH]    = func_execute_batch
 };
 
 enum bsmp_err bsmp_process_packet (bsmp_server_t *server,
                                     struct bsmp_raw_packet *request,
-                                    struct bsmp_raw_packet *response)
+                                    struct bsmp_raw_packet *response,
+                                    void *ctx)
 {
     if(!server || !request || !response)
         return BSMP_ERR_PARAM_INVALID;
@@ -146,6 +290,12 @@ enum bsmp_err bsmp_process_packet (bsmp_server_t *server,
 
     send_msg.payload = send_raw_msg->payload;
 
+    // Limit answers to what fits in the buffer of the communication interface
+    if(response->max_len)
+        send_msg.payload_max_size = response->max_len - BSMP_HEADER_SIZE;
+    else
+        send_msg.payload_max_size = UINT16_MAX;
+
     server->modified_list[0] = NULL;
 
     // Check inconsistency between the size of the received data and the size
@@ -157,7 +307,7 @@ enum bsmp_err bsmp_process_packet (bsmp_server_t *server,
     else if(!command[recv_msg.command_code])
         MESSAGE_SET_ANSWER(&send_msg, CMD_ERR_OP_NOT_SUPPORTED);
     else
-        command[recv_msg.command_code](server, &recv_msg, &send_msg);
+        command[recv_msg.command_code](server, &recv_msg, &send_msg, ctx);
 
     send_raw_msg->command_code = send_msg.command_code;
 
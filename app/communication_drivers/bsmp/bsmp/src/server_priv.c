@@ -2,6 +2,8 @@
 #include "server_priv.h"
 #include "../include/server.h"
 #include "md5/md5.h"
+#include "crc32/crc32.h"
+#include "murmur3/murmur3.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -23,7 +25,7 @@ enum bsmp_err var_check (struct bsmp_var *var)
     return BSMP_SUCCESS;
 }
 
-enum bsmp_err curve_check(struct bsmp_curve *curve)
+enum bsmp_err curve_check(const struct bsmp_curve *curve)
 {
     if(!curve)
         return BSMP_ERR_PARAM_INVALID;
@@ -43,7 +45,7 @@ enum bsmp_err curve_check(struct bsmp_curve *curve)
     return BSMP_SUCCESS;
 }
 
-enum bsmp_err func_check(struct bsmp_func *func)
+enum bsmp_err func_check(const struct bsmp_func *func)
 {
     if(!func)
         return BSMP_ERR_PARAM_INVALID;
@@ -76,6 +78,14 @@ void group_add_var (struct bsmp_group *grp, struct bsmp_var *var)
     grp->writable                     &= var->info.writable;
 }
 
+// Group changed, so every client must be sent all its values again
+void group_shadow_invalidate (bsmp_server_t *server, uint8_t id)
+{
+    unsigned int i;
+    for(i = 0; i < BSMP_MAX_SHADOW_CLIENTS; ++i)
+        server->group_shadows[i][id].valid = false;
+}
+
 static void group_to_mod_list (bsmp_server_t *server, struct bsmp_group *grp)
 {
     unsigned int i;
@@ -84,6 +94,201 @@ static void group_to_mod_list (bsmp_server_t *server, struct bsmp_group *grp)
     server->modified_list[i] = NULL;
 }
 
+// Copy values of the group's variables to dst, consistent with each other if
+// a read sequence lock is registered. Returns false if they couldn't be read
+// consistently.
+static bool group_read_values (bsmp_server_t *server, struct bsmp_group *grp,
+                               uint8_t *dst)
+{
+    unsigned int tries = 0;
+    uint32_t seq = 0;
+
+    do
+    {
+        uint8_t *p = dst;
+        unsigned int i;
+
+        if(server->read_begin && !server->read_begin(&seq))
+            return false;
+
+        for(i = 0; i < grp->vars.count; ++i)
+        {
+            struct bsmp_var *var = server->vars.list[grp->vars.list[i]->id];
+            memcpy(p, var->data, var->info.size);
+            p += var->info.size;
+        }
+
+        if(!server->read_retry || !server->read_retry(seq))
+            return true;
+    }
+    while(++tries < BSMP_MAX_READ_RETRIES);
+
+    return false;
+}
+
+/* Helper Curve functions */
+
+#define CURVE_BLOCK_DIRTY_WORD(block)   ((block) >> 5)
+#define CURVE_CSUM_CHUNK_SIZE           256
+#define CURVE_BLOCK_DIRTY_MASK(block)   (1UL << ((block) & 0x1F))
+
+void curve_invalidate_blocks (const struct bsmp_curve *curve,
+                              struct bsmp_curve_state *state)
+{
+    memset(state->block_dirty, 0xFF,
+           ((curve->info.nblocks + 31) >> 5)*sizeof(*state->block_dirty));
+}
+
+static void curve_invalidate_block (struct bsmp_curve_state *state,
+                                    uint16_t block)
+{
+    state->block_dirty[CURVE_BLOCK_DIRTY_WORD(block)] |=
+                                                CURVE_BLOCK_DIRTY_MASK(block);
+}
+
+// Running hash of one of the checksum algorithms
+struct curve_hash
+{
+    enum bsmp_curve_csum_algo algo;
+    union
+    {
+        MD5_CTX     md5;
+        CRC32_CTX   crc32;
+        MURMUR3_CTX murmur3;
+    } ctx;
+};
+
+static void curve_hash_init (struct curve_hash *hash,
+                             enum bsmp_curve_csum_algo algo)
+{
+    hash->algo = algo;
+
+    if(algo == BSMP_CURVE_CSUM_CRC32)
+        CRC32Init(&hash->ctx.crc32);
+    else if(algo == BSMP_CURVE_CSUM_MURMUR3)
+        MURMUR3Init(&hash->ctx.murmur3);
+    else
+        MD5Init(&hash->ctx.md5);
+}
+
+static void curve_hash_update (struct curve_hash *hash, uint8_t *data,
+                               unsigned int len)
+{
+    if(hash->algo == BSMP_CURVE_CSUM_CRC32)
+        CRC32Update(&hash->ctx.crc32, data, len);
+    else if(hash->algo == BSMP_CURVE_CSUM_MURMUR3)
+        MURMUR3Update(&hash->ctx.murmur3, data, len);
+    else
+        MD5Update(&hash->ctx.md5, data, len);
+}
+
+static void curve_hash_final (struct curve_hash *hash, uint8_t *csum)
+{
+    if(hash->algo == BSMP_CURVE_CSUM_CRC32)
+        CRC32Final(csum, &hash->ctx.crc32);
+    else if(hash->algo == BSMP_CURVE_CSUM_MURMUR3)
+        MURMUR3Final(csum, &hash->ctx.murmur3);
+    else
+        MD5Final(csum, &hash->ctx.md5);
+}
+
+// Hash a block in chunks, so blocks of any size are hashed with a small buffer.
+// Word aligned, so the kernels don't fall back to bytewise access. Requests are
+// processed one at a time, so a single buffer is shared by all servers.
+static uint32_t curve_csum_chunk[CURVE_CSUM_CHUNK_SIZE >> 2];
+
+static bool curve_hash_block (const struct bsmp_curve *curve,
+                              struct bsmp_curve_state *state, uint16_t block,
+                              struct curve_hash *hash, uint16_t *read_bytes,
+                              void *ctx)
+{
+    uint16_t offset = 0;
+    uint16_t len, req;
+
+    do
+    {
+        req = curve->info.block_size - offset;
+        if(req > CURVE_CSUM_CHUNK_SIZE)
+            req = CURVE_CSUM_CHUNK_SIZE;
+
+        len = req;
+        if(!curve->read_block_part(curve, state, block, offset,
+                                   (uint8_t *) curve_csum_chunk, &len, ctx))
+            return false;
+
+        curve_hash_update(hash, (uint8_t *) curve_csum_chunk, len);
+        offset += len;
+    }
+    while(len == req && offset < curve->info.block_size);
+
+    *read_bytes = offset;
+    return true;
+}
+
+// Hash only blocks written since last recalculation, then hash the list of
+// block checksums to obtain the checksum of the curve
+static bool curve_recalc_csum_incremental (const struct bsmp_curve *curve,
+                                           struct bsmp_curve_state *state,
+                                           void *ctx)
+{
+    struct curve_hash hash;
+    MD5_CTX md5ctx;
+
+    unsigned int i;
+    for(i = 0; i < curve->info.nblocks; ++i)
+    {
+        if(!(state->block_dirty[CURVE_BLOCK_DIRTY_WORD(i)] &
+             CURVE_BLOCK_DIRTY_MASK(i)))
+            continue;
+
+        uint16_t read_bytes = 0;
+        curve_hash_init(&hash, BSMP_CURVE_CSUM_MD5);
+        if(!curve_hash_block(curve, state, (uint16_t)i, &hash, &read_bytes,
+                             ctx))
+            return false;
+
+        curve_hash_final(&hash, state->block_csum[i]);
+
+        state->block_dirty[CURVE_BLOCK_DIRTY_WORD(i)] &=
+                                                ~CURVE_BLOCK_DIRTY_MASK(i);
+    }
+
+    MD5Init(&md5ctx);
+    MD5Update(&md5ctx, state->block_csum[0],
+              curve->info.nblocks*BSMP_CURVE_CSUM_SIZE);
+    MD5Final(state->checksum, &md5ctx);
+
+    return true;
+}
+
+// Compute checksum over the whole curve, up to the first block which is not
+// full. Word-wise checksums are fast enough to not need per-block caching.
+static bool curve_recalc_csum_whole (const struct bsmp_curve *curve,
+                                     struct bsmp_curve_state *state,
+                                     enum bsmp_curve_csum_algo algo,
+                                     uint8_t *csum, void *ctx)
+{
+    struct curve_hash hash;
+
+    curve_hash_init(&hash, algo);
+
+    unsigned int i;
+    for(i = 0; i < curve->info.nblocks; ++i)
+    {
+        uint16_t read_bytes = 0;
+        if(!curve_hash_block(curve, state, (uint16_t)i, &hash, &read_bytes,
+                             ctx))
+            return false;
+
+        if(read_bytes < curve->info.block_size)
+            break;
+    }
+
+    curve_hash_final(&hash, csum);
+
+    return true;
+}
+
 /* Version */
 
 SERVER_CMD_FUNCTION (query_version)
@@ -152,10 +357,26 @@ SERVER_CMD_FUNCTION (var_read)
         server->hook(BSMP_OP_READ, server->modified_list);
     }
 
-    // Set answer
-    MESSAGE_SET_ANSWER(send_msg, CMD_VAR_VALUE);
-    send_msg->payload_size = var->info.size;
-    memcpy(send_msg->payload, var->data, var->info.size);
+    unsigned int tries = 0;
+    uint32_t seq = 0;
+    do
+    {
+        if(server->read_begin && !server->read_begin(&seq))
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
+
+        memcpy(send_msg->payload, var->data, var->info.size);
+
+        if(!server->read_retry || !server->read_retry(seq))
+        {
+            // Set answer
+            MESSAGE_SET_ANSWER(send_msg, CMD_VAR_VALUE);
+            send_msg->payload_size = var->info.size;
+            return;
+        }
+    }
+    while(++tries < BSMP_MAX_READ_RETRIES);
+
+    MESSAGE_SET_ANSWER(send_msg, CMD_ERR_RESOURCE_BUSY);
 }
 
 SERVER_CMD_FUNCTION (var_write)
@@ -365,19 +586,104 @@ SERVER_CMD_FUNCTION (group_read)
         server->hook(BSMP_OP_READ, server->modified_list);
     }
 
-    // Iterate over group's variables
+    if(!group_read_values(server, grp, send_msg->payload))
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
+
     MESSAGE_SET_ANSWER(send_msg, CMD_GROUP_VALUES);
+    send_msg->payload_size = grp->size;
+}
+
+#define GROUP_READ_ALL  0x01
+
+SERVER_CMD_FUNCTION (group_read_changed)
+{
+    // Payload is the ID and, optionally, the flags
+    if(recv_msg->payload_size != 1 && recv_msg->payload_size != 2)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
+
+    if(!server->shadow_pool)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_OP_NOT_SUPPORTED);
+
+    // Check group ID
+    uint8_t group_id = recv_msg->payload[0];
+
+    if(group_id >= server->groups.count)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
+
+    // Each client keeps its own shadow, so it's sent every change
+    uint8_t client = server->shadow_client ? server->shadow_client(ctx) : 0;
+
+    if(client >= BSMP_MAX_SHADOW_CLIENTS)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_OP_NOT_SUPPORTED);
+
+    // Get desired group and its shadow
+    struct bsmp_group *grp = &server->groups.list[group_id];
+    struct bsmp_group_shadow *shadow = &server->group_shadows[client][group_id];
+    uint16_t bitmap_size = (grp->vars.count + 7) >> 3;
+
+    // Worst case answer must fit, since all values may have changed
+    if(bitmap_size + grp->size > send_msg->payload_max_size)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INSUFFICIENT_MEMORY);
+
+    // Take a shadow from the pool if the group doesn't fit in the current one,
+    // or if it was taken before the pool was emptied
+    struct bsmp_shadow_pool *pool = server->shadow_pool;
+
+    if(shadow->generation != pool->generation || shadow->capacity < grp->size)
+    {
+        if(pool->size - pool->used < grp->size)
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INSUFFICIENT_MEMORY);
+
+        shadow->data       = pool->data + pool->used;
+        shadow->capacity   = grp->size;
+        shadow->generation = pool->generation;
+        shadow->valid      = false;
+        pool->used        += grp->size;
+    }
+
+    if(recv_msg->payload_size == 2 && (recv_msg->payload[1] & GROUP_READ_ALL))
+        shadow->valid = false;
+
+    // Call hook
+    if(server->hook)
+    {
+        group_to_mod_list(server, grp);
+        server->hook(BSMP_OP_READ, server->modified_list);
+    }
 
+    // Take a snapshot of all values right after the bitmap, then compact it in
+    // place, keeping only those which changed. Shadow is left untouched if the
+    // snapshot isn't consistent.
     struct bsmp_var *var;
     unsigned int i;
-    uint8_t *payloadp = send_msg->payload;
+    uint8_t *bitmap = send_msg->payload;
+    uint8_t *payloadp = send_msg->payload + bitmap_size;
+    uint8_t *snapshotp = payloadp;
+    uint8_t *shadowp = shadow->data;
+
+    if(!group_read_values(server, grp, snapshotp))
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
+
+    MESSAGE_SET_ANSWER(send_msg, CMD_GROUP_CHANGED_VALUES);
+    memset(bitmap, 0, bitmap_size);
+
     for(i = 0; i < grp->vars.count; ++i)
     {
         var = server->vars.list[grp->vars.list[i]->id];
-        memcpy(payloadp, var->data, var->info.size);
-        payloadp += var->info.size;
+
+        if(!shadow->valid || memcmp(shadowp, snapshotp, var->info.size))
+        {
+            memcpy(shadowp, snapshotp, var->info.size);
+            memmove(payloadp, snapshotp, var->info.size);
+            payloadp += var->info.size;
+            bitmap[i >> 3] |= 1 << (i & 0x07);
+        }
+        shadowp += var->info.size;
+        snapshotp += var->info.size;
     }
-    send_msg->payload_size = grp->size;
+    shadow->valid = true;
+
+    send_msg->payload_size = payloadp - send_msg->payload;
 }
 
 SERVER_CMD_FUNCTION (group_write)
@@ -498,6 +804,7 @@ SERVER_CMD_FUNCTION (group_create)
 
     // Initialize group id
     group_init(grp, server->groups.count);
+    group_shadow_invalidate(server, server->groups.count);
 
     // Populate group
     int i;
@@ -529,7 +836,20 @@ SERVER_CMD_FUNCTION (group_remove_all)
     if(recv_msg->payload_size != 0)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
 
-    server->groups.count = GROUP_STANDARD_COUNT;
+    server->groups.count = server->groups_fixed;
+
+    unsigned int i;
+    for(i = server->groups_fixed; i < BSMP_MAX_GROUPS; ++i)
+        group_shadow_invalidate(server, i);
+
+    // Shadows are taken from the pool one after the other, so removed groups
+    // can only be given back by emptying it
+    if(server->shadow_pool)
+    {
+        server->shadow_pool->used = 0;
+        server->shadow_pool->generation++;
+    }
+
     MESSAGE_SET_ANSWER(send_msg, CMD_OK);
 }
 
@@ -543,7 +863,7 @@ SERVER_CMD_FUNCTION (curve_query_list)
 
     MESSAGE_SET_ANSWER(send_msg, CMD_CURVE_LIST);
 
-    struct bsmp_curve_info *curve;
+    const struct bsmp_curve_info *curve;
     unsigned int i;
     uint8_t *payloadp = send_msg->payload;
 
@@ -572,10 +892,10 @@ SERVER_CMD_FUNCTION (curve_query_csum)
     if(curve_id >= server->curves.count)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
 
-    struct bsmp_curve *curve = server->curves.list[curve_id];
+    struct bsmp_curve_state *state = &server->curves.state[curve_id];
 
     MESSAGE_SET_ANSWER(send_msg, CMD_CURVE_CSUM);
-    memcpy(send_msg->payload, curve->info.checksum, BSMP_CURVE_CSUM_SIZE);
+    memcpy(send_msg->payload, state->checksum, BSMP_CURVE_CSUM_SIZE);
     send_msg->payload_size = BSMP_CURVE_CSUM_SIZE;
 }
 
@@ -592,21 +912,28 @@ SERVER_CMD_FUNCTION (curve_block_request)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
 
     // Get curve
-    struct bsmp_curve *curve = server->curves.list[curve_id];
+    const struct bsmp_curve *curve = server->curves.list[curve_id];
+    struct bsmp_curve_state *state = &server->curves.state[curve_id];
 
     uint16_t block_offset = (recv_msg->payload[1] << 8) + recv_msg->payload[2];
 
     if(block_offset >= curve->info.nblocks)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_VALUE);
 
+    // Block must fit in the answer, so interfaces with smaller buffers have to
+    // use curves with smaller blocks
+    if(curve->info.block_size + BSMP_CURVE_BLOCK_INFO >
+       send_msg->payload_max_size)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INSUFFICIENT_MEMORY);
+
     MESSAGE_SET_ANSWER(send_msg, CMD_CURVE_BLOCK);
     send_msg->payload[0] = recv_msg->payload[0];    // Curve ID
     send_msg->payload[1] = recv_msg->payload[1];    // Offset (most sig.)
     send_msg->payload[2] = recv_msg->payload[2];    // Offset (less sig.)
 
-    bool ok = curve->read_block(curve, block_offset,
+    bool ok = curve->read_block(curve, state, block_offset,
                                 send_msg->payload + BSMP_CURVE_BLOCK_INFO,
-                                &send_msg->payload_size);
+                                &send_msg->payload_size, ctx);
 
     if(!ok)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
@@ -628,7 +955,8 @@ SERVER_CMD_FUNCTION (curve_block)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
 
     // Get curve
-    struct bsmp_curve *curve = server->curves.list[curve_id];
+    const struct bsmp_curve *curve = server->curves.list[curve_id];
+    struct bsmp_curve_state *state = &server->curves.state[curve_id];
 
     // Check block size
     if(recv_msg->payload_size > curve->info.block_size + BSMP_CURVE_BLOCK_INFO)
@@ -644,21 +972,26 @@ SERVER_CMD_FUNCTION (curve_block)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_READ_ONLY);
 
     // Everything ok, write block
-    bool ok = curve->write_block(curve, block_offset,
+    bool ok = curve->write_block(curve, state, block_offset,
                                  recv_msg->payload + BSMP_CURVE_BLOCK_INFO,
-                                 recv_msg->payload_size - BSMP_CURVE_BLOCK_INFO);
+                                 recv_msg->payload_size - BSMP_CURVE_BLOCK_INFO,
+                                 ctx);
 
     if(!ok)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
 
-    memset(curve->info.checksum, 0, sizeof(curve->info.checksum));
+    memset(state->checksum, 0, sizeof(state->checksum));
+
+    if(state->block_csum)
+        curve_invalidate_block(state, block_offset);
+
     MESSAGE_SET_ANSWER(send_msg, CMD_OK);
 }
 
 SERVER_CMD_FUNCTION (curve_recalc_csum)
 {
-    // Payload must contain Curve ID only
-    if(recv_msg->payload_size != 1)
+    // Payload must contain Curve ID and, optionally, the checksum algorithm
+    if(recv_msg->payload_size != 1 && recv_msg->payload_size != 2)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
 
     // Check curve ID
@@ -667,41 +1000,111 @@ SERVER_CMD_FUNCTION (curve_recalc_csum)
     if(curve_id >= server->curves.count)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
 
+    // Check algorithm. MD5 if not specified, for compatibility.
+    uint8_t algo = BSMP_CURVE_CSUM_MD5;
+
+    if(recv_msg->payload_size == 2)
+        algo = recv_msg->payload[1];
+
+    if(algo >= BSMP_CURVE_CSUM_ALGO_MAX)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_VALUE);
+
     // Get curve
-    struct bsmp_curve *curve = server->curves.list[curve_id];
+    const struct bsmp_curve *curve = server->curves.list[curve_id];
+    struct bsmp_curve_state *state = &server->curves.state[curve_id];
+
+    // Curves which can't be read in parts are those whose reads consume data,
+    // so they have no checksum, not even a custom one
+    if(!curve->read_block_part)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_OP_NOT_SUPPORTED);
+
+    bool custom = (algo == BSMP_CURVE_CSUM_MD5) && !state->block_csum &&
+                  server->custom_md5;
+
+    if(algo != BSMP_CURVE_CSUM_MD5)
+    {
+        if(!curve_recalc_csum_whole(curve, state,
+                                    (enum bsmp_curve_csum_algo) algo,
+                                    send_msg->payload, ctx))
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
+
+        MESSAGE_SET_ANSWER(send_msg, CMD_CURVE_CSUM);
+        send_msg->payload_size = BSMP_CURVE_FAST_CSUM_SIZE;
+        return;
+    }
 
     // Calculate checksum (this might take a while)
-    if(server->custom_md5)
+    if(state->block_csum)
     {
-        if(!server->custom_md5(curve, curve->info.checksum))
+        if(!curve_recalc_csum_incremental(curve, state, ctx))
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
+    }
+    else if(custom)
+    {
+        if(!server->custom_md5(curve, state, state->checksum, ctx))
             MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
     }
     else
     {
-        uint8_t block[curve->info.block_size];
-        MD5_CTX md5ctx;
-
-        MD5Init(&md5ctx);
-
-        unsigned int i;
-        for(i = 0; i < curve->info.nblocks; ++i)
-        {
-            uint16_t read_bytes = 0;
-            if(!curve->read_block(curve, (uint16_t)i, block, &read_bytes))
-                MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
-            MD5Update(&md5ctx, block, read_bytes);
-
-            if(read_bytes < curve->info.nblocks)
-                break;
-        }
-        MD5Final(curve->info.checksum, &md5ctx);
+        if(!curve_recalc_csum_whole(curve, state, BSMP_CURVE_CSUM_MD5,
+                                    state->checksum, ctx))
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
     }
 
     MESSAGE_SET_ANSWER(send_msg, CMD_CURVE_CSUM);
-    memcpy(send_msg->payload, curve->info.checksum, BSMP_CURVE_CSUM_SIZE);
+    memcpy(send_msg->payload, state->checksum, BSMP_CURVE_CSUM_SIZE);
     send_msg->payload_size = BSMP_CURVE_CSUM_SIZE;
 }
 
+SERVER_CMD_FUNCTION (curve_block_encoded)
+{
+    // Payload must contain, at least, 4 bytes (1 for ID, 2 for offset, 1 for
+    // encoded data)
+    if(recv_msg->payload_size < BSMP_CURVE_BLOCK_INFO + 1)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
+
+    // Check curve ID
+    uint8_t curve_id = recv_msg->payload[0];
+
+    if(curve_id >= server->curves.count)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
+
+    // Get curve
+    const struct bsmp_curve *curve = server->curves.list[curve_id];
+    struct bsmp_curve_state *state = &server->curves.state[curve_id];
+
+    // Check offset
+    uint16_t block_offset = (recv_msg->payload[1] << 8) + recv_msg->payload[2];
+    if(block_offset >= curve->info.nblocks)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_VALUE);
+
+    // Check whether the curve can be modified
+    if (!curve->info.writable)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_READ_ONLY);
+
+    if(!curve->write_block_encoded)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_OP_NOT_SUPPORTED);
+
+    uint8_t *data = recv_msg->payload + BSMP_CURVE_BLOCK_INFO;
+    uint16_t len  = recv_msg->payload_size - BSMP_CURVE_BLOCK_INFO;
+
+    // Check encoded data before touching curve memory
+    if(bsmp_curve_decode_block(NULL, curve->info.block_size, data, len) <= 0)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_VALUE);
+
+    // Everything ok, decode block
+    if(!curve->write_block_encoded(curve, state, block_offset, data, len,
+                                   ctx))
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_RESOURCE_BUSY);
+
+    memset(state->checksum, 0, sizeof(state->checksum));
+
+    if(state->block_csum)
+        curve_invalidate_block(state, block_offset);
+
+    MESSAGE_SET_ANSWER(send_msg, CMD_OK);
+}
+
 /* Functions */
 
 SERVER_CMD_FUNCTION (func_query_list)
@@ -712,7 +1115,7 @@ SERVER_CMD_FUNCTION (func_query_list)
 
     MESSAGE_SET_ANSWER(send_msg, CMD_FUNC_LIST);
 
-    struct bsmp_func_info *func_info;
+    const struct bsmp_func_info *func_info;
     unsigned int i;
     for(i = 0; i < server->funcs.count; ++i)
     {
@@ -735,14 +1138,14 @@ SERVER_CMD_FUNCTION (func_execute)
     if(func_id >= server->funcs.count)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
 
-    struct bsmp_func *func = server->funcs.list[func_id];
+    const struct bsmp_func *func = server->funcs.list[func_id];
 
     if(recv_msg->payload_size != 1 + func->info.input_size)
         MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
 
     uint8_t ret;
 
-    ret = func->func_p(&recv_msg->payload[1], &send_msg->payload[0]);
+    ret = func->func_p(&recv_msg->payload[1], &send_msg->payload[0], ctx);
 
     if(ret)
     {
@@ -757,3 +1160,78 @@ SERVER_CMD_FUNCTION (func_execute)
     }
 }
 
+#define BATCH_STOP_ON_ERROR     0x01
+
+SERVER_CMD_FUNCTION (func_execute_batch)
+{
+    // Payload must contain flags and, at least, server and function IDs
+    if(recv_msg->payload_size < 3)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
+
+    if(!server->batch_select)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_OP_NOT_SUPPORTED);
+
+    uint8_t flags = recv_msg->payload[0];
+    uint8_t func_error;
+    uint16_t in_idx, out_size = 0;
+    bsmp_server_t *target;
+    const struct bsmp_func *func;
+
+    // Check whole batch before executing any function
+    for(in_idx = 1; in_idx < recv_msg->payload_size;
+        in_idx += 2 + func->info.input_size)
+    {
+        if(recv_msg->payload_size - in_idx < 2)
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
+
+        uint8_t func_id = recv_msg->payload[in_idx + 1];
+
+        target = server->batch_select(recv_msg->payload[in_idx], func_id,
+                                      NULL, ctx);
+
+        if(!target || func_id >= target->funcs.count)
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_ID);
+
+        func = target->funcs.list[func_id];
+
+        if(recv_msg->payload_size - in_idx - 2 < func->info.input_size)
+            MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INVALID_PAYLOAD_SIZE);
+
+        out_size += 1 + func->info.output_size;
+    }
+
+    if(out_size > send_msg->payload_max_size)
+        MESSAGE_SET_ANSWER_RET(send_msg, CMD_ERR_INSUFFICIENT_MEMORY);
+
+    // Execute functions, concatenating result and output of each one
+    MESSAGE_SET_ANSWER(send_msg, CMD_FUNC_BATCH_RETURN);
+
+    for(in_idx = 1; in_idx < recv_msg->payload_size;
+        in_idx += 2 + func->info.input_size)
+    {
+        uint8_t *result = &send_msg->payload[send_msg->payload_size];
+        uint8_t func_id = recv_msg->payload[in_idx + 1];
+
+        func_error = 0;
+        target = server->batch_select(recv_msg->payload[in_idx], func_id,
+                                      &func_error, ctx);
+        func = target->funcs.list[func_id];
+
+        memset(result, 0, 1 + func->info.output_size);
+
+        if(!func_error)
+        {
+            func_error = func->func_p(&recv_msg->payload[in_idx + 2],
+                                      result + 1, ctx);
+
+            if(server->batch_done)
+                func_error = server->batch_done(func_error, result + 1, ctx);
+        }
+
+        *result = func_error;
+        send_msg->payload_size += 1 + func->info.output_size;
+
+        if(func_error && (flags & BATCH_STOP_ON_ERROR))
+            break;
+    }
+}
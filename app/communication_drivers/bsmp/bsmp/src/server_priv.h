@@ -26,6 +26,7 @@ struct message
 {
     uint8_t  command_code;
     uint16_t payload_size;
+    uint16_t payload_max_size;
     uint8_t  *payload;
 };
 
@@ -37,17 +38,21 @@ struct generic_list
 
 #define SERVER_CMD_FUNCTION(name) \
     void name (bsmp_server_t *server, struct message *recv_msg, \
-               struct message *send_msg)
+               struct message *send_msg, void *ctx)
 
 typedef SERVER_CMD_FUNCTION((*command_function_t));
 
 
 enum bsmp_err var_check     (struct bsmp_var *var);
-enum bsmp_err curve_check   (struct bsmp_curve *curve);
-enum bsmp_err func_check    (struct bsmp_func *func);
+enum bsmp_err curve_check   (const struct bsmp_curve *curve);
+enum bsmp_err func_check    (const struct bsmp_func *func);
 
 void          group_init    (struct bsmp_group *grp, uint8_t id);
 void          group_add_var (struct bsmp_group *grp, struct bsmp_var *var);
+void          group_shadow_invalidate (bsmp_server_t *server, uint8_t id);
+
+void          curve_invalidate_blocks (const struct bsmp_curve *curve,
+                                        struct bsmp_curve_state *state);
 
 SERVER_CMD_FUNCTION (query_version);
 SERVER_CMD_FUNCTION (var_query_list);
@@ -58,6 +63,7 @@ SERVER_CMD_FUNCTION (var_bin_op);
 SERVER_CMD_FUNCTION (group_query_list);
 SERVER_CMD_FUNCTION (group_query);
 SERVER_CMD_FUNCTION (group_read);
+SERVER_CMD_FUNCTION (group_read_changed);
 SERVER_CMD_FUNCTION (group_write);
 SERVER_CMD_FUNCTION (group_bin_op);
 SERVER_CMD_FUNCTION (group_create);
@@ -67,7 +73,9 @@ SERVER_CMD_FUNCTION (curve_query_csum);
 SERVER_CMD_FUNCTION (curve_block_request);
 SERVER_CMD_FUNCTION (curve_block);
 SERVER_CMD_FUNCTION (curve_recalc_csum);
+SERVER_CMD_FUNCTION (curve_block_encoded);
 SERVER_CMD_FUNCTION (func_query_list);
 SERVER_CMD_FUNCTION (func_execute);
+SERVER_CMD_FUNCTION (func_execute_batch);
 
 #endif
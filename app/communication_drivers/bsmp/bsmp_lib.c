@@ -39,6 +39,7 @@
 #include "communication_drivers/rs485/rs485.h"
 #include "communication_drivers/scope/scope.h"
 #include "communication_drivers/system_task/system_task.h"
+#include "communication_drivers/timer/timer.h"
 
 #include "inc/hw_memmap.h"
 #include "inc/hw_ipc.h"
@@ -53,78 +54,422 @@
 #include "bsmp/include/server.h"
 #include "bsmp_lib.h"
 
-#define TIMEOUT_DSP_IPC_ACK         30
+/**
+ * Timeout for C28 acknowledge of IPC commands, in global timer ticks (~1 ms).
+ * Tick resolution makes the actual timeout up to one tick shorter.
+ */
+#define TIMEOUT_DSP_IPC_ACK         5
 
-#define SIZE_WFMREF_BLOCK           8192
+#define SIZE_CURVE_BLOCK            1024
+#define SIZE_LARGE_CURVE_BLOCK      8192
 #define SIZE_SAMPLES_BUFFER         16384
 
 #define NUMBER_OF_BSMP_SERVERS      4
 #define NUMBER_OF_BSMP_CURVES       8
-#define NUMBER_OF_BSMP_FUNCTIONS    50
+
+/**
+ * Attempts to read power supply modules state while C28 updates it, which
+ * takes a small fraction of a control cycle
+ */
+#define TIMEOUT_PS_MODULE_UPDATE    100
+
+#define NUMBER_OF_WFMREF_CURVES     2
+#define NUMBER_OF_WFMREF_BLOCKS     16
+
+/**
+ * Curves 0 to 2 have 1 kB blocks, which fit in every interface buffer. Curves
+ * 3 to 5 are views of the same buffers with large blocks, so interfaces with
+ * large buffers (RS485, Ethernet writes) need fewer transactions per curve.
+ */
+#define LARGE_BLOCK_CURVES_OFFSET   3
+#define CURVE_BUFFER_ID(curve)      ((curve)->info.id % LARGE_BLOCK_CURVES_OFFSET)
 
 #define BSMP_QUERY_COMMANDS         0x10
 #define BSMP_READ_COMMANDS          0x20
 #define BSMP_BLOCK_COMMANDS         0x40
 #define BSMP_FUNC_EXECUTE           0x50
+#define BSMP_FUNC_RETURN            0x51
 #define BSMP_FUNC_ERROR             0x53
+#define BSMP_FUNC_EXECUTE_BATCH     0x54
 
 volatile bsmp_server_t bsmp[NUMBER_OF_BSMP_SERVERS];
 
-volatile unsigned long ulTimeout;
+static struct bsmp_var bsmp_vars[NUMBER_OF_BSMP_SERVERS][BSMP_MAX_VARIABLES];
+static struct bsmp_curve_state bsmp_curves_state[NUMBER_OF_BSMP_SERVERS][NUMBER_OF_BSMP_CURVES];
 
-static uint8_t dummy_u8;
+/**
+ * Scope stream curves drain whole frames, after a header with frame sequence
+ * number and dropped frames counter. Ring has as many frames as fit in scope
+ * buffer. Block number of a request acknowledges frames received, with the low
+ * byte of the next sequence number, so curves have a block for each value.
+ */
+#define SIZE_STREAM_HEADER          4
+#define STREAM_NUM_BLOCKS           256
+#define SIZE_STREAM_FRAME           (STREAM_FRAME_SIZE * sizeof(float))
+#define STREAM_NUM_FRAMES(p_buf)    ((uint16_t) (((p_buf)->p_buf_end.p_f -   \
+                                                  (p_buf)->p_buf_start.p_f + 1) \
+                                                 / STREAM_FRAME_SIZE))
 
-static struct bsmp_var bsmp_vars[NUMBER_OF_BSMP_SERVERS][BSMP_MAX_VARIABLES];
-static struct bsmp_curve bsmp_curves[NUMBER_OF_BSMP_SERVERS][NUMBER_OF_BSMP_CURVES];
-static struct bsmp_func bsmp_funcs[NUMBER_OF_BSMP_SERVERS][NUMBER_OF_BSMP_FUNCTIONS];
+static uint16_t stream_session = 0;
+static uint16_t stream_seq[NUMBER_OF_BSMP_SERVERS];     // First frame at tail
+static uint16_t stream_sent[NUMBER_OF_BSMP_SERVERS];    // Sent, not released
 
 /**
- * @brief Turn on BSMP Function
+ * Per-block checksums for WfmRef curves, so only written blocks are hashed
+ * again on checksum recalculation. Samples buffer curve is written by C28,
+ * which isn't tracked by BSMP, so it keeps full recalculation.
+ */
+static uint8_t wfmref_block_csum[NUMBER_OF_BSMP_SERVERS][NUMBER_OF_WFMREF_CURVES]
+                                [NUMBER_OF_WFMREF_BLOCKS][BSMP_CURVE_CSUM_SIZE];
+static uint32_t wfmref_block_dirty[NUMBER_OF_BSMP_SERVERS][NUMBER_OF_WFMREF_CURVES]
+                                  [(NUMBER_OF_WFMREF_BLOCKS + 31) >> 5];
+
+/**
+ * Variables of the slow diagnostics group, common to all power supplies
+ */
+static const uint8_t bsmp_group_diagnostics[] =
+{
+    4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30
+};
+
+/**
+ * Shadows of groups read with the read changed command, shared by all servers
+ * and kept apart for each command interface. Fits groups with all variables of
+ * the largest power supply models, both read-only and writable, plus a few
+ * created groups, read by two interfaces. Reads by a third one fail with
+ * insufficient memory if the pool is full, and it must use group read instead.
+ */
+#define SIZE_GROUP_SHADOW_POOL      4096
+
+static uint8_t group_shadow_data[SIZE_GROUP_SHADOW_POOL];
+static struct bsmp_shadow_pool group_shadow_pool =
+{
+    .data = group_shadow_data,
+    .size = SIZE_GROUP_SHADOW_POOL,
+    .used = 0
+};
+
+/**
+ * Callback executed when C28 acknowledges a pending IPC command. It may fill
+ * the function output with data which is only valid after DSP processing.
+ */
+typedef void (*ipc_ack_t)(uint8_t ps_id, uint8_t *output);
+
+/**
+ * Pending IPC command. BSMP functions which send an IPC message to C28 don't
+ * wait for its acknowledge. Instead, they register this record and return
+ * immediately, and the communication interface defers its response until
+ * bsmp_check_pending_cmd() finds the command acknowledged by C28 (or timeout).
+ * Low priority messages are acknowledged through command ring, if C28 serves
+ * it, so one command per interface may be in flight. Otherwise, C28 clears
+ * the IPC flag and only one command is allowed at a time.
+ */
+#define NUMBER_OF_PENDING_CMDS      4
+
+typedef struct
+{
+    volatile bool           pending;
+    bool                    on_ring;
+    bool                    timed_out;
+    uint16_t                seq;
+    uint32_t                ipc_flag;
+    uint32_t                start;      // global_timer_ticks when sent
+    uint8_t                 ps_id;
+    uint8_t                 *output;
+    ipc_ack_t               p_on_ack;
+    struct bsmp_raw_packet  *response;
+    void                    (*p_send_response)(void);
+} ipc_pending_cmd_t;
+
+static ipc_pending_cmd_t ipc_pending_cmd[NUMBER_OF_PENDING_CMDS];
+
+/**
+ * Record registered by last processed request, still waiting for its response
+ * to be attached by bsmp_defer_response()
+ */
+static ipc_pending_cmd_t *p_new_pending_cmd = NULL;
+
+enum bsmp_err bsmp_func_error(uint8_t func_error,
+                              struct bsmp_raw_packet *response);
+
+/**
+ * @brief Get a free pending command record
  *
- * Turn on the specified power supply
+ * @return pointer to free record. NULL if all are in use.
+ */
+static ipc_pending_cmd_t *get_free_pending_cmd(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < NUMBER_OF_PENDING_CMDS; i++)
+    {
+        if(!ipc_pending_cmd[i].pending)
+        {
+            return &ipc_pending_cmd[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Check if there's any command waiting for C28 acknowledge
+ */
+static bool any_pending_cmd(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < NUMBER_OF_PENDING_CMDS; i++)
+    {
+        if(ipc_pending_cmd[i].pending)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Check if a new IPC command can be sent to C28
  *
- * @param uint8_t* Pointer to input packet of data
- * @param uint8_t* Pointer to output packet of data
+ * @param ipc_flag MTOCIPCFLG bits used by IPC command
+ * @return 1 if command can't be sent now, 0 otherwise
+ */
+static uint16_t ipc_cmd_busy(uint32_t ipc_flag)
+{
+    if( (ipc_flag & IPC_MTOC_LOWPRIORITY_MSG) && ipc_cmd_ring_enabled() )
+    {
+        return (get_free_pending_cmd() == NULL) || ipc_cmd_ring_full();
+    }
+
+    return any_pending_cmd() || ipc_mtoc_busy(ipc_flag);
+}
+
+/**
+ * @brief Register pending acknowledge for an IPC command sent to C28
+ *
+ * @param sent status returned by send_ipc_lowpriority_msg(). If command wasn't
+ *             queued, nothing is registered, so the response can't complete
+ *             with the result of an older command.
+ * @param ps_id power supply ID
+ * @param ipc_flag MTOCIPCFLG bits to be cleared by C28 acknowledge
+ * @param output pointer to output packet of data of BSMP function
+ * @param p_on_ack callback executed after acknowledge. NULL if not used.
+ * @return command_ack for BSMP function
  */
-static uint8_t bsmp_turn_on(uint8_t *input, uint8_t *output)
+static uint8_t defer_ipc_ack(bool sent, uint8_t ps_id, uint32_t ipc_flag,
+                             uint8_t *output, ipc_ack_t p_on_ack)
 {
-    ulTimeout=0;
+    /// ipc_cmd_busy() was checked before sending, so a record is free
+    ipc_pending_cmd_t *p_cmd = get_free_pending_cmd();
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Turn_On)))
+    if(!sent || (p_cmd == NULL))
     {
-        *output = DSP_Busy;
+        return DSP_Busy;
+    }
+
+    p_cmd->on_ring          = (ipc_flag & IPC_MTOC_LOWPRIORITY_MSG) &&
+                              ipc_cmd_ring_enabled();
+    p_cmd->seq              = ipc_cmd_ring_last_seq();
+    p_cmd->ipc_flag         = ipc_flag;
+    p_cmd->start            = global_timer_ticks;
+    p_cmd->timed_out        = false;
+    p_cmd->ps_id            = ps_id;
+    p_cmd->output           = output;
+    p_cmd->p_on_ack         = p_on_ack;
+    p_cmd->response         = NULL;
+    p_cmd->p_send_response  = NULL;
+    p_cmd->pending          = true;
+
+    p_new_pending_cmd = p_cmd;
+
+    return Ok;
+}
+
+/**
+ * @brief Check whether specified response is waiting for C28 acknowledge
+ *
+ * @param response pointer to response packet. NULL checks whether last
+ *                 processed request left a command pending.
+ * @return true if response is pending
+ */
+bool bsmp_cmd_pending(struct bsmp_raw_packet *response)
+{
+    uint8_t i;
+
+    if(response == NULL)
+    {
+        return (p_new_pending_cmd != NULL) && p_new_pending_cmd->pending;
+    }
+
+    for(i = 0; i < NUMBER_OF_PENDING_CMDS; i++)
+    {
+        if(ipc_pending_cmd[i].pending &&
+           (ipc_pending_cmd[i].response == response))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Defer transmission of response until C28 acknowledges pending command
+ *
+ * Must be called by communication interface right after BSMPprocess(), when
+ * bsmp_cmd_pending() indicates an IPC command is pending.
+ *
+ * @param response pointer to response packet built by BSMPprocess()
+ * @param p_send_response function which transmits response packet. NULL if
+ *                        caller transmits it after bsmp_wait_pending_cmd().
+ */
+void bsmp_defer_response(struct bsmp_raw_packet *response,
+                         void (*p_send_response)(void))
+{
+    if(!bsmp_cmd_pending(NULL))
+    {
+        return;
+    }
+
+    p_new_pending_cmd->response        = response;
+    p_new_pending_cmd->p_send_response = p_send_response;
+    p_new_pending_cmd = NULL;
+}
+
+/**
+ * @brief Complete pending IPC command, if acknowledged or timed out
+ *
+ * @param p_cmd pointer to pending command record
+ */
+static void check_pending_cmd(ipc_pending_cmd_t *p_cmd)
+{
+    bool acked;
+
+    if(p_cmd->on_ring)
+    {
+        acked = ipc_cmd_ring_acked(p_cmd->seq, NULL);
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_status.bit.state = SlowRef;
-        send_ipc_lowpriority_msg(g_current_ps_id, Turn_On);
+        acked = !(HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) & p_cmd->ipc_flag);
+    }
 
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Turn_On)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
+    if(!acked)
+    {
+        if((global_timer_ticks - p_cmd->start) < TIMEOUT_DSP_IPC_ACK)
         {
-            ulTimeout++;
+            return;
         }
 
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
+        p_cmd->timed_out = true;
+
+        if(p_cmd->response != NULL)
         {
-            *output = DSP_Timeout;
+            bsmp_func_error(DSP_Timeout, p_cmd->response);
         }
         else
         {
-            if(g_ipc_ctom.ps_module[0].ps_status.bit.model == FBP_DCLink)
-            {
-                g_ipc_mtoc.ps_module[0].ps_setpoint.f = get_digital_potentiometer();
-            }
+            *p_cmd->output = DSP_Timeout;
+        }
+    }
+    else if(p_cmd->p_on_ack != NULL)
+    {
+        p_cmd->p_on_ack(p_cmd->ps_id, p_cmd->output);
+    }
 
-            *output = Ok;
+    if(p_cmd->p_send_response != NULL)
+    {
+        p_cmd->p_send_response();
+    }
+
+    /**
+     * Only release record after transmission, so the response buffer isn't
+     * overwritten by a new request in the meantime.
+     */
+    p_cmd->pending = false;
+}
+
+/**
+ * @brief Deferred task for completion of pending IPC commands
+ *
+ * Checks whether C28 has acknowledged the pending IPC commands. For each one
+ * acknowledged, or whose timeout has expired, the deferred response is
+ * completed and transmitted. Timeout is measured with global timer, so it
+ * doesn't depend on how often this task runs.
+ */
+void bsmp_check_pending_cmd(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < NUMBER_OF_PENDING_CMDS; i++)
+    {
+        if(ipc_pending_cmd[i].pending)
+        {
+            check_pending_cmd(&ipc_pending_cmd[i]);
         }
     }
+}
+
+/**
+ * @brief Wait for completion of pending IPC commands
+ *
+ * Used by callers which need the BSMP function result before proceeding, such
+ * as broadcast messages and internal tasks.
+ */
+void bsmp_wait_pending_cmd(void)
+{
+    while(any_pending_cmd())
+    {
+        bsmp_check_pending_cmd();
+    }
+}
+
+/**
+ * @brief Turn on acknowledge callback
+ *
+ * FBP DC-Link setpoint follows digital potentiometer after turn on.
+ */
+static void turn_on_ack(uint8_t ps_id, uint8_t *output)
+{
+    if(g_ipc_ctom.ps_module[0].ps_status.bit.model == FBP_DCLink)
+    {
+        g_ipc_mtoc.ps_module[0].ps_setpoint.f = get_digital_potentiometer();
+    }
+}
+
+/**
+ * @brief Turn on BSMP Function
+ *
+ * Turn on the specified power supply
+ *
+ * @param uint8_t* Pointer to input packet of data
+ * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
+ */
+static uint8_t bsmp_turn_on(uint8_t *input, uint8_t *output, void *ctx)
+{
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Turn_On)))
+    {
+        *output = DSP_Busy;
+    }
+    else
+    {
+        g_ipc_mtoc.ps_module[ps_id].ps_status.bit.state = SlowRef;
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Turn_On), ps_id,
+                                low_priority_msg_to_reg(Turn_On), output,
+                                turn_on_ack);
+    }
 
     return *output;
 }
 
-static struct bsmp_func bsmp_func_turn_on = {
+static const struct bsmp_func bsmp_func_turn_on = {
+    .info.id          = 0,
     .func_p           = bsmp_turn_on,
     .info.input_size  = 0, // Nothing is read from the input parameter
     .info.output_size = 1, // command_ack
@@ -137,34 +482,28 @@ static struct bsmp_func bsmp_func_turn_on = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-static uint8_t bsmp_turn_off(uint8_t *input, uint8_t *output)
+static uint8_t bsmp_turn_off(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Turn_Off)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Turn_Off)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_status.bit.state = Off;
-        send_ipc_lowpriority_msg(g_current_ps_id, Turn_Off);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Turn_Off)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK)){
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK){
-            *output = DSP_Timeout;
-        }
-        else{
-            *output = Ok;
-        }
+        g_ipc_mtoc.ps_module[ps_id].ps_status.bit.state = Off;
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Turn_Off),
+                                ps_id, low_priority_msg_to_reg(Turn_Off),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_turn_off = {
+static const struct bsmp_func bsmp_func_turn_off = {
+    .info.id          = 1,
     .func_p           = bsmp_turn_off,
     .info.input_size  = 0,       // Nothing is read from the input parameter
     .info.output_size = 1,       // command_ack
@@ -177,33 +516,25 @@ static struct bsmp_func bsmp_func_turn_off = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_open_loop(uint8_t *input, uint8_t *output)
+uint8_t bsmp_open_loop(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state == Off ||
-       g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked == UNLOCKED)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.state == Off ||
+       g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked == UNLOCKED)
     {
-        if(ipc_mtoc_busy(low_priority_msg_to_reg(Open_Loop)))
+        if(ipc_cmd_busy(low_priority_msg_to_reg(Open_Loop)))
         {
             *output = DSP_Busy;
         }
         else
         {
-            g_ipc_mtoc.ps_module[g_current_ps_id].ps_status.bit.openloop = 1;
-            send_ipc_lowpriority_msg(g_current_ps_id, Open_Loop);
-            while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                    low_priority_msg_to_reg(Open_Loop)) &&
-                    (ulTimeout<TIMEOUT_DSP_IPC_ACK)){
-                ulTimeout++;
-            }
-            if(ulTimeout==TIMEOUT_DSP_IPC_ACK){
-                *output = DSP_Timeout;
-            }
-            else{
-                *output = Ok;
-            }
+            g_ipc_mtoc.ps_module[ps_id].ps_status.bit.openloop = 1;
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Open_Loop),
+                                    ps_id, low_priority_msg_to_reg(Open_Loop),
+                                    output, NULL);
         }
     }
 
@@ -215,7 +546,8 @@ uint8_t bsmp_open_loop(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_open_loop = {
+static const struct bsmp_func bsmp_func_open_loop = {
+    .info.id          = 2,
     .func_p           = bsmp_open_loop,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
@@ -228,34 +560,26 @@ static struct bsmp_func bsmp_func_open_loop = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_closed_loop(uint8_t *input, uint8_t *output)
+uint8_t bsmp_closed_loop(uint8_t *input, uint8_t *output, void *ctx)
 {
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state == Off ||
-       g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked == UNLOCKED)
-    {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-        ulTimeout=0;
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.state == Off ||
+       g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked == UNLOCKED)
+    {
 
-        if(ipc_mtoc_busy(low_priority_msg_to_reg(Close_Loop)))
+        if(ipc_cmd_busy(low_priority_msg_to_reg(Close_Loop)))
         {
             *output = DSP_Busy;
         }
         else
         {
-            g_ipc_mtoc.ps_module[g_current_ps_id].ps_status.bit.openloop = 0;
-            send_ipc_lowpriority_msg(g_current_ps_id, Close_Loop);
-            while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                    low_priority_msg_to_reg(Close_Loop)) &&
-                    (ulTimeout<TIMEOUT_DSP_IPC_ACK)){
-                ulTimeout++;
-            }
-            if(ulTimeout==TIMEOUT_DSP_IPC_ACK){
-                *output = DSP_Timeout;
-            }
-            else{
-                *output = Ok;
-            }
+            g_ipc_mtoc.ps_module[ps_id].ps_status.bit.openloop = 0;
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Close_Loop),
+                                    ps_id, low_priority_msg_to_reg(Close_Loop),
+                                    output, NULL);
         }
     }
 
@@ -267,7 +591,8 @@ uint8_t bsmp_closed_loop(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_closed_loop = {
+static const struct bsmp_func bsmp_func_closed_loop = {
+    .info.id          = 3,
     .func_p           = bsmp_closed_loop,
     .info.input_size  = 0,       // Nothing is read from the input parameter
     .info.output_size = 1,       // command_ack
@@ -280,41 +605,35 @@ static struct bsmp_func bsmp_func_closed_loop = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_select_op_mode(uint8_t *input, uint8_t *output)
+uint8_t bsmp_select_op_mode(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
 
     /// TODO: fix this temporary solution
     WFMREF[1].sync_mode.enu = WFMREF[0].sync_mode.enu;
     WFMREF[2].sync_mode.enu = WFMREF[0].sync_mode.enu;
     WFMREF[3].sync_mode.enu = WFMREF[0].sync_mode.enu;
 
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Operating_Mode)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Operating_Mode)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_status.bit.state =
+        g_ipc_mtoc.ps_module[ps_id].ps_status.bit.state =
                 (ps_state_t)(input[1] << 8) | input[0];
-        send_ipc_lowpriority_msg(g_current_ps_id, Operating_Mode);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Operating_Mode)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK)){
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK){
-            *output = DSP_Timeout;
-        }
-        else{
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Operating_Mode),
+                                ps_id, low_priority_msg_to_reg(Operating_Mode),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_select_op_mode = {
+static const struct bsmp_func bsmp_func_select_op_mode = {
+    .info.id          = 4,
     .func_p           = bsmp_select_op_mode,
     .info.input_size  = 2,       // Uint16 ps_opmode
     .info.output_size = 1,      // command_ack
@@ -327,11 +646,14 @@ static struct bsmp_func bsmp_func_select_op_mode = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_reset_interlocks(uint8_t *input, uint8_t *output)
+uint8_t bsmp_reset_interlocks(uint8_t *input, uint8_t *output, void *ctx)
 {
-    g_ipc_mtoc.ps_module[g_current_ps_id].ps_hard_interlock.u32 = 0;
-    g_ipc_mtoc.ps_module[g_current_ps_id].ps_soft_interlock.u32 = 0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    g_ipc_mtoc.ps_module[ps_id].ps_hard_interlock.u32 = 0;
+    g_ipc_mtoc.ps_module[ps_id].ps_soft_interlock.u32 = 0;
 
     switch(g_ipc_ctom.ps_module[0].ps_status.bit.model)
     {
@@ -370,9 +692,7 @@ uint8_t bsmp_reset_interlocks(uint8_t *input, uint8_t *output)
         }
     }
 
-    ulTimeout=0;
-
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Reset_Interlocks)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Reset_Interlocks)))
     {
         *output = DSP_Busy;
     }
@@ -380,26 +700,16 @@ uint8_t bsmp_reset_interlocks(uint8_t *input, uint8_t *output)
     {
         TaskSetNew(CLEAR_ITLK_ALARM);
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Reset_Interlocks);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Reset_Interlocks)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Reset_Interlocks),
+                                ps_id,
+                                low_priority_msg_to_reg(Reset_Interlocks),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_reset_interlocks = {
+static const struct bsmp_func bsmp_func_reset_interlocks = {
+    .info.id          = 5,
     .func_p           = bsmp_reset_interlocks,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
@@ -412,8 +722,9 @@ static struct bsmp_func bsmp_func_reset_interlocks = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_serial_termination(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_serial_termination(uint8_t *input, uint8_t *output, void *ctx)
 {
     set_param(RS485_Termination, 0, input[0]);
     rs485_term_ctrl(input[0]);
@@ -421,7 +732,8 @@ uint8_t bsmp_set_serial_termination(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_serial_termination = {
+static const struct bsmp_func bsmp_func_set_serial_termination = {
+    .info.id          = 7,
     .func_p           = bsmp_set_serial_termination,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -433,37 +745,31 @@ static struct bsmp_func bsmp_func_set_serial_termination = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_command_interface(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_command_interface(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_Command_Interface)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_Command_Interface)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_status.bit.interface =
+        g_ipc_mtoc.ps_module[ps_id].ps_status.bit.interface =
                 (ps_interface_t)(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Set_Command_Interface);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_Command_Interface)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK)){
-            ulTimeout++;
-        }
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK){
-            *output = DSP_Timeout;
-        }
-        else{
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Set_Command_Interface),
+                                ps_id,
+                                low_priority_msg_to_reg(Set_Command_Interface),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_command_interface = {
+static const struct bsmp_func bsmp_func_set_command_interface = {
+    .info.id          = 6,
     .func_p           = bsmp_set_command_interface,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -491,36 +797,27 @@ static struct bsmp_func bsmp_func_set_command_interface = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_unlock_udc(uint8_t *input, uint8_t *output)
+uint8_t bsmp_unlock_udc(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     uint16_t password;
 
     password =  (uint16_t) (input[1] << 8) | input[0];
 
     if(password == PASSWORD)
     {
-        if(ipc_mtoc_busy(low_priority_msg_to_reg(Unlock_UDC)))
+        if(ipc_cmd_busy(low_priority_msg_to_reg(Unlock_UDC)))
         {
             *output = DSP_Busy;
         }
         else
         {
-            send_ipc_lowpriority_msg(g_current_ps_id, Unlock_UDC);
-            while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                    low_priority_msg_to_reg(Unlock_UDC)) &&
-                    (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-            {
-                ulTimeout++;
-            }
-            if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-            {
-                *output = DSP_Timeout;
-            }
-            else
-            {
-                *output = Ok;
-            }
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Unlock_UDC),
+                                    ps_id, low_priority_msg_to_reg(Unlock_UDC),
+                                    output, NULL);
         }
     }
 
@@ -532,7 +829,8 @@ uint8_t bsmp_unlock_udc(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_unlock_udc = {
+static const struct bsmp_func bsmp_func_unlock_udc = {
+    .info.id          = 8,
     .func_p           = bsmp_unlock_udc,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -559,36 +857,27 @@ static struct bsmp_func bsmp_func_unlock_udc = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_lock_udc(uint8_t *input, uint8_t *output)
+uint8_t bsmp_lock_udc(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     uint16_t password;
 
     password =  (uint16_t) (input[1] << 8) | input[0];
 
     if(password == PASSWORD)
     {
-        if(ipc_mtoc_busy(low_priority_msg_to_reg(Lock_UDC)))
+        if(ipc_cmd_busy(low_priority_msg_to_reg(Lock_UDC)))
         {
             *output = DSP_Busy;
         }
         else
         {
-            send_ipc_lowpriority_msg(g_current_ps_id, Lock_UDC);
-            while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                    low_priority_msg_to_reg(Lock_UDC)) &&
-                    (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-            {
-                ulTimeout++;
-            }
-            if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-            {
-                *output = DSP_Timeout;
-            }
-            else
-            {
-                *output = Ok;
-            }
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Lock_UDC),
+                                    ps_id, low_priority_msg_to_reg(Lock_UDC),
+                                    output, NULL);
         }
     }
 
@@ -600,7 +889,8 @@ uint8_t bsmp_lock_udc(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_lock_udc = {
+static const struct bsmp_func bsmp_func_lock_udc = {
+    .info.id          = 9,
     .func_p           = bsmp_lock_udc,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -614,41 +904,31 @@ static struct bsmp_func bsmp_func_lock_udc = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_cfg_source_scope(uint8_t *input, uint8_t *output)
+uint8_t bsmp_cfg_source_scope(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Cfg_Source_Scope)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Cfg_Source_Scope)))
     {
         *output = 6;
     }
     else
     {
-        g_ipc_mtoc.scope[g_current_ps_id].p_source.u32 = (input[3]<< 24) |
+        g_ipc_mtoc.scope[ps_id].p_source.u32 = (input[3]<< 24) |
                         (input[2] << 16)|(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Cfg_Source_Scope);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Cfg_Source_Scope)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = 5;
-        }
-        else
-        {
-            *output = 0;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Cfg_Source_Scope),
+                                ps_id,
+                                low_priority_msg_to_reg(Cfg_Source_Scope),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_cfg_source_scope = {
+static const struct bsmp_func bsmp_func_cfg_source_scope = {
+    .info.id          = 10,
     .func_p           = bsmp_cfg_source_scope,
     .info.input_size  = 4,
     .info.output_size = 1,
@@ -663,41 +943,30 @@ static struct bsmp_func bsmp_func_cfg_source_scope = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_cfg_freq_scope(uint8_t *input, uint8_t *output)
+uint8_t bsmp_cfg_freq_scope(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Cfg_Freq_Scope)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Cfg_Freq_Scope)))
     {
         *output = 6;
     }
     else
     {
-        g_ipc_mtoc.scope[g_current_ps_id].timeslicer.freq_sampling.u32 = (input[3]<< 24) |
+        g_ipc_mtoc.scope[ps_id].timeslicer.freq_sampling.u32 = (input[3]<< 24) |
                         (input[2] << 16)|(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Cfg_Freq_Scope);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Cfg_Freq_Scope)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = 5;
-        }
-        else
-        {
-            *output = 0;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Cfg_Freq_Scope),
+                                ps_id, low_priority_msg_to_reg(Cfg_Freq_Scope),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_cfg_freq_scope = {
+static const struct bsmp_func bsmp_func_cfg_freq_scope = {
+    .info.id          = 11,
     .func_p           = bsmp_cfg_freq_scope,
     .info.input_size  = 4,
     .info.output_size = 1,
@@ -712,41 +981,31 @@ static struct bsmp_func bsmp_func_cfg_freq_scope = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_cfg_duration_scope(uint8_t *input, uint8_t *output)
+uint8_t bsmp_cfg_duration_scope(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Cfg_Duration_Scope)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Cfg_Duration_Scope)))
     {
         *output = 6;
     }
     else
     {
-        g_ipc_mtoc.scope[g_current_ps_id].duration.u32 = (input[3]<< 24) |
+        g_ipc_mtoc.scope[ps_id].duration.u32 = (input[3]<< 24) |
                         (input[2] << 16)|(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Cfg_Duration_Scope);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Cfg_Duration_Scope)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = 5;
-        }
-        else
-        {
-            *output = 0;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Cfg_Duration_Scope),
+                                ps_id,
+                                low_priority_msg_to_reg(Cfg_Duration_Scope),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_cfg_duration_scope = {
+static const struct bsmp_func bsmp_func_cfg_duration_scope = {
+    .info.id          = 12,
     .func_p           = bsmp_cfg_duration_scope,
     .info.input_size  = 4,
     .info.output_size = 1,
@@ -759,39 +1018,29 @@ static struct bsmp_func bsmp_func_cfg_duration_scope = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_enable_scope(uint8_t *input, uint8_t *output)
+uint8_t bsmp_enable_scope(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
     g_ipc_mtoc.scope[0].buffer.status = Buffering;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Enable_Scope)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Enable_Scope)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_lowpriority_msg(g_current_ps_id, Enable_Scope);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Enable_Scope)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Enable_Scope),
+                                ps_id, low_priority_msg_to_reg(Enable_Scope),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_enable_scope = {
+static const struct bsmp_func bsmp_func_enable_scope = {
+    .info.id          = 13,
     .func_p           = bsmp_enable_scope,
     .info.input_size  = 0,
     .info.output_size = 1,
@@ -804,10 +1053,11 @@ static struct bsmp_func bsmp_func_enable_scope = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_disable_scope(uint8_t *input, uint8_t *output)
+uint8_t bsmp_disable_scope(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
     /**
      * TODO: It sets as Postmortem to wait buffer complete. Maybe
@@ -816,32 +1066,21 @@ uint8_t bsmp_disable_scope(uint8_t *input, uint8_t *output)
     //g_ipc_mtoc.buf_samples[0].status = Idle;
     g_ipc_mtoc.scope[0].buffer.status = Postmortem;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Disable_Scope)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Disable_Scope)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_lowpriority_msg(g_current_ps_id, Disable_Scope);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Disable_Scope)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Disable_Scope),
+                                ps_id, low_priority_msg_to_reg(Disable_Scope),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_disable_scope = {
+static const struct bsmp_func bsmp_func_disable_scope = {
+    .info.id          = 14,
     .func_p           = bsmp_disable_scope,
     .info.input_size  = 0,
     .info.output_size = 1,
@@ -854,40 +1093,46 @@ static struct bsmp_func bsmp_func_disable_scope = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_sync_pulse(uint8_t *input, uint8_t *output)
+uint8_t bsmp_sync_pulse(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(SYNC_PULSE))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(SYNC_PULSE))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_msg(g_current_ps_id, SYNC_PULSE);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) & SYNC_PULSE) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_msg(ps_id, SYNC_PULSE), ps_id,
+                                SYNC_PULSE, output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_sync_pulse = {
+static const struct bsmp_func bsmp_func_sync_pulse = {
+    .info.id          = 15,
     .func_p           = bsmp_sync_pulse,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
 };
 
+/**
+ * @brief Set SlowRef acknowledge callback
+ *
+ * FBP DC-Link reference is applied to digital potentiometer after C28 updates
+ * it.
+ */
+static void set_slowref_ack(uint8_t ps_id, uint8_t *output)
+{
+    if(g_ipc_ctom.ps_module[0].ps_status.bit.model == FBP_DCLink)
+    {
+        SysCtlDelay(750); /// Wait 10 us for DSP update reference
+        set_digital_potentiometer(g_ipc_ctom.ps_module[0].ps_reference.f);
+    }
+}
+
 /**
  * @brief Set SlowRef setpoint BSMP Function
  *
@@ -895,48 +1140,30 @@ static struct bsmp_func bsmp_func_sync_pulse = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_slowref (uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_slowref (uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SlowRef)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_setpoint.u32 = (input[3]<< 24) |
+        g_ipc_mtoc.ps_module[ps_id].ps_setpoint.u32 = (input[3]<< 24) |
                 (input[2] << 16)|(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Set_SlowRef);
-
-        while( (HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_SlowRef)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK) )
-        {
-            ulTimeout++;
-        }
-
-        if(ulTimeout == TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-
-        else
-        {
-            if(g_ipc_ctom.ps_module[0].ps_status.bit.model == FBP_DCLink)
-            {
-                SysCtlDelay(750); /// Wait 10 us for DSP update reference
-                set_digital_potentiometer(g_ipc_ctom.ps_module[0].ps_reference.f);
-            }
-
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Set_SlowRef),
+                                ps_id, low_priority_msg_to_reg(Set_SlowRef),
+                                output, set_slowref_ack);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_slowref = {
+static const struct bsmp_func bsmp_func_set_slowref = {
+    .info.id          = 16,
     .func_p           = bsmp_set_slowref,
     .info.input_size  = 4,      // float iSlowRef
     .info.output_size = 1,      // command_ack
@@ -949,11 +1176,13 @@ static struct bsmp_func bsmp_func_set_slowref = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_slowref_fbp(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_slowref_fbp(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
     {
         *output = DSP_Busy;
     }
@@ -968,69 +1197,93 @@ uint8_t bsmp_set_slowref_fbp(uint8_t *input, uint8_t *output)
         g_ipc_mtoc.ps_module[3].ps_setpoint.u32 = (input[15]<< 24) |
                 (input[14] << 16) | (input[13] << 8) | input[12];
 
-        send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_SlowRef_All_PS)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS),
+                                ps_id,
+                                low_priority_msg_to_reg(Set_SlowRef_All_PS),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_slowref_fbp = {
+static const struct bsmp_func bsmp_func_set_slowref_fbp = {
+    .info.id          = 17,
     .func_p           = bsmp_set_slowref_fbp,
     .info.input_size  = 16,     // iRef1(4) + iRef2(4) + iRef3(4) + iRef4(4)
     .info.output_size = 1,      // command_ack
 };
 
 /**
- * @brief Reset counters
+ * @brief Set SlowRef setpoint of all power supplies
  *
- * Reset all DSP counters
+ * Broadcast version of Set SlowRef BSMP Function. Same setpoint is given to
+ * all power supplies controlled from the command interface of the request,
+ * which are updated together by a single IPC message. Only FBP firmware
+ * handles Set_SlowRef_All_PS, as on Set SlowRef FBP BSMP Function.
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_reset_counters(uint8_t *input, uint8_t *output)
+static uint8_t bsmp_set_slowref_all_ps(uint8_t *input, uint8_t *output,
+                                       void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Reset_Counters)))
+    uint16_t command_interface =
+                        ((bsmp_request_ctx_t *) ctx)->command_interface;
+    uint32_t setpoint;
+    uint8_t i;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_lowpriority_msg(g_current_ps_id, Reset_Counters);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Reset_Counters)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
+        setpoint = (input[3]<< 24) | (input[2] << 16)|(input[1] << 8) | input[0];
+
+        for(i = 0; i < NUM_MAX_PS_MODULES; i++)
         {
-            *output = Ok;
+            if(command_interface ==
+               g_ipc_ctom.ps_module[i].ps_status.bit.interface)
+            {
+                g_ipc_mtoc.ps_module[i].ps_setpoint.u32 = setpoint;
+            }
         }
+
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS),
+                                0, low_priority_msg_to_reg(Set_SlowRef_All_PS),
+                                output, set_slowref_ack);
+    }
+    return *output;
+}
+
+/**
+ * @brief Reset counters
+ *
+ * Reset all DSP counters
+ *
+ * @param uint8_t* Pointer to input packet of data
+ * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
+ */
+uint8_t bsmp_reset_counters(uint8_t *input, uint8_t *output, void *ctx)
+{
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Reset_Counters)))
+    {
+        *output = DSP_Busy;
+    }
+    else
+    {
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Reset_Counters),
+                                ps_id, low_priority_msg_to_reg(Reset_Counters),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_reset_counters = {
+static const struct bsmp_func bsmp_func_reset_counters = {
+    .info.id          = 22,
     .func_p           = bsmp_reset_counters,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
@@ -1044,41 +1297,32 @@ static struct bsmp_func bsmp_func_reset_counters = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_cfg_wfmref(uint8_t *input, uint8_t *output)
+uint8_t bsmp_cfg_wfmref(uint8_t *input, uint8_t *output, void *ctx)
 {
-    memcpy(WFMREF[g_current_ps_id].wfmref_selected.u8, &input[0], 2);
-    memcpy(WFMREF[g_current_ps_id].sync_mode.u8, &input[2], 2);
-    memcpy(WFMREF[g_current_ps_id].lerp.freq_base.u8, &input[4], 4);
-    memcpy(WFMREF[g_current_ps_id].gain.u8, &input[8], 4);
-    memcpy(WFMREF[g_current_ps_id].offset.u8, &input[12], 4);
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    memcpy(WFMREF[ps_id].wfmref_selected.u8, &input[0], 2);
+    memcpy(WFMREF[ps_id].sync_mode.u8, &input[2], 2);
+    memcpy(WFMREF[ps_id].lerp.freq_base.u8, &input[4], 4);
+    memcpy(WFMREF[ps_id].gain.u8, &input[8], 4);
+    memcpy(WFMREF[ps_id].offset.u8, &input[12], 4);
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Cfg_WfmRef)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Cfg_WfmRef)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        if( ( (g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state != RmpWfm) &&
-              (g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state != MigWfm) ) ||
-            ( g_ipc_ctom.wfmref[g_current_ps_id].wfmref_data[g_ipc_ctom.wfmref[g_current_ps_id].wfmref_selected.u16].p_buf_idx.p_f >=
-              g_ipc_ctom.wfmref[g_current_ps_id].wfmref_data[g_ipc_ctom.wfmref[g_current_ps_id].wfmref_selected.u16].p_buf_end.p_f ) )
+        if( ( (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state != RmpWfm) &&
+              (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state != MigWfm) ) ||
+            ( g_ipc_ctom.wfmref[ps_id].wfmref_data[g_ipc_ctom.wfmref[ps_id].wfmref_selected.u16].p_buf_idx.p_f >=
+              g_ipc_ctom.wfmref[ps_id].wfmref_data[g_ipc_ctom.wfmref[ps_id].wfmref_selected.u16].p_buf_end.p_f ) )
         {
-            send_ipc_lowpriority_msg(g_current_ps_id, Cfg_WfmRef);
-            while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                    low_priority_msg_to_reg(Cfg_WfmRef)) &&
-                    (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-            {
-                ulTimeout++;
-            }
-            if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-            {
-                *output = DSP_Timeout;
-            }
-            else
-            {
-                *output = Ok;
-            }
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Cfg_WfmRef),
+                                    ps_id, low_priority_msg_to_reg(Cfg_WfmRef),
+                                    output, NULL);
         }
         else
         {
@@ -1089,7 +1333,8 @@ uint8_t bsmp_cfg_wfmref(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_cfg_wfmref = {
+static const struct bsmp_func bsmp_func_cfg_wfmref = {
+    .info.id          = 23,
     .func_p           = bsmp_cfg_wfmref,
     .info.input_size  = 16,     // idx (2) + sync_mode (2) + freq (4) + gain (4) + offset (4)
     .info.output_size = 1,      // command_ack
@@ -1100,42 +1345,34 @@ static struct bsmp_func bsmp_func_cfg_wfmref = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_select_wfmref(uint8_t *input, uint8_t *output)
+uint8_t bsmp_select_wfmref(uint8_t *input, uint8_t *output, void *ctx)
 {
-    WFMREF[g_current_ps_id].wfmref_selected.u16= input[0];
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    WFMREF[ps_id].wfmref_selected.u16= input[0];
 
     /// TODO: fix this temporary solution
     WFMREF[1].sync_mode.enu = WFMREF[0].sync_mode.enu;
     WFMREF[2].sync_mode.enu = WFMREF[0].sync_mode.enu;
     WFMREF[3].sync_mode.enu = WFMREF[0].sync_mode.enu;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Update_WfmRef)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Update_WfmRef)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        if( ( (g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state != RmpWfm) &&
-              (g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state != MigWfm) ) ||
-            ( g_ipc_ctom.wfmref[g_current_ps_id].wfmref_data[g_ipc_ctom.wfmref[g_current_ps_id].wfmref_selected.u16].p_buf_idx.p_f >=
-              g_ipc_ctom.wfmref[g_current_ps_id].wfmref_data[g_ipc_ctom.wfmref[g_current_ps_id].wfmref_selected.u16].p_buf_end.p_f ) )
+        if( ( (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state != RmpWfm) &&
+              (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state != MigWfm) ) ||
+            ( g_ipc_ctom.wfmref[ps_id].wfmref_data[g_ipc_ctom.wfmref[ps_id].wfmref_selected.u16].p_buf_idx.p_f >=
+              g_ipc_ctom.wfmref[ps_id].wfmref_data[g_ipc_ctom.wfmref[ps_id].wfmref_selected.u16].p_buf_end.p_f ) )
         {
-            send_ipc_lowpriority_msg(g_current_ps_id, Update_WfmRef);
-            while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                    low_priority_msg_to_reg(Update_WfmRef)) &&
-                    (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-            {
-                ulTimeout++;
-            }
-            if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-            {
-                *output = DSP_Timeout;
-            }
-            else
-            {
-                *output = Ok;
-            }
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Update_WfmRef),
+                                    ps_id,
+                                    low_priority_msg_to_reg(Update_WfmRef),
+                                    output, NULL);
         }
         else
         {
@@ -1146,7 +1383,8 @@ uint8_t bsmp_select_wfmref(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_select_wfmref = {
+static const struct bsmp_func bsmp_func_select_wfmref = {
+    .info.id          = 24,
     .func_p           = bsmp_select_wfmref,
     .info.input_size  = 2,     // idx (2)
     .info.output_size = 1,     // command_ack
@@ -1159,36 +1397,27 @@ static struct bsmp_func bsmp_func_select_wfmref = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_reset_wfmref(uint8_t *input, uint8_t *output)
+uint8_t bsmp_reset_wfmref(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Reset_WfmRef)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Reset_WfmRef)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_lowpriority_msg(g_current_ps_id, Reset_WfmRef);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Reset_WfmRef)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Reset_WfmRef),
+                                ps_id, low_priority_msg_to_reg(Reset_WfmRef),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_reset_wfmref = {
+static const struct bsmp_func bsmp_func_reset_wfmref = {
+    .info.id          = 26,
     .func_p           = bsmp_reset_wfmref,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
@@ -1199,75 +1428,66 @@ static struct bsmp_func bsmp_func_reset_wfmref = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_cfg_siggen(uint8_t *input, uint8_t *output)
+uint8_t bsmp_cfg_siggen(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Cfg_SigGen)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Cfg_SigGen)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        if(g_ipc_ctom.siggen[g_current_ps_id].enable.u16)
+        if(g_ipc_ctom.siggen[ps_id].enable.u16)
         {
             *output = Resource_Busy;
         }
         else
         {
-            g_ipc_mtoc.siggen[g_current_ps_id].type.u16 = (input[1] << 8) | input[0];
+            g_ipc_mtoc.siggen[ps_id].type.u16 = (input[1] << 8) | input[0];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].num_cycles.u16 = (input[3] << 8) | input[2];
+            g_ipc_mtoc.siggen[ps_id].num_cycles.u16 = (input[3] << 8) | input[2];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].freq.u32 = (input[7]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].freq.u32 = (input[7]<< 24) |
                                                           (input[6] << 16) |
                                                           (input[5] << 8) | input[4];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].amplitude.u32  = (input[11]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].amplitude.u32  = (input[11]<< 24) |
                                                   (input[10] << 16) |
                                                   (input[9] << 8) | input[8];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].offset.u32     = (input[15]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].offset.u32     = (input[15]<< 24) |
                                                   (input[14] << 16) |
                                                   (input[13] << 8) | input[12];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].aux_param[0].u32 = (input[19]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].aux_param[0].u32 = (input[19]<< 24) |
                                                     (input[18] << 16) |
                                                     (input[17] << 8) | input[16];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].aux_param[1].u32 = (input[23]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].aux_param[1].u32 = (input[23]<< 24) |
                                                     (input[22] << 16) |
                                                     (input[21] << 8) | input[20];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].aux_param[2].u32 = (input[27]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].aux_param[2].u32 = (input[27]<< 24) |
                                                     (input[26] << 16) |
                                                     (input[25] << 8) | input[24];
 
-            g_ipc_mtoc.siggen[g_current_ps_id].aux_param[3].u32 = (input[31]<< 24) |
+            g_ipc_mtoc.siggen[ps_id].aux_param[3].u32 = (input[31]<< 24) |
                                                     (input[30] << 16) |
                                                     (input[29] << 8) | input[28];
 
-            send_ipc_lowpriority_msg(g_current_ps_id, Cfg_SigGen);
-
-            while( (HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) & low_priority_msg_to_reg(Cfg_SigGen) ) &&
-                   (ulTimeout<TIMEOUT_DSP_IPC_ACK) )
-            {
-                ulTimeout++;
-            }
-            if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-            {
-                *output = DSP_Timeout;
-            }
-            else
-            {
-                *output = Ok;
-            }
+            *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Cfg_SigGen),
+                                    ps_id, low_priority_msg_to_reg(Cfg_SigGen),
+                                    output, NULL);
         }
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_cfg_siggen = {
+static const struct bsmp_func bsmp_func_cfg_siggen = {
+    .info.id          = 27,
     .func_p           = bsmp_cfg_siggen,
     .info.input_size  = 32,     // type(2)+num_cycles(2)+freq(4)+amp(4)+offset(4)+aux_params[16]
     .info.output_size = 1,      // command_ack
@@ -1278,48 +1498,39 @@ static struct bsmp_func bsmp_func_cfg_siggen = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_siggen(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_siggen(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SigGen)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SigGen)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        g_ipc_mtoc.siggen[g_current_ps_id].freq.u32       = (input[3]<< 24) |
+        g_ipc_mtoc.siggen[ps_id].freq.u32       = (input[3]<< 24) |
                                               (input[2] << 16) |
                                               (input[1] << 8) | input[0];
 
-        g_ipc_mtoc.siggen[g_current_ps_id].amplitude.u32  = (input[7]<< 24) |
+        g_ipc_mtoc.siggen[ps_id].amplitude.u32  = (input[7]<< 24) |
                                               (input[6] << 16) |
                                               (input[5] << 8) | input[4];
 
-        g_ipc_mtoc.siggen[g_current_ps_id].offset.u32     = (input[11]<< 24) |
+        g_ipc_mtoc.siggen[ps_id].offset.u32     = (input[11]<< 24) |
                                               (input[10] << 16) |
                                               (input[9] << 8) | input[8];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Set_SigGen);
-
-        while( (HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) & low_priority_msg_to_reg(Set_SigGen) ) &&
-               (ulTimeout<TIMEOUT_DSP_IPC_ACK) )
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Set_SigGen),
+                                ps_id, low_priority_msg_to_reg(Set_SigGen),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_siggen = {
+static const struct bsmp_func bsmp_func_set_siggen = {
+    .info.id          = 28,
     .func_p           = bsmp_set_siggen,
     .info.input_size  = 12,     // freq(4)+amp(4)+offset(4)
     .info.output_size = 1,      // command_ack
@@ -1330,36 +1541,27 @@ static struct bsmp_func bsmp_func_set_siggen = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_enable_siggen(uint8_t *input, uint8_t *output)
+uint8_t bsmp_enable_siggen(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Enable_SigGen)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Enable_SigGen)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_lowpriority_msg(g_current_ps_id, Enable_SigGen);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-        low_priority_msg_to_reg(Enable_SigGen)) &&
-        (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Enable_SigGen),
+                                ps_id, low_priority_msg_to_reg(Enable_SigGen),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_enable_siggen = {
+static const struct bsmp_func bsmp_func_enable_siggen = {
+    .info.id          = 29,
     .func_p           = bsmp_enable_siggen,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
@@ -1370,41 +1572,42 @@ static struct bsmp_func bsmp_func_enable_siggen = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_disable_siggen(uint8_t *input, uint8_t *output)
+uint8_t bsmp_disable_siggen(uint8_t *input, uint8_t *output, void *ctx)
 {
-    ulTimeout=0;
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Disable_SigGen)))
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Disable_SigGen)))
     {
         *output = DSP_Busy;
     }
     else
     {
-        send_ipc_lowpriority_msg(g_current_ps_id, Disable_SigGen);
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-        low_priority_msg_to_reg(Disable_SigGen)) &&
-        (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            *output = DSP_Timeout;
-        }
-        else
-        {
-            *output = Ok;
-        }
+        *output = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Disable_SigGen),
+                                ps_id, low_priority_msg_to_reg(Disable_SigGen),
+                                output, NULL);
     }
     return *output;
 }
 
-static struct bsmp_func bsmp_func_disable_siggen = {
+static const struct bsmp_func bsmp_func_disable_siggen = {
+    .info.id          = 30,
     .func_p           = bsmp_disable_siggen,
     .info.input_size  = 0,      // Nothing is read from the input parameter
     .info.output_size = 1,      // command_ack
 };
 
+/**
+ * @brief Set SlowRef readback acknowledge callback
+ *
+ * Returns load current of specified power supply
+ */
+static void set_slowref_readback_mon_ack(uint8_t ps_id, uint8_t *output)
+{
+    memcpy(output, g_controller_ctom.net_signals[ps_id].u8, 4);
+}
+
 /**
  * @brief Set SlowRef setpoint BSMP Function and return load current
  *
@@ -1413,50 +1616,49 @@ static struct bsmp_func bsmp_func_disable_siggen = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_slowref_readback_mon(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_slowref_readback_mon(uint8_t *input, uint8_t *output,
+                                      void *ctx)
 {
-    uint8_t result;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    ulTimeout = 0;
+    uint8_t result;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SlowRef)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef)))
     {
         result = 6;
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_setpoint.u32 = (input[3]<< 24) |
+        g_ipc_mtoc.ps_module[ps_id].ps_setpoint.u32 = (input[3]<< 24) |
                 (input[2] << 16)|(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Set_SlowRef);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_SlowRef)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            result = 5;
-        }
-        else
-        {
-            memcpy(output,g_controller_ctom.net_signals[g_current_ps_id].u8,4);
-            result = 0;
-        }
+        result = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Set_SlowRef),
+                               ps_id, low_priority_msg_to_reg(Set_SlowRef),
+                               output, set_slowref_readback_mon_ack);
     }
 
     return result;
 }
 
-static struct bsmp_func bsmp_func_set_slowref_readback_mon = {
+static const struct bsmp_func bsmp_func_set_slowref_readback_mon = {
+    .info.id          = 18,
     .func_p           = bsmp_set_slowref_readback_mon,
     .info.input_size  = 4,
     .info.output_size = 4,
 };
 
+/**
+ * @brief Set SlowRef FBP readback acknowledge callback
+ *
+ * Returns load currents of each FBP power supply
+ */
+static void set_slowref_fbp_readback_mon_ack(uint8_t ps_id, uint8_t *output)
+{
+    memcpy(output, g_controller_ctom.net_signals[0].u8, 16);
+}
+
 /**
  * @brief Set SlowRef FBP BSMP Function and return load currents
  *
@@ -1465,14 +1667,16 @@ static struct bsmp_func bsmp_func_set_slowref_readback_mon = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_slowref_fbp_readback_mon(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_slowref_fbp_readback_mon(uint8_t *input, uint8_t *output,
+                                          void *ctx)
 {
-    uint8_t result;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    ulTimeout=0;
+    uint8_t result;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
     {
         result = 6;
     }
@@ -1487,34 +1691,31 @@ uint8_t bsmp_set_slowref_fbp_readback_mon(uint8_t *input, uint8_t *output)
         g_ipc_mtoc.ps_module[3].ps_setpoint.u32 = (input[15]<< 24) |
                 (input[14] << 16) | (input[13] << 8) | input[12];
 
-        send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_SlowRef_All_PS)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            result = 5;
-        }
-        else
-        {
-            memcpy(output,g_controller_ctom.net_signals[0].u8,16);
-            result = 0;
-        }
+        result = defer_ipc_ack(send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS),
+                               ps_id,
+                               low_priority_msg_to_reg(Set_SlowRef_All_PS),
+                               output, set_slowref_fbp_readback_mon_ack);
     }
     return result;
 }
 
-static struct bsmp_func bsmp_func_set_slowref_fbp_readback_mon = {
+static const struct bsmp_func bsmp_func_set_slowref_fbp_readback_mon = {
+    .info.id          = 19,
     .func_p           = bsmp_set_slowref_fbp_readback_mon,
     .info.input_size  = 16,
     .info.output_size = 16,
 };
 
+/**
+ * @brief Set SlowRef readback reference acknowledge callback
+ *
+ * Returns reference of specified power supply
+ */
+static void set_slowref_readback_ref_ack(uint8_t ps_id, uint8_t *output)
+{
+    memcpy(output, g_ipc_ctom.ps_module[ps_id].ps_reference.u8, 4);
+}
+
 /**
  * @brief Set SlowRef setpoint BSMP Function and return load current
  *
@@ -1523,50 +1724,52 @@ static struct bsmp_func bsmp_func_set_slowref_fbp_readback_mon = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_slowref_readback_ref(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_slowref_readback_ref(uint8_t *input, uint8_t *output,
+                                      void *ctx)
 {
-    uint8_t result;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    ulTimeout = 0;
+    uint8_t result;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SlowRef)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef)))
     {
         result = 6;
     }
     else
     {
-        g_ipc_mtoc.ps_module[g_current_ps_id].ps_setpoint.u32 = (input[3]<< 24) |
+        g_ipc_mtoc.ps_module[ps_id].ps_setpoint.u32 = (input[3]<< 24) |
                 (input[2] << 16)|(input[1] << 8) | input[0];
 
-        send_ipc_lowpriority_msg(g_current_ps_id, Set_SlowRef);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_SlowRef)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            result = 5;
-        }
-        else
-        {
-            memcpy(output,g_ipc_ctom.ps_module[g_current_ps_id].ps_reference.u8,4);
-            result = 0;
-        }
+        result = defer_ipc_ack(send_ipc_lowpriority_msg(ps_id, Set_SlowRef),
+                               ps_id, low_priority_msg_to_reg(Set_SlowRef),
+                               output, set_slowref_readback_ref_ack);
     }
 
     return result;
 }
 
-static struct bsmp_func bsmp_func_set_slowref_readback_ref = {
+static const struct bsmp_func bsmp_func_set_slowref_readback_ref = {
+    .info.id          = 20,
     .func_p           = bsmp_set_slowref_readback_ref,
     .info.input_size  = 4,
     .info.output_size = 4,
 };
 
+/**
+ * @brief Set SlowRef FBP readback reference acknowledge callback
+ *
+ * Returns references of each FBP power supply
+ */
+static void set_slowref_fbp_readback_ref_ack(uint8_t ps_id, uint8_t *output)
+{
+    memcpy(output,      g_ipc_ctom.ps_module[0].ps_reference.u8, 4);
+    memcpy(output + 4,  g_ipc_ctom.ps_module[1].ps_reference.u8, 4);
+    memcpy(output + 8,  g_ipc_ctom.ps_module[2].ps_reference.u8, 4);
+    memcpy(output + 12, g_ipc_ctom.ps_module[3].ps_reference.u8, 4);
+}
+
 /**
  * @brief Set SlowRef FBP BSMP Function and return load currents
  *
@@ -1575,14 +1778,16 @@ static struct bsmp_func bsmp_func_set_slowref_readback_ref = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_slowref_fbp_readback_ref(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_slowref_fbp_readback_ref(uint8_t *input, uint8_t *output,
+                                          void *ctx)
 {
-    uint8_t result;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
 
-    ulTimeout=0;
+    uint8_t result;
 
-    if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
+    if(ipc_cmd_busy(low_priority_msg_to_reg(Set_SlowRef_All_PS)))
     {
         result = 6;
     }
@@ -1597,33 +1802,16 @@ uint8_t bsmp_set_slowref_fbp_readback_ref(uint8_t *input, uint8_t *output)
         g_ipc_mtoc.ps_module[3].ps_setpoint.u32 = (input[15]<< 24) |
                 (input[14] << 16) | (input[13] << 8) | input[12];
 
-        send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS);
-
-        while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_SlowRef_All_PS)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-        {
-            ulTimeout++;
-        }
-
-        if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-        {
-            result = 5;
-        }
-        else
-        {
-            memcpy(output,g_ipc_ctom.ps_module[0].ps_reference.u8,4);
-            memcpy(output+4,g_ipc_ctom.ps_module[1].ps_reference.u8,4);
-            memcpy(output+8,g_ipc_ctom.ps_module[2].ps_reference.u8,4);
-            memcpy(output+12,g_ipc_ctom.ps_module[3].ps_reference.u8,4);
-
-            result = 0;
-        }
+        result = defer_ipc_ack(send_ipc_lowpriority_msg(0, Set_SlowRef_All_PS),
+                               ps_id,
+                               low_priority_msg_to_reg(Set_SlowRef_All_PS),
+                               output, set_slowref_fbp_readback_ref_ack);
     }
     return result;
 }
 
-static struct bsmp_func bsmp_func_set_slowref_fbp_readback_ref = {
+static const struct bsmp_func bsmp_func_set_slowref_fbp_readback_ref = {
+    .info.id          = 21,
     .func_p           = bsmp_set_slowref_fbp_readback_ref,
     .info.input_size  = 16,
     .info.output_size = 16,
@@ -1634,13 +1822,16 @@ static struct bsmp_func bsmp_func_set_slowref_fbp_readback_ref = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_param(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_param(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t id, n;
     u_float_t u_val;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         id.u8[0] = input[0];
         id.u8[1] = input[1];
@@ -1667,7 +1858,8 @@ uint8_t bsmp_set_param(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_param = {
+static const struct bsmp_func bsmp_func_set_param = {
+    .info.id          = 31,
     .func_p           = bsmp_set_param,
     .info.input_size  = 8,
     .info.output_size = 1,
@@ -1678,8 +1870,9 @@ static struct bsmp_func bsmp_func_set_param = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_get_param(uint8_t *input, uint8_t *output)
+uint8_t bsmp_get_param(uint8_t *input, uint8_t *output, void *ctx)
 {
     u_uint16_t id, n;
     u_float_t u_val;
@@ -1702,7 +1895,8 @@ uint8_t bsmp_get_param(uint8_t *input, uint8_t *output)
     }
 }
 
-static struct bsmp_func bsmp_func_get_param = {
+static const struct bsmp_func bsmp_func_get_param = {
+    .info.id          = 32,
     .func_p           = bsmp_get_param,
     .info.input_size  = 4,
     .info.output_size = 4,
@@ -1713,12 +1907,15 @@ static struct bsmp_func bsmp_func_get_param = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_save_param_eeprom(uint8_t *input, uint8_t *output)
+uint8_t bsmp_save_param_eeprom(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t id, n, type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         id.u8[0] = input[0];
         id.u8[1] = input[1];
@@ -1745,7 +1942,8 @@ uint8_t bsmp_save_param_eeprom(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_save_param_eeprom = {
+static const struct bsmp_func bsmp_func_save_param_eeprom = {
+    .info.id          = 33,
     .func_p           = bsmp_save_param_eeprom,
     .info.input_size  = 6,
     .info.output_size = 1,
@@ -1756,12 +1954,15 @@ static struct bsmp_func bsmp_func_save_param_eeprom = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_load_param_eeprom(uint8_t *input, uint8_t *output)
+uint8_t bsmp_load_param_eeprom(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t id, n, type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         id.u8[0] = input[0];
         id.u8[1] = input[1];
@@ -1788,7 +1989,8 @@ uint8_t bsmp_load_param_eeprom(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_load_param_eeprom = {
+static const struct bsmp_func bsmp_func_load_param_eeprom = {
+    .info.id          = 34,
     .func_p           = bsmp_load_param_eeprom,
     .info.input_size  = 6,
     .info.output_size = 1,
@@ -1799,12 +2001,15 @@ static struct bsmp_func bsmp_func_load_param_eeprom = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_save_param_bank(uint8_t *input, uint8_t *output)
+uint8_t bsmp_save_param_bank(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         type_memory.u8[0] = input[0];
         type_memory.u8[1] = input[1];
@@ -1821,7 +2026,8 @@ uint8_t bsmp_save_param_bank(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_save_param_bank = {
+static const struct bsmp_func bsmp_func_save_param_bank = {
+    .info.id          = 35,
     .func_p           = bsmp_save_param_bank,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -1832,12 +2038,15 @@ static struct bsmp_func bsmp_func_save_param_bank = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_load_param_bank(uint8_t *input, uint8_t *output)
+uint8_t bsmp_load_param_bank(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         type_memory.u8[0] = input[0];
         type_memory.u8[1] = input[1];
@@ -1853,7 +2062,8 @@ uint8_t bsmp_load_param_bank(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_load_param_bank = {
+static const struct bsmp_func bsmp_func_load_param_bank = {
+    .info.id          = 36,
     .func_p           = bsmp_load_param_bank,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -1864,15 +2074,16 @@ static struct bsmp_func bsmp_func_load_param_bank = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_set_dsp_coeffs(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_dsp_coeffs(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t dsp_class, id;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
-        ulTimeout = 0;
-
         dsp_class.u8[0] = input[0];
         dsp_class.u8[1] = input[1];
         id.u8[0] = input[2];
@@ -1883,7 +2094,7 @@ uint8_t bsmp_set_dsp_coeffs(uint8_t *input, uint8_t *output)
         if( set_dsp_coeffs( &g_controller_mtoc, (dsp_class_t) dsp_class.u16, id.u16,
                            (float *) &input[4]) )
         {
-            if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_DSP_Coeffs)))
+            if(ipc_cmd_busy(low_priority_msg_to_reg(Set_DSP_Coeffs)))
             {
                 *output = DSP_Busy;
             }
@@ -1892,23 +2103,10 @@ uint8_t bsmp_set_dsp_coeffs(uint8_t *input, uint8_t *output)
             {
                 g_ipc_mtoc.dsp_module.dsp_class = (dsp_class_t) dsp_class.u16;
                 g_ipc_mtoc.dsp_module.id = id.u16;
-                send_ipc_lowpriority_msg(0, Set_DSP_Coeffs);
-                while ((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                low_priority_msg_to_reg(Set_DSP_Coeffs)) &&
-                (ulTimeout<TIMEOUT_DSP_IPC_ACK))
-                {
-                    ulTimeout++;
-                }
-
-                if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-                {
-                    *output = DSP_Timeout;
-                }
-
-                else
-                {
-                    *output = Ok;
-                }
+                *output = defer_ipc_ack(send_ipc_lowpriority_msg(0, Set_DSP_Coeffs),
+                                        ps_id,
+                                        low_priority_msg_to_reg(Set_DSP_Coeffs),
+                                        output, NULL);
             }
         }
         else
@@ -1925,7 +2123,8 @@ uint8_t bsmp_set_dsp_coeffs(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_set_dsp_coeffs = {
+static const struct bsmp_func bsmp_func_set_dsp_coeffs = {
+    .info.id          = 37,
     .func_p           = bsmp_set_dsp_coeffs,
     .info.input_size  = 4 + 4*NUM_MAX_COEFFS_DSP,
     .info.output_size = 1,
@@ -1936,8 +2135,9 @@ static struct bsmp_func bsmp_func_set_dsp_coeffs = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_get_dsp_coeff(uint8_t *input, uint8_t *output)
+uint8_t bsmp_get_dsp_coeff(uint8_t *input, uint8_t *output, void *ctx)
 {
     u_uint16_t dsp_class, id, coeff;
     u_float_t u_val;
@@ -1963,7 +2163,8 @@ uint8_t bsmp_get_dsp_coeff(uint8_t *input, uint8_t *output)
     }
 }
 
-static struct bsmp_func bsmp_func_get_dsp_coeff = {
+static const struct bsmp_func bsmp_func_get_dsp_coeff = {
+    .info.id          = 38,
     .func_p           = bsmp_get_dsp_coeff,
     .info.input_size  = 6,
     .info.output_size = 4,
@@ -1974,12 +2175,15 @@ static struct bsmp_func bsmp_func_get_dsp_coeff = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_save_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output)
+uint8_t bsmp_save_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t dsp_class, id, type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         dsp_class.u8[0] = input[0];
         dsp_class.u8[1] = input[1];
@@ -2006,7 +2210,8 @@ uint8_t bsmp_save_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_save_dsp_coeffs_eeprom = {
+static const struct bsmp_func bsmp_func_save_dsp_coeffs_eeprom = {
+    .info.id          = 39,
     .func_p           = bsmp_save_dsp_coeffs_eeprom,
     .info.input_size  = 6,
     .info.output_size = 1,
@@ -2017,12 +2222,15 @@ static struct bsmp_func bsmp_func_save_dsp_coeffs_eeprom = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_load_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output)
+uint8_t bsmp_load_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t dsp_class, id, type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         dsp_class.u8[0] = input[0];
         dsp_class.u8[1] = input[1];
@@ -2033,7 +2241,7 @@ uint8_t bsmp_load_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output)
 
         if( load_dsp_coeffs_eeprom( (dsp_class_t) dsp_class.u16, id.u16, type_memory.u16) )
         {
-            if(ipc_mtoc_busy(low_priority_msg_to_reg(Set_DSP_Coeffs)))
+            if(ipc_cmd_busy(low_priority_msg_to_reg(Set_DSP_Coeffs)))
             {
                 *output = DSP_Busy;
             }
@@ -2043,24 +2251,10 @@ uint8_t bsmp_load_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output)
                 g_ipc_mtoc.dsp_module.dsp_class = (dsp_class_t) dsp_class.u16;
                 g_ipc_mtoc.dsp_module.id = id.u16;
 
-                send_ipc_lowpriority_msg(0, Set_DSP_Coeffs);
-
-                while ( (HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
-                        low_priority_msg_to_reg(Set_DSP_Coeffs)) &&
-                        (ulTimeout<TIMEOUT_DSP_IPC_ACK) )
-                {
-                    ulTimeout++;
-                }
-
-                if(ulTimeout==TIMEOUT_DSP_IPC_ACK)
-                {
-                    *output = DSP_Timeout;
-                }
-
-                else
-                {
-                    *output = Ok;
-                }
+                *output = defer_ipc_ack(send_ipc_lowpriority_msg(0, Set_DSP_Coeffs),
+                                        ps_id,
+                                        low_priority_msg_to_reg(Set_DSP_Coeffs),
+                                        output, NULL);
             }
         }
         else
@@ -2077,7 +2271,8 @@ uint8_t bsmp_load_dsp_coeffs_eeprom(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_load_dsp_coeffs_eeprom = {
+static const struct bsmp_func bsmp_func_load_dsp_coeffs_eeprom = {
+    .info.id          = 40,
     .func_p           = bsmp_load_dsp_coeffs_eeprom,
     .info.input_size  = 6,
     .info.output_size = 1,
@@ -2088,12 +2283,15 @@ static struct bsmp_func bsmp_func_load_dsp_coeffs_eeprom = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_save_dsp_modules_eeprom(uint8_t *input, uint8_t *output)
+uint8_t bsmp_save_dsp_modules_eeprom(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         type_memory.u8[0] = input[0];
         type_memory.u8[1] = input[1];
@@ -2110,7 +2308,8 @@ uint8_t bsmp_save_dsp_modules_eeprom(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_save_dsp_modules_eeprom = {
+static const struct bsmp_func bsmp_func_save_dsp_modules_eeprom = {
+    .info.id          = 41,
     .func_p           = bsmp_save_dsp_modules_eeprom,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -2121,12 +2320,15 @@ static struct bsmp_func bsmp_func_save_dsp_modules_eeprom = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_load_dsp_modules_eeprom(uint8_t *input, uint8_t *output)
+uint8_t bsmp_load_dsp_modules_eeprom(uint8_t *input, uint8_t *output, void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
     u_uint16_t type_memory;
 
-    if(g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.unlocked)
+    if(g_ipc_ctom.ps_module[ps_id].ps_status.bit.unlocked)
     {
         type_memory.u8[0] = input[0];
         type_memory.u8[1] = input[1];
@@ -2143,7 +2345,8 @@ uint8_t bsmp_load_dsp_modules_eeprom(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_load_dsp_modules_eeprom = {
+static const struct bsmp_func bsmp_func_load_dsp_modules_eeprom = {
+    .info.id          = 42,
     .func_p           = bsmp_load_dsp_modules_eeprom,
     .info.input_size  = 2,
     .info.output_size = 1,
@@ -2154,8 +2357,9 @@ static struct bsmp_func bsmp_func_load_dsp_modules_eeprom = {
  *
  * @param uint8_t* Pointer to input packet of data
  * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t bsmp_reset_udc(uint8_t *input, uint8_t *output)
+uint8_t bsmp_reset_udc(uint8_t *input, uint8_t *output, void *ctx)
 {
     uint8_t i, reset;
 
@@ -2179,120 +2383,369 @@ uint8_t bsmp_reset_udc(uint8_t *input, uint8_t *output)
     return *output;
 }
 
-static struct bsmp_func bsmp_func_reset_udc = {
+static const struct bsmp_func bsmp_func_reset_udc = {
+    .info.id          = 43,
     .func_p           = bsmp_reset_udc,
     .info.input_size  = 0,
     .info.output_size = 1,
 };
 
-
 /**
- * Dummy BSMP Functions
+ * @brief Set RS485 baud-rate
+ *
+ * Propose a new RS485 baud-rate, applied right after the response to this
+ * request. Previous rate is restored if no valid frame is received at the new
+ * one within a timeout. RS485_Baudrate parameter is kept unchanged.
+ *
+ * @param uint8_t* Pointer to input packet of data
+ * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-uint8_t DummyFunc1(uint8_t *input, uint8_t *output)
+uint8_t bsmp_set_serial_baudrate(uint8_t *input, uint8_t *output, void *ctx)
 {
-    *output = Ok;
+    u_uint32_t baud;
+
+    memcpy(&baud.u8[0], input, 4);
+
+    if( (((bsmp_request_ctx_t *) ctx)->command_interface == Remote) &&
+        rs485_propose_baudrate(baud.u32) )
+    {
+        *output = Ok;
+    }
+    else
+    {
+        *output = Invalid_Command;
+    }
+
     return *output;
 }
 
-static struct bsmp_func dummy_func1 = {
-    .func_p           = DummyFunc1,
-    .info.input_size  = 0,      // nothing
-    .info.output_size = 1,      // command_ack
+static const struct bsmp_func bsmp_func_set_serial_baudrate = {
+    .info.id          = 44,
+    .func_p           = bsmp_set_serial_baudrate,
+    .info.input_size  = 4,
+    .info.output_size = 1,
 };
 
 /**
+ * @brief Enable scope streaming
  *
- * @param curve
- * @param block
- * @param data
- * @param len
- * @return
+ * Start a new stream session for the scope of specified power supply. C28
+ * writes frames on scope buffer, with its source and sampling frequency, and
+ * they are read through stream curves.
+ *
+ * @param uint8_t* Pointer to input packet of data
+ * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
  */
-static bool read_block_wfmref(struct bsmp_curve *curve, uint16_t block,
-                              uint8_t *data, uint16_t *len)
+uint8_t bsmp_enable_stream(uint8_t *input, uint8_t *output, void *ctx)
 {
-    uint8_t *block_data;
-    uint16_t block_size = curve->info.block_size;
-    wfmref_t *p_wfmref = (wfmref_t *) curve->user;
-
-    //block_data = &(g_wfmref[(block*block_size) >> 2].u8);
-    //block_data = ((uint8_t *) *((float **) curve->user)) + block * block_size;
-    block_data = ( (uint8_t *) ipc_ctom_translate(
-                   (uint32_t) p_wfmref->wfmref_data[curve->info.id].p_buf_start.p_f ) ) +
-                 block * block_size;
-    //block_data = WFMREF[g_current_ps_id].wfmref_data[curve->info.id].p_buf_start.f
-
-    memcpy(data, block_data, block_size);
-    *len = block_size;
-    return true;
-}
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+    buf_t *p_buf = (buf_t *) &g_ipc_mtoc.scope[ps_id].buffer;
+
+    if(STREAM_NUM_FRAMES(p_buf) < 2)
+    {
+        *output = Invalid_Command;
+    }
+    else
+    {
+        g_ipc_mtoc_stream[ps_id].tail = 0;
+        stream_seq[ps_id] = 0;
+        stream_sent[ps_id] = 0;
+
+        if(++stream_session == 0)
+        {
+            stream_session = 1;
+        }
+        g_ipc_mtoc_stream[ps_id].session = stream_session;
+
+        *output = Ok;
+    }
+
+    return *output;
+}
+
+static const struct bsmp_func bsmp_func_enable_stream = {
+    .info.id          = 45,
+    .func_p           = bsmp_enable_stream,
+    .info.input_size  = 0,
+    .info.output_size = 1,
+};
+
+/**
+ * @brief Disable scope streaming
+ *
+ * @param uint8_t* Pointer to input packet of data
+ * @param uint8_t* Pointer to output packet of data
+ * @param void* Pointer to request context
+ */
+uint8_t bsmp_disable_stream(uint8_t *input, uint8_t *output, void *ctx)
+{
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+
+    g_ipc_mtoc_stream[ps_id].session = 0;
+
+    *output = Ok;
+    return *output;
+}
+
+static const struct bsmp_func bsmp_func_disable_stream = {
+    .info.id          = 46,
+    .func_p           = bsmp_disable_stream,
+    .info.input_size  = 0,
+    .info.output_size = 1,
+};
+
+
+/**
+ * Dummy BSMP Functions
+ */
+uint8_t DummyFunc1(uint8_t *input, uint8_t *output, void *ctx)
+{
+    *output = Ok;
+    return *output;
+}
+
+static const struct bsmp_func dummy_func1 = {
+    .info.id          = 25,
+    .func_p           = DummyFunc1,
+    .info.input_size  = 0,      // nothing
+    .info.output_size = 1,      // command_ack
+};
 
 /**
+ * @brief Invalidate checksums of the other view of a WfmRef buffer
+ *
+ * Small and large block curves share the same WfmRef buffers, so a block
+ * written through one of them must invalidate the checksums of the other. BSMP
+ * server already takes care of the curve written.
+ *
+ * @param server BSMP server of the curve
+ * @param curve curve written
+ * @param state state of the curve written
+ * @param block block written
+ */
+static void invalidate_wfmref_views(uint8_t server,
+                                    const struct bsmp_curve *curve,
+                                    struct bsmp_curve_state *state,
+                                    uint16_t block)
+{
+    uint16_t i, first, last;
+    uint8_t buf_id = CURVE_BUFFER_ID(curve);
+    struct bsmp_curve_state *p_small = &bsmp_curves_state[server][buf_id];
+    struct bsmp_curve_state *p_large =
+                &bsmp_curves_state[server][buf_id + LARGE_BLOCK_CURVES_OFFSET];
+
+    if(state == p_small)
+    {
+        memset(p_large->checksum, 0, sizeof(p_large->checksum));
+    }
+    else
+    {
+        memset(p_small->checksum, 0, sizeof(p_small->checksum));
+
+        first = block * (SIZE_LARGE_CURVE_BLOCK / SIZE_CURVE_BLOCK);
+        last  = first + (SIZE_LARGE_CURVE_BLOCK / SIZE_CURVE_BLOCK);
+
+        for(i = first; (i < last) && (i < NUMBER_OF_WFMREF_BLOCKS); i++)
+        {
+            wfmref_block_dirty[server][buf_id][i >> 5] |= 1UL << (i & 0x1F);
+        }
+    }
+}
+
+/**
+ * @brief Read part of WfmRef curve block
  *
  * @param curve
+ * @param state
  * @param block
+ * @param offset offset of part within block
  * @param data
- * @param len
+ * @param len number of bytes to be read, limited to end of block
+ * @param ctx
  * @return
  */
-static bool write_block_wfmref(struct bsmp_curve *curve, uint16_t block,
-                               uint8_t *data, uint16_t len)
+static bool read_block_part_wfmref(const struct bsmp_curve *curve,
+                                   struct bsmp_curve_state *state,
+                                   uint16_t block, uint16_t offset,
+                                   uint8_t *data, uint16_t *len, void *ctx)
 {
-    uint8_t *block_data;
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
     uint16_t block_size = curve->info.block_size;
-    wfmref_t *p_wfmref = (wfmref_t *) curve->user;
+    shared_buf_t *p_buf =
+        &g_shared_bufs[SHARED_BUF_ID_WFMREF(ps_id, CURVE_BUFFER_ID(curve))];
 
-    //block_data = &(g_wfmref[(block*block_size) >> 2].u8);
-    //block_data = ((uint8_t *) *((float **) curve->user)) + block * block_size;
-    block_data = ( (uint8_t *) ipc_ctom_translate(
-                   (uint32_t) p_wfmref->wfmref_data[curve->info.id].p_buf_start.p_f ) ) +
-                 block * block_size;
+    if(!p_buf->size || (offset > block_size))
+    {
+        return false;
+    }
+
+    if(*len > block_size - offset)
+    {
+        *len = block_size - offset;
+    }
 
+    memcpy(data, p_buf->p_m3 + block * block_size + offset, *len);
+    return true;
+}
+
+/**
+ *
+ * @param curve
+ * @param state
+ * @param block
+ * @param data
+ * @param len
+ * @param ctx
+ * @return
+ */
+static bool read_block_wfmref(const struct bsmp_curve *curve,
+                              struct bsmp_curve_state *state, uint16_t block,
+                              uint8_t *data, uint16_t *len, void *ctx)
+{
+    *len = curve->info.block_size;
+    return read_block_part_wfmref(curve, state, block, 0, data, len, ctx);
+}
+
+/**
+ *
+ * @param curve
+ * @param state
+ * @param block
+ * @param data
+ * @param len
+ * @param ctx
+ * @return
+ */
+static bool write_block_wfmref(const struct bsmp_curve *curve,
+                               struct bsmp_curve_state *state, uint16_t block,
+                               uint8_t *data, uint16_t len, void *ctx)
+{
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+    uint32_t offset = block * curve->info.block_size;
+    wfmref_t *p_wfmref = (wfmref_t *) state->user;
+    uint8_t buf_id = CURVE_BUFFER_ID(curve);
+    shared_buf_t *p_buf = &g_shared_bufs[SHARED_BUF_ID_WFMREF(ps_id, buf_id)];
+
+    if(!p_buf->size)
+    {
+        return false;
+    }
 
     //if(curve->info.id == WFMREF[g_current_ps_id].wfmref_selected.u16)
     //if(curve->info.id == p_wfmref->wfmref_selected.u16)
-    if( (curve->info.id == p_wfmref->wfmref_selected.u16) &&
-        ( (g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state == RmpWfm) ||
-          (g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.state == MigWfm) ) )
+    if( (buf_id == p_wfmref->wfmref_selected.u16) &&
+        ( (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state == RmpWfm) ||
+          (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state == MigWfm) ) )
     {
         return false;
     }
     else
     {
-        memcpy(block_data, data, len);
-        p_wfmref->wfmref_data[curve->info.id].p_buf_end.p_f =
+        memcpy(p_buf->p_m3 + offset, data, len);
+        p_wfmref->wfmref_data[buf_id].p_buf_end.p_f =
         //WFMREF[g_current_ps_id].wfmref_data[curve->info.id].p_buf_end.f =
-                    (float *) (ipc_mtoc_translate((uint32_t) (block_data + len)) - 2);
-        p_wfmref->wfmref_data[curve->info.id].p_buf_idx.p_f =
+                    (float *) SHARED_BUF_C28_ADD(p_buf, offset + len - sizeof(float));
+        p_wfmref->wfmref_data[buf_id].p_buf_idx.p_f =
         //WFMREF[g_current_ps_id].wfmref_data[curve->info.id].p_buf_idx.f =
-                    (float *) (ipc_mtoc_translate((uint32_t) (block_data + len)));
+                    (float *) SHARED_BUF_C28_ADD(p_buf, offset + len);
+        invalidate_wfmref_views(ps_id, curve, state, block);
         return true;
     }
 }
 
 /**
+ * @brief Write encoded block of WfmRef curve
+ *
+ * Decode delta/run-length encoded block straight into WfmRef buffer in shared
+ * memory, and update its end and index pointers as write_block_wfmref() does.
  *
  * @param curve
+ * @param state
  * @param block
+ * @param data encoded block
+ * @param len size of encoded block
+ * @param ctx
+ * @return
+ */
+static bool write_block_wfmref_encoded(const struct bsmp_curve *curve,
+                                       struct bsmp_curve_state *state,
+                                       uint16_t block, uint8_t *data,
+                                       uint16_t len, void *ctx)
+{
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+    int32_t decoded_len;
+    uint16_t block_size = curve->info.block_size;
+    uint32_t offset = block * block_size;
+    wfmref_t *p_wfmref = (wfmref_t *) state->user;
+    uint8_t buf_id = CURVE_BUFFER_ID(curve);
+    shared_buf_t *p_buf = &g_shared_bufs[SHARED_BUF_ID_WFMREF(ps_id, buf_id)];
+
+    if(!p_buf->size)
+    {
+        return false;
+    }
+
+    if( (buf_id == p_wfmref->wfmref_selected.u16) &&
+        ( (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state == RmpWfm) ||
+          (g_ipc_ctom.ps_module[ps_id].ps_status.bit.state == MigWfm) ) )
+    {
+        return false;
+    }
+
+    decoded_len = bsmp_curve_decode_block(p_buf->p_m3 + offset, block_size,
+                                          data, len);
+
+    if(decoded_len <= 0)
+    {
+        return false;
+    }
+
+    p_wfmref->wfmref_data[buf_id].p_buf_end.p_f =
+                (float *) SHARED_BUF_C28_ADD(p_buf, offset + decoded_len -
+                                             sizeof(float));
+    p_wfmref->wfmref_data[buf_id].p_buf_idx.p_f =
+                (float *) SHARED_BUF_C28_ADD(p_buf, offset + decoded_len);
+    invalidate_wfmref_views(ps_id, curve, state, block);
+    return true;
+}
+
+/**
+ * @brief Read part of samples buffer curve block
+ *
+ * @param curve
+ * @param state
+ * @param block
+ * @param offset offset of part within block
  * @param data
- * @param len
+ * @param len number of bytes to be read, limited to end of block
+ * @param ctx
  * @return
  */
-static bool read_block_buf_samples_ctom(struct bsmp_curve *curve, uint16_t block,
-                                        uint8_t *data, uint16_t *len)
+static bool read_block_part_buf_samples_ctom(const struct bsmp_curve *curve,
+                                             struct bsmp_curve_state *state,
+                                             uint16_t block, uint16_t offset,
+                                             uint8_t *data, uint16_t *len,
+                                             void *ctx)
 {
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
     uint8_t *block_data;
     uint16_t block_size = curve->info.block_size;
-    buf_t *p_buf = (buf_t *) curve->user;
+    buf_t *p_buf = (buf_t *) state->user;
 
     //block_data = &(g_buf_samples_ctom[(block*block_size) >> 2].u8);
     block_data = ( (uint8_t *) p_buf->p_buf_start.p_f) + block * block_size;
 
-    if(g_ipc_ctom.scope[g_current_ps_id].buffer.status == Disabled)
+    if( (g_ipc_ctom.scope[ps_id].buffer.status == Disabled) &&
+        (g_ipc_mtoc_stream[ps_id].session == 0) && (offset <= block_size) )
     {
-        memcpy(data, block_data, block_size);
-        *len = block_size;
+        if(*len > block_size - offset)
+        {
+            *len = block_size - offset;
+        }
+
+        memcpy(data, block_data + offset, *len);
         return true;
     }
     else
@@ -2304,17 +2757,467 @@ static bool read_block_buf_samples_ctom(struct bsmp_curve *curve, uint16_t block
 /**
  *
  * @param curve
+ * @param state
  * @param block
  * @param data
  * @param len
+ * @param ctx
  * @return
  */
-static bool write_block_dummy(struct bsmp_curve *curve, uint16_t block,
-                              uint8_t *data, uint16_t len)
+static bool read_block_buf_samples_ctom(const struct bsmp_curve *curve,
+                                        struct bsmp_curve_state *state,
+                                        uint16_t block, uint8_t *data,
+                                        uint16_t *len, void *ctx)
+{
+    *len = curve->info.block_size;
+    return read_block_part_buf_samples_ctom(curve, state, block, 0, data, len,
+                                            ctx);
+}
+
+/**
+ * @brief Read frames from scope stream
+ *
+ * Sends as many frames as fit in a block. Data starts with the sequence
+ * number of the first frame since stream was enabled and the number of frames
+ * dropped by C28, both 16-bit, so a client detects gaps. Block carries no
+ * frames if none is available.
+ *
+ * Requested block is the low byte of the sequence number of the next frame
+ * the client expects, starting at 0. Frames sent are only released to C28
+ * when a request acknowledges them, asking for the frame after them. A
+ * request which asks again for the first frame sent, as after a lost answer,
+ * gets the same frames again. So frames are only lost when C28 finds the ring
+ * full, and then they're counted as dropped. Frames sent and not acknowledged
+ * yet still take room in the ring.
+ *
+ * Stream curves have no read_block_part, so the server rejects checksum
+ * requests for them instead of reading frames to hash them.
+ *
+ * @param curve
+ * @param state
+ * @param block
+ * @param data
+ * @param len
+ * @param ctx
+ * @return false if block acknowledges neither the frames sent last nor none
+ *         of them, stream is disabled, or C28 hasn't started current session
+ */
+static bool read_block_stream(const struct bsmp_curve *curve,
+                              struct bsmp_curve_state *state, uint16_t block,
+                              uint8_t *data, uint16_t *len, void *ctx)
+{
+    uint8_t ps_id = ((bsmp_request_ctx_t *) ctx)->ps_id;
+    buf_t *p_buf = (buf_t *) state->user;
+    uint16_t num_frames = STREAM_NUM_FRAMES(p_buf);
+    uint16_t max_frames = (curve->info.block_size - SIZE_STREAM_HEADER) /
+                          SIZE_STREAM_FRAME;
+    uint16_t tail = g_ipc_mtoc_stream[ps_id].tail;
+    uint16_t head = g_ipc_ctom_stream[ps_id].head;
+    uint16_t dropped = g_ipc_ctom_stream[ps_id].dropped;
+    uint16_t n = 0;
+
+    if( (g_ipc_mtoc_stream[ps_id].session == 0) ||
+        (g_ipc_ctom_stream[ps_id].session != g_ipc_mtoc_stream[ps_id].session) )
+    {
+        return false;
+    }
+
+    /// Client received frames sent last, so they're released to C28
+    if( (stream_sent[ps_id] != 0) &&
+        (block == (uint8_t) (stream_seq[ps_id] + stream_sent[ps_id])) )
+    {
+        tail = (tail + stream_sent[ps_id]) % num_frames;
+        g_ipc_mtoc_stream[ps_id].tail = tail;
+        stream_seq[ps_id] += stream_sent[ps_id];
+        stream_sent[ps_id] = 0;
+    }
+    else if(block != (uint8_t) stream_seq[ps_id])
+    {
+        return false;
+    }
+
+    memcpy(&data[0], &stream_seq[ps_id], 2);
+    memcpy(&data[2], &dropped, 2);
+
+    while( (n < max_frames) && (tail != head) )
+    {
+        memcpy(&data[SIZE_STREAM_HEADER + n * SIZE_STREAM_FRAME],
+               (uint8_t *) p_buf->p_buf_start.p_f + tail * SIZE_STREAM_FRAME,
+               SIZE_STREAM_FRAME);
+
+        if(++tail == num_frames)
+        {
+            tail = 0;
+        }
+        n++;
+    }
+
+    /// Frames are kept by C28 until the next request acknowledges them
+    stream_sent[ps_id] = n;
+
+    *len = SIZE_STREAM_HEADER + n * SIZE_STREAM_FRAME;
+    return true;
+}
+
+/**
+ *
+ * @param curve
+ * @param state
+ * @param block
+ * @param data
+ * @param len
+ * @param ctx
+ * @return
+ */
+static bool write_block_dummy(const struct bsmp_curve *curve,
+                              struct bsmp_curve_state *state, uint16_t block,
+                              uint8_t *data, uint16_t len, void *ctx)
+{
+    return false;
+}
+
+/**
+ * BSMP functions, shared by all servers
+ */
+static const struct bsmp_func *const bsmp_funcs[] =
+{
+    &bsmp_func_turn_on,                      // ID 0
+    &bsmp_func_turn_off,                     // ID 1
+    &bsmp_func_open_loop,                    // ID 2
+    &bsmp_func_closed_loop,                  // ID 3
+    &bsmp_func_select_op_mode,               // ID 4
+    &bsmp_func_reset_interlocks,             // ID 5
+    &bsmp_func_set_command_interface,        // ID 6
+    &bsmp_func_set_serial_termination,       // ID 7
+    &bsmp_func_unlock_udc,                   // ID 8
+    &bsmp_func_lock_udc,                     // ID 9
+    &bsmp_func_cfg_source_scope,             // ID 10
+    &bsmp_func_cfg_freq_scope,               // ID 11
+    &bsmp_func_cfg_duration_scope,           // ID 12
+    &bsmp_func_enable_scope,                 // ID 13
+    &bsmp_func_disable_scope,                // ID 14
+    &bsmp_func_sync_pulse,                   // ID 15
+    &bsmp_func_set_slowref,                  // ID 16
+    &bsmp_func_set_slowref_fbp,              // ID 17
+    &bsmp_func_set_slowref_readback_mon,     // ID 18
+    &bsmp_func_set_slowref_fbp_readback_mon, // ID 19
+    &bsmp_func_set_slowref_readback_ref,     // ID 20
+    &bsmp_func_set_slowref_fbp_readback_ref, // ID 21
+    &bsmp_func_reset_counters,               // ID 22
+    &bsmp_func_cfg_wfmref,                   // ID 23
+    &bsmp_func_select_wfmref,                // ID 24
+    &dummy_func1,                            // ID 25
+    &bsmp_func_reset_wfmref,                 // ID 26
+    &bsmp_func_cfg_siggen,                   // ID 27
+    &bsmp_func_set_siggen,                   // ID 28
+    &bsmp_func_enable_siggen,                // ID 29
+    &bsmp_func_disable_siggen,               // ID 30
+    &bsmp_func_set_param,                    // ID 31
+    &bsmp_func_get_param,                    // ID 32
+    &bsmp_func_save_param_eeprom,            // ID 33
+    &bsmp_func_load_param_eeprom,            // ID 34
+    &bsmp_func_save_param_bank,              // ID 35
+    &bsmp_func_load_param_bank,              // ID 36
+    &bsmp_func_set_dsp_coeffs,               // ID 37
+    &bsmp_func_get_dsp_coeff,                // ID 38
+    &bsmp_func_save_dsp_coeffs_eeprom,       // ID 39
+    &bsmp_func_load_dsp_coeffs_eeprom,       // ID 40
+    &bsmp_func_save_dsp_modules_eeprom,      // ID 41
+    &bsmp_func_load_dsp_modules_eeprom,      // ID 42
+    &bsmp_func_reset_udc,                    // ID 43
+    &bsmp_func_set_serial_baudrate,          // ID 44
+    &bsmp_func_enable_stream,                // ID 45
+    &bsmp_func_disable_stream,               // ID 46
+};
+
+/**
+ * BSMP functions with a broadcast version, executed once for all power
+ * supplies in a single IPC transaction. Only C28 firmwares of the specified
+ * model handle its IPC message, so other models run the function on each
+ * server in turn.
+ */
+static const struct
+{
+    uint8_t     func_id;
+    ps_model_t  ps_model;
+    bsmp_func_t func_p;
+} bsmp_bcast_funcs[] =
+{
+    {16, FBP, bsmp_set_slowref_all_ps},
+};
+
+/**
+ * BSMP curves, shared by all servers. WfmRef and samples buffers of each
+ * server are given by the user field of its curve states.
+ */
+static const struct bsmp_curve bsmp_curve_wfmref_0 = {
+    .info.id             = 0,
+    .info.writable       = true,
+    .info.nblocks        = NUMBER_OF_WFMREF_BLOCKS,
+    .info.block_size     = SIZE_CURVE_BLOCK,
+    .read_block          = read_block_wfmref,
+    .read_block_part     = read_block_part_wfmref,
+    .write_block         = write_block_wfmref,
+    .write_block_encoded = write_block_wfmref_encoded,
+};
+
+static const struct bsmp_curve bsmp_curve_wfmref_1 = {
+    .info.id             = 1,
+    .info.writable       = true,
+    .info.nblocks        = NUMBER_OF_WFMREF_BLOCKS,
+    .info.block_size     = SIZE_CURVE_BLOCK,
+    .read_block          = read_block_wfmref,
+    .read_block_part     = read_block_part_wfmref,
+    .write_block         = write_block_wfmref,
+    .write_block_encoded = write_block_wfmref_encoded,
+};
+
+static const struct bsmp_curve bsmp_curve_buf_samples = {
+    .info.id             = 2,
+    .info.writable       = false,
+    .info.nblocks        = 16,
+    .info.block_size     = SIZE_CURVE_BLOCK,
+    .read_block          = read_block_buf_samples_ctom,
+    .read_block_part     = read_block_part_buf_samples_ctom,
+    .write_block         = write_block_dummy,
+};
+
+static const struct bsmp_curve bsmp_curve_wfmref_0_large = {
+    .info.id             = 3,
+    .info.writable       = true,
+    .info.nblocks        = NUMBER_OF_WFMREF_BLOCKS*SIZE_CURVE_BLOCK/SIZE_LARGE_CURVE_BLOCK,
+    .info.block_size     = SIZE_LARGE_CURVE_BLOCK,
+    .read_block          = read_block_wfmref,
+    .read_block_part     = read_block_part_wfmref,
+    .write_block         = write_block_wfmref,
+    .write_block_encoded = write_block_wfmref_encoded,
+};
+
+static const struct bsmp_curve bsmp_curve_wfmref_1_large = {
+    .info.id             = 4,
+    .info.writable       = true,
+    .info.nblocks        = NUMBER_OF_WFMREF_BLOCKS*SIZE_CURVE_BLOCK/SIZE_LARGE_CURVE_BLOCK,
+    .info.block_size     = SIZE_LARGE_CURVE_BLOCK,
+    .read_block          = read_block_wfmref,
+    .read_block_part     = read_block_part_wfmref,
+    .write_block         = write_block_wfmref,
+    .write_block_encoded = write_block_wfmref_encoded,
+};
+
+static const struct bsmp_curve bsmp_curve_buf_samples_large = {
+    .info.id             = 5,
+    .info.writable       = false,
+    .info.nblocks        = SIZE_SAMPLES_BUFFER/SIZE_LARGE_CURVE_BLOCK,
+    .info.block_size     = SIZE_LARGE_CURVE_BLOCK,
+    .read_block          = read_block_buf_samples_ctom,
+    .read_block_part     = read_block_part_buf_samples_ctom,
+    .write_block         = write_block_dummy,
+};
+
+static const struct bsmp_curve bsmp_curve_stream = {
+    .info.id             = 6,
+    .info.writable       = false,
+    .info.nblocks        = STREAM_NUM_BLOCKS,
+    .info.block_size     = SIZE_CURVE_BLOCK,
+    .read_block          = read_block_stream,
+    .write_block         = write_block_dummy,
+};
+
+static const struct bsmp_curve bsmp_curve_stream_large = {
+    .info.id             = 7,
+    .info.writable       = false,
+    .info.nblocks        = STREAM_NUM_BLOCKS,
+    .info.block_size     = SIZE_LARGE_CURVE_BLOCK,
+    .read_block          = read_block_stream,
+    .write_block         = write_block_dummy,
+};
+
+static const struct bsmp_curve *const bsmp_curves[] =
+{
+    &bsmp_curve_wfmref_0,           // ID 0
+    &bsmp_curve_wfmref_1,           // ID 1
+    &bsmp_curve_buf_samples,        // ID 2
+    &bsmp_curve_wfmref_0_large,     // ID 3
+    &bsmp_curve_wfmref_1_large,     // ID 4
+    &bsmp_curve_buf_samples_large,  // ID 5
+    &bsmp_curve_stream,             // ID 6
+    &bsmp_curve_stream_large,       // ID 7
+};
+
+/**
+ * @brief Check whether function can be executed from command interface
+ *
+ * Functions may only be executed from the interface selected for the power
+ * supply, except for Get Param and Set Command Interface functions.
+ *
+ * @param ps_id power supply ID
+ * @param command_interface interface which sent the command
+ * @param func_id BSMP function ID
+ * @return true if execution is allowed
+ */
+static bool bsmp_func_allowed(uint8_t ps_id, uint16_t command_interface,
+                              uint8_t func_id)
+{
+    return (command_interface ==
+            g_ipc_ctom.ps_module[ps_id].ps_status.bit.interface) ||
+           (func_id == 32) || (func_id == 6);
+}
+
+/**
+ * @brief Select server for a function in batch execution
+ *
+ * Commands pending from other requests must be acknowledged by DSP before the
+ * function is executed, since only one IPC command may be in flight without
+ * command ring.
+ *
+ * @param server_id BSMP server ID, i.e., power supply ID
+ * @param func_id BSMP function ID
+ * @param func_error set with error code if function can't be executed. NULL
+ *                   while batch is checked, when nothing else is done.
+ * @param ctx request context, updated with selected power supply
+ * @return pointer to BSMP server, or NULL if server_id is invalid
+ */
+static bsmp_server_t *bsmp_batch_select(uint8_t server_id, uint8_t func_id,
+                                        uint8_t *func_error, void *ctx)
+{
+    bsmp_request_ctx_t *p_ctx = (bsmp_request_ctx_t *) ctx;
+
+    if( (server_id >= NUMBER_OF_BSMP_SERVERS) || !bsmp[server_id].funcs.count )
+    {
+        return NULL;
+    }
+
+    /// Batch is being checked before execution
+    if(func_error == NULL)
+    {
+        return (bsmp_server_t *) &bsmp[server_id];
+    }
+
+    bsmp_wait_pending_cmd();
+
+    p_ctx->ps_id = server_id;
+
+    if(!bsmp_func_allowed(server_id, p_ctx->command_interface, func_id))
+    {
+        *func_error = (p_ctx->command_interface == Remote) ? PS_is_Local :
+                                                           Invalid_Command;
+    }
+
+    return (bsmp_server_t *) &bsmp[server_id];
+}
+
+/**
+ * @brief Complete function in batch execution
+ *
+ * Waits for DSP acknowledge of the IPC command sent by the function, so
+ * functions of the batch are applied in order, and a DSP timeout is reported
+ * as the function result, instead of only in its output.
+ *
+ * @param func_error error returned by the function
+ * @param output output of the function
+ * @param ctx request context
+ * @return final error of the function
+ */
+static uint8_t bsmp_batch_done(uint8_t func_error, uint8_t *output, void *ctx)
 {
+    ipc_pending_cmd_t *p_cmd = p_new_pending_cmd;
+
+    if(p_cmd == NULL)
+    {
+        return func_error;
+    }
+
+    /// Batch response isn't deferred, as the command is completed here
+    p_new_pending_cmd = NULL;
+
+    while(p_cmd->pending)
+    {
+        bsmp_check_pending_cmd();
+    }
+
+    return p_cmd->timed_out ? DSP_Timeout : func_error;
+}
+
+/**
+ * @brief Get sum of sequence counters of all power supply modules
+ *
+ * @param p_odd set true if any module is being updated by C28
+ */
+static uint32_t ps_module_seq(bool *p_odd)
+{
+    uint8_t i;
+    uint16_t seq;
+    uint32_t sum = 0;
+
+    *p_odd = false;
+
+    for(i = 0; i < NUM_MAX_PS_MODULES; i++)
+    {
+        seq = g_ipc_ctom.ps_module[i].ps_status.sync.seq;
+        sum += seq;
+        *p_odd |= seq & 1;
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Start a consistent read of power supply modules state
+ *
+ * C28 increments sequence counter of a module before and after updating it,
+ * so it's odd while an update is in progress. Counters only increase, so any
+ * update changes their sum. C28 firmwares which don't update counters keep
+ * them at 0, and reads are never retried.
+ *
+ * @param seq sequence of modules state, after updates in progress finish
+ * @return false if an update is still in progress after
+ *         TIMEOUT_PS_MODULE_UPDATE attempts, so the read fails
+ */
+static bool ps_module_read_begin(uint32_t *seq)
+{
+    uint8_t tries = 0;
+    bool odd;
+
+    do
+    {
+        *seq = ps_module_seq(&odd);
+
+        if(!odd)
+        {
+            return true;
+        }
+    }
+    while(++tries < TIMEOUT_PS_MODULE_UPDATE);
+
     return false;
 }
 
+/**
+ * @brief Check whether power supply modules were updated since read started
+ *
+ * @param seq sequence returned by ps_module_read_begin()
+ * @return true if read must be retried
+ */
+static bool ps_module_read_retry(uint32_t seq)
+{
+    bool odd;
+
+    return ps_module_seq(&odd) != seq;
+}
+
+/**
+ * @brief Give the client of a group read changed request
+ *
+ * Each command interface keeps its own group shadows, so a read by one of them
+ * doesn't hide changes from the others.
+ *
+ * @param ctx request context
+ * @return interface which received the request
+ */
+static uint8_t bsmp_shadow_client(void *ctx)
+{
+    return ((bsmp_request_ctx_t *) ctx)->command_interface;
+}
 
 /**
  * @brief Initialize BSMP module.
@@ -2325,60 +3228,25 @@ static bool write_block_dummy(struct bsmp_curve *curve, uint16_t block,
  */
 void bsmp_init(uint8_t server)
 {
+    uint8_t i;
+
     /**
      * Initialize communications library
      */
     bsmp_server_init(&bsmp[server]);
     //bsmp_register_hook(&bsmp, hook);
+    bsmp_register_batch_select(&bsmp[server], bsmp_batch_select,
+                               bsmp_batch_done);
+    bsmp_register_read_seqlock(&bsmp[server], ps_module_read_begin,
+                               ps_module_read_retry);
+    bsmp_register_group_shadow(&bsmp[server], &group_shadow_pool,
+                               bsmp_shadow_client);
 
     /**
      * BSMP Function Register
      */
-    bsmp_register_function(&bsmp[server], &bsmp_func_turn_on);                  // ID 0
-    bsmp_register_function(&bsmp[server], &bsmp_func_turn_off);                 // ID 1
-    bsmp_register_function(&bsmp[server], &bsmp_func_open_loop);                // ID 2
-    bsmp_register_function(&bsmp[server], &bsmp_func_closed_loop);              // ID 3
-    bsmp_register_function(&bsmp[server], &bsmp_func_select_op_mode);           // ID 4
-    bsmp_register_function(&bsmp[server], &bsmp_func_reset_interlocks);         // ID 5
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_command_interface);    // ID 6
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_serial_termination);   // ID 7
-    bsmp_register_function(&bsmp[server], &bsmp_func_unlock_udc);               // ID 8
-    bsmp_register_function(&bsmp[server], &bsmp_func_lock_udc);                 // ID 9
-    bsmp_register_function(&bsmp[server], &bsmp_func_cfg_source_scope);         // ID 10
-    bsmp_register_function(&bsmp[server], &bsmp_func_cfg_freq_scope);           // ID 11
-    bsmp_register_function(&bsmp[server], &bsmp_func_cfg_duration_scope);       // ID 12
-    bsmp_register_function(&bsmp[server], &bsmp_func_enable_scope);             // ID 13
-    bsmp_register_function(&bsmp[server], &bsmp_func_disable_scope);            // ID 14
-    bsmp_register_function(&bsmp[server], &bsmp_func_sync_pulse);               // ID 15
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_slowref);              // ID 16
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_slowref_fbp);          // ID 17
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_slowref_readback_mon); // ID 18
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_slowref_fbp_readback_mon); // ID 19
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_slowref_readback_ref); // ID 20
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_slowref_fbp_readback_ref); // ID 21
-    bsmp_register_function(&bsmp[server], &bsmp_func_reset_counters);           // ID 22
-    bsmp_register_function(&bsmp[server], &bsmp_func_cfg_wfmref);               // ID 23
-    //create_bsmp_function(20, server, &bsmp_select_wfmref, 2, 1);              // ID 24
-    bsmp_register_function(&bsmp[server], &bsmp_func_select_wfmref);            // ID 24
-    bsmp_register_function(&bsmp[server], &dummy_func1);                        // ID 25
-    bsmp_register_function(&bsmp[server], &bsmp_func_reset_wfmref);             // ID 26
-    bsmp_register_function(&bsmp[server], &bsmp_func_cfg_siggen);               // ID 27
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_siggen);               // ID 28
-    bsmp_register_function(&bsmp[server], &bsmp_func_enable_siggen);            // ID 29
-    bsmp_register_function(&bsmp[server], &bsmp_func_disable_siggen);           // ID 30
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_param);                // ID 31
-    bsmp_register_function(&bsmp[server], &bsmp_func_get_param);                // ID 32
-    bsmp_register_function(&bsmp[server], &bsmp_func_save_param_eeprom);        // ID 33
-    bsmp_register_function(&bsmp[server], &bsmp_func_load_param_eeprom);        // ID 34
-    bsmp_register_function(&bsmp[server], &bsmp_func_save_param_bank);          // ID 35
-    bsmp_register_function(&bsmp[server], &bsmp_func_load_param_bank);          // ID 36
-    bsmp_register_function(&bsmp[server], &bsmp_func_set_dsp_coeffs);           // ID 37
-    bsmp_register_function(&bsmp[server], &bsmp_func_get_dsp_coeff);            // ID 38
-    bsmp_register_function(&bsmp[server], &bsmp_func_save_dsp_coeffs_eeprom);   // ID 39
-    bsmp_register_function(&bsmp[server], &bsmp_func_load_dsp_coeffs_eeprom);   // ID 40
-    bsmp_register_function(&bsmp[server], &bsmp_func_save_dsp_modules_eeprom);  // ID 41
-    bsmp_register_function(&bsmp[server], &bsmp_func_load_dsp_modules_eeprom);  // ID 42
-    bsmp_register_function(&bsmp[server], &bsmp_func_reset_udc);                // ID 43
+    bsmp_register_function_table(&bsmp[server], bsmp_funcs,
+                                 sizeof(bsmp_funcs)/sizeof(bsmp_funcs[0]));
 
     /**
      * BSMP Variable Register
@@ -2402,6 +3270,11 @@ void bsmp_init(uint8_t server)
     create_bsmp_var(16, server, 4, false, g_ipc_ctom.wfmref[server].lerp.freq_base.u8);
     create_bsmp_var(17, server, 4, false, g_ipc_ctom.wfmref[server].gain.u8);
     create_bsmp_var(18, server, 4, false, g_ipc_ctom.wfmref[server].offset.u8);
+    /**
+     * WfmRef pointers on C28 memory map, kept for existing hosts. Buffers
+     * themselves are accessed through curves, which are stable IDs of shared
+     * buffers registry.
+     */
     create_bsmp_var(19, server, 4, false, g_ipc_mtoc.wfmref[server].wfmref_data[0].p_buf_start.u8);
     create_bsmp_var(20, server, 4, false, g_ipc_mtoc.wfmref[server].wfmref_data[0].p_buf_end.u8);
     create_bsmp_var(21, server, 4, false, g_ipc_ctom.wfmref[server].wfmref_data[0].p_buf_idx.u8);
@@ -2412,23 +3285,38 @@ void bsmp_init(uint8_t server)
     create_bsmp_var(26, server, 4, false, g_ipc_ctom.scope[server].duration.u8);
     create_bsmp_var(27, server, 4, false, g_ipc_ctom.scope[server].p_source.u8);
     create_bsmp_var(28, server, 4, false, g_ipc_ctom.period_sync_pulse.u8);
-    create_bsmp_var(29, server, 1, false, &dummy_u8);   // Reserved common variable
-    create_bsmp_var(30, server, 1, false, &dummy_u8);   // Reserved common variable
+    create_bsmp_var(29, server, 2, false, g_rs485_rx_stats.peak_depth.u8);
+    create_bsmp_var(30, server, 4, false, g_rs485_rx_stats.dropped.u8);
+
+    /**
+     * BSMP Group Register
+     *
+     * Slow diagnostics group, with counters and SigGen, WfmRef and scope
+     * parameters. Power supply models add their own groups after it.
+     */
+    create_bsmp_group(BSMP_GROUP_ID_DIAGNOSTICS, server, bsmp_group_diagnostics,
+                      sizeof(bsmp_group_diagnostics));
 
     /**
      * BSMP Curves Register
      */
-    create_bsmp_curve(0, server, 16, 1024, true,
-                      &WFMREF[server],
-                      read_block_wfmref, write_block_wfmref);
+    for(i = 0; i < NUMBER_OF_WFMREF_CURVES; i++)
+    {
+        bsmp_curves_state[server][i].block_csum  = wfmref_block_csum[server][i];
+        bsmp_curves_state[server][i].block_dirty = wfmref_block_dirty[server][i];
+        bsmp_curves_state[server][i].user        = &WFMREF[server];
+        bsmp_curves_state[server][i + LARGE_BLOCK_CURVES_OFFSET].user =
+                                                            &WFMREF[server];
+    }
 
-    create_bsmp_curve(1, server, 16, 1024, true,
-                      &WFMREF[server],
-                      read_block_wfmref, write_block_wfmref);
+    bsmp_curves_state[server][2].user = &g_ipc_mtoc.scope[server].buffer;
+    bsmp_curves_state[server][5].user = &g_ipc_mtoc.scope[server].buffer;
+    bsmp_curves_state[server][6].user = &g_ipc_mtoc.scope[server].buffer;
+    bsmp_curves_state[server][7].user = &g_ipc_mtoc.scope[server].buffer;
 
-    create_bsmp_curve(2, server, 16, 1024, false,
-                      &g_ipc_mtoc.scope[server].buffer,
-                      read_block_buf_samples_ctom, write_block_dummy);
+    bsmp_register_curve_table(&bsmp[server], bsmp_curves,
+                              bsmp_curves_state[server],
+                              sizeof(bsmp_curves)/sizeof(bsmp_curves[0]));
 }
 
 /**
@@ -2460,6 +3348,28 @@ void create_bsmp_var(uint8_t var_id, uint8_t server, uint8_t size,
     }
 }
 
+/**
+ * @brief Create new BSMP group
+ *
+ * Create new predefined BSMP group. This function verifies if specified ID
+ * respects the automatic registration of groups ID performed by BSMP library,
+ * according to the sequential call of this function. Groups must be created
+ * after all of its variables.
+ *
+ * @param group_id ID for BSMP group
+ * @param server BSMP server to be initialized
+ * @param var_ids list of variables IDs, in ascending order
+ * @param count number of variables
+ */
+void create_bsmp_group(uint8_t group_id, uint8_t server,
+                       const uint8_t *var_ids, uint8_t count)
+{
+    if(bsmp[server].groups.count == group_id)
+    {
+        bsmp_register_group(&bsmp[server], var_ids, count);
+    }
+}
+
 /**
  * Modify a pre-created variable. This function must be used only under the
  * following constraints:
@@ -2478,67 +3388,6 @@ void modify_bsmp_var(uint8_t var_id, uint8_t server, volatile uint8_t *p_var)
     bsmp_vars[server][var_id].data = p_var;
 }
 
-/**
- * @brief Create new BSMP curve
- *
- * Create new BSMP curve. This function verifies if specified ID respects
- * the automatic registration of curves ID performed by BSMP library,
- * according to the sequential call of this function. In this case, curve is
- * initialized with given properties.
- *
- * @param curve_id ID for BSMP curve
- * @param server BSMP server to be initialized
- * @param nblocks number of blocks
- * @param block_size block size in bytes
- * @param writable define whether is read-only or writable
- * @param user user defined variable. For WfmRefs curves, is used as a pointer to WfmRef structs.
- * @param p_read_block pointer to read block function for specified curve
- * @param p_write_block pointer to write block function for specified curve
- */
-void create_bsmp_curve(uint8_t curve_id, uint8_t server, uint32_t nblocks,
-                       uint16_t block_size, bool writable, void *user,
-                       bool (*p_read_block)(struct bsmp_curve *,uint16_t,
-                                            uint8_t *,uint16_t *),
-                       bool (*p_write_block)(struct bsmp_curve *,uint16_t,
-                                             uint8_t *, uint16_t))
-{
-    if( (bsmp[server].curves.count == curve_id) &&
-        (curve_id < NUMBER_OF_BSMP_CURVES) )
-    {
-        bsmp_curves[server][curve_id].info.nblocks    = nblocks;
-        bsmp_curves[server][curve_id].info.block_size = block_size;
-        bsmp_curves[server][curve_id].info.writable   = writable;
-        bsmp_curves[server][curve_id].read_block      = p_read_block;
-        bsmp_curves[server][curve_id].write_block     = p_write_block;
-        bsmp_curves[server][curve_id].user            = user;
-
-        bsmp_register_curve(&bsmp[server], &bsmp_curves[server][curve_id]);
-    }
-}
-
-/**
- *
- * @param func_id
- * @param server
- * @param func_p
- * @param input_size
- * @param output_size
- */
-void create_bsmp_function(uint8_t func_id, uint8_t server, bsmp_func_t func_p,
-                          uint8_t input_size, uint8_t output_size)
-{
-    if( (bsmp[server].funcs.count == func_id) &&
-        (func_id < BSMP_MAX_FUNCTIONS) )
-    {
-        bsmp_funcs[server][func_id].func_p = func_p;
-        bsmp_funcs[server][func_id].info.input_size = input_size;
-        bsmp_funcs[server][func_id].info.output_size = output_size;
-
-        bsmp_register_function(&bsmp[server], &bsmp_funcs[server][func_id]);
-    }
-}
-
-
 enum bsmp_err bsmp_func_error(uint8_t func_error, struct bsmp_raw_packet *response)
 {
 
@@ -2554,11 +3403,14 @@ enum bsmp_err bsmp_func_error(uint8_t func_error, struct bsmp_raw_packet *respon
 /**
  * @brief BSMP process data
  *
- * Send received data to BSMP server specified and process
+ * Send received data to BSMP server specified and process. The power supply
+ * and command interface of the request are kept in a context on the stack, so
+ * interfaces may call it from different interrupt priorities.
  *
  * @param bsmp_raw_packet* Pointer to received packet
  * @param bsmp_raw_packet* Pointer to store response packet
  * @param uint8_t ID for BSMP server
+ * @param uint16_t Command interface which received the packet
  */
 
 void BSMPprocess(struct bsmp_raw_packet *recv_packet,
@@ -2566,19 +3418,27 @@ void BSMPprocess(struct bsmp_raw_packet *recv_packet,
                  uint16_t command_interface)
 {
     uint8_t bsmp_cmd_type = recv_packet->data[0] & 0xF0;
+    bsmp_request_ctx_t ctx;
+
+    ctx.ps_id             = server;
+    ctx.command_interface = command_interface;
+
+    p_new_pending_cmd = NULL;
+
     /**
      * Check if command interface is correct, or if is one of the possible
-     * conditions is fulfilled
+     * conditions is fulfilled. Functions in batch are checked one by one.
      */
     //if( (command_interface == get_param(Command_Interface,0)) ||
-    if( (command_interface == g_ipc_ctom.ps_module[g_current_ps_id].ps_status.bit.interface ) ||
+    if( (command_interface == g_ipc_ctom.ps_module[server].ps_status.bit.interface ) ||
         (bsmp_cmd_type == BSMP_READ_COMMANDS ) ||
         (bsmp_cmd_type == BSMP_QUERY_COMMANDS ) ||
         (bsmp_cmd_type == BSMP_BLOCK_COMMANDS) ||
-        ((bsmp_cmd_type == BSMP_FUNC_EXECUTE) && (recv_packet->data[3] == 32)) ||
-        ((bsmp_cmd_type == BSMP_FUNC_EXECUTE) && (recv_packet->data[3] == 6)) )
+        (recv_packet->data[0] == BSMP_FUNC_EXECUTE_BATCH) ||
+        ((recv_packet->data[0] == BSMP_FUNC_EXECUTE) &&
+         bsmp_func_allowed(server, command_interface, recv_packet->data[3])) )
     {
-        bsmp_process_packet(&bsmp[server], recv_packet, send_packet);
+        bsmp_process_packet(&bsmp[server], recv_packet, send_packet, &ctx);
     }
     else if(command_interface == Remote)
     {
@@ -2590,3 +3450,85 @@ void BSMPprocess(struct bsmp_raw_packet *recv_packet,
         bsmp_func_error(Invalid_Command, send_packet);
     }
 }
+
+/**
+ * @brief BSMP process broadcast data
+ *
+ * Functions with a broadcast version for the power supply model are executed
+ * once for all power supplies, so they're updated in the same control cycle.
+ * Other requests, and every request on other models, are processed
+ * by each server in turn. Response packet is just a scratch buffer, as there's
+ * no response to broadcast requests.
+ *
+ * @param bsmp_raw_packet* Pointer to received packet
+ * @param bsmp_raw_packet* Pointer to scratch response packet
+ * @param uint16_t Command interface which received the packet
+ */
+void BSMPprocess_broadcast(struct bsmp_raw_packet *recv_packet,
+                           struct bsmp_raw_packet *send_packet,
+                           uint16_t command_interface)
+{
+    uint8_t i, func_id;
+    bsmp_request_ctx_t ctx;
+
+    ctx.ps_id             = 0;
+    ctx.command_interface = command_interface;
+
+    p_new_pending_cmd = NULL;
+
+    if( (recv_packet->data[0] == BSMP_FUNC_EXECUTE) && (recv_packet->len > 3) )
+    {
+        func_id = recv_packet->data[3];
+
+        for(i = 0; i < sizeof(bsmp_bcast_funcs)/sizeof(bsmp_bcast_funcs[0]); i++)
+        {
+            if( (bsmp_bcast_funcs[i].func_id == func_id) &&
+                (bsmp_bcast_funcs[i].ps_model ==
+                 g_ipc_ctom.ps_module[0].ps_status.bit.model) &&
+                (recv_packet->len ==
+                 4 + bsmp_funcs[func_id]->info.input_size) &&
+                (((recv_packet->data[1] << 8) | recv_packet->data[2]) ==
+                 recv_packet->len - 3) )
+            {
+                send_packet->data[0] = BSMP_FUNC_RETURN;
+                send_packet->data[1] = 0x00;
+                send_packet->data[2] = 0x01;
+                send_packet->len = 4;
+
+                bsmp_bcast_funcs[i].func_p(&recv_packet->data[4],
+                                           &send_packet->data[3], &ctx);
+                bsmp_wait_pending_cmd();
+                return;
+            }
+        }
+    }
+
+    for(i = 0; i < NUMBER_OF_BSMP_SERVERS; i++)
+    {
+        BSMPprocess(recv_packet, send_packet, i, command_interface);
+        bsmp_wait_pending_cmd();
+    }
+}
+
+/**
+ * @brief Run BSMP function
+ *
+ * Execute BSMP function from internal tasks, out of a BSMP request.
+ *
+ * @param server BSMP server, i.e., power supply ID
+ * @param func_id BSMP function ID
+ * @param input pointer to input data of function
+ * @param output pointer to output data of function
+ * @return function result
+ */
+uint8_t run_bsmp_func(uint8_t server, uint8_t func_id, uint8_t *input,
+                      uint8_t *output)
+{
+    bsmp_request_ctx_t ctx;
+
+    ctx.ps_id             = server;
+    ctx.command_interface =
+                g_ipc_ctom.ps_module[server].ps_status.bit.interface;
+
+    return bsmp[server].funcs.list[func_id]->func_p(input, output, &ctx);
+}
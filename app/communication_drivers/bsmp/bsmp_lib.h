@@ -12,7 +12,15 @@
 
 #define NUMBER_OF_BSMP_SERVERS      4
 
-#define RUN_BSMP_FUNC(server, idx, input, output)   bsmp[server].funcs.list[idx]->func_p((uint8_t *) input, (uint8_t *) output);
+/**
+ * Predefined groups, registered after the standard ones (all, read-only and
+ * writable variables). Models without IIB don't have its group.
+ */
+#define BSMP_GROUP_ID_DIAGNOSTICS   3
+#define BSMP_GROUP_ID_STATUS        4
+#define BSMP_GROUP_ID_IIB           5
+
+#define RUN_BSMP_FUNC(server, idx, input, output)   run_bsmp_func(server, idx, (uint8_t *) input, (uint8_t *) output);
 
 typedef enum
 {
@@ -27,21 +35,36 @@ typedef enum
     Invalid_Command
 } bsmp_command_ack_t;
 
+/**
+ * Context of a BSMP request, given to BSMP functions and curves callbacks
+ */
+typedef struct
+{
+    uint8_t     ps_id;              // Power supply addressed by request
+    uint16_t    command_interface;  // Interface which received request
+} bsmp_request_ctx_t;
+
 extern volatile bsmp_server_t bsmp[NUMBER_OF_BSMP_SERVERS];
 
 extern void BSMPprocess(struct bsmp_raw_packet *recv_packet,
                         struct bsmp_raw_packet *send_packet, uint8_t server,
                         uint16_t command_interface);
+extern void BSMPprocess_broadcast(struct bsmp_raw_packet *recv_packet,
+                                  struct bsmp_raw_packet *send_packet,
+                                  uint16_t command_interface);
 extern void bsmp_init(uint8_t server);
+extern uint8_t run_bsmp_func(uint8_t server, uint8_t func_id, uint8_t *input,
+                             uint8_t *output);
 extern void create_bsmp_var(uint8_t var_id, uint8_t server, uint8_t size,
                             bool writable, volatile uint8_t *p_var);
+extern void create_bsmp_group(uint8_t group_id, uint8_t server,
+                              const uint8_t *var_ids, uint8_t count);
 extern void modify_bsmp_var(uint8_t var_id, uint8_t server,
                             volatile uint8_t *p_var);
-extern void create_bsmp_curve(uint8_t curve_id, uint8_t server, uint32_t nblocks,
-                              uint16_t block_size, bool writable, void *user,
-                              bool (*p_read_block)(struct bsmp_curve *,uint16_t,
-                                                   uint8_t *,uint16_t *),
-                              bool (*p_write_block)(struct bsmp_curve *,uint16_t,
-                                                    uint8_t *, uint16_t));
+extern bool bsmp_cmd_pending(struct bsmp_raw_packet *response);
+extern void bsmp_defer_response(struct bsmp_raw_packet *response,
+                                void (*p_send_response)(void));
+extern void bsmp_check_pending_cmd(void);
+extern void bsmp_wait_pending_cmd(void);
 
 #endif /* BSMP_LIB_H_ */
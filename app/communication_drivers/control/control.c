@@ -21,11 +21,15 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include "control.h"
 
 #pragma DATA_SECTION(g_controller_mtoc,"SHARERAMS0_0");
 #pragma DATA_SECTION(g_controller_ctom,"SHARERAMS1_0");
 
+#pragma CODE_SECTION(run_dsp_plan, "ramfuncs");
+#pragma CODE_SECTION(swap_dsp_coeffs, "ramfuncs");
+
 volatile control_framework_t g_controller_ctom;
 volatile control_framework_t g_controller_mtoc;
 
@@ -42,8 +46,23 @@ void init_control_framework(volatile control_framework_t *p_controller)
     {
         p_controller->output_signals[i].f = 0.0;
     }
+
+    p_controller->dsp_coeffs_swap_mode = DSP_Coeffs_Swap_Immediate;
+    p_controller->dsp_coeffs_pending = 0;
 }
 
+/**
+ * Configure coefficients of a DSP module. They're written on shadow bank of
+ * module, so module never runs with a partially updated set. Bank is swapped
+ * in right away on DSP_Coeffs_Swap_Immediate mode, otherwise on next call of
+ * swap_dsp_coeffs() by control loop.
+ *
+ * @param p_controller
+ * @param dsp_class
+ * @param id
+ * @param p_coeffs      coefficients vector, ordered as dsp_*_t coeffs
+ * @return 1 if class is valid, 0 otherwise
+ */
 uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
                        dsp_class_t dsp_class, uint16_t id, float *p_coeffs)
 {
@@ -54,7 +73,7 @@ uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
             //memcpy(&p_controller->dsp_modules.dsp_srlim[id].coeffs.f, p_coeffs,
             //       4*NUM_COEFFS_DSP_SRLIM);
             cfg_dsp_srlim(&p_controller->dsp_modules.dsp_srlim[id], *(p_coeffs));
-            return 1;
+            break;
         }
 
         case DSP_LPF:
@@ -62,7 +81,7 @@ uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
             //memcpy(&p_controller->dsp_modules.dsp_lpf[id].coeffs.f, p_coeffs,
             //       4*NUM_COEFFS_DSP_LPF);
             cfg_dsp_lpf(&p_controller->dsp_modules.dsp_lpf[id], *(p_coeffs));
-            return 1;
+            break;
         }
 
         case DSP_PI:
@@ -72,7 +91,7 @@ uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
             //       8);
             cfg_dsp_pi(&p_controller->dsp_modules.dsp_pi[id], *(p_coeffs),
                        *(p_coeffs+1), *(p_coeffs+2), *(p_coeffs+3));
-            return 1;
+            break;
        }
        case DSP_IIR_2P2Z:
        {
@@ -82,7 +101,7 @@ uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
                              *(p_coeffs), *(p_coeffs+1), *(p_coeffs+2),
                              *(p_coeffs+3), *(p_coeffs+4), *(p_coeffs+5),
                              *(p_coeffs+6));
-            return 1;
+            break;
         }
 
         case DSP_IIR_3P3Z:
@@ -93,7 +112,7 @@ uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
                              *(p_coeffs), *(p_coeffs+1), *(p_coeffs+2),
                              *(p_coeffs+3), *(p_coeffs+4), *(p_coeffs+5),
                              *(p_coeffs+6), *(p_coeffs+7), *(p_coeffs+8));
-            return 1;
+            break;
         }
 
         case DSP_VdcLink_FeedForward:
@@ -102,14 +121,43 @@ uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
             //       4*NUM_COEFFS_DSP_VDCLINK_FF);
             cfg_dsp_vdclink_ff(&p_controller->dsp_modules.dsp_ff[id],
                                *(p_coeffs), *(p_coeffs+1));
-            return 1;
+            break;
+        }
+
+        /// Each ID is a section: id = cascade * NUM_MAX_IIR_SOS_SECTIONS + section
+        case DSP_IIR_SOS:
+        {
+            cfg_dsp_iir_sos(&p_controller->dsp_modules.dsp_iir_sos[id / NUM_MAX_IIR_SOS_SECTIONS],
+                            id % NUM_MAX_IIR_SOS_SECTIONS, *(p_coeffs),
+                            *(p_coeffs+1), *(p_coeffs+2), *(p_coeffs+3),
+                            *(p_coeffs+4), *(p_coeffs+5), *(p_coeffs+6));
+            break;
         }
 
         default:
             return 0;
     }
+
+    p_controller->dsp_coeffs_pending = 1;
+
+    if(p_controller->dsp_coeffs_swap_mode == DSP_Coeffs_Swap_Immediate)
+    {
+        swap_dsp_coeffs(p_controller, 0);
+    }
+
+    return 1;
 }
 
+/**
+ * Get latest configured coefficient of a DSP module, even if it's still
+ * pending for swap.
+ *
+ * @param p_controller
+ * @param dsp_class
+ * @param id
+ * @param coeff
+ * @return coefficient value, or NAN if class is invalid
+ */
 float get_dsp_coeff(volatile control_framework_t *p_controller,
                     dsp_class_t dsp_class, uint16_t id, uint16_t coeff)
 {
@@ -117,34 +165,617 @@ float get_dsp_coeff(volatile control_framework_t *p_controller,
     {
         case DSP_SRLim:
         {
-            return p_controller->dsp_modules.dsp_srlim[id].coeffs.f[coeff];
+            return DSP_LATEST_COEFFS(p_controller->dsp_modules.dsp_srlim[id]).f[coeff];
         }
 
         case DSP_LPF:
         {
-            return p_controller->dsp_modules.dsp_lpf[id].coeffs.f[coeff];
+            return DSP_LATEST_COEFFS(p_controller->dsp_modules.dsp_lpf[id]).f[coeff];
         }
 
         case DSP_PI:
         {
-            return p_controller->dsp_modules.dsp_pi[id].coeffs.f[coeff];
+            return DSP_LATEST_COEFFS(p_controller->dsp_modules.dsp_pi[id]).f[coeff];
         }
         case DSP_IIR_2P2Z:
         {
-            return p_controller->dsp_modules.dsp_iir_2p2z[id].coeffs.f[coeff];
+            return DSP_LATEST_COEFFS(p_controller->dsp_modules.dsp_iir_2p2z[id]).f[coeff];
         }
 
         case DSP_IIR_3P3Z:
         {
-            return p_controller->dsp_modules.dsp_iir_3p3z[id].coeffs.f[coeff];
+            return DSP_LATEST_COEFFS(p_controller->dsp_modules.dsp_iir_3p3z[id]).f[coeff];
         }
 
         case DSP_VdcLink_FeedForward:
         {
-            return p_controller->dsp_modules.dsp_ff[id].coeffs.f[coeff];
+            return DSP_LATEST_COEFFS(p_controller->dsp_modules.dsp_ff[id]).f[coeff];
+        }
+
+        case DSP_IIR_SOS:
+        {
+            return get_dsp_iir_sos_coeff(&p_controller->dsp_modules.dsp_iir_sos[id / NUM_MAX_IIR_SOS_SECTIONS],
+                                         id % NUM_MAX_IIR_SOS_SECTIONS, coeff);
         }
 
         default:
             return NAN;
     }
 }
+
+/**
+ * Swap coefficients banks of all DSP modules with pending updates, so new
+ * coefficients take effect together, between two cycles. Unless on
+ * DSP_Coeffs_Swap_Immediate mode, it must be called by control loop before
+ * running DSP modules. On DSP_Coeffs_Swap_Sync_Pulse mode, swap is held until
+ * a cycle with sync pulse.
+ *
+ * Modules being updated when this is called are swapped on a later call.
+ *
+ * @param p_controller
+ * @param sync_pulse    1 if sync pulse was received on this cycle
+ * @return 1 if banks were swapped
+ */
+uint16_t swap_dsp_coeffs(volatile control_framework_t *p_controller,
+                         uint16_t sync_pulse)
+{
+    volatile dsp_modules_t *p_modules = &p_controller->dsp_modules;
+    uint16_t i, pending = 0;
+
+    if( !p_controller->dsp_coeffs_pending ||
+        ( (p_controller->dsp_coeffs_swap_mode == DSP_Coeffs_Swap_Sync_Pulse) &&
+          !sync_pulse ) )
+    {
+        return 0;
+    }
+
+    p_controller->dsp_coeffs_pending = 0;
+
+    for(i = 0; i < NUM_MAX_DSP_SRLIM; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_srlim[i].bank);
+    }
+
+    for(i = 0; i < NUM_MAX_DSP_LPF; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_lpf[i].bank);
+    }
+
+    for(i = 0; i < NUM_MAX_DSP_PI; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_pi[i].bank);
+    }
+
+    for(i = 0; i < NUM_MAX_DSP_IIR_2P2Z; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_iir_2p2z[i].bank);
+    }
+
+    for(i = 0; i < NUM_MAX_DSP_IIR_3P3Z; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_iir_3p3z[i].bank);
+    }
+
+    for(i = 0; i < NUM_MAX_DSP_VDCLINK_FF; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_ff[i].bank);
+    }
+
+    for(i = 0; i < NUM_MAX_DSP_IIR_SOS; i++)
+    {
+        pending |= swap_dsp_coeffs_bank(&p_modules->dsp_iir_sos[i].bank);
+    }
+
+    if(pending)
+    {
+        p_controller->dsp_coeffs_pending = 1;
+    }
+
+    return 1;
+}
+
+/**
+ * Get DSP module from class and ID.
+ *
+ * @return pointer to module, or NULL if class or ID are invalid
+ */
+static volatile void * get_dsp_module(volatile control_framework_t *p_controller,
+                                      dsp_class_t dsp_class, uint16_t id)
+{
+    volatile dsp_modules_t *p_modules = &p_controller->dsp_modules;
+
+    switch(dsp_class)
+    {
+        case DSP_Error:
+            return (id < NUM_MAX_DSP_ERROR) ? &p_modules->dsp_error[id] : NULL;
+        case DSP_SRLim:
+            return (id < NUM_MAX_DSP_SRLIM) ? &p_modules->dsp_srlim[id] : NULL;
+        case DSP_LPF:
+            return (id < NUM_MAX_DSP_LPF) ? &p_modules->dsp_lpf[id] : NULL;
+        case DSP_PI:
+            return (id < NUM_MAX_DSP_PI) ? &p_modules->dsp_pi[id] : NULL;
+        case DSP_IIR_2P2Z:
+            return (id < NUM_MAX_DSP_IIR_2P2Z) ? &p_modules->dsp_iir_2p2z[id] : NULL;
+        case DSP_IIR_3P3Z:
+            return (id < NUM_MAX_DSP_IIR_3P3Z) ? &p_modules->dsp_iir_3p3z[id] : NULL;
+        case DSP_VdcLink_FeedForward:
+            return (id < NUM_MAX_DSP_VDCLINK_FF) ? &p_modules->dsp_ff[id] : NULL;
+        case DSP_Vect_Product:
+            return (id < NUM_MAX_DSP_VECT_PRODUCT) ? &p_modules->dsp_vect_product[id] : NULL;
+        case DSP_IIR_SOS:
+            return (id < NUM_MAX_DSP_IIR_SOS) ? &p_modules->dsp_iir_sos[id] : NULL;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Get index of signal on net signals followed by output signals, which are
+ * contiguous on control_framework_t.
+ *
+ * @return signal index, or DSP_PLAN_EXTERNAL_SIGNAL if it's not a signal of
+ * Control Framework
+ */
+static uint16_t get_signal_index(volatile control_framework_t *p_controller,
+                                 volatile float *p_signal)
+{
+    volatile float *p_first = &p_controller->net_signals[0].f;
+
+    if( (p_signal >= p_first) &&
+        (p_signal < p_first + NUM_MAX_NET_SIGNALS + NUM_MAX_OUTPUT_SIGNALS) )
+    {
+        return p_signal - p_first;
+    }
+
+    return DSP_PLAN_EXTERNAL_SIGNAL;
+}
+
+/**
+ * Compile operation of a DSP module.
+ *
+ * @return 1 if module is wired, 0 otherwise
+ */
+static uint8_t compile_dsp_plan_op(volatile control_framework_t *p_controller,
+                                   dsp_plan_op_t *p_op, dsp_class_t dsp_class,
+                                   volatile void *p_module)
+{
+    volatile float *in, *aux = NULL, *out;
+    uint16_t i;
+
+    p_op->dsp_class = dsp_class;
+    p_op->p_module = p_module;
+    p_op->p_bank = NULL;
+
+    switch(dsp_class)
+    {
+        case DSP_Error:
+        {
+            dsp_error_t *p_error = (dsp_error_t *) p_module;
+            p_op->type = DSP_Plan_Error;
+            in = p_error->pos;
+            aux = p_error->neg;
+            out = p_error->error;
+            break;
+        }
+
+        case DSP_SRLim:
+        {
+            dsp_srlim_t *p_srlim = (dsp_srlim_t *) p_module;
+            p_op->type = DSP_Plan_Run_Module;
+            in = p_srlim->in;
+            out = p_srlim->out;
+            break;
+        }
+
+        case DSP_LPF:
+        {
+            dsp_lpf_t *p_lpf = (dsp_lpf_t *) p_module;
+            p_op->type = DSP_Plan_LPF;
+            p_op->p_bank = &p_lpf->bank.active;
+            in = p_lpf->in;
+            out = p_lpf->out;
+            break;
+        }
+
+        case DSP_PI:
+        {
+            dsp_pi_t *p_pi = (dsp_pi_t *) p_module;
+            p_op->type = DSP_Plan_PI;
+            p_op->p_bank = &p_pi->bank.active;
+            for(i = 0; i < NUM_DSP_COEFFS_BANKS; i++)
+            {
+                p_op->p_coeffs[i] = (const float *) p_pi->coeffs[i].f;
+            }
+            in = p_pi->in;
+            out = p_pi->out;
+            break;
+        }
+
+        case DSP_IIR_2P2Z:
+        {
+            dsp_iir_2p2z_t *p_iir = (dsp_iir_2p2z_t *) p_module;
+            p_op->type = DSP_Plan_IIR_2P2Z;
+            p_op->p_bank = &p_iir->bank.active;
+            for(i = 0; i < NUM_DSP_COEFFS_BANKS; i++)
+            {
+                p_op->p_coeffs[i] = (const float *) p_iir->coeffs[i].f;
+            }
+            in = p_iir->in;
+            out = p_iir->out;
+            break;
+        }
+
+        case DSP_IIR_3P3Z:
+        {
+            dsp_iir_3p3z_t *p_iir = (dsp_iir_3p3z_t *) p_module;
+            p_op->type = DSP_Plan_IIR_3P3Z;
+            p_op->p_bank = &p_iir->bank.active;
+            for(i = 0; i < NUM_DSP_COEFFS_BANKS; i++)
+            {
+                p_op->p_coeffs[i] = (const float *) p_iir->coeffs[i].f;
+            }
+            in = p_iir->in;
+            out = p_iir->out;
+            break;
+        }
+
+        case DSP_VdcLink_FeedForward:
+        {
+            dsp_vdclink_ff_t *p_ff = (dsp_vdclink_ff_t *) p_module;
+            p_op->type = DSP_Plan_VdcLink_FF;
+            p_op->p_bank = &p_ff->bank.active;
+            for(i = 0; i < NUM_DSP_COEFFS_BANKS; i++)
+            {
+                p_op->p_coeffs[i] = (const float *) p_ff->coeffs[i].f;
+            }
+            in = p_ff->in;
+            aux = p_ff->vdc_meas;
+            out = p_ff->out;
+            break;
+        }
+
+        case DSP_Vect_Product:
+        {
+            dsp_vect_product_t *p_vect = (dsp_vect_product_t *) p_module;
+            p_op->type = DSP_Plan_Run_Module;
+            in = p_vect->in;
+            out = p_vect->out;
+            break;
+        }
+
+        case DSP_IIR_SOS:
+        {
+            dsp_iir_sos_t *p_sos = (dsp_iir_sos_t *) p_module;
+            p_op->type = DSP_Plan_Run_Module;
+            in = p_sos->in;
+            out = p_sos->out;
+            break;
+        }
+
+        default:
+            return 0;
+    }
+
+    if( (in == NULL) || (out == NULL) )
+    {
+        return 0;
+    }
+
+    p_op->in = get_signal_index(p_controller, in);
+    p_op->aux = (aux == NULL) ? DSP_PLAN_EXTERNAL_SIGNAL :
+                                get_signal_index(p_controller, aux);
+    p_op->out = get_signal_index(p_controller, out);
+
+    /// Modules connected to external signals run through their own functions
+    if( (p_op->in == DSP_PLAN_EXTERNAL_SIGNAL) ||
+        (p_op->out == DSP_PLAN_EXTERNAL_SIGNAL) ||
+        ((aux != NULL) && (p_op->aux == DSP_PLAN_EXTERNAL_SIGNAL)) )
+    {
+        p_op->type = DSP_Plan_Run_Module;
+    }
+
+    return 1;
+}
+
+/**
+ * Check whether operation reads output of another operation of plan, from
+ * first to last - 1.
+ */
+static uint8_t dsp_plan_op_depends(dsp_plan_op_t *p_ops, uint16_t op,
+                                   uint16_t first, uint16_t last)
+{
+    uint16_t i;
+
+    for(i = first; i < last; i++)
+    {
+        if( (i != op) && (p_ops[i].out != DSP_PLAN_EXTERNAL_SIGNAL) &&
+            ( (p_ops[i].out == p_ops[op].in) ||
+              (p_ops[i].out == p_ops[op].aux) ) )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Compile execution plan of DSP modules from Control Framework.
+ *
+ * If a list of modules is given, they're run on its order. Otherwise, all
+ * wired modules (with input and output connected) are run, ordered by
+ * dataflow: a module runs after the modules which write on its inputs. Ties,
+ * and modules on feedback loops, keep the order of dsp_modules_t.
+ *
+ * @param p_controller
+ * @param p_plan
+ * @param p_modules list of modules, or NULL to use all wired modules
+ * @param num_modules number of modules on list
+ * @return number of operations of plan
+ */
+uint16_t compile_dsp_plan(volatile control_framework_t *p_controller,
+                          dsp_plan_t *p_plan, const dsp_module_t *p_modules,
+                          uint16_t num_modules)
+{
+    static const uint16_t num_max_modules[NUM_DSP_CLASSES] =
+    {
+        [DSP_Error]                 = NUM_MAX_DSP_ERROR,
+        [DSP_SRLim]                 = NUM_MAX_DSP_SRLIM,
+        [DSP_LPF]                   = NUM_MAX_DSP_LPF,
+        [DSP_PI]                    = NUM_MAX_DSP_PI,
+        [DSP_IIR_2P2Z]              = NUM_MAX_DSP_IIR_2P2Z,
+        [DSP_IIR_3P3Z]              = NUM_MAX_DSP_IIR_3P3Z,
+        [DSP_VdcLink_FeedForward]   = NUM_MAX_DSP_VDCLINK_FF,
+        [DSP_Vect_Product]          = NUM_MAX_DSP_VECT_PRODUCT,
+        [DSP_IIR_SOS]               = NUM_MAX_DSP_IIR_SOS
+    };
+    dsp_plan_op_t op;
+    volatile void *p_module;
+    uint16_t i, j, n = 0;
+
+    p_plan->p_signals = (float *) &p_controller->net_signals[0].f;
+
+    if(p_modules != NULL)
+    {
+        for(i = 0; (i < num_modules) && (n < NUM_MAX_DSP_PLAN_OPS); i++)
+        {
+            p_module = get_dsp_module(p_controller, p_modules[i].dsp_class,
+                                      p_modules[i].id);
+
+            if( (p_module != NULL) &&
+                compile_dsp_plan_op(p_controller, &p_plan->ops[n],
+                                    p_modules[i].dsp_class, p_module) )
+            {
+                n++;
+            }
+        }
+
+        p_plan->num_ops = n;
+        return n;
+    }
+
+    for(i = DSP_Error; i < NUM_DSP_CLASSES; i++)
+    {
+        for(j = 0; j < num_max_modules[i]; j++)
+        {
+            p_module = get_dsp_module(p_controller, (dsp_class_t) i, j);
+
+            if( (p_module != NULL) && (n < NUM_MAX_DSP_PLAN_OPS) &&
+                compile_dsp_plan_op(p_controller, &p_plan->ops[n],
+                                    (dsp_class_t) i, p_module) )
+            {
+                n++;
+            }
+        }
+    }
+
+    /// Move to each position the first operation whose inputs are ready
+    for(i = 0; i < n; i++)
+    {
+        for(j = i; j < n; j++)
+        {
+            if(!dsp_plan_op_depends(p_plan->ops, j, i, n))
+            {
+                break;
+            }
+        }
+
+        if(j == n)
+        {
+            continue;
+        }
+
+        if(j > i)
+        {
+            op = p_plan->ops[j];
+            memmove(&p_plan->ops[i + 1], &p_plan->ops[i],
+                    (j - i) * sizeof(dsp_plan_op_t));
+            p_plan->ops[i] = op;
+        }
+    }
+
+    p_plan->num_ops = n;
+    return n;
+}
+
+/**
+ * Run DSP module through its own function.
+ */
+static void run_dsp_module(dsp_class_t dsp_class, volatile void *p_module)
+{
+    switch(dsp_class)
+    {
+        case DSP_Error:
+            run_dsp_error((dsp_error_t *) p_module);
+            break;
+        case DSP_SRLim:
+            run_dsp_srlim((dsp_srlim_t *) p_module,
+                          ((dsp_srlim_t *) p_module)->bypass);
+            break;
+        case DSP_LPF:
+            run_dsp_lpf((dsp_lpf_t *) p_module);
+            break;
+        case DSP_PI:
+            run_dsp_pi((dsp_pi_t *) p_module);
+            break;
+        case DSP_IIR_2P2Z:
+            run_dsp_iir_2p2z((dsp_iir_2p2z_t *) p_module);
+            break;
+        case DSP_IIR_3P3Z:
+            run_dsp_iir_3p3z((dsp_iir_3p3z_t *) p_module);
+            break;
+        case DSP_VdcLink_FeedForward:
+            run_dsp_vdclink_ff((dsp_vdclink_ff_t *) p_module);
+            break;
+        case DSP_Vect_Product:
+            run_dsp_vect_product((dsp_vect_product_t *) p_module);
+            break;
+        case DSP_IIR_SOS:
+            run_dsp_iir_sos((dsp_iir_sos_t *) p_module);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Run execution plan of DSP modules. Computations are the same of run_dsp_*
+ * functions, but signals are accessed by index and coefficients are read
+ * through the active bank referenced by plan.
+ *
+ * @param p_plan
+ */
+void run_dsp_plan(dsp_plan_t *p_plan)
+{
+    float *sig = p_plan->p_signals;
+    const dsp_plan_op_t *p_op = p_plan->ops;
+    const dsp_plan_op_t *p_end = p_op + p_plan->num_ops;
+    const float *c;
+    float in, w0, yacc, temp, dyn_max, dyn_min;
+    uint16_t bank;
+
+    for( ; p_op < p_end; p_op++)
+    {
+        switch(p_op->type)
+        {
+            case DSP_Plan_Error:
+            {
+                sig[p_op->out] = sig[p_op->in] - sig[p_op->aux];
+                break;
+            }
+
+            case DSP_Plan_LPF:
+            {
+                dsp_lpf_t *p_lpf = (dsp_lpf_t *) p_op->p_module;
+                bank = *(p_op->p_bank);
+
+                in = sig[p_op->in];
+                yacc = sig[p_op->out] * p_lpf->a[bank];
+                yacc += p_lpf->k[bank] * (p_lpf->in_old + in);
+                p_lpf->in_old = in;
+                sig[p_op->out] = yacc;
+                break;
+            }
+
+            case DSP_Plan_PI:
+            {
+                dsp_pi_t *p_pi = (dsp_pi_t *) p_op->p_module;
+                c = p_op->p_coeffs[*(p_op->p_bank)];
+
+                in = sig[p_op->in];
+
+                temp = in * c[0];
+                SATURATE(temp, c[2], c[3]);
+                p_pi->u_prop = temp;
+
+                dyn_max = (c[2] - temp);
+                dyn_min = (c[3] - temp);
+
+                yacc = temp;
+                temp = p_pi->u_int + in * c[1];
+                SATURATE(temp, dyn_max, dyn_min);
+                p_pi->u_int = temp;
+
+                sig[p_op->out] = temp + yacc;
+                break;
+            }
+
+            case DSP_Plan_IIR_2P2Z:
+            {
+                dsp_iir_2p2z_t *p_iir = (dsp_iir_2p2z_t *) p_op->p_module;
+                c = p_op->p_coeffs[*(p_op->p_bank)];
+
+                in = sig[p_op->in];
+
+                yacc = in * c[0];
+                yacc += p_iir->w1;
+
+                SATURATE(yacc, c[5], c[6]);
+
+                w0 = in * c[1];
+                w0 += p_iir->w2;
+                w0 -= yacc * c[3];
+                p_iir->w1 = w0;
+
+                w0 = in * c[2];
+                w0 -= yacc * c[4];
+                p_iir->w2 = w0;
+
+                sig[p_op->out] = yacc;
+                break;
+            }
+
+            case DSP_Plan_IIR_3P3Z:
+            {
+                dsp_iir_3p3z_t *p_iir = (dsp_iir_3p3z_t *) p_op->p_module;
+                c = p_op->p_coeffs[*(p_op->p_bank)];
+
+                in = sig[p_op->in];
+
+                yacc = in * c[0];
+                yacc += p_iir->w1;
+
+                SATURATE(yacc, c[7], c[8]);
+
+                w0 = in * c[1];
+                w0 += p_iir->w2;
+                w0 -= yacc * c[4];
+                p_iir->w1 = w0;
+
+                w0 = in * c[2];
+                w0 += p_iir->w3;
+                w0 -= yacc * c[5];
+                p_iir->w2 = w0;
+
+                w0 = in * c[3];
+                w0 -= yacc * c[6];
+                p_iir->w3 = w0;
+
+                sig[p_op->out] = yacc;
+                break;
+            }
+
+            case DSP_Plan_VdcLink_FF:
+            {
+                c = p_op->p_coeffs[*(p_op->p_bank)];
+                in = sig[p_op->aux];
+
+                if(in < c[1])
+                {
+                    sig[p_op->out] = sig[p_op->in];
+                }
+                else
+                {
+                    sig[p_op->out] = sig[p_op->in] * c[0] / in;
+                }
+                break;
+            }
+
+            default:
+            {
+                run_dsp_module(p_op->dsp_class, p_op->p_module);
+                break;
+            }
+        }
+    }
+}
@@ -39,9 +39,23 @@
 #define NUM_MAX_DSP_IIR_3P3Z        4
 #define NUM_MAX_DSP_VDCLINK_FF      2
 #define NUM_MAX_DSP_VECT_PRODUCT    2
+#define NUM_MAX_DSP_IIR_SOS         2
 
 #define NUM_MAX_TIMESLICERS         4
 
+#define NUM_MAX_DSP_PLAN_OPS        (NUM_MAX_DSP_ERROR + NUM_MAX_DSP_SRLIM +     \
+                                     NUM_MAX_DSP_LPF + NUM_MAX_DSP_PI +         \
+                                     NUM_MAX_DSP_IIR_2P2Z +                     \
+                                     NUM_MAX_DSP_IIR_3P3Z +                     \
+                                     NUM_MAX_DSP_VDCLINK_FF +                   \
+                                     NUM_MAX_DSP_VECT_PRODUCT +                 \
+                                     NUM_MAX_DSP_IIR_SOS)
+
+/**
+ * Signal index of module connections not on net or output signals
+ */
+#define DSP_PLAN_EXTERNAL_SIGNAL    0xFFFF
+
 /**
  * Collection of DSP modules used by Control Framework
  */
@@ -55,9 +69,23 @@ typedef volatile struct
     dsp_iir_3p3z_t      dsp_iir_3p3z[NUM_MAX_DSP_IIR_3P3Z];
     dsp_vdclink_ff_t    dsp_ff[NUM_MAX_DSP_VDCLINK_FF];
     dsp_vect_product_t  dsp_vect_product[NUM_MAX_DSP_VECT_PRODUCT];
+    dsp_iir_sos_t       dsp_iir_sos[NUM_MAX_DSP_IIR_SOS];
 } dsp_modules_t;
 
 
+/**
+ * When coefficients configured by set_dsp_coeffs() take effect. On
+ * DSP_Coeffs_Swap_Immediate, the default, they're swapped in right away, as
+ * if written directly on modules. Other modes require the control loop to
+ * call swap_dsp_coeffs() every cycle.
+ */
+typedef enum
+{
+    DSP_Coeffs_Swap_Immediate,
+    DSP_Coeffs_Swap_Next_Cycle,
+    DSP_Coeffs_Swap_Sync_Pulse
+} dsp_coeffs_swap_mode_t;
+
 /**
  * Control Framework entity. This struct groups information regarding a
  * particular Control Framework implementation, including:
@@ -65,6 +93,7 @@ typedef volatile struct
  *      - Set of net signals for internal DSP modules interconnection
  *      - Set of output signals for duty cycles, for example.
  *      - Set of DSP modules
+ *      - Swap mode and pending flag of DSP modules coefficients
  */
 typedef volatile struct
 {
@@ -84,9 +113,53 @@ typedef volatile struct
 
     dsp_modules_t   dsp_modules;
     timeslicer_t    timeslicer[NUM_MAX_TIMESLICERS];
+    uint16_t        dsp_coeffs_swap_mode;   // dsp_coeffs_swap_mode_t
+    uint16_t        dsp_coeffs_pending;
 } control_framework_t;
 
 
+/**
+ * Execution plan of DSP modules. It's compiled once from the wired modules of
+ * a Control Framework, resolving connections to indexes of its signals, so
+ * modules run without pointer chasing. Coefficients aren't copied: each
+ * operation references both coefficients banks of its module and its active
+ * bank index, so swaps take effect on plan as on modules, without compiling it
+ * again. Modules connected to external signals, or without a compiled kernel,
+ * are run through their own run_dsp_* function. States are kept on modules,
+ * so reset_dsp_* functions still apply.
+ *
+ * Plan must only be compiled again when modules are wired differently.
+ */
+typedef enum
+{
+    DSP_Plan_Run_Module,
+    DSP_Plan_Error,
+    DSP_Plan_LPF,
+    DSP_Plan_PI,
+    DSP_Plan_IIR_2P2Z,
+    DSP_Plan_IIR_3P3Z,
+    DSP_Plan_VdcLink_FF
+} dsp_plan_op_type_t;
+
+typedef struct
+{
+    dsp_plan_op_type_t  type;
+    dsp_class_t         dsp_class;
+    uint16_t            in;
+    uint16_t            aux;        // Error negative input, FF DC-link input
+    uint16_t            out;
+    const float         *p_coeffs[NUM_DSP_COEFFS_BANKS];
+    volatile uint16_t   *p_bank;    // Active bank of module
+    volatile void       *p_module;
+} dsp_plan_op_t;
+
+typedef struct
+{
+    float           *p_signals;     // Net signals followed by output signals
+    uint16_t        num_ops;
+    dsp_plan_op_t   ops[NUM_MAX_DSP_PLAN_OPS];
+} dsp_plan_t;
+
 extern volatile control_framework_t g_controller_ctom;
 extern volatile control_framework_t g_controller_mtoc;
 
@@ -97,5 +170,13 @@ extern uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
                               float *p_coeffs);
 extern float get_dsp_coeff(volatile control_framework_t *p_controller,
                            dsp_class_t dsp_class, uint16_t id, uint16_t coeff);
+extern uint16_t swap_dsp_coeffs(volatile control_framework_t *p_controller,
+                                uint16_t sync_pulse);
+
+extern uint16_t compile_dsp_plan(volatile control_framework_t *p_controller,
+                                 dsp_plan_t *p_plan,
+                                 const dsp_module_t *p_modules,
+                                 uint16_t num_modules);
+extern void run_dsp_plan(dsp_plan_t *p_plan);
 
 #endif /* CONTROL_H_ */
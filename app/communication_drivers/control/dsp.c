@@ -38,6 +38,71 @@
 #pragma CODE_SECTION(run_dsp_iir_3p3z, "ramfuncs");
 #pragma CODE_SECTION(run_dsp_vdclink_ff, "ramfuncs");
 #pragma CODE_SECTION(run_dsp_vect_product, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_iir_sos, "ramfuncs");
+#pragma CODE_SECTION(swap_dsp_coeffs_bank, "ramfuncs");
+
+/**
+ * Reset bank of coefficients, so bank 0 is active and nothing is pending.
+ * Shared RAM isn't cleared on target, so every init_dsp_* function must call
+ * it before configuring the module.
+ *
+ * @param p_bank
+ */
+void init_dsp_coeffs_bank(dsp_coeffs_bank_t *p_bank)
+{
+    p_bank->active = 0;
+    p_bank->pending = 0;
+    p_bank->updating = 0;
+}
+
+/**
+ * Start writing on shadow bank of coefficients. Bank isn't swapped until
+ * update is finished with end_dsp_coeffs_update().
+ *
+ * @param p_bank
+ * @return index of shadow bank
+ */
+uint16_t begin_dsp_coeffs_update(dsp_coeffs_bank_t *p_bank)
+{
+    p_bank->updating = 1;
+    return p_bank->active ^ 1;
+}
+
+/**
+ * Finish writing on shadow bank of coefficients, which is then pending for
+ * swap.
+ *
+ * @param p_bank
+ */
+void end_dsp_coeffs_update(dsp_coeffs_bank_t *p_bank)
+{
+    p_bank->pending = 1;
+    p_bank->updating = 0;
+}
+
+/**
+ * Swap active and shadow banks of coefficients, if shadow bank is pending and
+ * not being written. It must be called between executions of module, usually
+ * at the beginning of control loop.
+ *
+ * @param p_bank
+ * @return 1 if swap is still pending, 0 otherwise
+ */
+uint16_t swap_dsp_coeffs_bank(dsp_coeffs_bank_t *p_bank)
+{
+    if(p_bank->pending)
+    {
+        if(p_bank->updating)
+        {
+            return 1;
+        }
+
+        p_bank->active ^= 1;
+        p_bank->pending = 0;
+    }
+
+    return 0;
+}
 
 /**
  * Initialization of error signal entity.
@@ -91,6 +156,7 @@ void run_dsp_error(dsp_error_t *p_error)
 void init_dsp_srlim(dsp_srlim_t *p_srlim, float max_slewrate, float freq_sampling,
                     volatile float *in, volatile float *out)
 {
+    init_dsp_coeffs_bank(&p_srlim->bank);
     p_srlim->bypass = USE_MODULE;
     p_srlim->freq_sampling = freq_sampling;
     p_srlim->in = in;
@@ -98,12 +164,17 @@ void init_dsp_srlim(dsp_srlim_t *p_srlim, float max_slewrate, float freq_samplin
     *(p_srlim->out) = 0.0;
 
     cfg_dsp_srlim(p_srlim, max_slewrate);
+    swap_dsp_coeffs_bank(&p_srlim->bank);
 }
 
 void cfg_dsp_srlim(dsp_srlim_t *p_srlim, float max_slewrate)
 {
-    p_srlim->coeffs.s.max_slewrate = max_slewrate;
-    p_srlim->delta_max = max_slewrate / p_srlim->freq_sampling;
+    uint16_t bank = begin_dsp_coeffs_update(&p_srlim->bank);
+
+    p_srlim->coeffs[bank].s.max_slewrate = max_slewrate;
+    p_srlim->delta_max[bank] = max_slewrate / p_srlim->freq_sampling;
+
+    end_dsp_coeffs_update(&p_srlim->bank);
 }
 
 /**
@@ -135,7 +206,7 @@ void reset_dsp_srlim(dsp_srlim_t *p_srlim)
  */
 void run_dsp_srlim(dsp_srlim_t *p_srlim, uint16_t bypass)
 {
-    float delta;
+    float delta, delta_max;
 
     if(bypass)
     {
@@ -143,8 +214,9 @@ void run_dsp_srlim(dsp_srlim_t *p_srlim, uint16_t bypass)
     }
     else
     {
+        delta_max = p_srlim->delta_max[p_srlim->bank.active];
         delta = *(p_srlim->in) - *(p_srlim->out);
-        SATURATE(delta, p_srlim->delta_max, -p_srlim->delta_max);
+        SATURATE(delta, delta_max, -delta_max);
         *(p_srlim->out) = *(p_srlim->out) + delta;
     }
 }
@@ -164,6 +236,7 @@ void run_dsp_srlim(dsp_srlim_t *p_srlim, uint16_t bypass)
 void init_dsp_lpf(dsp_lpf_t *p_lpf, float freq_cut, float freq_sampling,
                   volatile float *in, volatile float *out)
 {
+    init_dsp_coeffs_bank(&p_lpf->bank);
     p_lpf->freq_sampling = freq_sampling;
     p_lpf->in_old = 0.0;
     p_lpf->in = in;
@@ -171,19 +244,25 @@ void init_dsp_lpf(dsp_lpf_t *p_lpf, float freq_cut, float freq_sampling,
     *(p_lpf->out) = 0.0;
 
     cfg_dsp_lpf(p_lpf, freq_cut);
+    swap_dsp_coeffs_bank(&p_lpf->bank);
 }
 
 void cfg_dsp_lpf(dsp_lpf_t *p_lpf, float freq_cut)
 {
     float wt, k, a;
+    uint16_t bank;
 
     wt = (2.0 * 3.141592653589793 * freq_cut) / p_lpf->freq_sampling;
     k = wt / (2.0 + wt);
     a = (2 - wt)/(2 + wt);
 
-    p_lpf->coeffs.s.freq_cut = freq_cut;
-    p_lpf->k = k;
-    p_lpf->a = a;
+    bank = begin_dsp_coeffs_update(&p_lpf->bank);
+
+    p_lpf->coeffs[bank].s.freq_cut = freq_cut;
+    p_lpf->k[bank] = k;
+    p_lpf->a[bank] = a;
+
+    end_dsp_coeffs_update(&p_lpf->bank);
 }
 
 
@@ -206,9 +285,10 @@ void reset_dsp_lpf(dsp_lpf_t *p_lpf)
 void run_dsp_lpf(dsp_lpf_t *p_lpf)
 {
     float yacc;
+    uint16_t bank = p_lpf->bank.active;
 
-    yacc = *(p_lpf->out) * p_lpf->a;
-    yacc += p_lpf->k * (p_lpf->in_old + *(p_lpf->in));
+    yacc = *(p_lpf->out) * p_lpf->a[bank];
+    yacc += p_lpf->k[bank] * (p_lpf->in_old + *(p_lpf->in));
     p_lpf->in_old = *(p_lpf->in);
     *(p_lpf->out) = yacc;
 }
@@ -231,6 +311,7 @@ void init_dsp_pi(dsp_pi_t *p_pi, float kp, float ki, float freq_sampling,
                  float u_max, float u_min, volatile float *in,
                  volatile float *out)
 {
+    init_dsp_coeffs_bank(&p_pi->bank);
     p_pi->freq_sampling = freq_sampling;
     p_pi->u_prop = 0.0;
     p_pi->u_int = 0.0;
@@ -239,14 +320,19 @@ void init_dsp_pi(dsp_pi_t *p_pi, float kp, float ki, float freq_sampling,
     *(p_pi->out) = 0.0;
 
     cfg_dsp_pi(p_pi, kp, ki, u_max, u_min);
+    swap_dsp_coeffs_bank(&p_pi->bank);
 }
 
 void cfg_dsp_pi(dsp_pi_t *p_pi, float kp, float ki, float u_max, float u_min)
 {
-    p_pi->coeffs.s.kp = kp;
-    p_pi->coeffs.s.ki = ki;
-    p_pi->coeffs.s.u_max = u_max;
-    p_pi->coeffs.s.u_min = u_min;
+    uint16_t bank = begin_dsp_coeffs_update(&p_pi->bank);
+
+    p_pi->coeffs[bank].s.kp = kp;
+    p_pi->coeffs[bank].s.ki = ki;
+    p_pi->coeffs[bank].s.u_max = u_max;
+    p_pi->coeffs[bank].s.u_min = u_min;
+
+    end_dsp_coeffs_update(&p_pi->bank);
 }
 
 /**
@@ -271,15 +357,16 @@ void run_dsp_pi(dsp_pi_t *p_pi)
     float dyn_max;
     float dyn_min;
     float temp;
+    uint16_t bank = p_pi->bank.active;
 
-    temp = *(p_pi->in) * p_pi->coeffs.s.kp;
-    SATURATE(temp, p_pi->coeffs.s.u_max, p_pi->coeffs.s.u_min);
+    temp = *(p_pi->in) * p_pi->coeffs[bank].s.kp;
+    SATURATE(temp, p_pi->coeffs[bank].s.u_max, p_pi->coeffs[bank].s.u_min);
     p_pi->u_prop = temp;
 
-    dyn_max = (p_pi->coeffs.s.u_max - temp);
-    dyn_min = (p_pi->coeffs.s.u_min - temp);
+    dyn_max = (p_pi->coeffs[bank].s.u_max - temp);
+    dyn_min = (p_pi->coeffs[bank].s.u_min - temp);
 
-    temp = p_pi->u_int + *(p_pi->in) * p_pi->coeffs.s.ki;
+    temp = p_pi->u_int + *(p_pi->in) * p_pi->coeffs[bank].s.ki;
     SATURATE(temp, dyn_max, dyn_min);
     p_pi->u_int = temp;
 
@@ -305,6 +392,7 @@ void init_dsp_iir_2p2z(dsp_iir_2p2z_t *p_iir, float b0, float b1, float b2,
                        float a1, float a2, float u_max, float u_min,
                        volatile float *in, volatile float *out)
 {
+    init_dsp_coeffs_bank(&p_iir->bank);
     p_iir->w1 = 0.0;
     p_iir->w2 = 0.0;
     p_iir->in = in;
@@ -312,18 +400,23 @@ void init_dsp_iir_2p2z(dsp_iir_2p2z_t *p_iir, float b0, float b1, float b2,
     *(p_iir->out) = 0.0;
 
     cfg_dsp_iir_2p2z(p_iir, b0, b1, b2, a1, a2, u_max, u_min);
+    swap_dsp_coeffs_bank(&p_iir->bank);
 }
 
 void cfg_dsp_iir_2p2z(dsp_iir_2p2z_t *p_iir, float b0, float b1, float b2,
                       float a1, float a2, float u_max, float u_min)
 {
-    p_iir->coeffs.s.b0 = b0;
-    p_iir->coeffs.s.b1 = b1;
-    p_iir->coeffs.s.b2 = b2;
-    p_iir->coeffs.s.a1 = a1;
-    p_iir->coeffs.s.a2 = a2;
-    p_iir->coeffs.s.u_max = u_max;
-    p_iir->coeffs.s.u_min = u_min;
+    uint16_t bank = begin_dsp_coeffs_update(&p_iir->bank);
+
+    p_iir->coeffs[bank].s.b0 = b0;
+    p_iir->coeffs[bank].s.b1 = b1;
+    p_iir->coeffs[bank].s.b2 = b2;
+    p_iir->coeffs[bank].s.a1 = a1;
+    p_iir->coeffs[bank].s.a2 = a2;
+    p_iir->coeffs[bank].s.u_max = u_max;
+    p_iir->coeffs[bank].s.u_min = u_min;
+
+    end_dsp_coeffs_update(&p_iir->bank);
 }
 
 /**
@@ -346,21 +439,14 @@ void init_dsp_notch_2p2z(dsp_iir_2p2z_t *p_iir, float alpha, float freq_cut,
                          volatile float *in, volatile float *out)
 {
     float beta = cos(2.0 * 3.141592653589793 * (freq_cut/freq_sampling));
+    float b0, b1;
 
     SATURATE(alpha, 0.99999, 0.0);
 
-    p_iir->coeffs.s.b0 = (1.0 + alpha)/2.0;
-    p_iir->coeffs.s.b1 = -beta*(1.0 + alpha);
-    p_iir->coeffs.s.b2 = p_iir->coeffs.s.b0;
-    p_iir->coeffs.s.a1 = p_iir->coeffs.s.b1;
-    p_iir->coeffs.s.a2 = alpha;
-    p_iir->coeffs.s.u_max = u_max;
-    p_iir->coeffs.s.u_min = u_min;
-    p_iir->w1 = 0.0;
-    p_iir->w2 = 0.0;
-    p_iir->in = in;
-    p_iir->out = out;
-    *(p_iir->out) = 0.0;
+    b0 = (1.0 + alpha)/2.0;
+    b1 = -beta*(1.0 + alpha);
+
+    init_dsp_iir_2p2z(p_iir, b0, b1, b0, b1, alpha, u_max, u_min, in, out);
 }
 
 /**
@@ -383,19 +469,20 @@ void reset_dsp_iir_2p2z(dsp_iir_2p2z_t *p_iir)
 void run_dsp_iir_2p2z(dsp_iir_2p2z_t *p_iir)
 {
     float w0, yacc;
+    uint16_t bank = p_iir->bank.active;
 
-    yacc = *(p_iir->in) * p_iir->coeffs.s.b0;
+    yacc = *(p_iir->in) * p_iir->coeffs[bank].s.b0;
     yacc += p_iir->w1;
 
-    SATURATE(yacc, p_iir->coeffs.s.u_max, p_iir->coeffs.s.u_min);
+    SATURATE(yacc, p_iir->coeffs[bank].s.u_max, p_iir->coeffs[bank].s.u_min);
 
-    w0 = *(p_iir->in) * p_iir->coeffs.s.b1;
+    w0 = *(p_iir->in) * p_iir->coeffs[bank].s.b1;
     w0 += p_iir->w2;
-    w0 -= yacc * p_iir->coeffs.s.a1;
+    w0 -= yacc * p_iir->coeffs[bank].s.a1;
     p_iir->w1 = w0;
 
-    w0 = *(p_iir->in) * p_iir->coeffs.s.b2;
-    w0 -= yacc * p_iir->coeffs.s.a2;
+    w0 = *(p_iir->in) * p_iir->coeffs[bank].s.b2;
+    w0 -= yacc * p_iir->coeffs[bank].s.a2;
     p_iir->w2 = w0;
 
     *(p_iir->out) = yacc;
@@ -422,6 +509,7 @@ void init_dsp_iir_3p3z(dsp_iir_3p3z_t *p_iir, float b0, float b1, float b2,
                        float b3, float a1, float a2, float a3, float u_max,
                        float u_min, volatile float *in, volatile float *out)
 {
+    init_dsp_coeffs_bank(&p_iir->bank);
     p_iir->w1 = 0.0;
     p_iir->w2 = 0.0;
     p_iir->w3 = 0.0;
@@ -430,21 +518,26 @@ void init_dsp_iir_3p3z(dsp_iir_3p3z_t *p_iir, float b0, float b1, float b2,
     *(p_iir->out) = 0.0;
 
     cfg_dsp_iir_3p3z(p_iir, b0, b1, b2, b3, a1, a2, a3, u_max, u_min);
+    swap_dsp_coeffs_bank(&p_iir->bank);
 }
 
 void cfg_dsp_iir_3p3z(dsp_iir_3p3z_t *p_iir, float b0, float b1, float b2,
                       float b3, float a1, float a2, float a3, float u_max,
                       float u_min)
 {
-    p_iir->coeffs.s.b0 = b0;
-    p_iir->coeffs.s.b1 = b1;
-    p_iir->coeffs.s.b2 = b2;
-    p_iir->coeffs.s.b3 = b3;
-    p_iir->coeffs.s.a1 = a1;
-    p_iir->coeffs.s.a2 = a2;
-    p_iir->coeffs.s.a3 = a3;
-    p_iir->coeffs.s.u_max = u_max;
-    p_iir->coeffs.s.u_min = u_min;
+    uint16_t bank = begin_dsp_coeffs_update(&p_iir->bank);
+
+    p_iir->coeffs[bank].s.b0 = b0;
+    p_iir->coeffs[bank].s.b1 = b1;
+    p_iir->coeffs[bank].s.b2 = b2;
+    p_iir->coeffs[bank].s.b3 = b3;
+    p_iir->coeffs[bank].s.a1 = a1;
+    p_iir->coeffs[bank].s.a2 = a2;
+    p_iir->coeffs[bank].s.a3 = a3;
+    p_iir->coeffs[bank].s.u_max = u_max;
+    p_iir->coeffs[bank].s.u_min = u_min;
+
+    end_dsp_coeffs_update(&p_iir->bank);
 }
 
 /**
@@ -468,24 +561,25 @@ void reset_dsp_iir_3p3z(dsp_iir_3p3z_t *p_iir)
 void run_dsp_iir_3p3z(dsp_iir_3p3z_t *p_iir)
 {
     float w0, yacc;
+    uint16_t bank = p_iir->bank.active;
 
-    yacc = *(p_iir->in) * p_iir->coeffs.s.b0;
+    yacc = *(p_iir->in) * p_iir->coeffs[bank].s.b0;
     yacc += p_iir->w1;
 
-    SATURATE(yacc, p_iir->coeffs.s.u_max, p_iir->coeffs.s.u_min);
+    SATURATE(yacc, p_iir->coeffs[bank].s.u_max, p_iir->coeffs[bank].s.u_min);
 
-    w0 = *(p_iir->in) * p_iir->coeffs.s.b1;
+    w0 = *(p_iir->in) * p_iir->coeffs[bank].s.b1;
     w0 += p_iir->w2;
-    w0 -= yacc * p_iir->coeffs.s.a1;
+    w0 -= yacc * p_iir->coeffs[bank].s.a1;
     p_iir->w1 = w0;
 
-    w0 = *(p_iir->in) * p_iir->coeffs.s.b2;
+    w0 = *(p_iir->in) * p_iir->coeffs[bank].s.b2;
     w0 += p_iir->w3;
-    w0 -= yacc * p_iir->coeffs.s.a2;
+    w0 -= yacc * p_iir->coeffs[bank].s.a2;
     p_iir->w2 = w0;
 
-    w0 = *(p_iir->in) * p_iir->coeffs.s.b3;
-    w0 -= yacc * p_iir->coeffs.s.a3;
+    w0 = *(p_iir->in) * p_iir->coeffs[bank].s.b3;
+    w0 -= yacc * p_iir->coeffs[bank].s.a3;
     p_iir->w3 = w0;
 
     *(p_iir->out) = yacc;
@@ -504,17 +598,23 @@ void init_dsp_vdclink_ff(dsp_vdclink_ff_t *p_ff, float vdc_nom, float vdc_min,
                          volatile float *vdc_meas, volatile float *in,
                          volatile float *out)
 {
+    init_dsp_coeffs_bank(&p_ff->bank);
     p_ff->vdc_meas = vdc_meas;
     p_ff->in = in;
     p_ff->out = out;
 
     cfg_dsp_vdclink_ff(p_ff, vdc_nom, vdc_min);
+    swap_dsp_coeffs_bank(&p_ff->bank);
 }
 
 void cfg_dsp_vdclink_ff(dsp_vdclink_ff_t *p_ff, float vdc_nom, float vdc_min)
 {
-    p_ff->coeffs.s.vdc_nom = vdc_nom;
-    p_ff->coeffs.s.vdc_min = vdc_min;
+    uint16_t bank = begin_dsp_coeffs_update(&p_ff->bank);
+
+    p_ff->coeffs[bank].s.vdc_nom = vdc_nom;
+    p_ff->coeffs[bank].s.vdc_min = vdc_min;
+
+    end_dsp_coeffs_update(&p_ff->bank);
 }
 
 /**
@@ -532,13 +632,16 @@ void reset_dsp_vdclink_ff(dsp_vdclink_ff_t *p_ff)
  */
 void run_dsp_vdclink_ff(dsp_vdclink_ff_t *p_ff)
 {
-    if( *(p_ff->vdc_meas) < p_ff->coeffs.s.vdc_min )
+    uint16_t bank = p_ff->bank.active;
+
+    if( *(p_ff->vdc_meas) < p_ff->coeffs[bank].s.vdc_min )
     {
         *(p_ff->out) = *(p_ff->in);
     }
     else
     {
-        *(p_ff->out) = *(p_ff->in) * p_ff->coeffs.s.vdc_nom / *(p_ff->vdc_meas);
+        *(p_ff->out) = *(p_ff->in) * p_ff->coeffs[bank].s.vdc_nom /
+                       *(p_ff->vdc_meas);
     }
 }
 
@@ -607,3 +710,163 @@ void run_dsp_vect_product(dsp_vect_product_t *p_vect_product)
         }
     }
 }
+
+/**
+ * Initialization of cascade of 2nd-order digital IIR filters (second-order
+ * sections). Each section is implemented with Transposed Direct-Form II, as
+ * dsp_iir_2p2z_t, and is initialized as an unitary gain, so coefficients may
+ * be configured section by section.
+ *
+ * @param p_sos
+ * @param num_sections
+ * @param u_max
+ * @param u_min
+ * @param in
+ * @param out
+ */
+void init_dsp_iir_sos(dsp_iir_sos_t *p_sos, uint16_t num_sections, float u_max,
+                      float u_min, volatile float *in, volatile float *out)
+{
+    uint16_t i;
+
+    init_dsp_coeffs_bank(&p_sos->bank);
+
+    if(num_sections > NUM_MAX_IIR_SOS_SECTIONS)
+    {
+        num_sections = NUM_MAX_IIR_SOS_SECTIONS;
+    }
+
+    p_sos->num_sections = num_sections;
+    p_sos->in = in;
+    p_sos->out = out;
+
+    for(i = 0; i < NUM_MAX_IIR_SOS_SECTIONS; i++)
+    {
+        cfg_dsp_iir_sos(p_sos, i, 1.0, 0.0, 0.0, 0.0, 0.0, u_max, u_min);
+    }
+
+    swap_dsp_coeffs_bank(&p_sos->bank);
+    reset_dsp_iir_sos(p_sos);
+}
+
+/**
+ * Configure one section of cascade. Saturation limits are applied to the
+ * output of the whole cascade, so they're the same for all sections. Sections
+ * not configured keep their coefficients after swap.
+ *
+ * @param p_sos
+ * @param section
+ * @param b0
+ * @param b1
+ * @param b2
+ * @param a1
+ * @param a2
+ * @param u_max
+ * @param u_min
+ */
+void cfg_dsp_iir_sos(dsp_iir_sos_t *p_sos, uint16_t section, float b0,
+                     float b1, float b2, float a1, float a2, float u_max,
+                     float u_min)
+{
+    uint16_t bank = begin_dsp_coeffs_update(&p_sos->bank);
+
+    /// First update since last swap: shadow bank must start as active one
+    if(!p_sos->bank.pending)
+    {
+        p_sos->coeffs[bank] = p_sos->coeffs[bank ^ 1];
+    }
+
+    p_sos->coeffs[bank].b0[section] = b0;
+    p_sos->coeffs[bank].b1[section] = b1;
+    p_sos->coeffs[bank].b2[section] = b2;
+    p_sos->coeffs[bank].a1[section] = a1;
+    p_sos->coeffs[bank].a2[section] = a2;
+    p_sos->coeffs[bank].u_max = u_max;
+    p_sos->coeffs[bank].u_min = u_min;
+
+    end_dsp_coeffs_update(&p_sos->bank);
+}
+
+/**
+ * Get latest coefficient of one section of cascade, ordered as in
+ * cfg_dsp_iir_sos().
+ *
+ * @param p_sos
+ * @param section
+ * @param coeff
+ * @return coefficient value, or NAN if coeff is invalid
+ */
+float get_dsp_iir_sos_coeff(dsp_iir_sos_t *p_sos, uint16_t section,
+                            uint16_t coeff)
+{
+    switch(coeff)
+    {
+        case 0:     return DSP_LATEST_COEFFS(*p_sos).b0[section];
+        case 1:     return DSP_LATEST_COEFFS(*p_sos).b1[section];
+        case 2:     return DSP_LATEST_COEFFS(*p_sos).b2[section];
+        case 3:     return DSP_LATEST_COEFFS(*p_sos).a1[section];
+        case 4:     return DSP_LATEST_COEFFS(*p_sos).a2[section];
+        case 5:     return DSP_LATEST_COEFFS(*p_sos).u_max;
+        case 6:     return DSP_LATEST_COEFFS(*p_sos).u_min;
+        default:    return NAN;
+    }
+}
+
+/**
+ * Reset cascade of 2nd-order digital IIR filters.
+ *
+ * @param p_sos
+ */
+void reset_dsp_iir_sos(dsp_iir_sos_t *p_sos)
+{
+    uint16_t i;
+
+    for(i = 0; i < NUM_MAX_IIR_SOS_SECTIONS; i++)
+    {
+        p_sos->w1[i] = 0.0;
+        p_sos->w2[i] = 0.0;
+    }
+
+    *(p_sos->out) = 0.0;
+}
+
+/**
+ * Run cascade of 2nd-order digital IIR filters. Output of each section is the
+ * input of the next one, without saturation between them. Only the output of
+ * the cascade is limited, after all states are updated, so saturation doesn't
+ * act as anti-windup on any section as it does on a 2P2Z module. Cascade is
+ * bit-exact to a chain of 2P2Z modules with unbounded limits, whose output is
+ * then limited, as checked by the host simulator. Sections must keep their
+ * intermediate signals bounded by design.
+ *
+ * @param p_sos
+ */
+void run_dsp_iir_sos(dsp_iir_sos_t *p_sos)
+{
+    uint16_t i;
+    uint16_t bank = p_sos->bank.active;
+    float x, w0, yacc;
+
+    x = *(p_sos->in);
+
+    for(i = 0; i < p_sos->num_sections; i++)
+    {
+        yacc = x * p_sos->coeffs[bank].b0[i];
+        yacc += p_sos->w1[i];
+
+        w0 = x * p_sos->coeffs[bank].b1[i];
+        w0 += p_sos->w2[i];
+        w0 -= yacc * p_sos->coeffs[bank].a1[i];
+        p_sos->w1[i] = w0;
+
+        w0 = x * p_sos->coeffs[bank].b2[i];
+        w0 -= yacc * p_sos->coeffs[bank].a2[i];
+        p_sos->w2[i] = w0;
+
+        x = yacc;
+    }
+
+    SATURATE(x, p_sos->coeffs[bank].u_max, p_sos->coeffs[bank].u_min);
+
+    *(p_sos->out) = x;
+}
@@ -40,7 +40,7 @@
 #define NUM_MAX_MATRIX_SIZE     12
 #define NUM_MAX_COEFFS_DSP      NUM_MAX_MATRIX_SIZE
 
-#define NUM_DSP_CLASSES         8
+#define NUM_DSP_CLASSES         9
 
 #define NUM_COEFFS_DSP_SRLIM        1
 #define NUM_COEFFS_DSP_LPF          1
@@ -49,6 +49,18 @@
 #define NUM_COEFFS_DSP_IIR_3P3Z     16
 #define NUM_COEFFS_DSP_VDCLINK_FF   2
 #define NUM_COEFFS_DSP_MATRIX       (2 + NUM_MAX_MATRIX_SIZE*NUM_MAX_MATRIX_SIZE)
+#define NUM_COEFFS_DSP_IIR_SOS      7
+
+#define NUM_MAX_IIR_SOS_SECTIONS    4
+
+#define NUM_DSP_COEFFS_BANKS        2
+
+/**
+ * Coefficients bank with latest values of a DSP module: shadow bank while a
+ * swap is pending, active bank otherwise.
+ */
+#define DSP_LATEST_COEFFS(module)   ((module).coeffs[(module).bank.active ^     \
+                                                     (module).bank.pending])
 
 typedef enum
 {
@@ -59,7 +71,8 @@ typedef enum
     DSP_IIR_2P2Z,
     DSP_IIR_3P3Z,
     DSP_VdcLink_FeedForward,
-    DSP_Vect_Product
+    DSP_Vect_Product,
+    DSP_IIR_SOS
 } dsp_class_t;
 
 typedef volatile struct
@@ -68,6 +81,19 @@ typedef volatile struct
     uint16_t    id;
 } dsp_module_t;
 
+/**
+ * Double-buffered coefficients of a DSP module. run_dsp_* functions only read
+ * the active bank, while cfg_dsp_* functions write on the shadow bank and mark
+ * it as pending. New coefficients take effect all at once when the bank index
+ * is flipped by swap_dsp_coeffs_bank(), which skips banks being written.
+ */
+typedef volatile struct
+{
+    uint16_t    active;
+    uint16_t    pending;
+    uint16_t    updating;
+} dsp_coeffs_bank_t;
+
 typedef volatile struct
 {
     volatile float *pos;
@@ -84,11 +110,12 @@ typedef volatile struct
         {
             float max_slewrate;
         } s;
-    } coeffs;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
 
+    dsp_coeffs_bank_t bank;
     uint16_t bypass;
     float freq_sampling;
-    float delta_max;
+    float delta_max[NUM_DSP_COEFFS_BANKS];
     volatile float *in;
     volatile float *out;
 } dsp_srlim_t;
@@ -102,11 +129,12 @@ typedef volatile struct
         {
             float freq_cut;
         } s;
-    } coeffs;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
 
+    dsp_coeffs_bank_t bank;
     float freq_sampling;
-    float k;
-    float a;
+    float k[NUM_DSP_COEFFS_BANKS];
+    float a[NUM_DSP_COEFFS_BANKS];
     float in_old;
     volatile float *in;
     volatile float *out;
@@ -124,8 +152,9 @@ typedef volatile struct
             float u_max;
             float u_min;
         } s;
-    } coeffs;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
 
+    dsp_coeffs_bank_t bank;
     float freq_sampling;
     float u_prop;
     float u_int;
@@ -148,8 +177,9 @@ typedef volatile struct
             float u_max;
             float u_min;
         } s;
-    } coeffs;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
 
+    dsp_coeffs_bank_t bank;
     float w1;
     float w2;
     volatile float *in;
@@ -173,8 +203,9 @@ typedef volatile struct
             float u_max;
             float u_min;
         } s;
-    } coeffs;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
 
+    dsp_coeffs_bank_t bank;
     float w1;
     float w2;
     float w3;
@@ -192,8 +223,9 @@ typedef volatile struct
             float vdc_nom;
             float vdc_min;
         } s;
-    } coeffs;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
 
+    dsp_coeffs_bank_t bank;
     volatile float *vdc_meas;
     volatile float *in;
     volatile float *out;
@@ -220,6 +252,39 @@ typedef volatile struct
     volatile float  *out;
 } dsp_vect_product_t;
 
+/**
+ * Cascade of 2nd-order sections. Coefficients and states of all sections are
+ * stored on contiguous arrays, and saturation is applied only to the output of
+ * the whole cascade. All sections share one coefficients bank, so they're
+ * swapped together.
+ */
+typedef volatile struct
+{
+    struct
+    {
+        float b0[NUM_MAX_IIR_SOS_SECTIONS];
+        float b1[NUM_MAX_IIR_SOS_SECTIONS];
+        float b2[NUM_MAX_IIR_SOS_SECTIONS];
+        float a1[NUM_MAX_IIR_SOS_SECTIONS];
+        float a2[NUM_MAX_IIR_SOS_SECTIONS];
+        float u_max;
+        float u_min;
+    } coeffs[NUM_DSP_COEFFS_BANKS];
+
+    dsp_coeffs_bank_t bank;
+    uint16_t num_sections;
+    float w1[NUM_MAX_IIR_SOS_SECTIONS];
+    float w2[NUM_MAX_IIR_SOS_SECTIONS];
+    volatile float *in;
+    volatile float *out;
+} dsp_iir_sos_t;
+
+
+extern void init_dsp_coeffs_bank(dsp_coeffs_bank_t *p_bank);
+extern uint16_t begin_dsp_coeffs_update(dsp_coeffs_bank_t *p_bank);
+extern void end_dsp_coeffs_update(dsp_coeffs_bank_t *p_bank);
+extern uint16_t swap_dsp_coeffs_bank(dsp_coeffs_bank_t *p_bank);
+
 
 extern void init_dsp_error(dsp_error_t *p_error, volatile float *pos,
                              volatile float *neg, volatile float *error);
@@ -293,4 +358,16 @@ extern void init_dsp_vect_product(dsp_vect_product_t *p_vect_product,
 extern void reset_dsp_vect_product(dsp_vect_product_t *p_vect_product);
 extern void run_dsp_vect_product(dsp_vect_product_t *p_vect_product);
 
+
+extern void init_dsp_iir_sos(dsp_iir_sos_t *p_sos, uint16_t num_sections,
+                             float u_max, float u_min, volatile float *in,
+                             volatile float *out);
+extern void cfg_dsp_iir_sos(dsp_iir_sos_t *p_sos, uint16_t section, float b0,
+                            float b1, float b2, float a1, float a2, float u_max,
+                            float u_min);
+extern float get_dsp_iir_sos_coeff(dsp_iir_sos_t *p_sos, uint16_t section,
+                                   uint16_t coeff);
+extern void reset_dsp_iir_sos(dsp_iir_sos_t *p_sos);
+extern void run_dsp_iir_sos(dsp_iir_sos_t *p_sos);
+
 #endif /* DSP_H_ */
@@ -0,0 +1,935 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file dsp_q.c
+ * @brief Fixed-point Digital Signal Processing Module
+ *
+ * Q31 and Q15 versions of error, slew-rate limiter, low-pass filter, PI
+ * controller and 2nd-order IIR filter from DSP module, for cores without FPU.
+ * Float operations are only used on initialization and configuration, to
+ * convert coefficients.
+ *
+ * @author agent
+ * @date 16/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include "dsp.h"
+#include "dsp_q.h"
+
+#pragma CODE_SECTION(run_dsp_error_q31, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_srlim_q31, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_lpf_q31, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_pi_q31, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_iir_2p2z_q31, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_error_q15, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_srlim_q15, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_lpf_q15, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_pi_q15, "ramfuncs");
+#pragma CODE_SECTION(run_dsp_iir_2p2z_q15, "ramfuncs");
+
+#define Q31_ONE             2147483648.0f
+#define Q15_ONE             32768.0f
+
+static q31_t sat_q31(int64_t x)
+{
+    if(x > Q31_MAX)
+    {
+        return Q31_MAX;
+    }
+    if(x < Q31_MIN)
+    {
+        return Q31_MIN;
+    }
+    return (q31_t) x;
+}
+
+static q15_t sat_q15(int32_t x)
+{
+    if(x > Q15_MAX)
+    {
+        return Q15_MAX;
+    }
+    if(x < Q15_MIN)
+    {
+        return Q15_MIN;
+    }
+    return (q15_t) x;
+}
+
+/**
+ * Scale accumulator by 2^(-shift), rounding to nearest, and saturate to Q31.
+ * Negative shifts scale up.
+ */
+static q31_t shift_sat_q31(int64_t acc, int16_t shift)
+{
+    if(shift > 0)
+    {
+        acc = (acc + ((int64_t) 1 << (shift - 1))) >> shift;
+    }
+    else if(shift < 0)
+    {
+        shift = -shift;
+
+        if(acc > ((int64_t) Q31_MAX >> shift))
+        {
+            return Q31_MAX;
+        }
+        if(acc < ((int64_t) Q31_MIN >> shift))
+        {
+            return Q31_MIN;
+        }
+        acc = acc * ((int64_t) 1 << shift);
+    }
+
+    return sat_q31(acc);
+}
+
+static q15_t q31_to_q15(q31_t x)
+{
+    return sat_q15((int32_t) (((int64_t) x + 0x8000) >> 16));
+}
+
+/**
+ * Convert float to Q31, as a fraction of full-scale. Out of range values
+ * saturate.
+ *
+ * @param x
+ * @param full_scale
+ * @return Q31 value
+ */
+q31_t float_to_q31(float x, float full_scale)
+{
+    float v = x / full_scale;
+
+    if(v != v)
+    {
+        return 0;
+    }
+    if(v >= 1.0)
+    {
+        return Q31_MAX;
+    }
+    if(v <= -1.0)
+    {
+        return Q31_MIN;
+    }
+    return (q31_t) floor(v * Q31_ONE + 0.5);
+}
+
+/**
+ * Convert Q31 to float, given its full-scale.
+ *
+ * @param x
+ * @param full_scale
+ * @return float value
+ */
+float q31_to_float(q31_t x, float full_scale)
+{
+    return (float) x * (full_scale / Q31_ONE);
+}
+
+/**
+ * Convert float to Q15, as a fraction of full-scale. Out of range values
+ * saturate.
+ *
+ * @param x
+ * @param full_scale
+ * @return Q15 value
+ */
+q15_t float_to_q15(float x, float full_scale)
+{
+    float v = x / full_scale;
+
+    if(v != v)
+    {
+        return 0;
+    }
+    if(v >= 1.0)
+    {
+        return Q15_MAX;
+    }
+    if(v <= -1.0)
+    {
+        return Q15_MIN;
+    }
+    return sat_q15((int32_t) floor(v * Q15_ONE + 0.5));
+}
+
+/**
+ * Convert Q15 to float, given its full-scale.
+ *
+ * @param x
+ * @param full_scale
+ * @return float value
+ */
+float q15_to_float(q15_t x, float full_scale)
+{
+    return (float) x * (full_scale / Q15_ONE);
+}
+
+/**
+ * Get exponent e which normalizes x to [0.5, 1.0) when divided by 2^e,
+ * limited to [Q_EXP_MIN, Q_EXP_MAX].
+ *
+ * @param x
+ * @return exponent
+ */
+int16_t get_q_exp(float x)
+{
+    int16_t exp = 0;
+
+    x = fabs(x);
+
+    if(x == 0.0)
+    {
+        return 0;
+    }
+
+    while((x >= 1.0) && (exp < Q_EXP_MAX))
+    {
+        x *= 0.5;
+        exp++;
+    }
+
+    while((x < 0.5) && (exp > Q_EXP_MIN))
+    {
+        x *= 2.0;
+        exp--;
+    }
+
+    return exp;
+}
+
+/**
+ * Get common exponent for a set of coefficients.
+ */
+static int16_t get_coeffs_q_exp(const float *p_coeffs, uint16_t num_coeffs)
+{
+    uint16_t i;
+    float max = 0.0;
+
+    for(i = 0; i < num_coeffs; i++)
+    {
+        if(fabs(p_coeffs[i]) > max)
+        {
+            max = fabs(p_coeffs[i]);
+        }
+    }
+
+    return get_q_exp(max);
+}
+
+/**
+ * Tustin discretization of 1st-order low-pass filter, as in cfg_dsp_lpf().
+ * Returns pole coefficient a, while k = (1 - a)/2.
+ */
+static float get_lpf_pole(float freq_cut, float freq_sampling)
+{
+    float wt;
+
+    wt = (2.0 * 3.141592653589793 * freq_cut) / freq_sampling;
+
+    return (2.0 - wt) / (2.0 + wt);
+}
+
+/******************************************************************************
+ *                                Q31 modules
+ *****************************************************************************/
+
+/**
+ * Initialization of Q31 error signal entity.
+ *
+ * @param p_error
+ * @param pos
+ * @param neg
+ * @param error
+ */
+void init_dsp_error_q31(dsp_error_q31_t *p_error, volatile q31_t *pos,
+                        volatile q31_t *neg, volatile q31_t *error)
+{
+    p_error->pos = pos;
+    p_error->neg = neg;
+    p_error->error = error;
+    *(p_error->error) = 0;
+}
+
+/**
+ * Reset Q31 error signal.
+ *
+ * @param p_error
+ */
+void reset_dsp_error_q31(dsp_error_q31_t *p_error)
+{
+    *(p_error->error) = 0;
+}
+
+/**
+ * Calculate Q31 error signal.
+ *
+ * @param p_error
+ */
+void run_dsp_error_q31(dsp_error_q31_t *p_error)
+{
+    *(p_error->error) = sat_q31((int64_t) *(p_error->pos) - *(p_error->neg));
+}
+
+/**
+ * Initialization of Q31 slew-rate limiter.
+ *
+ * @param p_srlim
+ * @param p_coeffs          same as dsp_srlim_t coeffs: max_slewrate [units/s]
+ * @param freq_sampling     [Hz]
+ * @param full_scale        [units]
+ * @param in
+ * @param out
+ */
+void init_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim,
+                        const volatile float *p_coeffs, float freq_sampling,
+                        float full_scale, volatile q31_t *in,
+                        volatile q31_t *out)
+{
+    p_srlim->bypass = USE_MODULE;
+    p_srlim->freq_sampling = freq_sampling;
+    p_srlim->full_scale = full_scale;
+    p_srlim->in = in;
+    p_srlim->out = out;
+    *(p_srlim->out) = 0;
+
+    cfg_dsp_srlim_q31(p_srlim, p_coeffs);
+}
+
+void cfg_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim, const volatile float *p_coeffs)
+{
+    p_srlim->delta_max = float_to_q31(p_coeffs[0] / p_srlim->freq_sampling,
+                                      p_srlim->full_scale);
+}
+
+/**
+ * Reset Q31 slew-rate limiter.
+ *
+ * @param p_srlim
+ */
+void reset_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim)
+{
+    *(p_srlim->out) = 0;
+}
+
+/**
+ * Run Q31 slew-rate limiter.
+ *
+ * @param p_srlim
+ * @param bypass
+ */
+void run_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim, uint16_t bypass)
+{
+    q31_t delta;
+
+    if(bypass)
+    {
+        *(p_srlim->out) = *(p_srlim->in);
+    }
+    else
+    {
+        delta = sat_q31((int64_t) *(p_srlim->in) - *(p_srlim->out));
+        SATURATE(delta, p_srlim->delta_max, -p_srlim->delta_max);
+        *(p_srlim->out) = sat_q31((int64_t) *(p_srlim->out) + delta);
+    }
+}
+
+/**
+ * Initialization of Q31 1st-order low-pass filter. Input and output have the
+ * same full-scale. Gain k is derived from quantized pole a, so DC gain is
+ * exactly 1.
+ *
+ * @param p_lpf
+ * @param p_coeffs          same as dsp_lpf_t coeffs: freq_cut [Hz]
+ * @param freq_sampling     [Hz]
+ * @param in
+ * @param out
+ */
+void init_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf, const volatile float *p_coeffs,
+                      float freq_sampling, volatile q31_t *in,
+                      volatile q31_t *out)
+{
+    p_lpf->freq_sampling = freq_sampling;
+    p_lpf->in_old = 0;
+    p_lpf->in = in;
+    p_lpf->out = out;
+    *(p_lpf->out) = 0;
+
+    cfg_dsp_lpf_q31(p_lpf, p_coeffs);
+}
+
+void cfg_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf, const volatile float *p_coeffs)
+{
+    q31_t a;
+
+    a = float_to_q31(get_lpf_pole(p_coeffs[0], p_lpf->freq_sampling), 1.0);
+
+    /// Round a to even, so k = (1 - a)/2 is exact
+    a = sat_q31((int64_t) a + 1) & ~1;
+
+    p_lpf->a = a;
+    p_lpf->k = (q31_t) ((((int64_t) 1 << 31) - a) >> 1);
+}
+
+/**
+ * Reset Q31 1st-order low-pass filter.
+ *
+ * @param p_lpf
+ */
+void reset_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf)
+{
+    p_lpf->in_old = 0;
+    *(p_lpf->out) = 0;
+}
+
+/**
+ * Run Q31 1st-order low-pass filter.
+ *
+ * @param p_lpf
+ */
+void run_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf)
+{
+    int64_t acc;
+    q31_t in = *(p_lpf->in);
+
+    acc = (int64_t) p_lpf->a * *(p_lpf->out);
+    acc += (int64_t) p_lpf->k * p_lpf->in_old;
+    acc += (int64_t) p_lpf->k * in;
+    p_lpf->in_old = in;
+    *(p_lpf->out) = shift_sat_q31(acc, 31);
+}
+
+/**
+ * Initialization of Q31 PI controller with dynamic anti-windup scheme.
+ *
+ * @param p_pi
+ * @param p_coeffs      same as dsp_pi_t coeffs: kp, ki, u_max, u_min
+ * @param scale_in      input full-scale
+ * @param scale_out     output full-scale
+ * @param in
+ * @param out
+ */
+void init_dsp_pi_q31(dsp_pi_q31_t *p_pi, const volatile float *p_coeffs,
+                     float scale_in, float scale_out, volatile q31_t *in,
+                     volatile q31_t *out)
+{
+    p_pi->scale_in = scale_in;
+    p_pi->scale_out = scale_out;
+    p_pi->u_prop = 0;
+    p_pi->u_int = 0;
+    p_pi->in = in;
+    p_pi->out = out;
+    *(p_pi->out) = 0;
+
+    cfg_dsp_pi_q31(p_pi, p_coeffs);
+}
+
+void cfg_dsp_pi_q31(dsp_pi_q31_t *p_pi, const volatile float *p_coeffs)
+{
+    float gain = p_pi->scale_in / p_pi->scale_out;
+    float k[2];
+    float exp_scale;
+
+    k[0] = p_coeffs[0] * gain;
+    k[1] = p_coeffs[1] * gain;
+
+    p_pi->exp = get_coeffs_q_exp(k, 2);
+    exp_scale = ldexp(1.0, p_pi->exp);
+
+    p_pi->kp = float_to_q31(k[0], exp_scale);
+    p_pi->ki = float_to_q31(k[1], exp_scale);
+    p_pi->u_max = float_to_q31(p_coeffs[2], p_pi->scale_out);
+    p_pi->u_min = float_to_q31(p_coeffs[3], p_pi->scale_out);
+}
+
+/**
+ * Reset Q31 PI controller.
+ *
+ * @param p_pi
+ */
+void reset_dsp_pi_q31(dsp_pi_q31_t *p_pi)
+{
+    p_pi->u_prop = 0;
+    p_pi->u_int = 0;
+    *(p_pi->out) = 0;
+}
+
+/**
+ * Run Q31 PI controller.
+ *
+ * @param p_pi
+ */
+void run_dsp_pi_q31(dsp_pi_q31_t *p_pi)
+{
+    q31_t in = *(p_pi->in);
+    q31_t dyn_max;
+    q31_t dyn_min;
+    q31_t temp;
+    int16_t shift = 31 - p_pi->exp;
+
+    temp = shift_sat_q31((int64_t) p_pi->kp * in, shift);
+    SATURATE(temp, p_pi->u_max, p_pi->u_min);
+    p_pi->u_prop = temp;
+
+    dyn_max = sat_q31((int64_t) p_pi->u_max - temp);
+    dyn_min = sat_q31((int64_t) p_pi->u_min - temp);
+
+    temp = sat_q31((int64_t) p_pi->u_int +
+                   shift_sat_q31((int64_t) p_pi->ki * in, shift));
+    SATURATE(temp, dyn_max, dyn_min);
+    p_pi->u_int = temp;
+
+    *(p_pi->out) = sat_q31((int64_t) p_pi->u_int + p_pi->u_prop);
+}
+
+/**
+ * Initialization of Q31 2nd-order IIR filter. Implemented with Transposed
+ * Direct-Form II.
+ *
+ * @param p_iir
+ * @param p_coeffs      same as dsp_iir_2p2z_t coeffs: b0, b1, b2, a1, a2,
+ *                      u_max, u_min
+ * @param scale_in      input full-scale
+ * @param scale_out     output full-scale
+ * @param in
+ * @param out
+ */
+void init_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir,
+                           const volatile float *p_coeffs, float scale_in,
+                           float scale_out, volatile q31_t *in,
+                           volatile q31_t *out)
+{
+    p_iir->scale_in = scale_in;
+    p_iir->scale_out = scale_out;
+    p_iir->w1 = 0;
+    p_iir->w2 = 0;
+    p_iir->in = in;
+    p_iir->out = out;
+    *(p_iir->out) = 0;
+
+    cfg_dsp_iir_2p2z_q31(p_iir, p_coeffs);
+}
+
+void cfg_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir,
+                          const volatile float *p_coeffs)
+{
+    float gain = p_iir->scale_in / p_iir->scale_out;
+    float c[5];
+    float exp_scale;
+
+    c[0] = p_coeffs[0] * gain;
+    c[1] = p_coeffs[1] * gain;
+    c[2] = p_coeffs[2] * gain;
+    c[3] = p_coeffs[3];
+    c[4] = p_coeffs[4];
+
+    p_iir->exp = get_coeffs_q_exp(c, 5);
+    exp_scale = ldexp(1.0, p_iir->exp);
+
+    p_iir->b0 = float_to_q31(c[0], exp_scale);
+    p_iir->b1 = float_to_q31(c[1], exp_scale);
+    p_iir->b2 = float_to_q31(c[2], exp_scale);
+    p_iir->a1 = float_to_q31(c[3], exp_scale);
+    p_iir->a2 = float_to_q31(c[4], exp_scale);
+    p_iir->u_max = float_to_q31(p_coeffs[5], p_iir->scale_out);
+    p_iir->u_min = float_to_q31(p_coeffs[6], p_iir->scale_out);
+}
+
+/**
+ * Reset Q31 2nd-order IIR filter.
+ *
+ * @param p_iir
+ */
+void reset_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir)
+{
+    p_iir->w1 = 0;
+    p_iir->w2 = 0;
+    *(p_iir->out) = 0;
+}
+
+/**
+ * Run Q31 2nd-order IIR filter.
+ *
+ * @param p_iir
+ */
+void run_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir)
+{
+    q31_t in = *(p_iir->in);
+    q31_t yacc;
+    int16_t shift = 31 - p_iir->exp;
+
+    yacc = sat_q31((int64_t) p_iir->w1 +
+                   shift_sat_q31((int64_t) p_iir->b0 * in, shift));
+
+    SATURATE(yacc, p_iir->u_max, p_iir->u_min);
+
+    p_iir->w1 = sat_q31((int64_t) p_iir->w2 +
+                        shift_sat_q31((int64_t) p_iir->b1 * in -
+                                      (int64_t) p_iir->a1 * yacc, shift));
+
+    p_iir->w2 = shift_sat_q31((int64_t) p_iir->b2 * in -
+                              (int64_t) p_iir->a2 * yacc, shift);
+
+    *(p_iir->out) = yacc;
+}
+
+/******************************************************************************
+ *                                Q15 modules
+ *****************************************************************************/
+
+/**
+ * Initialization of Q15 error signal entity.
+ *
+ * @param p_error
+ * @param pos
+ * @param neg
+ * @param error
+ */
+void init_dsp_error_q15(dsp_error_q15_t *p_error, volatile q15_t *pos,
+                        volatile q15_t *neg, volatile q15_t *error)
+{
+    p_error->pos = pos;
+    p_error->neg = neg;
+    p_error->error = error;
+    *(p_error->error) = 0;
+}
+
+/**
+ * Reset Q15 error signal.
+ *
+ * @param p_error
+ */
+void reset_dsp_error_q15(dsp_error_q15_t *p_error)
+{
+    *(p_error->error) = 0;
+}
+
+/**
+ * Calculate Q15 error signal.
+ *
+ * @param p_error
+ */
+void run_dsp_error_q15(dsp_error_q15_t *p_error)
+{
+    *(p_error->error) = sat_q15((int32_t) *(p_error->pos) - *(p_error->neg));
+}
+
+/**
+ * Initialization of Q15 slew-rate limiter. Output is accumulated in Q31, so
+ * slew-rates below 1 LSB per sample are still followed.
+ *
+ * @param p_srlim
+ * @param p_coeffs          same as dsp_srlim_t coeffs: max_slewrate [units/s]
+ * @param freq_sampling     [Hz]
+ * @param full_scale        [units]
+ * @param in
+ * @param out
+ */
+void init_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim,
+                        const volatile float *p_coeffs, float freq_sampling,
+                        float full_scale, volatile q15_t *in,
+                        volatile q15_t *out)
+{
+    p_srlim->bypass = USE_MODULE;
+    p_srlim->freq_sampling = freq_sampling;
+    p_srlim->full_scale = full_scale;
+    p_srlim->in = in;
+    p_srlim->out = out;
+
+    reset_dsp_srlim_q15(p_srlim);
+    cfg_dsp_srlim_q15(p_srlim, p_coeffs);
+}
+
+void cfg_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim, const volatile float *p_coeffs)
+{
+    p_srlim->delta_max = float_to_q31(p_coeffs[0] / p_srlim->freq_sampling,
+                                      p_srlim->full_scale);
+}
+
+/**
+ * Reset Q15 slew-rate limiter.
+ *
+ * @param p_srlim
+ */
+void reset_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim)
+{
+    p_srlim->out_acc = 0;
+    *(p_srlim->out) = 0;
+}
+
+/**
+ * Run Q15 slew-rate limiter.
+ *
+ * @param p_srlim
+ * @param bypass
+ */
+void run_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim, uint16_t bypass)
+{
+    q31_t in = (q31_t) *(p_srlim->in) * 65536;
+    q31_t delta;
+
+    if(bypass)
+    {
+        p_srlim->out_acc = in;
+    }
+    else
+    {
+        delta = sat_q31((int64_t) in - p_srlim->out_acc);
+        SATURATE(delta, p_srlim->delta_max, -p_srlim->delta_max);
+        p_srlim->out_acc = sat_q31((int64_t) p_srlim->out_acc + delta);
+    }
+
+    *(p_srlim->out) = q31_to_q15(p_srlim->out_acc);
+}
+
+/**
+ * Initialization of Q15 1st-order low-pass filter. Input and output have the
+ * same full-scale. Gain k is derived from quantized pole a, so DC gain is
+ * exactly 1, and output is accumulated in Q31 to avoid dead-band.
+ *
+ * @param p_lpf
+ * @param p_coeffs          same as dsp_lpf_t coeffs: freq_cut [Hz]
+ * @param freq_sampling     [Hz]
+ * @param in
+ * @param out
+ */
+void init_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf, const volatile float *p_coeffs,
+                      float freq_sampling, volatile q15_t *in,
+                      volatile q15_t *out)
+{
+    p_lpf->freq_sampling = freq_sampling;
+    p_lpf->in = in;
+    p_lpf->out = out;
+
+    reset_dsp_lpf_q15(p_lpf);
+    cfg_dsp_lpf_q15(p_lpf, p_coeffs);
+}
+
+void cfg_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf, const volatile float *p_coeffs)
+{
+    q15_t a;
+
+    a = float_to_q15(get_lpf_pole(p_coeffs[0], p_lpf->freq_sampling), 1.0);
+
+    /// Round a to even, so k = (1 - a)/2 is exact
+    a = sat_q15((int32_t) a + 1) & ~1;
+
+    p_lpf->a = a;
+    p_lpf->k = (q15_t) ((32768 - (int32_t) a) >> 1);
+}
+
+/**
+ * Reset Q15 1st-order low-pass filter.
+ *
+ * @param p_lpf
+ */
+void reset_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf)
+{
+    p_lpf->in_old = 0;
+    p_lpf->out_acc = 0;
+    *(p_lpf->out) = 0;
+}
+
+/**
+ * Run Q15 1st-order low-pass filter.
+ *
+ * @param p_lpf
+ */
+void run_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf)
+{
+    int64_t acc;
+    q15_t in = *(p_lpf->in);
+
+    acc = (int64_t) p_lpf->a * p_lpf->out_acc;
+    acc += (int64_t) p_lpf->k * ((int32_t) p_lpf->in_old + in) * 65536;
+    p_lpf->in_old = in;
+    p_lpf->out_acc = shift_sat_q31(acc, 15);
+    *(p_lpf->out) = q31_to_q15(p_lpf->out_acc);
+}
+
+/**
+ * Initialization of Q15 PI controller with dynamic anti-windup scheme. Each
+ * gain has its own exponent, and both actions are accumulated in Q31.
+ *
+ * @param p_pi
+ * @param p_coeffs      same as dsp_pi_t coeffs: kp, ki, u_max, u_min
+ * @param scale_in      input full-scale
+ * @param scale_out     output full-scale
+ * @param in
+ * @param out
+ */
+void init_dsp_pi_q15(dsp_pi_q15_t *p_pi, const volatile float *p_coeffs,
+                     float scale_in, float scale_out, volatile q15_t *in,
+                     volatile q15_t *out)
+{
+    p_pi->scale_in = scale_in;
+    p_pi->scale_out = scale_out;
+    p_pi->u_prop = 0;
+    p_pi->u_int = 0;
+    p_pi->in = in;
+    p_pi->out = out;
+    *(p_pi->out) = 0;
+
+    cfg_dsp_pi_q15(p_pi, p_coeffs);
+}
+
+void cfg_dsp_pi_q15(dsp_pi_q15_t *p_pi, const volatile float *p_coeffs)
+{
+    float gain = p_pi->scale_in / p_pi->scale_out;
+    float kp = p_coeffs[0] * gain;
+    float ki = p_coeffs[1] * gain;
+
+    p_pi->exp_kp = get_q_exp(kp);
+    p_pi->exp_ki = get_q_exp(ki);
+
+    p_pi->kp = float_to_q15(kp, ldexp(1.0, p_pi->exp_kp));
+    p_pi->ki = float_to_q15(ki, ldexp(1.0, p_pi->exp_ki));
+    p_pi->u_max = float_to_q31(p_coeffs[2], p_pi->scale_out);
+    p_pi->u_min = float_to_q31(p_coeffs[3], p_pi->scale_out);
+}
+
+/**
+ * Reset Q15 PI controller.
+ *
+ * @param p_pi
+ */
+void reset_dsp_pi_q15(dsp_pi_q15_t *p_pi)
+{
+    p_pi->u_prop = 0;
+    p_pi->u_int = 0;
+    *(p_pi->out) = 0;
+}
+
+/**
+ * Run Q15 PI controller.
+ *
+ * @param p_pi
+ */
+void run_dsp_pi_q15(dsp_pi_q15_t *p_pi)
+{
+    q15_t in = *(p_pi->in);
+    q31_t dyn_max;
+    q31_t dyn_min;
+    q31_t temp;
+
+    /// Q15 x Q15 = Q30, so Q31 result is scaled by 2^(exp + 1)
+    temp = shift_sat_q31((int32_t) p_pi->kp * in, -1 - p_pi->exp_kp);
+    SATURATE(temp, p_pi->u_max, p_pi->u_min);
+    p_pi->u_prop = temp;
+
+    dyn_max = sat_q31((int64_t) p_pi->u_max - temp);
+    dyn_min = sat_q31((int64_t) p_pi->u_min - temp);
+
+    temp = sat_q31((int64_t) p_pi->u_int +
+                   shift_sat_q31((int32_t) p_pi->ki * in, -1 - p_pi->exp_ki));
+    SATURATE(temp, dyn_max, dyn_min);
+    p_pi->u_int = temp;
+
+    *(p_pi->out) = q31_to_q15(sat_q31((int64_t) p_pi->u_int + p_pi->u_prop));
+}
+
+/**
+ * Initialization of Q15 2nd-order IIR filter. Implemented with Transposed
+ * Direct-Form II, with states in Q31. All coefficients share one exponent,
+ * so prefer the Q31 version when b coefficients are much smaller than a
+ * coefficients, as on low cut-off frequency filters.
+ *
+ * @param p_iir
+ * @param p_coeffs      same as dsp_iir_2p2z_t coeffs: b0, b1, b2, a1, a2,
+ *                      u_max, u_min
+ * @param scale_in      input full-scale
+ * @param scale_out     output full-scale
+ * @param in
+ * @param out
+ */
+void init_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir,
+                           const volatile float *p_coeffs, float scale_in,
+                           float scale_out, volatile q15_t *in,
+                           volatile q15_t *out)
+{
+    p_iir->scale_in = scale_in;
+    p_iir->scale_out = scale_out;
+    p_iir->w1 = 0;
+    p_iir->w2 = 0;
+    p_iir->in = in;
+    p_iir->out = out;
+    *(p_iir->out) = 0;
+
+    cfg_dsp_iir_2p2z_q15(p_iir, p_coeffs);
+}
+
+void cfg_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir,
+                          const volatile float *p_coeffs)
+{
+    float gain = p_iir->scale_in / p_iir->scale_out;
+    float c[5];
+    float exp_scale;
+
+    c[0] = p_coeffs[0] * gain;
+    c[1] = p_coeffs[1] * gain;
+    c[2] = p_coeffs[2] * gain;
+    c[3] = p_coeffs[3];
+    c[4] = p_coeffs[4];
+
+    p_iir->exp = get_coeffs_q_exp(c, 5);
+    exp_scale = ldexp(1.0, p_iir->exp);
+
+    p_iir->b0 = float_to_q15(c[0], exp_scale);
+    p_iir->b1 = float_to_q15(c[1], exp_scale);
+    p_iir->b2 = float_to_q15(c[2], exp_scale);
+    p_iir->a1 = float_to_q15(c[3], exp_scale);
+    p_iir->a2 = float_to_q15(c[4], exp_scale);
+    p_iir->u_max = float_to_q15(p_coeffs[5], p_iir->scale_out);
+    p_iir->u_min = float_to_q15(p_coeffs[6], p_iir->scale_out);
+}
+
+/**
+ * Reset Q15 2nd-order IIR filter.
+ *
+ * @param p_iir
+ */
+void reset_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir)
+{
+    p_iir->w1 = 0;
+    p_iir->w2 = 0;
+    *(p_iir->out) = 0;
+}
+
+/**
+ * Run Q15 2nd-order IIR filter.
+ *
+ * @param p_iir
+ */
+void run_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir)
+{
+    q15_t in = *(p_iir->in);
+    q15_t yacc;
+    int16_t shift = -1 - p_iir->exp;
+
+    yacc = q31_to_q15(sat_q31((int64_t) p_iir->w1 +
+                              shift_sat_q31((int32_t) p_iir->b0 * in, shift)));
+
+    SATURATE(yacc, p_iir->u_max, p_iir->u_min);
+
+    p_iir->w1 = sat_q31((int64_t) p_iir->w2 +
+                        shift_sat_q31((int64_t) p_iir->b1 * in -
+                                      (int32_t) p_iir->a1 * yacc, shift));
+
+    p_iir->w2 = shift_sat_q31((int64_t) p_iir->b2 * in -
+                              (int32_t) p_iir->a2 * yacc, shift);
+
+    *(p_iir->out) = yacc;
+}
@@ -0,0 +1,265 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file dsp_q.h
+ * @brief Fixed-point Digital Signal Processing Module
+ *
+ * Q31 and Q15 versions of error, slew-rate limiter, low-pass filter, PI
+ * controller and 2nd-order IIR filter from DSP module, for cores without FPU.
+ * Arithmetic saturates instead of wrapping around.
+ *
+ * Signals are fractions of a full-scale value, given on initialization:
+ *
+ *      x[Qn] = x[float] / full_scale * 2^n
+ *
+ * Coefficients are configured from the same float coefficient vectors used by
+ * set_dsp_coeffs() (DSP_LATEST_COEFFS(dsp_xxx_t).f), and stored as a Qn
+ * mantissa and a power-of-2 exponent, so gains above 1.0 or much lower than
+ * 1.0 keep full resolution. Q15 modules run on 16-bit signals and coefficients, but keep
+ * integrators and filter states in Q31 to avoid dead-bands.
+ *
+ * @author agent
+ * @date 16/10/2026
+ *
+ */
+
+#ifndef DSP_Q_H_
+#define DSP_Q_H_
+
+#include <stdint.h>
+
+typedef int32_t q31_t;
+typedef int16_t q15_t;
+
+#define Q31_MAX             ((q31_t) 0x7FFFFFFF)
+#define Q31_MIN             ((q31_t) 0x80000000)
+#define Q15_MAX             ((q15_t) 0x7FFF)
+#define Q15_MIN             ((q15_t) 0x8000)
+
+#define Q_EXP_MAX           15
+#define Q_EXP_MIN           -15
+
+extern q31_t float_to_q31(float x, float full_scale);
+extern float q31_to_float(q31_t x, float full_scale);
+extern q15_t float_to_q15(float x, float full_scale);
+extern float q15_to_float(q15_t x, float full_scale);
+extern int16_t get_q_exp(float x);
+
+/**
+ * Q31 modules
+ */
+typedef volatile struct
+{
+    volatile q31_t *pos;
+    volatile q31_t *neg;
+    volatile q31_t *error;
+} dsp_error_q31_t;
+
+typedef volatile struct
+{
+    uint16_t bypass;
+    float freq_sampling;
+    float full_scale;
+    q31_t delta_max;
+    volatile q31_t *in;
+    volatile q31_t *out;
+} dsp_srlim_q31_t;
+
+typedef volatile struct
+{
+    float freq_sampling;
+    q31_t k;
+    q31_t a;
+    q31_t in_old;
+    volatile q31_t *in;
+    volatile q31_t *out;
+} dsp_lpf_q31_t;
+
+typedef volatile struct
+{
+    float scale_in;
+    float scale_out;
+    int16_t exp;
+    q31_t kp;
+    q31_t ki;
+    q31_t u_max;
+    q31_t u_min;
+    q31_t u_prop;
+    q31_t u_int;
+    volatile q31_t *in;
+    volatile q31_t *out;
+} dsp_pi_q31_t;
+
+typedef volatile struct
+{
+    float scale_in;
+    float scale_out;
+    int16_t exp;
+    q31_t b0;
+    q31_t b1;
+    q31_t b2;
+    q31_t a1;
+    q31_t a2;
+    q31_t u_max;
+    q31_t u_min;
+    q31_t w1;
+    q31_t w2;
+    volatile q31_t *in;
+    volatile q31_t *out;
+} dsp_iir_2p2z_q31_t;
+
+/**
+ * Q15 modules
+ */
+typedef volatile struct
+{
+    volatile q15_t *pos;
+    volatile q15_t *neg;
+    volatile q15_t *error;
+} dsp_error_q15_t;
+
+typedef volatile struct
+{
+    uint16_t bypass;
+    float freq_sampling;
+    float full_scale;
+    q31_t delta_max;
+    q31_t out_acc;
+    volatile q15_t *in;
+    volatile q15_t *out;
+} dsp_srlim_q15_t;
+
+typedef volatile struct
+{
+    float freq_sampling;
+    q15_t k;
+    q15_t a;
+    q15_t in_old;
+    q31_t out_acc;
+    volatile q15_t *in;
+    volatile q15_t *out;
+} dsp_lpf_q15_t;
+
+typedef volatile struct
+{
+    float scale_in;
+    float scale_out;
+    int16_t exp_kp;
+    int16_t exp_ki;
+    q15_t kp;
+    q15_t ki;
+    q31_t u_max;
+    q31_t u_min;
+    q31_t u_prop;
+    q31_t u_int;
+    volatile q15_t *in;
+    volatile q15_t *out;
+} dsp_pi_q15_t;
+
+typedef volatile struct
+{
+    float scale_in;
+    float scale_out;
+    int16_t exp;
+    q15_t b0;
+    q15_t b1;
+    q15_t b2;
+    q15_t a1;
+    q15_t a2;
+    q15_t u_max;
+    q15_t u_min;
+    q31_t w1;
+    q31_t w2;
+    volatile q15_t *in;
+    volatile q15_t *out;
+} dsp_iir_2p2z_q15_t;
+
+
+extern void init_dsp_error_q31(dsp_error_q31_t *p_error, volatile q31_t *pos,
+                               volatile q31_t *neg, volatile q31_t *error);
+extern void reset_dsp_error_q31(dsp_error_q31_t *p_error);
+extern void run_dsp_error_q31(dsp_error_q31_t *p_error);
+
+extern void init_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim,
+                               const volatile float *p_coeffs,
+                               float freq_sampling, float full_scale,
+                               volatile q31_t *in, volatile q31_t *out);
+extern void cfg_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim,
+                              const volatile float *p_coeffs);
+extern void reset_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim);
+extern void run_dsp_srlim_q31(dsp_srlim_q31_t *p_srlim, uint16_t bypass);
+
+extern void init_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf,
+                             const volatile float *p_coeffs,
+                             float freq_sampling, volatile q31_t *in,
+                             volatile q31_t *out);
+extern void cfg_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf,
+                            const volatile float *p_coeffs);
+extern void reset_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf);
+extern void run_dsp_lpf_q31(dsp_lpf_q31_t *p_lpf);
+
+extern void init_dsp_pi_q31(dsp_pi_q31_t *p_pi, const volatile float *p_coeffs,
+                            float scale_in, float scale_out,
+                            volatile q31_t *in, volatile q31_t *out);
+extern void cfg_dsp_pi_q31(dsp_pi_q31_t *p_pi, const volatile float *p_coeffs);
+extern void reset_dsp_pi_q31(dsp_pi_q31_t *p_pi);
+extern void run_dsp_pi_q31(dsp_pi_q31_t *p_pi);
+
+extern void init_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir,
+                                  const volatile float *p_coeffs,
+                                  float scale_in, float scale_out,
+                                  volatile q31_t *in, volatile q31_t *out);
+extern void cfg_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir,
+                                 const volatile float *p_coeffs);
+extern void reset_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir);
+extern void run_dsp_iir_2p2z_q31(dsp_iir_2p2z_q31_t *p_iir);
+
+
+extern void init_dsp_error_q15(dsp_error_q15_t *p_error, volatile q15_t *pos,
+                               volatile q15_t *neg, volatile q15_t *error);
+extern void reset_dsp_error_q15(dsp_error_q15_t *p_error);
+extern void run_dsp_error_q15(dsp_error_q15_t *p_error);
+
+extern void init_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim,
+                               const volatile float *p_coeffs,
+                               float freq_sampling, float full_scale,
+                               volatile q15_t *in, volatile q15_t *out);
+extern void cfg_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim,
+                              const volatile float *p_coeffs);
+extern void reset_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim);
+extern void run_dsp_srlim_q15(dsp_srlim_q15_t *p_srlim, uint16_t bypass);
+
+extern void init_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf,
+                             const volatile float *p_coeffs,
+                             float freq_sampling, volatile q15_t *in,
+                             volatile q15_t *out);
+extern void cfg_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf,
+                            const volatile float *p_coeffs);
+extern void reset_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf);
+extern void run_dsp_lpf_q15(dsp_lpf_q15_t *p_lpf);
+
+extern void init_dsp_pi_q15(dsp_pi_q15_t *p_pi, const volatile float *p_coeffs,
+                            float scale_in, float scale_out,
+                            volatile q15_t *in, volatile q15_t *out);
+extern void cfg_dsp_pi_q15(dsp_pi_q15_t *p_pi, const volatile float *p_coeffs);
+extern void reset_dsp_pi_q15(dsp_pi_q15_t *p_pi);
+extern void run_dsp_pi_q15(dsp_pi_q15_t *p_pi);
+
+extern void init_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir,
+                                  const volatile float *p_coeffs,
+                                  float scale_in, float scale_out,
+                                  volatile q15_t *in, volatile q15_t *out);
+extern void cfg_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir,
+                                 const volatile float *p_coeffs);
+extern void reset_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir);
+extern void run_dsp_iir_2p2z_q15(dsp_iir_2p2z_q15_t *p_iir);
+
+#endif /* DSP_Q_H_ */
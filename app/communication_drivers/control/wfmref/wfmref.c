@@ -31,7 +31,11 @@ void init_wfmref(wfmref_t *p_wfmref, uint16_t wfmref_selected,
                  float gain, float offset, float *p_start, uint16_t size,
                  float *p_out)
 {
-    uint16_t i;
+    uint16_t i, buf_id;
+    shared_buf_t *p_buf;
+
+    /// WfmRef instances are indexed by power supply on IPC structure
+    uint16_t ps_id = p_wfmref - &WFMREF[0];
 
     p_wfmref->wfmref_selected.u16 = wfmref_selected;
     p_wfmref->sync_mode.u16 = sync_mode;
@@ -43,15 +47,18 @@ void init_wfmref(wfmref_t *p_wfmref, uint16_t wfmref_selected,
     {
         init_buffer(&p_wfmref->wfmref_data[i], p_start + i * size, size);
 
+        buf_id = SHARED_BUF_ID_WFMREF(ps_id, i);
+        register_shared_buf(buf_id, p_start + i * size, size * sizeof(float));
+        p_buf = &g_shared_bufs[buf_id];
+
         /// Convert WfmRef pointers to C28 memory mapping
-        p_wfmref->wfmref_data[i].p_buf_start.p_f =
-                (float *) ipc_mtoc_translate((uint32_t) p_wfmref->wfmref_data[i].p_buf_start.p_f);
+        p_wfmref->wfmref_data[i].p_buf_start.p_f = (float *) p_buf->c28_start;
 
         p_wfmref->wfmref_data[i].p_buf_idx.p_f =
-                        (float *) ipc_mtoc_translate((uint32_t) (p_wfmref->wfmref_data[i].p_buf_end.p_f + 1));
+                (float *) SHARED_BUF_C28_ADD(p_buf, p_buf->size);
 
         p_wfmref->wfmref_data[i].p_buf_end.p_f =
-                (float *) ipc_mtoc_translate((uint32_t) p_wfmref->wfmref_data[i].p_buf_end.p_f);
+                (float *) SHARED_BUF_C28_ADD(p_buf, p_buf->size - sizeof(float));
     }
 
     p_wfmref->lerp.counter = 0;
@@ -68,7 +68,8 @@ static struct serial_buffer send_buffer = {.index = 0};
 static struct bsmp_raw_packet recv_packet;
 
 static struct bsmp_raw_packet send_packet =
-                             { .data = send_buffer.data + 1 };
+                             { .data = send_buffer.data + 1,
+                               .max_len = sizeof(send_buffer.data) - 1 };
 uint16_t loop_count;
 //unsigned long clock_set;
 
@@ -167,15 +168,6 @@ static volatile unsigned long g_ulFlags;
 //*****************************************************************************
 volatile unsigned long g_ulTickCounter = 0;
 
-//*****************************************************************************
-// The control table used by the uDMA controller.  This table must be aligned
-// to a 1024 byte boundary.  In this application uDMA is only used for USB,
-// so only the first 8 channels are needed.
-//*****************************************************************************
-#pragma DATA_ALIGN(g_sDMAControlTable, 1024)
-//tDMAControlTable g_sDMAControlTable[1024];
-uint8_t g_sDMAControlTable[1024];
-
 //*****************************************************************************
 // Default TCP/IP Settings for this application.
 // Default to Link Local address ... (169.254.1.0 to 169.254.254.255).  Note:
@@ -662,6 +654,8 @@ void ethernet_process_cmd(void)
     // Library will process the packet
     // TODO: Process 4 BSMP servers
     BSMPprocess(&recv_packet, &send_packet, 0, 0);
+    bsmp_defer_response(&send_packet, NULL);
+    bsmp_wait_pending_cmd();
 
     httpd_insert_response(send_packet.len,(uint8_t *)send_packet.data);
 
@@ -682,10 +676,7 @@ void ethernet_init(void)
     // DMA can be used.
     uip_buf = (u8_t *)(((unsigned long)ucUIPBuffer + 3) & 0xfffffffe);
 
-    // Enable the uDMA controller and set up the control table base.
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
-    uDMAEnable();
-    uDMAControlBaseSet(g_sDMAControlTable);
+    // uDMA controller and its control table are set up by pinout_setup()
 
     // Configure the DMA TX channel
     uDMAChannelAttributeDisable(UDMA_CHANNEL_ETH0TX, UDMA_ATTR_ALL);
@@ -54,6 +54,7 @@ const uint16_t dsp_modules_eeprom_add[NUM_DSP_CLASSES] =
     [DSP_IIR_3P3Z]      = 0x0DE0,
     [DSP_VdcLink_FeedForward] = 0x0EE0,
     [DSP_Vect_Product]  = 0x1FE0,
+    [DSP_IIR_SOS]       = 0x1FE0,
 };
 
 const uint16_t num_coeffs_dsp_module[NUM_DSP_CLASSES] =
@@ -65,7 +66,8 @@ const uint16_t num_coeffs_dsp_module[NUM_DSP_CLASSES] =
     [DSP_IIR_2P2Z]      = NUM_COEFFS_DSP_IIR_2P2Z,
     [DSP_IIR_3P3Z]      = NUM_COEFFS_DSP_IIR_3P3Z,
     [DSP_VdcLink_FeedForward] = NUM_COEFFS_DSP_VDCLINK_FF,
-    [DSP_Vect_Product]  = NUM_COEFFS_DSP_MATRIX
+    [DSP_Vect_Product]  = NUM_COEFFS_DSP_MATRIX,
+    [DSP_IIR_SOS]       = NUM_COEFFS_DSP_IIR_SOS
 };
 
 const uint16_t num_dsp_modules[NUM_DSP_CLASSES] =
@@ -77,7 +79,8 @@ const uint16_t num_dsp_modules[NUM_DSP_CLASSES] =
     [DSP_IIR_2P2Z]      = NUM_MAX_DSP_IIR_2P2Z,
     [DSP_IIR_3P3Z]      = NUM_MAX_DSP_IIR_3P3Z,
     [DSP_VdcLink_FeedForward] = NUM_MAX_DSP_VDCLINK_FF,
-    [DSP_Vect_Product]  = NUM_MAX_DSP_VECT_PRODUCT
+    [DSP_Vect_Product]  = NUM_MAX_DSP_VECT_PRODUCT,
+    [DSP_IIR_SOS]       = NUM_MAX_DSP_IIR_SOS*NUM_MAX_IIR_SOS_SECTIONS
 };
 
 static uint8_t data_eeprom[64];
@@ -102,36 +105,36 @@ uint8_t save_dsp_coeffs_onboard_eeprom(dsp_class_t dsp_class, uint16_t id)
     {
         case DSP_SRLim:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_srlim[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_srlim[id]).f;
             break;
         }
 
         case DSP_LPF:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_lpf[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_lpf[id]).f;
             break;
         }
 
         case DSP_PI:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_pi[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_pi[id]).f;
             break;
         }
         case DSP_IIR_2P2Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id]).f;
             break;
         }
 
         case DSP_IIR_3P3Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id]).f;
             break;
         }
 
         case DSP_VdcLink_FeedForward:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_ff[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_ff[id]).f;
             break;
         }
 
@@ -192,36 +195,36 @@ uint8_t save_dsp_coeffs_offboard_eeprom(dsp_class_t dsp_class, uint16_t id)
     {
         case DSP_SRLim:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_srlim[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_srlim[id]).f;
             break;
         }
 
         case DSP_LPF:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_lpf[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_lpf[id]).f;
             break;
         }
 
         case DSP_PI:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_pi[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_pi[id]).f;
             break;
         }
         case DSP_IIR_2P2Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id]).f;
             break;
         }
 
         case DSP_IIR_3P3Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id]).f;
             break;
         }
 
         case DSP_VdcLink_FeedForward:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_ff[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_ff[id]).f;
             break;
         }
 
@@ -276,36 +279,36 @@ uint8_t load_dsp_coeffs_onboard_eeprom(dsp_class_t dsp_class, uint16_t id)
     {
         case DSP_SRLim:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_srlim[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_srlim[id]).f;
             break;
         }
 
         case DSP_LPF:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_lpf[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_lpf[id]).f;
             break;
         }
 
         case DSP_PI:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_pi[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_pi[id]).f;
             break;
         }
         case DSP_IIR_2P2Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id]).f;
             break;
         }
 
         case DSP_IIR_3P3Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id]).f;
             break;
         }
 
         case DSP_VdcLink_FeedForward:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_ff[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_ff[id]).f;
             break;
         }
 
@@ -363,36 +366,36 @@ uint8_t load_dsp_coeffs_offboard_eeprom(dsp_class_t dsp_class, uint16_t id)
     {
         case DSP_SRLim:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_srlim[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_srlim[id]).f;
             break;
         }
 
         case DSP_LPF:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_lpf[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_lpf[id]).f;
             break;
         }
 
         case DSP_PI:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_pi[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_pi[id]).f;
             break;
         }
         case DSP_IIR_2P2Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_2p2z[id]).f;
             break;
         }
 
         case DSP_IIR_3P3Z:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_iir_3p3z[id]).f;
             break;
         }
 
         case DSP_VdcLink_FeedForward:
         {
-            p_val = (uint8_t *) &g_controller_mtoc.dsp_modules.dsp_ff[id].coeffs.f;
+            p_val = (uint8_t *) &DSP_LATEST_COEFFS(g_controller_mtoc.dsp_modules.dsp_ff[id]).f;
             break;
         }
 
@@ -75,7 +75,6 @@ static uint8_t SERIAL_CH_3_ADDRESS = 4;
 
 //static uint8_t BCAST_ADDRESS  = 255; // Broadcast Address
 
-volatile uint8_t g_current_ps_id; //Save ID for current power_supply 0 - 3.
 
 
 //*****************************************************************************
@@ -92,7 +91,9 @@ static struct serial_buffer send_buffer = {.index = 0};
 static struct bsmp_raw_packet recv_packet =
                              { .data = recv_buffer.data + 1 };
 static struct bsmp_raw_packet send_packet =
-                             { .data = send_buffer.data + 1 };
+                             { .data = send_buffer.data + 1,
+                               .max_len = SERIAL_BUF_SIZE - SERIAL_HEADER -
+                                          SERIAL_CSUM };
 
 //*****************************************************************************
 
@@ -194,6 +195,10 @@ void ihm_process_data(void)
     if(recv_buffer.csum)
         goto exit;
 
+    // Previous response still waiting for DSP acknowledge
+    if(bsmp_cmd_pending(&send_packet))
+        goto exit;
+
     // Packet is not for me
     if(recv_buffer.data[0] != SERIAL_CH_1_ADDRESS && recv_buffer.data[0] !=
             SERIAL_CH_2_ADDRESS && recv_buffer.data[0] != SERIAL_CH_3_ADDRESS
@@ -207,31 +212,34 @@ void ihm_process_data(void)
     //    (recv_buffer.data[0] == BCAST_ADDRESS))
     if (recv_buffer.data[0] == SERIAL_CH_0_ADDRESS)
     {
-        g_current_ps_id = 0;
         BSMPprocess(&recv_packet, &send_packet, 0, Local);
     }
 
     else if (recv_buffer.data[0] == SERIAL_CH_1_ADDRESS)
     {
-        g_current_ps_id = 1;
         BSMPprocess(&recv_packet, &send_packet, 1, Local);
     }
 
     else if (recv_buffer.data[0] == SERIAL_CH_2_ADDRESS)
     {
-        g_current_ps_id = 2;
         BSMPprocess(&recv_packet, &send_packet, 2, Local);
     }
 
     else if (recv_buffer.data[0] == SERIAL_CH_3_ADDRESS)
     {
-        g_current_ps_id = 3;
         BSMPprocess(&recv_packet, &send_packet, 3, Local);
     }
 
     //if (recv_buffer.data[0] != BCAST_ADDRESS)
     //{
-    ihm_tx_handler();
+    if(bsmp_cmd_pending(NULL))
+    {
+        bsmp_defer_response(&send_packet, ihm_tx_handler);
+    }
+    else
+    {
+        ihm_tx_handler();
+    }
     //}
 
     exit:
@@ -0,0 +1,208 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file ipc_layout.h
+ * @brief Shared memory layout schema
+ *
+ * Single description of every structure shared between ARM and C28 cores:
+ * the byte offset of each field, the size of each structure and the RAM
+ * block where it lives. ARM firmware includes this file from its IPC module,
+ * so any change on a shared structure which is not mirrored here, or which
+ * makes it outgrow its block, breaks the build. C28 firmware isn't part of
+ * this tree and doesn't include it: changes must be mirrored on C28 by hand,
+ * checking them against the values below. test/ipc_layout_test.c checks them
+ * on host builds too, so a change doesn't need a TI build to be caught.
+ *
+ * All values are in bytes. C28 addresses memory in 16-bit words, so sizes
+ * and offsets given by the compiler are scaled by LAYOUT_BYTES().
+ *
+ * Ownership of shared RAM (only the owner writes on a block):
+ *
+ *  Block       Address      Size     Owner   Contents
+ *  MTOCRAM     0x2007F800   0x600    ARM     g_ipc_mtoc
+ *  MTOCRING    0x2007FE00   0x100    ARM     g_ipc_mtoc_cmd_ring
+ *              0x2007FF00   0x100    ARM     g_ipc_mtoc_stream
+ *  CTOMRAM     0x2007F000   0x600    C28     g_ipc_ctom
+ *  CTOMRING    0x2007F600   0x100    C28     g_ipc_ctom_cmd_ring
+ *              0x2007F700   0x100    C28     g_ipc_ctom_stream
+ *  S0 (0-4k)   SHARERAMS0_0 0x1000   ARM     g_controller_mtoc
+ *  S0 (4-8k)   SHARERAMS0_1 0x1000   ARM     g_param_bank
+ *  S1 (0-4k)   SHARERAMS1_0 0x1000   C28     g_controller_ctom
+ *  S2-S5       SHARERAMS2345 0x8000  ARM     g_wfmref_data
+ *  S6-S7       SHARERAMS67  0x4000   C28     g_buf_samples_ctom
+ *
+ * Ring blocks hold two objects each. Linker command files of both cores pin
+ * them at LAYOUT_OFFSET_CMD_RING and LAYOUT_OFFSET_STREAM from the start of
+ * the block, so they never overlap.
+ *
+ * Enumerations on ARM are packed (TI EABI), so they are 1 or 2 bytes wide
+ * according to its range, which matches the 16-bit enums on C28.
+ *
+ * @author agent
+ * @date 16/10/2026
+ *
+ */
+
+#ifndef IPC_LAYOUT_H_
+#define IPC_LAYOUT_H_
+
+#include <stddef.h>
+#include <limits.h>
+#include "communication_drivers/control/control.h"
+#include "communication_drivers/control/wfmref/wfmref.h"
+#include "communication_drivers/parameters/ps_parameters.h"
+#include "communication_drivers/scope/scope.h"
+#include "ipc_lib.h"
+
+/**
+ * Shared RAM blocks sizes, as defined on linker command files
+ */
+#define LAYOUT_SIZE_MSG_RAM         0x600
+#define LAYOUT_SIZE_MSG_RING        0x200
+#define LAYOUT_SIZE_SHARED_RAM      0x1000
+#define LAYOUT_SIZE_SHARED_RAMS2345 0x8000
+#define LAYOUT_SIZE_SHARED_RAMS67   0x4000
+
+/**
+ * Offsets of the objects placed on ring blocks, as pinned on linker command
+ * files
+ */
+#define LAYOUT_OFFSET_CMD_RING      0x000
+#define LAYOUT_OFFSET_STREAM        0x100
+
+#define LAYOUT_BYTES(n)             ((n) * (CHAR_BIT / 8))
+
+/**
+ * Layout is checked by target compilers, and by host compilers when
+ * IPC_LAYOUT_CHECK is defined, building for 32-bit pointers and packed
+ * enumerations. Other host builds of tests have wider ones.
+ */
+#if defined(__TI_COMPILER_VERSION__) || defined(IPC_LAYOUT_CHECK)
+#define LAYOUT_ASSERT(name, cond)   typedef char layout_##name[(cond) ? 1 : -1]
+#else
+#define LAYOUT_ASSERT(name, cond)
+#endif
+
+/**
+ * Structures sizes: X(type, size)
+ */
+#define LAYOUT_SIZES(X)                 \
+    X(ipc_ctom_t,           1028)       \
+    X(ipc_mtoc_t,           1056)       \
+    X(ipc_mtoc_cmd_ring_t,  196)        \
+    X(ipc_ctom_cmd_ring_t,  72)         \
+    X(stream_mtoc_t,        4)          \
+    X(stream_ctom_t,        8)          \
+    X(control_framework_t,  4020)       \
+    X(param_bank_t,         2220)       \
+    X(u_wfmref_data_t,      32768)
+
+/**
+ * Fields offsets: X(type, field, offset)
+ */
+#define LAYOUT_FIELDS(X)                                    \
+    X(ipc_ctom_t,           udc_c28_version,        0)      \
+    X(ipc_ctom_t,           msg_mtoc,               32)     \
+    X(ipc_ctom_t,           msg_id,                 36)     \
+    X(ipc_ctom_t,           error_mtoc,             38)     \
+    X(ipc_ctom_t,           counter_set_slowref,    40)     \
+    X(ipc_ctom_t,           counter_sync_pulse,     44)     \
+    X(ipc_ctom_t,           period_sync_pulse,      48)     \
+    X(ipc_ctom_t,           ps_module,              52)     \
+    X(ipc_ctom_t,           siggen,                 228)    \
+    X(ipc_ctom_t,           wfmref,                 580)    \
+    X(ipc_ctom_t,           scope,                  868)    \
+                                                            \
+    X(ipc_mtoc_t,           msg_ctom,               0)      \
+    X(ipc_mtoc_t,           msg_id,                 4)      \
+    X(ipc_mtoc_t,           error_ctom,             6)      \
+    X(ipc_mtoc_t,           ps_name,                8)      \
+    X(ipc_mtoc_t,           ps_model,               72)     \
+    X(ipc_mtoc_t,           num_ps_modules,         74)     \
+    X(ipc_mtoc_t,           ps_module,              76)     \
+    X(ipc_mtoc_t,           siggen,                 252)    \
+    X(ipc_mtoc_t,           wfmref,                 604)    \
+    X(ipc_mtoc_t,           scope,                  892)    \
+    X(ipc_mtoc_t,           dsp_module,             1052)   \
+                                                            \
+    X(ipc_mtoc_cmd_ring_t,  write_idx,              0)      \
+    X(ipc_mtoc_cmd_ring_t,  ack_read_idx,           2)      \
+    X(ipc_mtoc_cmd_ring_t,  cmd,                    4)      \
+    X(ipc_ctom_cmd_ring_t,  version,                0)      \
+    X(ipc_ctom_cmd_ring_t,  read_idx,               2)      \
+    X(ipc_ctom_cmd_ring_t,  ack_write_idx,          4)      \
+    X(ipc_ctom_cmd_ring_t,  ack,                    8)      \
+                                                            \
+    X(stream_mtoc_t,        session,                0)      \
+    X(stream_mtoc_t,        tail,                   2)      \
+    X(stream_ctom_t,        session,                0)      \
+    X(stream_ctom_t,        head,                   2)      \
+    X(stream_ctom_t,        dropped,                4)      \
+                                                            \
+    X(control_framework_t,  net_signals,            0)      \
+    X(control_framework_t,  output_signals,         128)    \
+    X(control_framework_t,  dsp_modules,            192)    \
+    X(control_framework_t,  timeslicer,             3968)   \
+    X(control_framework_t,  dsp_coeffs_swap_mode,   4016)   \
+    X(control_framework_t,  dsp_coeffs_pending,     4018)   \
+                                                            \
+    X(param_bank_t,         ps_name,                768)    \
+    X(param_bank_t,         ps_model,               832)    \
+    X(param_bank_t,         num_ps_modules,         834)    \
+    X(param_bank_t,         communication,          836)    \
+    X(param_bank_t,         control,                864)    \
+    X(param_bank_t,         pwm,                    968)    \
+    X(param_bank_t,         hradc,                  996)    \
+    X(param_bank_t,         siggen,                 1060)   \
+    X(param_bank_t,         wfmref,                 1092)   \
+    X(param_bank_t,         analog_vars,            1156)   \
+    X(param_bank_t,         interlocks,             1668)   \
+    X(param_bank_t,         scope,                  2180)   \
+    X(param_bank_t,         password,               2212)   \
+    X(param_bank_t,         enable_onboard_eeprom,  2214)   \
+    X(param_bank_t,         type_memory,            2216)
+
+/**
+ * Shared RAM blocks contents: X(name, size used, room on block)
+ */
+#define LAYOUT_BLOCKS(X)                                                    \
+    X(mtoc_ram,     sizeof(ipc_mtoc_t),             LAYOUT_SIZE_MSG_RAM)    \
+    X(ctom_ram,     sizeof(ipc_ctom_t),             LAYOUT_SIZE_MSG_RAM)    \
+    X(mtoc_cmd_ring, sizeof(ipc_mtoc_cmd_ring_t),                           \
+                    LAYOUT_OFFSET_STREAM - LAYOUT_OFFSET_CMD_RING)          \
+    X(mtoc_stream,  NUM_MAX_SCOPES*sizeof(stream_mtoc_t),                   \
+                    LAYOUT_SIZE_MSG_RING - LAYOUT_OFFSET_STREAM)            \
+    X(ctom_cmd_ring, sizeof(ipc_ctom_cmd_ring_t),                           \
+                    LAYOUT_OFFSET_STREAM - LAYOUT_OFFSET_CMD_RING)          \
+    X(ctom_stream,  NUM_MAX_SCOPES*sizeof(stream_ctom_t),                   \
+                    LAYOUT_SIZE_MSG_RING - LAYOUT_OFFSET_STREAM)            \
+    X(s0_0,         sizeof(control_framework_t),    LAYOUT_SIZE_SHARED_RAM) \
+    X(s0_1,         sizeof(param_bank_t),           LAYOUT_SIZE_SHARED_RAM) \
+    X(s1_0,         sizeof(control_framework_t),    LAYOUT_SIZE_SHARED_RAM) \
+    X(s2345,        sizeof(u_wfmref_data_t),        LAYOUT_SIZE_SHARED_RAMS2345) \
+    X(s67,          SIZE_BUF_SAMPLES_CTOM*sizeof(u_float_t),                \
+                                                    LAYOUT_SIZE_SHARED_RAMS67)
+
+#define LAYOUT_CHECK_SIZE(type, size)                                       \
+    LAYOUT_ASSERT(size_##type, LAYOUT_BYTES(sizeof(type)) == (size));
+
+#define LAYOUT_CHECK_FIELD(type, field, offset)                             \
+    LAYOUT_ASSERT(offset_##type##_##field,                                  \
+                  LAYOUT_BYTES(offsetof(type, field)) == (offset));
+
+#define LAYOUT_CHECK_BLOCK(name, used, size)                                \
+    LAYOUT_ASSERT(block_##name, LAYOUT_BYTES(used) <= (size));
+
+LAYOUT_SIZES(LAYOUT_CHECK_SIZE)
+LAYOUT_FIELDS(LAYOUT_CHECK_FIELD)
+LAYOUT_BLOCKS(LAYOUT_CHECK_BLOCK)
+
+#endif /* IPC_LAYOUT_H_ */
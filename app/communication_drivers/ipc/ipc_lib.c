@@ -22,6 +22,8 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 
 #include "inc/hw_memmap.h"
 #include "inc/hw_ipc.h"
@@ -36,6 +38,7 @@
 #include "communication_drivers/i2c_onboard/exio.h"
 
 #include "ipc_lib.h"
+#include "ipc_layout.h"
 
 #define M3_CTOMMSGRAM_START         0x2007F000
 #define C28_CTOMMSGRAM_START        0x0003F800
@@ -57,6 +60,23 @@ volatile u_float_t g_buf_samples_ctom[SIZE_BUF_SAMPLES_CTOM];
 volatile ipc_ctom_t g_ipc_ctom;
 volatile ipc_mtoc_t g_ipc_mtoc;
 
+#pragma DATA_SECTION(g_ipc_ctom_cmd_ring, "CTOM_CMD_RING")
+#pragma DATA_SECTION(g_ipc_mtoc_cmd_ring, "MTOC_CMD_RING")
+volatile ipc_ctom_cmd_ring_t g_ipc_ctom_cmd_ring;
+volatile ipc_mtoc_cmd_ring_t g_ipc_mtoc_cmd_ring;
+
+#pragma DATA_SECTION(g_ipc_ctom_stream, "CTOM_STREAM")
+#pragma DATA_SECTION(g_ipc_mtoc_stream, "MTOC_STREAM")
+volatile stream_ctom_t g_ipc_ctom_stream[NUM_MAX_SCOPES];
+volatile stream_mtoc_t g_ipc_mtoc_stream[NUM_MAX_SCOPES];
+
+shared_buf_t g_shared_bufs[NUM_SHARED_BUFS];
+
+/**
+ * Result of acknowledged commands, indexed by sequence number
+ */
+static error_mtoc_t cmd_ring_result[IPC_CMD_RING_SIZE];
+
 void isr_ipc_lowpriority_msg(void);
 void init_parameters(void);
 
@@ -71,6 +91,9 @@ void init_ipc(void)
     g_ipc_mtoc.msg_id = 0;
     g_ipc_mtoc.error_ctom = No_Error_CtoM;
 
+    g_ipc_mtoc_cmd_ring.write_idx = 0;
+    g_ipc_mtoc_cmd_ring.ack_read_idx = 0;
+
     /**
      * Initialize PS modules
      */
@@ -88,6 +111,9 @@ void init_ipc(void)
         g_ipc_mtoc.ps_module[uiloop].ps_hard_interlock.u32 = 0;
 
         g_ipc_mtoc.siggen[uiloop].enable.u16 = 0;
+
+        g_ipc_mtoc_stream[uiloop].session = 0;
+        g_ipc_mtoc_stream[uiloop].tail = 0;
     }
 
     for (uiloop = 0; uiloop < (uint8_t) get_param(Num_PS_Modules,0); uiloop++)
@@ -125,33 +151,50 @@ void init_ipc(void)
 /**
  * Send IPC MtoC message. This function must be used with care, because it
  * directly sets MTOCIPC register bits according to the argument 'msg' when
- * there's no pending messages.
+ * there's no pending messages. Command ring doorbell doesn't count, as it
+ * doesn't use MSG_ID_MTOC.
  *
  * @param msg_id specified IPC module
  * @param msg specified message
+ *
+ * @return true if message was sent, false if another one is pending
  */
-void send_ipc_msg(uint16_t msg_id, uint32_t msg)
+bool send_ipc_msg(uint16_t msg_id, uint32_t msg)
 {
-    if(HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) == 0x00000000)
+    if((HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) & ~IPC_MTOC_CMD_RING) ==
+       0x00000000)
     {
         MSG_ID_MTOC = msg_id;
         HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCSET) = msg;
+        return true;
     }
+
+    return false;
 }
 
 /**
  * @brief Send IPC low priority message
  *
  * This function sets MTOC_IPCSET with the message type as defined in
- * ipc_mtoc_lowpriority_msg_t.
+ * ipc_mtoc_lowpriority_msg_t. If C28 serves the command ring, message is
+ * queued on it instead, and ipc_cmd_ring_last_seq() identifies it.
  *
  * @param uint16_t ID of message. 0 - 3
  * @param ipc_mtoc_lowpriority_msg_t Message type.
+ *
+ * @return true if message was sent, false if command ring is full
  */
-void send_ipc_lowpriority_msg(uint16_t msg_id, ipc_mtoc_lowpriority_msg_t msg)
+bool send_ipc_lowpriority_msg(uint16_t msg_id, ipc_mtoc_lowpriority_msg_t msg)
 {
+    if(ipc_cmd_ring_enabled())
+    {
+        return ipc_cmd_ring_send(msg_id, msg, 0);
+    }
+
     MSG_ID_MTOC = msg_id;
     HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCSET) |= low_priority_msg_to_reg(msg);
+
+    return true;
 }
 
 /**
@@ -166,6 +209,150 @@ uint32_t low_priority_msg_to_reg(ipc_mtoc_lowpriority_msg_t msg)
     return ((msg << 4) | IPC_MTOC_LOWPRIORITY_MSG) & 0x0000FFFF;
 }
 
+/**
+ * @brief Check whether C28 serves the command ring
+ *
+ * @return true if C28 advertises a compatible ring version
+ */
+bool ipc_cmd_ring_enabled(void)
+{
+    return g_ipc_ctom_cmd_ring.version == IPC_CMD_RING_VERSION;
+}
+
+/**
+ * @brief Read acknowledges posted by C28 on the ack ring
+ */
+static void ipc_cmd_ring_read_acks(void)
+{
+    uint16_t idx = g_ipc_mtoc_cmd_ring.ack_read_idx;
+
+    while(idx != g_ipc_ctom_cmd_ring.ack_write_idx)
+    {
+        cmd_ring_result[g_ipc_ctom_cmd_ring.ack[idx & IPC_CMD_RING_MASK].seq &
+                        IPC_CMD_RING_MASK] =
+            (error_mtoc_t) g_ipc_ctom_cmd_ring.ack[idx & IPC_CMD_RING_MASK].result;
+        idx++;
+    }
+
+    g_ipc_mtoc_cmd_ring.ack_read_idx = idx;
+}
+
+/**
+ * @brief Check if command ring is full
+ *
+ * A slot is only released after its acknowledge is read, so the ack ring
+ * never overflows either.
+ *
+ * @return true if there's no room for a new command
+ */
+bool ipc_cmd_ring_full(void)
+{
+    ipc_cmd_ring_read_acks();
+
+    return (uint16_t) (g_ipc_mtoc_cmd_ring.write_idx -
+                       g_ipc_mtoc_cmd_ring.ack_read_idx) >= IPC_CMD_RING_SIZE;
+}
+
+/**
+ * @brief Queue command on command ring and ring the doorbell
+ *
+ * Entry is completely written before write index is published. C28 must
+ * acknowledge the doorbell flag before reading the ring, so entries queued
+ * meanwhile set it again. Sequence number is the free-running write index,
+ * given by ipc_cmd_ring_last_seq().
+ *
+ * @param ps_id power supply ID
+ * @param msg message type
+ * @param payload message argument, if not already on shared structures
+ * @return true if command was queued, false if ring is full
+ */
+bool ipc_cmd_ring_send(uint16_t ps_id, ipc_mtoc_lowpriority_msg_t msg,
+                       uint32_t payload)
+{
+    uint16_t seq;
+    volatile ipc_cmd_t *p_cmd;
+
+    if(ipc_cmd_ring_full())
+    {
+        return false;
+    }
+
+    seq = g_ipc_mtoc_cmd_ring.write_idx;
+    p_cmd = &g_ipc_mtoc_cmd_ring.cmd[seq & IPC_CMD_RING_MASK];
+
+    p_cmd->seq = seq;
+    p_cmd->msg = msg;
+    p_cmd->ps_id = ps_id;
+    p_cmd->payload.u32 = payload;
+
+    g_ipc_mtoc_cmd_ring.write_idx = seq + 1;
+    HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCSET) = IPC_MTOC_CMD_RING;
+
+    return true;
+}
+
+/**
+ * @brief Get sequence number of last command queued on command ring
+ */
+uint16_t ipc_cmd_ring_last_seq(void)
+{
+    return g_ipc_mtoc_cmd_ring.write_idx - 1;
+}
+
+/**
+ * @brief Check whether C28 has acknowledged specified command
+ *
+ * C28 acknowledges commands in the same order they were queued, so every
+ * command older than the oldest one not acknowledged is complete. Result is
+ * available until IPC_CMD_RING_SIZE newer commands are acknowledged.
+ *
+ * @param seq sequence number of command
+ * @param p_result pointer to store command result. NULL if not used.
+ * @return true if command was acknowledged
+ */
+bool ipc_cmd_ring_acked(uint16_t seq, error_mtoc_t *p_result)
+{
+    ipc_cmd_ring_read_acks();
+
+    if( (uint16_t) (g_ipc_mtoc_cmd_ring.write_idx - seq) <=
+        (uint16_t) (g_ipc_mtoc_cmd_ring.write_idx -
+                    g_ipc_mtoc_cmd_ring.ack_read_idx) )
+    {
+        return false;
+    }
+
+    if(p_result != NULL)
+    {
+        *p_result = cmd_ring_result[seq & IPC_CMD_RING_MASK];
+    }
+
+    return true;
+}
+
+/**
+ * @brief Register buffer on shared RAM
+ *
+ * Store ARM and C28 views of buffer, so its users don't need to translate
+ * addresses on every access.
+ *
+ * @param buf_id stable ID of buffer
+ * @param p_start start of buffer on ARM memory map
+ * @param size buffer size [bytes]
+ */
+void register_shared_buf(uint16_t buf_id, volatile void *p_start,
+                         uint32_t size)
+{
+    shared_buf_t *p_buf;
+
+    if(buf_id < NUM_SHARED_BUFS)
+    {
+        p_buf = &g_shared_bufs[buf_id];
+        p_buf->p_m3 = (uint8_t *) p_start;
+        p_buf->c28_start = ipc_mtoc_translate((uint32_t) p_start);
+        p_buf->size = size;
+    }
+}
+
 /**
  * @brief Function to convert Shared Memory Adress from Master to Control.
  *
@@ -24,6 +24,7 @@
 #define IPC_LIB_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "board_drivers/version.h"
 #include "communication_drivers/control/dsp.h"
 #include "communication_drivers/control/siggen/siggen.h"
@@ -52,9 +53,38 @@
 #define HARD_INTERLOCK              0x00000004  // IPC3
 #define SOFT_INTERLOCK              0x00000008  // IPC4
 
+/**
+ * Low priority messages take IPC1 and IPC5-16 (see low_priority_msg_to_reg()),
+ * so the command ring doorbell is kept above them
+ */
+#define IPC_MTOC_CMD_RING           0x00010000  // IPC17: command ring doorbell
+
 #define MSG_ID_MTOC                 g_ipc_mtoc.msg_id
 #define MSG_ID_CTOM                 g_ipc_ctom.msg_id
 
+/**
+ * Command ring defines. Ring size must be a power of 2. C28 sets version field
+ * on its side of the ring with IPC_CMD_RING_VERSION when it serves the rings,
+ * otherwise low priority messages are sent through IPC1 flag.
+ */
+#define IPC_CMD_RING_SIZE           16
+#define IPC_CMD_RING_MASK           (IPC_CMD_RING_SIZE - 1)
+#define IPC_CMD_RING_VERSION        0x0001
+
+/**
+ * Shared buffers registry. Each buffer has a stable ID, which is the same as
+ * its BSMP curve on the server of its power supply. Views of ARM and C28 are
+ * computed once, when buffer is registered.
+ */
+#define NUM_SHARED_BUFS                     (NUM_MAX_PS_MODULES*NUM_WFMREF_CURVES)
+#define SHARED_BUF_ID_WFMREF(ps_id, curve)  ((ps_id)*NUM_WFMREF_CURVES + (curve))
+
+/**
+ * C28 address of a given byte offset within registered buffer. C28 addresses
+ * 16-bit words.
+ */
+#define SHARED_BUF_C28_ADD(p_buf, offset)   ((p_buf)->c28_start + ((offset) >> 1))
+
 typedef enum
 {
     Turn_On = 1,
@@ -123,7 +153,7 @@ typedef volatile struct
     char            udc_c28_version[2*SIZE_VERSION]; // C28 char = 2 bytes
     uint32_t        msg_mtoc;
     uint16_t        msg_id;
-    error_mtoc_t    error_mtoc;
+    uint16_t        error_mtoc;     // error_mtoc_t
     union
     {
         uint8_t     u8[4];
@@ -166,17 +196,75 @@ typedef volatile struct
     //param_interlocks_t      interlocks;
 } ipc_mtoc_t;
 
+/**
+ * Command ring. Each core only writes on its own message RAM, so M3 owns the
+ * command entries and the ack read index, while C28 owns the ack entries and
+ * the command read index. Indexes are free-running and masked on access.
+ */
+typedef volatile struct
+{
+    uint16_t    seq;
+    uint16_t    msg;        // ipc_mtoc_lowpriority_msg_t
+    uint16_t    ps_id;
+    uint16_t    rsvd;
+    u_uint32_t  payload;
+} ipc_cmd_t;
+
+typedef volatile struct
+{
+    uint16_t    seq;
+    uint16_t    result;     // error_mtoc_t
+} ipc_cmd_ack_t;
+
+typedef volatile struct
+{
+    uint16_t        write_idx;
+    uint16_t        ack_read_idx;
+    ipc_cmd_t       cmd[IPC_CMD_RING_SIZE];
+} ipc_mtoc_cmd_ring_t;
+
+typedef volatile struct
+{
+    uint16_t        version;
+    uint16_t        read_idx;
+    uint16_t        ack_write_idx;
+    uint16_t        rsvd;
+    ipc_cmd_ack_t   ack[IPC_CMD_RING_SIZE];
+} ipc_ctom_cmd_ring_t;
+
+typedef struct
+{
+    uint8_t     *p_m3;          // Buffer start on ARM memory map
+    uint32_t    c28_start;      // Buffer start on C28 memory map
+    uint32_t    size;           // Buffer size [bytes], 0 if not registered
+} shared_buf_t;
+
 extern volatile u_float_t g_buf_samples_ctom[SIZE_BUF_SAMPLES_CTOM];
 
 extern volatile ipc_ctom_t g_ipc_ctom;
 extern volatile ipc_mtoc_t g_ipc_mtoc;
+extern volatile ipc_mtoc_cmd_ring_t g_ipc_mtoc_cmd_ring;
+extern volatile ipc_ctom_cmd_ring_t g_ipc_ctom_cmd_ring;
+extern volatile stream_mtoc_t g_ipc_mtoc_stream[NUM_MAX_SCOPES];
+extern volatile stream_ctom_t g_ipc_ctom_stream[NUM_MAX_SCOPES];
+extern shared_buf_t g_shared_bufs[NUM_SHARED_BUFS];
 
 extern void init_ipc(void);
-extern void send_ipc_msg(uint16_t msg_id, uint32_t flag);
-extern void send_ipc_lowpriority_msg(uint16_t msg_id,
+extern bool send_ipc_msg(uint16_t msg_id, uint32_t flag);
+extern bool send_ipc_lowpriority_msg(uint16_t msg_id,
                                      ipc_mtoc_lowpriority_msg_t msg);
 extern uint32_t low_priority_msg_to_reg(ipc_mtoc_lowpriority_msg_t msg);
 
+extern bool ipc_cmd_ring_enabled(void);
+extern bool ipc_cmd_ring_full(void);
+extern bool ipc_cmd_ring_send(uint16_t ps_id, ipc_mtoc_lowpriority_msg_t msg,
+                              uint32_t payload);
+extern uint16_t ipc_cmd_ring_last_seq(void);
+extern bool ipc_cmd_ring_acked(uint16_t seq, error_mtoc_t *p_result);
+
+extern void register_shared_buf(uint16_t buf_id, volatile void *p_start,
+                                uint32_t size);
+
 extern uint32_t ipc_mtoc_translate (uint32_t ulShareAddress);
 extern uint32_t ipc_ctom_translate (uint32_t ulShareAddress);
 extern uint16_t ipc_mtoc_busy (uint32_t ulFlags);
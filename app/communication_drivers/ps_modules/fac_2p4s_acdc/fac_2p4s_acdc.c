@@ -128,6 +128,24 @@ static void adcp_channel_config(void)
     g_analog_ch_7.Enable = 0;
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35
+};
+
+/**
+ * Variables of the IIB telemetry group
+ */
+static const uint8_t bsmp_group_iib[] =
+{
+    36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54,
+    55, 56, 57, 58
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -172,6 +190,11 @@ static void bsmp_init_server(void)
     create_bsmp_var(57, MOD_A_ID, 4, false, fac_2p4s_acdc_cmd[MOD_A_ID].InterlocksRegister.u8);
     create_bsmp_var(58, MOD_A_ID, 4, false, fac_2p4s_acdc_cmd[MOD_A_ID].AlarmsRegister.u8);
 
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_A_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
+    create_bsmp_group(BSMP_GROUP_ID_IIB, MOD_A_ID, bsmp_group_iib,
+                      sizeof(bsmp_group_iib));
+
     /**
      * Create module B specific variables
      */
@@ -216,6 +239,11 @@ static void bsmp_init_server(void)
     create_bsmp_var(56, MOD_B_ID, 4, false, fac_2p4s_acdc_cmd[MOD_B_ID].RelativeHumidity.u8);
     create_bsmp_var(57, MOD_B_ID, 4, false, fac_2p4s_acdc_cmd[MOD_B_ID].InterlocksRegister.u8);
     create_bsmp_var(58, MOD_B_ID, 4, false, fac_2p4s_acdc_cmd[MOD_B_ID].AlarmsRegister.u8);
+
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_B_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
+    create_bsmp_group(BSMP_GROUP_ID_IIB, MOD_B_ID, bsmp_group_iib,
+                      sizeof(bsmp_group_iib));
 }
 
 /**
@@ -202,6 +202,25 @@ static void adcp_channel_config(void)
     g_analog_ch_7.Value = &(V_CAPBANK_MOD_8.f);
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 82
+};
+
+/**
+ * Variables of the IIB telemetry group
+ */
+static const uint8_t bsmp_group_iib[] =
+{
+    54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72,
+    73, 74, 75, 76, 77, 78, 79, 80, 81
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -288,6 +307,11 @@ static void bsmp_init_server(void)
         create_bsmp_var(81, server, 4, false, iib_fac_2p4s_dcdc[server*2+1].AlarmsRegister.u8);
 
         create_bsmp_var(82, server, 4, false, g_ipc_ctom.ps_module[0].ps_alarms.u8);
+
+        create_bsmp_group(BSMP_GROUP_ID_STATUS, server, bsmp_group_status,
+                          sizeof(bsmp_group_status));
+        create_bsmp_group(BSMP_GROUP_ID_IIB, server, bsmp_group_iib,
+                          sizeof(bsmp_group_iib));
     }
 }
 
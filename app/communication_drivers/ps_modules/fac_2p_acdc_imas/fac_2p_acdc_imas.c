@@ -107,6 +107,15 @@ static void adcp_channel_config(void)
     g_analog_ch_7.Enable = 0;
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -124,6 +133,9 @@ static void bsmp_init_server(void)
     create_bsmp_var(34, MOD_A_ID, 4, false, IOUT_RECT_MOD_A.u8);
     create_bsmp_var(35, MOD_A_ID, 4, false, DUTY_CYCLE_MOD_A.u8);
 
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_A_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
+
     /**
      * Create module B specific variables
      */
@@ -141,6 +153,9 @@ static void bsmp_init_server(void)
     create_bsmp_var(33, MOD_B_ID, 4, false, V_CAPBANK_MOD_B.u8);
     create_bsmp_var(34, MOD_B_ID, 4, false, IOUT_RECT_MOD_B.u8);
     create_bsmp_var(35, MOD_B_ID, 4, false, DUTY_CYCLE_MOD_B.u8);
+
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_B_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
 }
 
 /**
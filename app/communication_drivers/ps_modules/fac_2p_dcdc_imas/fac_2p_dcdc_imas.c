@@ -109,6 +109,15 @@ static void adcp_channel_config(void)
     g_analog_ch_7.Enable = 0;
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -133,6 +142,9 @@ static void bsmp_init_server(void)
     create_bsmp_var(40, 0, 4, false, DUTY_CYCLE_MOD_1.u8);
     create_bsmp_var(41, 0, 4, false, DUTY_CYCLE_MOD_2.u8);
     create_bsmp_var(42, 0, 4, false, DUTY_ARMS_DIFF.u8);
+
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, 0, bsmp_group_status,
+                      sizeof(bsmp_group_status));
 }
 
 /**
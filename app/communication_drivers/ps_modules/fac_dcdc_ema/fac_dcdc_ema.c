@@ -119,6 +119,23 @@ static void adcp_channel_config(void)
     g_analog_ch_7.Enable = 0;
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35, 36, 51
+};
+
+/**
+ * Variables of the IIB telemetry group
+ */
+static const uint8_t bsmp_group_iib[] =
+{
+    37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -153,6 +170,11 @@ static void bsmp_init_server(void)
     create_bsmp_var(50, 0, 4, false, iib_fac_os.AlarmsRegister.u8);
 
     create_bsmp_var(51, 0, 4, false, g_ipc_ctom.ps_module[0].ps_alarms.u8);
+
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, 0, bsmp_group_status,
+                      sizeof(bsmp_group_status));
+    create_bsmp_group(BSMP_GROUP_ID_IIB, 0, bsmp_group_iib,
+                      sizeof(bsmp_group_iib));
 }
 
 /**
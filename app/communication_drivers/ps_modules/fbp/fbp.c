@@ -138,6 +138,16 @@ static void adcp_channel_config(void)
     g_analog_ch_5.Value = &(PS4_LOAD_VOLTAGE.f);
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35, 36, 37, 38, 46, 47, 48, 49, 50, 51, 52, 53, 54,
+    55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -233,6 +243,9 @@ static void bsmp_init_server(void)
         create_bsmp_var(71, server, 4, false, g_ipc_ctom.ps_module[PS2_ID].ps_alarms.u8);
         create_bsmp_var(72, server, 4, false, g_ipc_ctom.ps_module[PS3_ID].ps_alarms.u8);
         create_bsmp_var(73, server, 4, false, g_ipc_ctom.ps_module[PS4_ID].ps_alarms.u8);
+
+        create_bsmp_group(BSMP_GROUP_ID_STATUS, server, bsmp_group_status,
+                          sizeof(bsmp_group_status));
     }
 
 }
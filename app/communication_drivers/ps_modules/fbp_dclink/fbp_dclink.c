@@ -98,6 +98,15 @@ static void adcp_channel_config(void)
     g_analog_ch_7.Enable = 0;
 }
 
+/**
+ * Variables of the fast status group: status, references, interlocks and
+ * control measurements
+ */
+static const uint8_t bsmp_group_status[] =
+{
+    0, 1, 2, 31, 32, 33, 34, 35, 36, 37, 38
+};
+
 /**
 * @brief Initialize BSMP servers.
 *
@@ -115,6 +124,9 @@ static void bsmp_init_server(void)
     create_bsmp_var(37, MOD_1_ID, 4, false, V_PS3_OUTPUT.u8);
     create_bsmp_var(38, MOD_1_ID, 1, false, DIGITAL_POT_VOLTAGE.u8);
 
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_1_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
+
     /// Module 1 BSMP server already initialized
 
     /// Module 2 initialization
@@ -134,6 +146,9 @@ static void bsmp_init_server(void)
     create_bsmp_var(37, MOD_2_ID, 4, false, V_PS3_OUTPUT.u8);
     create_bsmp_var(38, MOD_2_ID, 1, false, DIGITAL_POT_VOLTAGE.u8);
 
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_2_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
+
     /// Module 3 initialization
     bsmp_init(MOD_3_ID);
 
@@ -150,6 +165,9 @@ static void bsmp_init_server(void)
     create_bsmp_var(36, MOD_3_ID, 4, false, V_PS2_OUTPUT.u8);
     create_bsmp_var(37, MOD_3_ID, 4, false, V_PS3_OUTPUT.u8);
     create_bsmp_var(38, MOD_3_ID, 1, false, DIGITAL_POT_VOLTAGE.u8);
+
+    create_bsmp_group(BSMP_GROUP_ID_STATUS, MOD_3_ID, bsmp_group_status,
+                      sizeof(bsmp_group_status));
 }
 
 /**
@@ -98,11 +98,21 @@ typedef struct
     uint16_t        reserved   : 2;    // 15:14    Reserved for future use
 } ps_status_bits_t;
 
+/**
+ * Status word is followed by a sequence counter, which C28 increments before
+ * and after updating the module, so ARM can take consistent snapshots. It
+ * takes the padding before next field in both cores, so layout is unchanged.
+ */
 typedef union
 {
     uint8_t             u8[2];
     uint16_t            all;
     ps_status_bits_t    bit;
+    struct
+    {
+        uint16_t        status;
+        uint16_t        seq;
+    } sync;
 } ps_status_t;
 
 typedef struct
@@ -31,6 +31,7 @@
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
 #include "inc/hw_gpio.h"
+#include "inc/hw_uart.h"
 
 #include "driverlib/gpio.h"
 #include "driverlib/sysctl.h"
@@ -39,6 +40,7 @@
 #include "driverlib/systick.h"
 #include "driverlib/debug.h"
 #include "driverlib/ram.h"
+#include "driverlib/udma.h"
 
 #include "board_drivers/hardware_def.h"
 
@@ -54,11 +56,20 @@
 // Put the code in to the RAM memory
 #pragma CODE_SECTION(isr_rs485, "ramfuncs");
 #pragma CODE_SECTION(rs485_process_data, "ramfuncs");
+#pragma CODE_SECTION(rs485_rx_dma_arm, "ramfuncs");
+#pragma CODE_SECTION(rs485_rx_dma_start, "ramfuncs");
+#pragma CODE_SECTION(rs485_rx_next_frame, "ramfuncs");
+#pragma CODE_SECTION(rs485_rx_rewind, "ramfuncs");
+#pragma CODE_SECTION(rs485_is_my_address, "ramfuncs");
+#pragma CODE_SECTION(rs485_tx_dma_arm, "ramfuncs");
+#pragma CODE_SECTION(rs485_csum, "ramfuncs");
 
 //*****************************************************************************
 
 #pragma DATA_SECTION(recv_buffer, "SERIALBUFFER")
 #pragma DATA_SECTION(send_buffer, "SERIALBUFFER")
+#pragma DATA_ALIGN(recv_buffer, 4)
+#pragma DATA_ALIGN(send_buffer, 4)
 
 //*****************************************************************************
 
@@ -72,6 +83,27 @@
 #define LOW_SPEED_BAUD          115200
 
 #define BAUDRATE_DEFAULT        HIGH_SPEED_BAUD
+#define BAUDRATE_MAX            6000000
+#define BAUDRATE_MIN            9600
+
+#define BAUDRATE_TRIAL_TIMEOUT  1000    // 1000 ms without valid frame
+
+/**
+ * RX uDMA transfers bursts of 4 bytes, requested when RX FIFO holds 8 bytes
+ * (UART_FIFO_RX4_8). At least 4 bytes at the end of a frame (or the whole
+ * frame, if shorter) are left in FIFO, so the receive timeout interrupt always
+ * signals the idle line.
+ */
+#define DMA_CHUNK_SIZE          1024    // Maximum uDMA transfer size
+
+/**
+ * Received frames are queued back to back in recv_buffer, which holds one
+ * maximum size frame plus some short ones. Together with send_buffer, it must
+ * fit in SERIALBUFFER.
+ */
+#define RX_BUF_SIZE             (SERIAL_BUF_SIZE + 6144)
+#define RX_QUEUE_SIZE           8       // Must be a power of 2
+#define RX_QUEUE_MASK           (RX_QUEUE_SIZE - 1)
 
 static uint8_t SERIAL_CH_0_ADDRESS = 1;
 static uint8_t SERIAL_CH_1_ADDRESS = 2;
@@ -80,7 +112,6 @@ static uint8_t SERIAL_CH_3_ADDRESS = 4;
 
 static uint8_t BCAST_ADDRESS  = 255; // Broadcast Address
 
-volatile uint8_t g_current_ps_id; //Save ID for current power_supply 0 - 3.
 
 
 //*****************************************************************************
@@ -91,223 +122,597 @@ struct serial_buffer
     uint8_t csum;
 };
 
-static struct serial_buffer recv_buffer = {.index = 0};
+static uint8_t recv_buffer[RX_BUF_SIZE];
 static struct serial_buffer send_buffer = {.index = 0};
 
-static struct bsmp_raw_packet recv_packet =
-                             { .data = recv_buffer.data + 1 };
+static struct bsmp_raw_packet recv_packet;
+
+/**
+ * Frame completed by RX interrupt, to be processed by rs485_process_data()
+ */
+typedef struct
+{
+    uint16_t    start;      // Offset of frame in recv_buffer
+    uint16_t    len;
+} rs485_frame_t;
+
+/**
+ * Queue of received frames, processed from main loop. Only the ISR writes
+ * head and only rs485_process_data() writes tail, so no locking is needed.
+ * A frame stays in recv_buffer until it's released by rs485_process_data().
+ */
+static struct
+{
+    rs485_frame_t       frame[RX_QUEUE_SIZE];
+    volatile uint8_t    head;
+    volatile uint8_t    tail;
+} rx_queue;
+
+volatile rs485_rx_stats_t g_rs485_rx_stats;
+
+/**
+ * RX uDMA runs in ping-pong mode over consecutive chunks of recv_buffer, so a
+ * frame is received without CPU intervention. Each control structure (0:
+ * primary, 1: alternate) is rearmed with the next chunk as soon as it's done.
+ */
+static struct
+{
+    uint16_t    start[2];   // Offset of chunk of each control structure
+    uint16_t    size[2];    // Size of chunk of each control structure
+    uint16_t    next;       // Offset of next chunk to be armed
+    uint16_t    frame;      // Offset of frame being received
+    uint16_t    end;        // End of free region for frame being received
+    uint8_t     active;     // Control structure being filled
+} rx_dma;
+
+/**
+ * TX uDMA also runs in ping-pong mode over consecutive chunks of send_buffer.
+ * Transmission is done when both control structures are left stopped.
+ */
+static struct
+{
+    uint16_t    size[2];    // Size of chunk of each control structure
+    uint16_t    next;       // Offset of next chunk to be armed
+    uint16_t    end;        // Size of frame being transmitted
+    uint8_t     active;     // Control structure being transmitted
+} tx_dma;
+
+static volatile bool tx_busy = false;
+
+static const uint32_t dma_select[2] = {UDMA_PRI_SELECT, UDMA_ALT_SELECT};
 static struct bsmp_raw_packet send_packet =
-                             { .data = send_buffer.data + 1 };
+                             { .data = send_buffer.data + 1,
+                               .max_len = SERIAL_BUF_SIZE - SERIAL_HEADER -
+                                          SERIAL_CSUM };
 
 //*****************************************************************************
 
-static uint8_t MessageOverflow = 0;
 static uint32_t baudrate = 0;
 
+/**
+ * Baud-rate proposed by master is applied right after the response to the
+ * proposal. It's kept on trial until a valid frame is received at the new
+ * rate, otherwise the previous one is restored.
+ */
+static volatile uint32_t baudrate_next = 0;     // Proposed rate. 0 if none.
+static uint32_t baudrate_prev = 0;              // Rate restored upon fallback
+static volatile uint16_t baudrate_trial = 0;    // Trial time left [ms]
+
 //*****************************************************************************
 
-void isr_rs485(void)
+/**
+ * @brief Arm RX uDMA control structure with next chunk of recv_buffer
+ *
+ * Control structure is stopped if free region of recv_buffer is full. It may
+ * still be armed from a frame which ended before it was done, and ping-pong
+ * mode would switch to it once the other one is done.
+ *
+ * @param sel control structure (0: primary, 1: alternate)
+ */
+static void rs485_rx_dma_arm(uint8_t sel)
 {
-	//uint32_t lChar;
-	uint16_t sCarga;
-	//uint8_t ucChar;
-	uint32_t ulStatus;
+    uint16_t size = rx_dma.end - rx_dma.next;
+
+    if(size > DMA_CHUNK_SIZE)
+    {
+        size = DMA_CHUNK_SIZE;
+    }
 
-	uint8_t time_out = 0;
+    rx_dma.start[sel] = rx_dma.next;
+    rx_dma.size[sel]  = size;
 
-	// Get the interrrupt status.
-	ulStatus = UARTIntStatus(RS485_UART_BASE, true);
+    if(size)
+    {
+        uDMAChannelTransferSet(RS485_UART_RX_UDMA | dma_select[sel],
+                               UDMA_MODE_PINGPONG,
+                               (void *)(RS485_UART_BASE + UART_O_DR),
+                               &recv_buffer[rx_dma.next], size);
+        rx_dma.next += size;
+    }
+    else
+    {
+        uDMAChannelTransferSet(RS485_UART_RX_UDMA | dma_select[sel],
+                               UDMA_MODE_STOP,
+                               (void *)(RS485_UART_BASE + UART_O_DR),
+                               &recv_buffer[rx_dma.next], 1);
+    }
+}
 
-	// Clear the asserted interrupts.
-	UARTIntClear(RS485_UART_BASE, ulStatus);
+/**
+ * @brief Start RX uDMA at specified offset of recv_buffer
+ *
+ * @param offset where next received byte is written
+ */
+static void rs485_rx_dma_start(uint16_t offset)
+{
+    uDMAChannelDisable(RS485_UART_RX_UDMA);
+    uDMAChannelAttributeDisable(RS485_UART_RX_UDMA, UDMA_ATTR_ALTSELECT);
 
-	if(UARTRxErrorGet(RS485_UART_BASE)) UARTRxErrorClear(RS485_UART_BASE);
+    rx_dma.next   = offset;
+    rx_dma.active = 0;
 
-	// Receive Interrupt Mask
-	if(UART_INT_RX == ulStatus || UART_INT_RT == ulStatus)
-	{
-	    // Low baud-rate
-	    if(baudrate < 1000000)
-	    {
-            for(time_out = 0; time_out < 15; time_out++)
-            {
-                // Loop while there are characters in the receive FIFO.
-                while(UARTCharsAvail(RS485_UART_BASE) &&
-                      recv_buffer.index < SERIAL_BUF_SIZE)
-                {
+    rs485_rx_dma_arm(0);
+    rs485_rx_dma_arm(1);
 
-                    recv_buffer.data[recv_buffer.index] =
-                            (uint8_t)UARTCharGet(RS485_UART_BASE);;
-                    recv_buffer.csum += recv_buffer.data[recv_buffer.index++];
+    if(rx_dma.size[0])
+    {
+        uDMAChannelEnable(RS485_UART_RX_UDMA);
+    }
+}
 
-                    time_out = 0;
+/**
+ * @brief Arm TX uDMA control structure with next chunk of send_buffer
+ *
+ * Control structure is left stopped if the whole frame is already armed.
+ *
+ * @param sel control structure (0: primary, 1: alternate)
+ */
+static void rs485_tx_dma_arm(uint8_t sel)
+{
+    uint16_t size = tx_dma.end - tx_dma.next;
 
-                }
-            }
+    if(size > DMA_CHUNK_SIZE)
+    {
+        size = DMA_CHUNK_SIZE;
+    }
 
-            sCarga = (recv_buffer.data[2]<<8) | recv_buffer.data[3];
+    if(size)
+    {
+        uDMAChannelTransferSet(RS485_UART_TX_UDMA | dma_select[sel],
+                               UDMA_MODE_PINGPONG,
+                               &send_buffer.data[tx_dma.next],
+                               (void *)(RS485_UART_BASE + UART_O_DR), size);
+        tx_dma.next += size;
+    }
 
-            if(recv_buffer.index > sCarga +4)
-            {
-                //TaskSetNew(PROCESS_RS485_MESSAGE);
-                rs485_process_data();
-                MessageOverflow = 0;
-            }
+    // Only set after control structure is armed, as ISR checks it
+    tx_dma.size[sel] = size;
+}
 
-            if(sCarga > SERIAL_BUF_SIZE)
-            {
-                recv_buffer.index = 0;
-                recv_buffer.csum  = 0;
-                send_buffer.index = 0;
-                send_buffer.csum  = 0;
+/**
+ * @brief Start reception of next frame in largest free region of recv_buffer
+ *
+ * Free space lies between the end of the last received frame and the start of
+ * the oldest frame still queued, wrapping around recv_buffer end.
+ *
+ * @param offset end of last received frame
+ */
+static void rs485_rx_next_frame(uint16_t offset)
+{
+    uint16_t oldest;
 
-                MessageOverflow = 0;
-            }
-	    }
-	    // High baud-rate
-	    else
-	    {
-            for(time_out = 0; time_out < 15; time_out++)
-            {
-                // Loop while there are characters in the receive FIFO.
-                while(UARTCharsAvail(RS485_UART_BASE) &&
-                        recv_buffer.index < SERIAL_BUF_SIZE)
-                {
+    offset = (offset + 3) & ~3;
+    if(offset > RX_BUF_SIZE)
+    {
+        offset = RX_BUF_SIZE;
+    }
 
-                    recv_buffer.data[recv_buffer.index] =
-                            (uint8_t)UARTCharGet(RS485_UART_BASE);
-                    recv_buffer.csum += recv_buffer.data[recv_buffer.index++];
-                    time_out = 0;
+    if(rx_queue.head == rx_queue.tail)
+    {
+        rx_dma.frame = 0;
+        rx_dma.end   = RX_BUF_SIZE;
+    }
+    else
+    {
+        oldest = rx_queue.frame[rx_queue.tail & RX_QUEUE_MASK].start;
 
-                }
-            }
+        // Queued frames wrap around recv_buffer end
+        if(offset <= oldest)
+        {
+            rx_dma.frame = offset;
+            rx_dma.end   = oldest;
+        }
+        else if(RX_BUF_SIZE - offset >= oldest)
+        {
+            rx_dma.frame = offset;
+            rx_dma.end   = RX_BUF_SIZE;
+        }
+        else
+        {
+            rx_dma.frame = 0;
+            rx_dma.end   = oldest;
+        }
+    }
 
-            sCarga = (recv_buffer.data[2]<<8) | recv_buffer.data[3];
+    rs485_rx_dma_start(rx_dma.frame);
+}
 
-            if(recv_buffer.index > sCarga +4)
+/**
+ * @brief Move reception back to recv_buffer start, once all frames are done
+ *
+ * Region for next frame is chosen while last frame is still queued, so it may
+ * be too short for a maximum size frame. If this frame hasn't started yet, the
+ * whole recv_buffer is given to it. Called from main loop.
+ */
+static void rs485_rx_rewind(void)
+{
+    IntDisable(RS485_INT);
+
+    if( (rx_queue.head == rx_queue.tail) && rx_dma.frame )
+    {
+        uDMAChannelDisable(RS485_UART_RX_UDMA);
+
+        // No byte transferred yet by uDMA: bytes in RX FIFO go to new region
+        if( (rx_dma.active == 0) && (rx_dma.start[0] == rx_dma.frame) &&
+            (uDMAChannelSizeGet(RS485_UART_RX_UDMA | UDMA_PRI_SELECT) ==
+             rx_dma.size[0]) )
+        {
+            rs485_rx_next_frame(0);
+        }
+        else if(rx_dma.size[rx_dma.active])
+        {
+            uDMAChannelEnable(RS485_UART_RX_UDMA);
+        }
+    }
+
+    IntEnable(RS485_INT);
+}
+
+/**
+ * @brief Check whether frame is addressed to one of the BSMP servers
+ *
+ * @param addr destination address of frame
+ * @return true if frame is for this UDC, including broadcast
+ */
+static bool rs485_is_my_address(uint8_t addr)
+{
+    return (addr == SERIAL_CH_0_ADDRESS) || (addr == SERIAL_CH_1_ADDRESS) ||
+           (addr == SERIAL_CH_2_ADDRESS) || (addr == SERIAL_CH_3_ADDRESS) ||
+           (addr == BCAST_ADDRESS);
+}
+
+/**
+ * @brief Checksum of frame
+ *
+ * Bytes are summed a word at a time, in 16-bit lanes, which are folded every
+ * 128 words, before they may overflow.
+ *
+ * @param data word aligned frame
+ * @param len frame size, in bytes
+ * @return 8-bit sum of all bytes, which is zero for a valid frame
+ */
+static uint8_t rs485_csum(const uint8_t *data, uint16_t len)
+{
+    const uint32_t *p_word = (const uint32_t *) data;
+    uint16_t n_words = len >> 2;
+    uint16_t i, n;
+    uint32_t word, lanes;
+    uint32_t sum = 0;
+
+    while(n_words)
+    {
+        n = (n_words > 128) ? 128 : n_words;
+        n_words -= n;
+
+        lanes = 0;
+        for(i = 0; i < n; i++)
+        {
+            word = *p_word++;
+            lanes += (word & 0x00FF00FF) + ((word >> 8) & 0x00FF00FF);
+        }
+
+        sum += (lanes & 0xFFFF) + (lanes >> 16);
+    }
+
+    for(i = len & ~3; i < len; i++)
+    {
+        sum += data[i];
+    }
+
+    return (uint8_t) sum;
+}
+
+/**
+ * @brief Configure RS485 UART baud-rate
+ *
+ * Operation mode is 8-N-1. RX and TX FIFOs are flushed.
+ *
+ * @param BaudRate new baud-rate
+ */
+static void rs485_set_baudrate(uint32_t BaudRate)
+{
+	// Save current configuration of baudrate
+	baudrate = BaudRate;
+
+	// RS485 serial configuration, operation mode 8-N-1
+	UARTConfigSetExpClk(RS485_UART_BASE, SysCtlClockGet(SYSTEM_CLOCK_SPEED), BaudRate,
+						(UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+						UART_CONFIG_PAR_NONE));
+}
+
+/**
+ * @brief Switch to baud-rate proposed by master, on trial
+ */
+static void rs485_apply_baudrate(void)
+{
+	baudrate_prev  = baudrate;
+	baudrate_trial = BAUDRATE_TRIAL_TIMEOUT;
+
+	rs485_set_baudrate(baudrate_next);
+	baudrate_next = 0;
+}
+
+void isr_rs485(void)
+{
+    uint32_t ulStatus;
+    uint16_t len;
+    uint16_t frame_len;
+    uint16_t expected_len;
+    uint8_t  *p_frame;
+    uint8_t  active;
+    uint8_t  depth;
+    bool     truncated;
+
+    // Get the interrrupt status.
+    ulStatus = UARTIntStatus(RS485_UART_BASE, true);
+
+    // Clear the asserted interrupts.
+    UARTIntClear(RS485_UART_BASE, ulStatus);
+
+    if(UARTRxErrorGet(RS485_UART_BASE)) UARTRxErrorClear(RS485_UART_BASE);
+
+    // RX uDMA chunks completed are rearmed with the following ones
+    while(rx_dma.size[rx_dma.active] &&
+          (uDMAChannelModeGet(RS485_UART_RX_UDMA |
+                              dma_select[rx_dma.active]) == UDMA_MODE_STOP))
+    {
+        rs485_rx_dma_arm(rx_dma.active);
+        rx_dma.active ^= 1;
+    }
+
+    // TX uDMA chunks completed are rearmed likewise
+    while(tx_dma.size[tx_dma.active] &&
+          (uDMAChannelModeGet(RS485_UART_TX_UDMA |
+                              dma_select[tx_dma.active]) == UDMA_MODE_STOP))
+    {
+        rs485_tx_dma_arm(tx_dma.active);
+        tx_dma.active ^= 1;
+    }
+
+    // Receive timeout: line is idle, so frame is complete
+    if(ulStatus & UART_INT_RT)
+    {
+        uDMAChannelDisable(RS485_UART_RX_UDMA);
+
+        active = rx_dma.active;
+        len = rx_dma.start[active] + rx_dma.size[active] -
+              uDMAChannelSizeGet(RS485_UART_RX_UDMA | dma_select[active]);
+
+        // Bytes below RX FIFO level are left by uDMA
+        truncated = false;
+        while(UARTCharsAvail(RS485_UART_BASE))
+        {
+            if(len < rx_dma.end)
             {
-                //TaskSetNew(PROCESS_RS485_MESSAGE);
-                rs485_process_data();
-                MessageOverflow = 0;
+                recv_buffer[len++] = (uint8_t) UARTCharGet(RS485_UART_BASE);
             }
             else
             {
-                recv_buffer.index = 0;
-                recv_buffer.csum  = 0;
-                send_buffer.index = 0;
-                send_buffer.csum  = 0;
+                UARTCharGet(RS485_UART_BASE);
+                truncated = true;
             }
-	    }
-    //#endif
-	}
+        }
+
+        p_frame      = &recv_buffer[rx_dma.frame];
+        frame_len    = len - rx_dma.frame;
+        expected_len = SERIAL_HEADER + 3 + SERIAL_CSUM +
+                       ((p_frame[2] << 8) | p_frame[3]);
+
+        /**
+         * At low baud-rates, masters may pause within a frame, so reception
+         * goes on until BSMP header and the size it specifies are received
+         */
+        if( (baudrate < 1000000) && frame_len && !truncated &&
+            ( (frame_len < SERIAL_HEADER + 3) ||
+              ((frame_len < expected_len) && (expected_len <= SERIAL_BUF_SIZE)) ) )
+        {
+            rs485_rx_dma_start(len);
+        }
+
+        // Packet is not for me: its region is reused
+        else if(frame_len && !truncated && !rs485_is_my_address(p_frame[0]))
+        {
+            rs485_rx_next_frame(rx_dma.frame);
+        }
+
+        // No room for frame in recv_buffer or in queue
+        else if( truncated || !frame_len ||
+                 ((uint8_t)(rx_queue.head - rx_queue.tail) >= RX_QUEUE_SIZE) )
+        {
+            g_rs485_rx_stats.dropped.u32++;
+            rs485_rx_next_frame(rx_dma.frame);
+        }
 
-    // Transmit Interrupt Mask
-	else if(UART_INT_TX == ulStatus) // TX interrupt
+        else
+        {
+            rx_queue.frame[rx_queue.head & RX_QUEUE_MASK].start = rx_dma.frame;
+            rx_queue.frame[rx_queue.head & RX_QUEUE_MASK].len   = frame_len;
+            rx_queue.head++;
+
+            depth = rx_queue.head - rx_queue.tail;
+            if(depth > g_rs485_rx_stats.peak_depth.u16)
+            {
+                g_rs485_rx_stats.peak_depth.u16 = depth;
+            }
+
+            TaskSetNew(PROCESS_RS485_MESSAGE);
+            rs485_rx_next_frame(len);
+        }
+    }
+
+    // Transmit Interrupt Mask: end of transmission, if uDMA is done too
+    if( (ulStatus & UART_INT_TX) && !tx_dma.size[0] && !tx_dma.size[1] )
 	{
 		while(UARTBusy(RS485_RD_BASE));
 
 		// Put IC in the reception mode
 		GPIOPinWrite(RS485_RD_BASE, RS485_RD_PIN, OFF);
 
+		tx_busy = false;
+
+		// Response to baud-rate proposal is done: switch to new rate
+		if(baudrate_next)
+		{
+		    rs485_apply_baudrate();
+		}
 	}
 }
 
 void rs485_tx_handler(void)
 {
-	unsigned int i;
+	uint16_t len = send_packet.len + SERIAL_HEADER;
+
+	// Prepare answer, with checksum appended
+	send_buffer.data[0]   = SERIAL_MASTER_ADDRESS;
+	send_buffer.csum      = -rs485_csum(send_buffer.data, len);
+	send_buffer.data[len] = send_buffer.csum;
 
-	// Prepare answer
-	send_buffer.data[0] = SERIAL_MASTER_ADDRESS;
-	send_buffer.csum    = 0;
+	/**
+	 * ISR rearms TX uDMA and releases the bus at EOT, so it must not run while
+	 * transmission is being set up
+	 */
+	IntDisable(RS485_INT);
 
-	// Send packet
+	tx_busy = true;
 
 	// Put IC in the transmition mode
 	GPIOPinWrite(RS485_RD_BASE, RS485_RD_PIN, ON);
 
-	for(i = 0; i < send_packet.len + SERIAL_HEADER; ++i)
-	{
-		// Wait until have space in the TX buffer
-		while(!UARTSpaceAvail(RS485_UART_BASE));
-		// CheckSum calc
-		send_buffer.csum -= send_buffer.data[i];
-		// Send Byte
-		UARTCharPut(RS485_UART_BASE, send_buffer.data[i]);
-	}
-	// Wait until have space in the TX buffer
-	while(!UARTSpaceAvail(RS485_UART_BASE));
-	// Send Byte
-	UARTCharPut(RS485_UART_BASE, send_buffer.csum);
+	// Send packet: uDMA feeds TX FIFO and EOT interrupt releases the bus
+	uDMAChannelDisable(RS485_UART_TX_UDMA);
+	uDMAChannelAttributeDisable(RS485_UART_TX_UDMA, UDMA_ATTR_ALTSELECT);
+
+	tx_dma.next   = 0;
+	tx_dma.end    = len + SERIAL_CSUM;
+	tx_dma.active = 0;
+
+	rs485_tx_dma_arm(0);
+	rs485_tx_dma_arm(1);
 
+	uDMAChannelEnable(RS485_UART_TX_UDMA);
+
+	IntEnable(RS485_INT);
 }
 
 void rs485_process_data(void)
 {
+    rs485_frame_t *frame;
+    uint8_t *data;
+
+    // No frame queued
+    if(rx_queue.head == rx_queue.tail)
+        return;
+
+    frame = &rx_queue.frame[rx_queue.tail & RX_QUEUE_MASK];
+    data  = &recv_buffer[frame->start];
+
 	// Received less than HEADER + CSUM bytes
-	if(recv_buffer.index < (SERIAL_HEADER + SERIAL_CSUM))
+	if(frame->len < (SERIAL_HEADER + SERIAL_CSUM))
 		goto exit;
 
+	/**
+	 * Previous response still waiting for DSP acknowledge or being
+	 * transmitted: try again later. Checked before checksum, so the frame is
+	 * only validated once, when it's actually processed.
+	 */
+	if(bsmp_cmd_pending(&send_packet) || tx_busy)
+	{
+	    TaskSetNew(PROCESS_RS485_MESSAGE);
+	    return;
+	}
+
 	// Checksum is not zero
-	if(recv_buffer.csum)
+	if(rs485_csum(data, frame->len))
 		goto exit;
 
-	// Packet is not for me
-	if(recv_buffer.data[0] != SERIAL_CH_1_ADDRESS && recv_buffer.data[0] !=
-	        SERIAL_CH_2_ADDRESS && recv_buffer.data[0] != SERIAL_CH_3_ADDRESS
-	        && recv_buffer.data[0] != SERIAL_CH_0_ADDRESS &&
-	        recv_buffer.data[0] != BCAST_ADDRESS)
-	    goto exit;
-
 	//GPIOPinWrite(EEPROM_WP_BASE, EEPROM_WP_PIN, ON);
 
-	recv_packet.len = recv_buffer.index - SERIAL_HEADER - SERIAL_CSUM;
+	// Valid frame: baud-rate on trial is confirmed
+	baudrate_trial = 0;
+
+	recv_packet.data = data + SERIAL_HEADER;
+	recv_packet.len  = frame->len - SERIAL_HEADER - SERIAL_CSUM;
 
-    if (recv_buffer.data[0] == SERIAL_CH_0_ADDRESS)
+    if (data[0] == SERIAL_CH_0_ADDRESS)
     {
-        g_current_ps_id = 0;
         BSMPprocess(&recv_packet, &send_packet, 0, Remote);
     }
 
-    else if (recv_buffer.data[0] == SERIAL_CH_1_ADDRESS)
+    else if (data[0] == SERIAL_CH_1_ADDRESS)
 	{
-        g_current_ps_id = 1;
 	    BSMPprocess(&recv_packet, &send_packet, 1, Remote);
 	}
 
-	else if (recv_buffer.data[0] == SERIAL_CH_2_ADDRESS)
+	else if (data[0] == SERIAL_CH_2_ADDRESS)
     {
-        g_current_ps_id = 2;
         BSMPprocess(&recv_packet, &send_packet, 2, Remote);
     }
 
-	else if (recv_buffer.data[0] == SERIAL_CH_3_ADDRESS)
+	else if (data[0] == SERIAL_CH_3_ADDRESS)
     {
-        g_current_ps_id = 3;
         BSMPprocess(&recv_packet, &send_packet, 3, Remote);
     }
 
-	else if(recv_buffer.data[0] == BCAST_ADDRESS)
+	else if(data[0] == BCAST_ADDRESS)
     {
-        uint8_t idx;
-        for(idx = 0; idx < 4; idx++)
+        BSMPprocess_broadcast(&recv_packet, &send_packet, Remote);
+
+        // There's no response, so proposed baud-rate is applied right away
+        if(baudrate_next)
         {
-            g_current_ps_id = idx;
-            BSMPprocess(&recv_packet, &send_packet, idx, Remote);
+            IntDisable(RS485_INT);
+            rs485_apply_baudrate();
+            IntEnable(RS485_INT);
         }
     }
 
 	//rs485_bkp_tx_handler();
-    if (recv_buffer.data[0] != BCAST_ADDRESS)
+    if (data[0] != BCAST_ADDRESS)
     {
-        rs485_tx_handler();
+        if(bsmp_cmd_pending(NULL))
+        {
+            bsmp_defer_response(&send_packet, rs485_tx_handler);
+        }
+        else
+        {
+            rs485_tx_handler();
+        }
     }
 
 	exit:
-	recv_buffer.index = 0;
-	recv_buffer.csum  = 0;
 	send_buffer.index = 0;
 	send_buffer.csum  = 0;
 
+	// Release frame and keep on with the next one
+	rx_queue.tail++;
+	if(rx_queue.head != rx_queue.tail)
+	{
+	    TaskSetNew(PROCESS_RS485_MESSAGE);
+	}
+	else
+	{
+	    rs485_rx_rewind();
+	}
 }
 
 void set_rs485_ch_1_address(uint8_t addr)
@@ -371,7 +776,7 @@ uint8_t get_rs485_ch_0_address()
 void config_rs485(uint32_t BaudRate)
 {
 	// Baudrate limit
-	if( (BaudRate > 6000000) || (BaudRate < 9600) ||
+	if( (BaudRate > BAUDRATE_MAX) || (BaudRate < BAUDRATE_MIN) ||
 	    isinf(BaudRate) || isnan(BaudRate) )
 	{
 	    BaudRate = BAUDRATE_DEFAULT;
@@ -382,13 +787,49 @@ void config_rs485(uint32_t BaudRate)
 	    //save_param_eeprom(RS485_Baudrate, 0);
 	}
 
-	// Save current configuration of baudrate
-	baudrate = BaudRate;
+	rs485_set_baudrate(BaudRate);
+}
 
-	// RS485 serial configuration, operation mode 8-N-1
-	UARTConfigSetExpClk(RS485_UART_BASE, SysCtlClockGet(SYSTEM_CLOCK_SPEED), BaudRate,
-						(UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
-						UART_CONFIG_PAR_NONE));
+/**
+ * @brief Propose a new RS485 baud-rate
+ *
+ * Proposed rate is applied at the end of the response to current request, or
+ * right after processing it, if broadcast. It falls back to the current rate if
+ * no valid frame is received within BAUDRATE_TRIAL_TIMEOUT. RS485_Baudrate
+ * parameter is kept unchanged.
+ *
+ * @param BaudRate proposed baud-rate
+ * @return true if proposed baud-rate is valid
+ */
+bool rs485_propose_baudrate(uint32_t BaudRate)
+{
+	if( (BaudRate > BAUDRATE_MAX) || (BaudRate < BAUDRATE_MIN) )
+	{
+	    return false;
+	}
+
+	if(BaudRate != baudrate)
+	{
+	    baudrate_next = BaudRate;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Count trial time of new RS485 baud-rate
+ *
+ * Called every 1 ms by global timer. Previous baud-rate is restored if trial
+ * time expires without a valid frame.
+ */
+void rs485_baudrate_trial_tick(void)
+{
+	if(baudrate_trial && !(--baudrate_trial))
+	{
+	    IntDisable(RS485_INT);
+	    rs485_set_baudrate(baudrate_prev);
+	    IntEnable(RS485_INT);
+	}
 }
 
 void init_rs485(void)
@@ -404,11 +845,33 @@ void init_rs485(void)
 	config_rs485(get_param(RS485_Baudrate,0));
 
 	UARTFIFOEnable(RS485_UART_BASE);
-	UARTFIFOLevelSet(RS485_UART_BASE, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
+	UARTFIFOLevelSet(RS485_UART_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
+
+    // RX uDMA: bursts from UART FIFO to recv_buffer, in ping-pong mode
+    uDMAChannelAttributeDisable(RS485_UART_RX_UDMA, UDMA_ATTR_ALL);
+    uDMAChannelAttributeEnable(RS485_UART_RX_UDMA, UDMA_ATTR_USEBURST);
+    uDMAChannelControlSet(RS485_UART_RX_UDMA | UDMA_PRI_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 |
+                          UDMA_ARB_4);
+    uDMAChannelControlSet(RS485_UART_RX_UDMA | UDMA_ALT_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 |
+                          UDMA_ARB_4);
+
+    // TX uDMA: from send_buffer to UART FIFO, in ping-pong mode
+    uDMAChannelAttributeDisable(RS485_UART_TX_UDMA, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(RS485_UART_TX_UDMA | UDMA_PRI_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE |
+                          UDMA_ARB_4);
+    uDMAChannelControlSet(RS485_UART_TX_UDMA | UDMA_ALT_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE |
+                          UDMA_ARB_4);
+
+    UARTDMAEnable(RS485_UART_BASE, UART_DMA_RX | UART_DMA_TX);
+    rs485_rx_next_frame(0);
 
 	//Habilita interrupção pela UART1 (RS-485)
 	IntRegister(RS485_INT, isr_rs485);
-	UARTIntEnable(RS485_UART_BASE, UART_INT_RX | UART_INT_TX | UART_INT_RT);
+	UARTIntEnable(RS485_UART_BASE, UART_INT_TX | UART_INT_RT);
 	//UARTIntEnable(RS485_UART_BASE, UART_INT_RX | UART_INT_RT);
 
 	//EOT - End of Transmission
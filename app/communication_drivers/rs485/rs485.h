@@ -24,11 +24,27 @@
 
 #include <stdint.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <string.h>
 
+#include "communication_drivers/common/structs.h"
+
+/**
+ * Statistics of RS485 frames queue, exposed as BSMP variables
+ */
+typedef struct
+{
+    u_uint16_t  peak_depth;     // Maximum number of frames queued
+    u_uint32_t  dropped;        // Frames dropped for lack of buffer or queue
+} rs485_rx_stats_t;
+
+extern volatile rs485_rx_stats_t g_rs485_rx_stats;
+
 extern void init_rs485(void);
 extern void rs485_process_data(void);
 extern void config_rs485(uint32_t BaudRate);
+extern bool rs485_propose_baudrate(uint32_t BaudRate);
+extern void rs485_baudrate_trial_tick(void);
 //extern void SetRS485Address(uint8_t addr);
 extern uint8_t ReadRS485Address(void);
 
@@ -42,6 +58,4 @@ extern void set_rs485_ch_2_address(uint8_t addr);
 extern void set_rs485_ch_3_address(uint8_t addr);
 extern void set_rs485_ch_4_address(uint8_t addr);
 
-extern volatile uint8_t g_current_ps_id;
-
 #endif /* RS485_H_ */
@@ -29,6 +29,13 @@
 
 #define NUM_MAX_SCOPES      4
 
+/**
+ * Streaming mode of scope. C28 splits scope buffer into frames of
+ * STREAM_FRAME_SIZE samples, used as a ring drained by ARM, so acquisition
+ * runs continuously instead of stopping when buffer is full.
+ */
+#define STREAM_FRAME_SIZE   64
+
 #define RUN_SCOPE(scp)  RUN_TIMESLICER_NEW(scp.timeslicer)   \
                             scp.p_run_scope(&scp);          \
                         END_TIMESLICER_NEW(scp.timeslicer)
@@ -44,6 +51,28 @@ struct scope_t
     void            (*p_run_scope)(scope_t *p_scp);
 };
 
+/**
+ * Stream ring indexes written by ARM. A new session number (0 disables it)
+ * restarts the stream.
+ */
+typedef volatile struct
+{
+    uint16_t    session;
+    uint16_t    tail;       // First frame not acknowledged by client yet
+} stream_mtoc_t;
+
+/**
+ * Stream ring indexes written by C28. Session number is copied from ARM once
+ * indexes are restarted, so ARM only reads frames from current session.
+ */
+typedef volatile struct
+{
+    uint16_t    session;
+    uint16_t    head;       // Next frame to be written by C28
+    uint16_t    dropped;    // Frames dropped because ring was full
+    uint16_t    rsvd;
+} stream_ctom_t;
+
 inline void run_scope(scope_t *p_scp)
 {
     /*********************************************/
@@ -120,6 +120,7 @@ TaskSetNew(uint8_t TaskNum)
 
 void TaskCheck(void)
 {
+    bsmp_check_pending_cmd();
 
 	if(ADCP_SAMPLE_AVAILABLE_REQUEST)
 	{
@@ -307,7 +308,9 @@ void TaskCheck(void)
 
         for(i = 0; i < NUM_PS_MODULES; i++)
         {
+            bsmp_wait_pending_cmd();
             RUN_BSMP_FUNC(i, 6, &interface.u8, &dummy);
+            bsmp_wait_pending_cmd();
         }
 	}
 
@@ -321,7 +324,9 @@ void TaskCheck(void)
 
 	    for(i = 0; i < NUM_PS_MODULES; i++)
 	    {
+            bsmp_wait_pending_cmd();
             RUN_BSMP_FUNC(i, 9, &password.u8, &dummy);
+            bsmp_wait_pending_cmd();
 	    }
 
 	    //bsmp[0].funcs.list[11]->func_p(&password.u8, &dummy);
@@ -35,6 +35,7 @@
 #include "communication_drivers/system_task/system_task.h"
 #include "communication_drivers/i2c_onboard/exio.h"
 #include "communication_drivers/ipc/ipc_lib.h"
+#include "communication_drivers/rs485/rs485.h"
 #include "board_drivers/hardware_def.h"
 
 #define MAX_COUNT_COMMAND_INTERFACE     60000   // 60000 ms = 1 min
@@ -45,6 +46,12 @@ uint8_t     iib_sample = 0x00;
 uint32_t    counter_command_interface = 0;
 uint32_t    counter_lock_udc = 0;
 
+/**
+ * Free-running count of global timer interrupts, for timeouts measured from
+ * main loop. Wraps around, so elapsed ticks must be taken by subtraction.
+ */
+volatile uint32_t global_timer_ticks = 0;
+
 /**
  * @brief Interrupt Service Routine for global timer
  */
@@ -53,6 +60,7 @@ void isr_global_timer(void)
 {
 	time++;
 	iib_sample++;
+	global_timer_ticks++;
 
 	// Apaga a interrup��o do timer 0 A
 	TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
@@ -60,6 +68,8 @@ void isr_global_timer(void)
 	adcp_read();
 	//TaskSetNew(SAMPLE_ADCP);
 
+	rs485_baudrate_trial_tick();
+
 	if(iib_sample >= 40)
 	{
 		iib_sample = 0;
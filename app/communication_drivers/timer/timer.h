@@ -21,6 +21,10 @@
 #ifndef TIMER_H_
 #define TIMER_H_
 
+#include <stdint.h>
+
+extern volatile uint32_t global_timer_ticks;
+
 extern void global_timer_init(void);
 
 #endif /* APP_COMMUNICATION_DRIVERS_TIMER_TIMER_H_ */
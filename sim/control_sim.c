@@ -0,0 +1,1036 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file control_sim.c
+ * @brief Host closed-loop simulator for control library
+ *
+ * Runs the DSP modules of the control framework against a plant model, at a
+ * given control loop frequency, and reports step response figures and cost of
+ * controller kernels per iteration. Controller is built as on firmware,
+ * through net signals and set_dsp_coeffs(), and runs either module by module
+ * or through its compiled execution plan:
+ *
+ *      ref -> error -> PI -> [SOS cascade] -> duty * Vdc -> plant -> meas
+ *
+ * With --fixed, the loop is closed by the Q31 or Q15 version of this chain
+ * instead (a single SOS section runs as 2P2Z filter), configured from the
+ * same coefficient vectors, while the float controller runs alongside on the
+ * same measurements to report the deviation of fixed-point output.
+ *
+ * SOS cascade is also checked for bit-exactness against a chain of 2P2Z
+ * modules with the same sections, and both are benchmarked.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 16/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define READ_CYCLES()       __rdtsc()
+#else
+#define READ_CYCLES()       0
+#endif
+
+#include "communication_drivers/control/control.h"
+#include "communication_drivers/control/dsp_q.h"
+#include "plant.h"
+
+#define REFERENCE           g_controller_ctom.net_signals[0].f
+#define MEASUREMENT         g_controller_ctom.net_signals[1].f
+#define ERROR_SIGNAL        g_controller_ctom.net_signals[2].f
+#define PI_OUTPUT           g_controller_ctom.net_signals[3].f
+#define DUTY_CYCLE          g_controller_ctom.output_signals[0].f
+
+#define ERROR_CTRL          &g_controller_ctom.dsp_modules.dsp_error[0]
+#define PI_CTRL             &g_controller_ctom.dsp_modules.dsp_pi[0]
+#define SOS_CTRL            &g_controller_ctom.dsp_modules.dsp_iir_sos[0]
+
+#define SETTLING_BAND       0.02
+#define BENCH_ROUNDS        5
+#define DUTY_FULL_SCALE     2.0
+
+static dsp_plan_t plan;
+static int use_plan;
+
+/**
+ * SOS cascade checked against a chain of 2P2Z modules with the same sections.
+ * Cascade only limits its output, so sections of the chain are unbounded and
+ * its output is limited afterwards.
+ */
+typedef struct
+{
+    dsp_iir_sos_t   sos;
+    dsp_iir_2p2z_t  chain[NUM_MAX_IIR_SOS_SECTIONS];
+    float           chain_sig[NUM_MAX_IIR_SOS_SECTIONS + 1];
+    float           sos_out;
+    float           u_max;
+    float           u_min;
+    float           in_amplitude;
+    uint16_t        num_sections;
+} sos_check_t;
+
+static sos_check_t sos_check;
+
+/**
+ * Sections used by SOS check when none is given with --sos
+ */
+static const float sos_check_default[2][5] =
+{
+    {0.3, 0.2, 0.1, -0.5, 0.3},
+    {1.0, -1.6, 0.8, -1.2, 0.5}
+};
+
+typedef struct
+{
+    q31_t               ref;
+    q31_t               meas;
+    q31_t               error;
+    q31_t               pi_out;
+    q31_t               duty;
+    q31_t               duty_max;
+    q31_t               duty_min;
+    dsp_error_q31_t     error_ctrl;
+    dsp_pi_q31_t        pi_ctrl;
+    dsp_iir_2p2z_q31_t  iir_ctrl;
+} controller_q31_t;
+
+typedef struct
+{
+    q15_t               ref;
+    q15_t               meas;
+    q15_t               error;
+    q15_t               pi_out;
+    q15_t               duty;
+    q15_t               duty_max;
+    q15_t               duty_min;
+    dsp_error_q15_t     error_ctrl;
+    dsp_pi_q15_t        pi_ctrl;
+    dsp_iir_2p2z_q15_t  iir_ctrl;
+} controller_q15_t;
+
+static controller_q31_t ctrl_q31;
+static controller_q15_t ctrl_q15;
+static int fixed_format;
+static int fixed_use_iir;
+static float fixed_full_scale;
+
+typedef struct
+{
+    plant_type_t    plant;
+    double          freq;
+    double          time;
+    double          step;
+    double          r;
+    double          l;
+    double          c;
+    double          r_load;
+    double          vdc;
+    float           kp;
+    float           ki;
+    float           u_max;
+    float           u_min;
+    float           sos[NUM_MAX_IIR_SOS_SECTIONS][5];
+    uint16_t        num_sections;
+    unsigned int    substeps;
+    unsigned long   bench_iters;
+    int             use_plan;
+    int             fixed;
+    double          full_scale;
+    double          retune_time;
+    float           retune_kp;
+    float           retune_ki;
+    const char      *csv;
+} sim_cfg_t;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --plant=rl|dclink|lc   plant model (rl)\n"
+        "  --freq=HZ              control loop frequency (50000)\n"
+        "  --time=S               simulated time (0.01)\n"
+        "  --step=X               reference step amplitude (10)\n"
+        "  --r=OHM --l=H --c=F    series resistance, inductance, capacitance\n"
+        "  --rload=OHM            load resistance for dclink and lc (10)\n"
+        "  --vdc=V                voltage for unitary duty cycle (100)\n"
+        "  --kp=K --ki=K          PI gains, ki per sample\n"
+        "  --umax=D --umin=D      PI and cascade output limits (1, -1)\n"
+        "  --sos=b0,b1,b2,a1,a2   section appended to cascade after PI,\n"
+        "                         up to %d times\n"
+        "  --substeps=N           plant integration steps per period (20)\n"
+        "  --bench=N              iterations for kernels benchmark (1000000)\n"
+        "  --csv=FILE             dump time, reference, measurement, duty\n"
+        "  --plan                 simulate through compiled execution plan\n"
+        "  --fixed=q31|q15        close loop with fixed-point controller\n"
+        "  --fullscale=X          fixed-point full-scale of reference and\n"
+        "                         measurement (4 * step)\n"
+        "  --retune=T,KP,KI       set new PI gains at time T, while running\n",
+        prog, NUM_MAX_IIR_SOS_SECTIONS);
+}
+
+static int parse_args(int argc, char **argv, sim_cfg_t *p_cfg)
+{
+    static const struct option opts[] =
+    {
+        {"plant",    required_argument, 0, 'p'},
+        {"freq",     required_argument, 0, 'f'},
+        {"time",     required_argument, 0, 't'},
+        {"step",     required_argument, 0, 's'},
+        {"r",        required_argument, 0, 'r'},
+        {"l",        required_argument, 0, 'l'},
+        {"c",        required_argument, 0, 'c'},
+        {"rload",    required_argument, 0, 'R'},
+        {"vdc",      required_argument, 0, 'v'},
+        {"kp",       required_argument, 0, 'P'},
+        {"ki",       required_argument, 0, 'I'},
+        {"umax",     required_argument, 0, 'M'},
+        {"umin",     required_argument, 0, 'm'},
+        {"sos",      required_argument, 0, 'S'},
+        {"substeps", required_argument, 0, 'n'},
+        {"bench",    required_argument, 0, 'b'},
+        {"csv",      required_argument, 0, 'o'},
+        {"plan",     no_argument,       0, 'x'},
+        {"fixed",    required_argument, 0, 'q'},
+        {"fullscale", required_argument, 0, 'F'},
+        {"retune",   required_argument, 0, 'T'},
+        {"help",     no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+    float *p_sos;
+    int opt;
+
+    while((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1)
+    {
+        switch(opt)
+        {
+            case 'p':
+            {
+                if(!strcmp(optarg, "rl"))           p_cfg->plant = Plant_RL;
+                else if(!strcmp(optarg, "dclink"))  p_cfg->plant = Plant_DCLink;
+                else if(!strcmp(optarg, "lc"))      p_cfg->plant = Plant_LC;
+                else                                return -1;
+                break;
+            }
+
+            case 'f':   p_cfg->freq = atof(optarg);             break;
+            case 't':   p_cfg->time = atof(optarg);             break;
+            case 's':   p_cfg->step = atof(optarg);             break;
+            case 'r':   p_cfg->r = atof(optarg);                break;
+            case 'l':   p_cfg->l = atof(optarg);                break;
+            case 'c':   p_cfg->c = atof(optarg);                break;
+            case 'R':   p_cfg->r_load = atof(optarg);           break;
+            case 'v':   p_cfg->vdc = atof(optarg);              break;
+            case 'P':   p_cfg->kp = atof(optarg);               break;
+            case 'I':   p_cfg->ki = atof(optarg);               break;
+            case 'M':   p_cfg->u_max = atof(optarg);            break;
+            case 'm':   p_cfg->u_min = atof(optarg);            break;
+            case 'n':   p_cfg->substeps = atoi(optarg);         break;
+            case 'b':   p_cfg->bench_iters = strtoul(optarg, NULL, 0); break;
+            case 'o':   p_cfg->csv = optarg;                    break;
+            case 'x':   p_cfg->use_plan = 1;                    break;
+            case 'F':   p_cfg->full_scale = atof(optarg);       break;
+
+            case 'T':
+            {
+                if(sscanf(optarg, "%lf,%f,%f", &p_cfg->retune_time,
+                          &p_cfg->retune_kp, &p_cfg->retune_ki) != 3)
+                {
+                    return -1;
+                }
+                break;
+            }
+
+            case 'q':
+            {
+                if(!strcmp(optarg, "q31"))
+                {
+                    p_cfg->fixed = 31;
+                }
+                else if(!strcmp(optarg, "q15"))
+                {
+                    p_cfg->fixed = 15;
+                }
+                else
+                {
+                    return -1;
+                }
+                break;
+            }
+
+            case 'S':
+            {
+                if(p_cfg->num_sections == NUM_MAX_IIR_SOS_SECTIONS)
+                {
+                    return -1;
+                }
+
+                p_sos = p_cfg->sos[p_cfg->num_sections];
+
+                if(sscanf(optarg, "%f,%f,%f,%f,%f", &p_sos[0], &p_sos[1],
+                          &p_sos[2], &p_sos[3], &p_sos[4]) != 5)
+                {
+                    return -1;
+                }
+
+                p_cfg->num_sections++;
+                break;
+            }
+
+            default:
+                return -1;
+        }
+    }
+
+    if( (p_cfg->freq <= 0.0) || (p_cfg->time <= 0.0) || (p_cfg->l <= 0.0) ||
+        (p_cfg->r <= 0.0) || (p_cfg->c <= 0.0) || (p_cfg->r_load <= 0.0) )
+    {
+        return -1;
+    }
+
+    /// Fixed-point chain has a single 2nd-order filter
+    if(p_cfg->fixed && (p_cfg->num_sections > 1))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Build controller as firmware does: DSP modules wired through net signals,
+ * and coefficients loaded with set_dsp_coeffs().
+ */
+static void init_controller(sim_cfg_t *p_cfg)
+{
+    float coeffs[NUM_MAX_COEFFS_DSP];
+    uint16_t i;
+
+    init_control_framework(&g_controller_ctom);
+
+    init_dsp_error(ERROR_CTRL, &REFERENCE, &MEASUREMENT, &ERROR_SIGNAL);
+
+    init_dsp_pi(PI_CTRL, p_cfg->kp, p_cfg->ki, p_cfg->freq, p_cfg->u_max,
+                p_cfg->u_min, &ERROR_SIGNAL, &PI_OUTPUT);
+
+    init_dsp_iir_sos(SOS_CTRL, p_cfg->num_sections, p_cfg->u_max, p_cfg->u_min,
+                     &PI_OUTPUT, &DUTY_CYCLE);
+
+    coeffs[0] = p_cfg->kp;
+    coeffs[1] = p_cfg->ki;
+    coeffs[2] = p_cfg->u_max;
+    coeffs[3] = p_cfg->u_min;
+    set_dsp_coeffs(&g_controller_ctom, DSP_PI, 0, coeffs);
+
+    for(i = 0; i < p_cfg->num_sections; i++)
+    {
+        memcpy(coeffs, p_cfg->sos[i], 5 * sizeof(float));
+        coeffs[5] = p_cfg->u_max;
+        coeffs[6] = p_cfg->u_min;
+        set_dsp_coeffs(&g_controller_ctom, DSP_IIR_SOS, i, coeffs);
+    }
+
+    compile_dsp_plan(&g_controller_ctom, &plan, NULL, 0);
+    use_plan = p_cfg->use_plan;
+
+    /// Simulated loop swaps coefficients at cycle boundary, so retunes exercise
+    /// double-buffering instead of the default immediate mode
+    g_controller_ctom.dsp_coeffs_swap_mode = DSP_Coeffs_Swap_Next_Cycle;
+}
+
+/**
+ * Build fixed-point controller from the same coefficient vectors loaded on
+ * float controller. As on SOS cascade, filter output is only limited after
+ * the filter, so its states are not affected by saturation.
+ */
+static void init_fixed_controller(sim_cfg_t *p_cfg)
+{
+    volatile float *p_pi_coeffs =
+        DSP_LATEST_COEFFS(g_controller_ctom.dsp_modules.dsp_pi[0]).f;
+    float iir_coeffs[NUM_COEFFS_DSP_IIR_2P2Z];
+
+    fixed_format = p_cfg->fixed;
+    fixed_use_iir = (p_cfg->num_sections == 1);
+    fixed_full_scale = (p_cfg->full_scale > 0.0) ? p_cfg->full_scale :
+                                                   4.0 * fabs(p_cfg->step);
+
+    memcpy(iir_coeffs, p_cfg->sos[0], 5 * sizeof(float));
+    iir_coeffs[5] = DUTY_FULL_SCALE;
+    iir_coeffs[6] = -DUTY_FULL_SCALE;
+
+    ctrl_q31.duty_max = float_to_q31(p_cfg->u_max, DUTY_FULL_SCALE);
+    ctrl_q31.duty_min = float_to_q31(p_cfg->u_min, DUTY_FULL_SCALE);
+    ctrl_q15.duty_max = float_to_q15(p_cfg->u_max, DUTY_FULL_SCALE);
+    ctrl_q15.duty_min = float_to_q15(p_cfg->u_min, DUTY_FULL_SCALE);
+
+    init_dsp_error_q31(&ctrl_q31.error_ctrl, &ctrl_q31.ref, &ctrl_q31.meas,
+                       &ctrl_q31.error);
+    init_dsp_pi_q31(&ctrl_q31.pi_ctrl, p_pi_coeffs, fixed_full_scale,
+                    DUTY_FULL_SCALE, &ctrl_q31.error, &ctrl_q31.pi_out);
+    init_dsp_iir_2p2z_q31(&ctrl_q31.iir_ctrl, iir_coeffs, DUTY_FULL_SCALE,
+                          DUTY_FULL_SCALE, &ctrl_q31.pi_out, &ctrl_q31.duty);
+
+    init_dsp_error_q15(&ctrl_q15.error_ctrl, &ctrl_q15.ref, &ctrl_q15.meas,
+                       &ctrl_q15.error);
+    init_dsp_pi_q15(&ctrl_q15.pi_ctrl, p_pi_coeffs, fixed_full_scale,
+                    DUTY_FULL_SCALE, &ctrl_q15.error, &ctrl_q15.pi_out);
+    init_dsp_iir_2p2z_q15(&ctrl_q15.iir_ctrl, iir_coeffs, DUTY_FULL_SCALE,
+                          DUTY_FULL_SCALE, &ctrl_q15.pi_out, &ctrl_q15.duty);
+}
+
+static void reset_fixed_controller(void)
+{
+    reset_dsp_pi_q31(&ctrl_q31.pi_ctrl);
+    reset_dsp_iir_2p2z_q31(&ctrl_q31.iir_ctrl);
+    reset_dsp_pi_q15(&ctrl_q15.pi_ctrl);
+    reset_dsp_iir_2p2z_q15(&ctrl_q15.iir_ctrl);
+}
+
+static void run_fixed_modules(void)
+{
+    if(fixed_format == 31)
+    {
+        run_dsp_error_q31(&ctrl_q31.error_ctrl);
+        run_dsp_pi_q31(&ctrl_q31.pi_ctrl);
+        if(fixed_use_iir)
+        {
+            run_dsp_iir_2p2z_q31(&ctrl_q31.iir_ctrl);
+            SATURATE(ctrl_q31.duty, ctrl_q31.duty_max, ctrl_q31.duty_min);
+        }
+        else
+        {
+            ctrl_q31.duty = ctrl_q31.pi_out;
+        }
+    }
+    else
+    {
+        run_dsp_error_q15(&ctrl_q15.error_ctrl);
+        run_dsp_pi_q15(&ctrl_q15.pi_ctrl);
+        if(fixed_use_iir)
+        {
+            run_dsp_iir_2p2z_q15(&ctrl_q15.iir_ctrl);
+            SATURATE(ctrl_q15.duty, ctrl_q15.duty_max, ctrl_q15.duty_min);
+        }
+        else
+        {
+            ctrl_q15.duty = ctrl_q15.pi_out;
+        }
+    }
+}
+
+/**
+ * Run fixed-point controller on float reference and measurement, as sampled
+ * by an ADC, and return its duty cycle.
+ */
+static float run_fixed_controller(float ref, float meas)
+{
+    if(fixed_format == 31)
+    {
+        ctrl_q31.ref = float_to_q31(ref, fixed_full_scale);
+        ctrl_q31.meas = float_to_q31(meas, fixed_full_scale);
+        run_fixed_modules();
+        return q31_to_float(ctrl_q31.duty, DUTY_FULL_SCALE);
+    }
+    else
+    {
+        ctrl_q15.ref = float_to_q15(ref, fixed_full_scale);
+        ctrl_q15.meas = float_to_q15(meas, fixed_full_scale);
+        run_fixed_modules();
+        return q15_to_float(ctrl_q15.duty, DUTY_FULL_SCALE);
+    }
+}
+
+/**
+ * Build SOS cascade and equivalent 2P2Z chain from the sections given with
+ * --sos, or from sos_check_default. Input amplitude is twice the output limits,
+ * so the check covers saturation as well.
+ */
+static void init_sos_check(sim_cfg_t *p_cfg)
+{
+    const float (*p_sections)[5] = (const float (*)[5]) p_cfg->sos;
+    uint16_t i;
+
+    sos_check.num_sections = p_cfg->num_sections;
+    if(!sos_check.num_sections)
+    {
+        p_sections = sos_check_default;
+        sos_check.num_sections = 2;
+    }
+
+    sos_check.u_max = p_cfg->u_max;
+    sos_check.u_min = p_cfg->u_min;
+    sos_check.in_amplitude = 2.0 * fmax(fabs(p_cfg->u_max), fabs(p_cfg->u_min));
+
+    init_dsp_iir_sos(&sos_check.sos, sos_check.num_sections, p_cfg->u_max,
+                     p_cfg->u_min, &sos_check.chain_sig[0], &sos_check.sos_out);
+
+    for(i = 0; i < sos_check.num_sections; i++)
+    {
+        cfg_dsp_iir_sos(&sos_check.sos, i, p_sections[i][0], p_sections[i][1],
+                        p_sections[i][2], p_sections[i][3], p_sections[i][4],
+                        p_cfg->u_max, p_cfg->u_min);
+
+        init_dsp_iir_2p2z(&sos_check.chain[i], p_sections[i][0],
+                          p_sections[i][1], p_sections[i][2], p_sections[i][3],
+                          p_sections[i][4], INFINITY, -INFINITY,
+                          &sos_check.chain_sig[i], &sos_check.chain_sig[i + 1]);
+    }
+
+    swap_dsp_coeffs_bank(&sos_check.sos.bank);
+}
+
+static void reset_sos_check(void)
+{
+    uint16_t i;
+
+    reset_dsp_iir_sos(&sos_check.sos);
+
+    for(i = 0; i < sos_check.num_sections; i++)
+    {
+        reset_dsp_iir_2p2z(&sos_check.chain[i]);
+    }
+}
+
+static float run_sos_chain(void)
+{
+    float out;
+    uint16_t i;
+
+    for(i = 0; i < sos_check.num_sections; i++)
+    {
+        run_dsp_iir_2p2z(&sos_check.chain[i]);
+    }
+
+    out = sos_check.chain_sig[sos_check.num_sections];
+    SATURATE(out, sos_check.u_max, sos_check.u_min);
+
+    return out;
+}
+
+/**
+ * Pseudo-random input of SOS check, uniform within +-in_amplitude
+ */
+static float sos_check_input(uint32_t *p_seed)
+{
+    *p_seed = *p_seed * 1664525 + 1013904223;
+
+    return sos_check.in_amplitude *
+           ((float) (int32_t) *p_seed / (float) INT32_MAX);
+}
+
+/**
+ * Feed SOS cascade and 2P2Z chain with the same input sequence and count the
+ * samples on which their outputs aren't bit-exact.
+ */
+static unsigned long run_sos_check(unsigned long iters)
+{
+    unsigned long k, mismatches = 0;
+    uint32_t seed = 1;
+    float out_chain;
+
+    reset_sos_check();
+
+    for(k = 0; k < iters; k++)
+    {
+        sos_check.chain_sig[0] = sos_check_input(&seed);
+        run_dsp_iir_sos(&sos_check.sos);
+        out_chain = run_sos_chain();
+
+        if(memcmp(&sos_check.sos_out, &out_chain, sizeof(float)))
+        {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+/**
+ * Cost of SOS cascade (run_chain = 0) or of the equivalent 2P2Z chain, fed
+ * with alternating inputs as the controller benchmark.
+ */
+static double bench_sos(unsigned long iters, int run_chain, double *p_cycles)
+{
+    struct timespec t0, t1;
+    uint64_t c0, c1;
+    unsigned long k;
+
+    reset_sos_check();
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = READ_CYCLES();
+
+    for(k = 0; k < iters; k++)
+    {
+        sos_check.chain_sig[0] = (k & 1) ? 0.001 : -0.001;
+
+        if(run_chain)
+        {
+            run_sos_chain();
+        }
+        else
+        {
+            run_dsp_iir_sos(&sos_check.sos);
+        }
+    }
+
+    c1 = READ_CYCLES();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    *p_cycles = (c1 > c0) ? (double) (c1 - c0) / iters : 0.0;
+
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / iters;
+}
+
+static void run_modules(void)
+{
+    run_dsp_error(ERROR_CTRL);
+    run_dsp_pi(PI_CTRL);
+    run_dsp_iir_sos(SOS_CTRL);
+}
+
+/**
+ * Set new PI gains while loop is running, as set_dsp_coeffs BSMP function
+ * does. They take effect all at once, on next cycle.
+ */
+static void retune_controller(sim_cfg_t *p_cfg)
+{
+    float coeffs[NUM_MAX_COEFFS_DSP];
+
+    coeffs[0] = p_cfg->retune_kp;
+    coeffs[1] = p_cfg->retune_ki;
+    coeffs[2] = p_cfg->u_max;
+    coeffs[3] = p_cfg->u_min;
+    set_dsp_coeffs(&g_controller_ctom, DSP_PI, 0, coeffs);
+
+    if(p_cfg->fixed)
+    {
+        cfg_dsp_pi_q31(&ctrl_q31.pi_ctrl, coeffs);
+        cfg_dsp_pi_q15(&ctrl_q15.pi_ctrl, coeffs);
+    }
+}
+
+static void run_controller(void)
+{
+    /// New coefficients take effect at cycle boundary, as on control loop,
+    /// both for modules and plan, which references their banks
+    swap_dsp_coeffs(&g_controller_ctom, 0);
+
+    if(use_plan)
+    {
+        run_dsp_plan(&plan);
+    }
+    else
+    {
+        run_modules();
+    }
+}
+
+/**
+ * Step response figures, considering reference step at first sample.
+ */
+static void report_step(const float *p_y, unsigned long n, double ts,
+                        double step)
+{
+    unsigned long k, k10 = 0, k90 = 0, k_settle = 0, k_ss;
+    double y_max = -INFINITY, ss = 0.0;
+    int found10 = 0, found90 = 0;
+
+    for(k = 0; k < n; k++)
+    {
+        if(p_y[k] > y_max)
+        {
+            y_max = p_y[k];
+        }
+
+        if(!found10 && (p_y[k] >= 0.1 * step))
+        {
+            k10 = k;
+            found10 = 1;
+        }
+
+        if(!found90 && (p_y[k] >= 0.9 * step))
+        {
+            k90 = k;
+            found90 = 1;
+        }
+
+        if(fabs(p_y[k] - step) > SETTLING_BAND * fabs(step))
+        {
+            k_settle = k + 1;
+        }
+    }
+
+    /// Steady-state from last 10% of simulation
+    k_ss = n - n / 10;
+    for(k = k_ss; k < n; k++)
+    {
+        ss += p_y[k];
+    }
+    ss /= (n - k_ss);
+
+    if(found10 && found90)
+    {
+        printf("rise time (10-90%%):   %.3f us\n", (k90 - k10) * ts * 1e6);
+    }
+    else
+    {
+        printf("rise time (10-90%%):   not reached\n");
+    }
+
+    printf("overshoot:             %.2f %%\n",
+           (y_max > step) ? 100.0 * (y_max - step) / step : 0.0);
+
+    if(k_settle < n)
+    {
+        printf("settling time (%g%%):   %.3f us\n", SETTLING_BAND * 100.0,
+               k_settle * ts * 1e6);
+    }
+    else
+    {
+        printf("settling time (%g%%):   not settled\n", SETTLING_BAND * 100.0);
+    }
+
+    printf("steady-state error:    %.4g\n", step - ss);
+}
+
+/**
+ * Cost of fixed-point controller kernels, fed with the same input sequence as
+ * float kernels, already converted as it would come from an ADC.
+ */
+static double bench_fixed_controller(unsigned long iters, double *p_cycles,
+                                     float *p_out)
+{
+    struct timespec t0, t1;
+    uint64_t c0, c1;
+    unsigned long k;
+    q31_t meas_q31[2];
+    q15_t meas_q15[2];
+
+    reset_fixed_controller();
+    ctrl_q31.ref = 0;
+    ctrl_q15.ref = 0;
+    meas_q31[0] = float_to_q31(-0.001, fixed_full_scale);
+    meas_q31[1] = float_to_q31(0.001, fixed_full_scale);
+    meas_q15[0] = float_to_q15(-0.001, fixed_full_scale);
+    meas_q15[1] = float_to_q15(0.001, fixed_full_scale);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = READ_CYCLES();
+
+    for(k = 0; k < iters; k++)
+    {
+        ctrl_q31.meas = meas_q31[k & 1];
+        ctrl_q15.meas = meas_q15[k & 1];
+        run_fixed_modules();
+    }
+
+    c1 = READ_CYCLES();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    *p_cycles = (c1 > c0) ? (double) (c1 - c0) / iters : 0.0;
+    *p_out = (fixed_format == 31) ?
+             q31_to_float(ctrl_q31.duty, DUTY_FULL_SCALE) :
+             q15_to_float(ctrl_q15.duty, DUTY_FULL_SCALE);
+
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / iters;
+}
+
+/**
+ * Cost of controller kernels, without plant model, when run module by module
+ * or through execution plan. Both are fed with the same input sequence, so
+ * their outputs must match. With run_plan = 2, fixed-point kernels are run.
+ */
+static double bench_controller(unsigned long iters, int run_plan,
+                               double *p_cycles, float *p_out)
+{
+    struct timespec t0, t1;
+    uint64_t c0, c1;
+    unsigned long k;
+
+    if(run_plan > 1)
+    {
+        return bench_fixed_controller(iters, p_cycles, p_out);
+    }
+
+    reset_dsp_pi(PI_CTRL);
+    reset_dsp_iir_sos(SOS_CTRL);
+    REFERENCE = 0.0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = READ_CYCLES();
+
+    for(k = 0; k < iters; k++)
+    {
+        MEASUREMENT = (k & 1) ? 0.001 : -0.001;
+
+        if(run_plan)
+        {
+            run_dsp_plan(&plan);
+        }
+        else
+        {
+            run_modules();
+        }
+    }
+
+    c1 = READ_CYCLES();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    *p_cycles = (c1 > c0) ? (double) (c1 - c0) / iters : 0.0;
+    *p_out = DUTY_CYCLE;
+
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / iters;
+}
+
+static void report_bench(unsigned long iters)
+{
+    double ns, cycles, best_ns[3] = {INFINITY, INFINITY, INFINITY};
+    double best_cycles[3];
+    float out[3];
+    unsigned int i, round, num_runs = fixed_format ? 3 : 2;
+    static const char *labels[3] =
+    {
+        "module kernels:  ", "plan kernels:    ", "fixed kernels:   "
+    };
+
+    if(!iters)
+    {
+        return;
+    }
+
+    /// Alternate both runs and keep the best, to reduce host noise
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for(i = 0; i < num_runs; i++)
+        {
+            ns = bench_controller(iters, i, &cycles, &out[i]);
+
+            if(ns < best_ns[i])
+            {
+                best_ns[i] = ns;
+                best_cycles[i] = cycles;
+            }
+        }
+    }
+
+    printf("plan operations:       %u per iteration\n", plan.num_ops);
+
+    for(i = 0; i < num_runs; i++)
+    {
+        printf("%s    %.1f ns/iteration", labels[i], best_ns[i]);
+        if(best_cycles[i] > 0.0)
+        {
+            printf(", %.1f cycles/iteration", best_cycles[i]);
+        }
+        printf("\n");
+    }
+
+    printf("plan output:           %s\n",
+           memcmp(&out[0], &out[1], sizeof(float)) ? "MISMATCH" :
+                                                      "matches modules");
+
+    if(fixed_format)
+    {
+        printf("fixed output:          %g (float %g)\n", out[2], out[0]);
+    }
+}
+
+/**
+ * Check SOS cascade against 2P2Z chain over iters samples and compare their
+ * cost. Returns the number of samples which aren't bit-exact.
+ */
+static unsigned long report_sos_check(unsigned long iters)
+{
+    double ns, cycles, best_ns[2] = {INFINITY, INFINITY};
+    double best_cycles[2];
+    unsigned long mismatches;
+    unsigned int i, round;
+    static const char *labels[2] =
+    {
+        "sos cascade:     ", "2p2z chain:      "
+    };
+
+    if(!iters)
+    {
+        return 0;
+    }
+
+    mismatches = run_sos_check(iters);
+
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for(i = 0; i < 2; i++)
+        {
+            ns = bench_sos(iters, i, &cycles);
+
+            if(ns < best_ns[i])
+            {
+                best_ns[i] = ns;
+                best_cycles[i] = cycles;
+            }
+        }
+    }
+
+    printf("sos sections:          %u\n", sos_check.num_sections);
+
+    for(i = 0; i < 2; i++)
+    {
+        printf("%s    %.1f ns/iteration", labels[i], best_ns[i]);
+        if(best_cycles[i] > 0.0)
+        {
+            printf(", %.1f cycles/iteration", best_cycles[i]);
+        }
+        printf("\n");
+    }
+
+    if(mismatches)
+    {
+        printf("sos output:            MISMATCH on %lu of %lu samples\n",
+               mismatches, iters);
+    }
+    else
+    {
+        printf("sos output:            matches 2p2z chain\n");
+    }
+
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    sim_cfg_t cfg =
+    {
+        .plant = Plant_RL,
+        .freq = 50000.0,
+        .time = 0.01,
+        .step = 10.0,
+        .r = 1.0,
+        .l = 0.01,
+        .c = 0.001,
+        .r_load = 10.0,
+        .vdc = 100.0,
+        .kp = 0.628,
+        .ki = 0.00126,
+        .u_max = 1.0,
+        .u_min = -1.0,
+        .substeps = 20,
+        .bench_iters = 1000000,
+        .retune_time = -1.0,
+    };
+    plant_t plant;
+    unsigned long k, n, k_retune;
+    float *p_y;
+    FILE *p_csv = NULL;
+    double ts, dev, dev_max = 0.0, dev_sq = 0.0;
+    unsigned long sos_mismatches;
+    float duty;
+
+    if(parse_args(argc, argv, &cfg))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ts = 1.0 / cfg.freq;
+    n = (unsigned long) (cfg.time * cfg.freq);
+    if(!n)
+    {
+        n = 1;
+    }
+
+    p_y = malloc(n * sizeof(float));
+    if(p_y == NULL)
+    {
+        return 1;
+    }
+
+    if(cfg.csv && ((p_csv = fopen(cfg.csv, "w")) == NULL))
+    {
+        perror(cfg.csv);
+        return 1;
+    }
+
+    init_plant(&plant, cfg.plant, cfg.r, cfg.l, cfg.c, cfg.r_load, cfg.freq,
+               cfg.substeps);
+    init_controller(&cfg);
+    init_sos_check(&cfg);
+
+    if(cfg.fixed)
+    {
+        init_fixed_controller(&cfg);
+    }
+
+    REFERENCE = cfg.step;
+    k_retune = (cfg.retune_time >= 0.0) ?
+               (unsigned long) (cfg.retune_time * cfg.freq) : n;
+
+    for(k = 0; k < n; k++)
+    {
+        if(k == k_retune)
+        {
+            retune_controller(&cfg);
+        }
+
+        p_y[k] = MEASUREMENT;
+        run_controller();
+        duty = DUTY_CYCLE;
+
+        if(cfg.fixed)
+        {
+            duty = run_fixed_controller(REFERENCE, MEASUREMENT);
+            dev = fabs(duty - DUTY_CYCLE);
+            dev_sq += dev * dev;
+            if(dev > dev_max)
+            {
+                dev_max = dev;
+            }
+        }
+
+        if(p_csv)
+        {
+            fprintf(p_csv, "%.9g,%g,%g,%g\n", k * ts, REFERENCE, MEASUREMENT,
+                    duty);
+        }
+
+        MEASUREMENT = run_plant(&plant, duty * cfg.vdc);
+    }
+
+    printf("samples:               %lu @ %g Hz\n", n, cfg.freq);
+    report_step(p_y, n, ts, cfg.step);
+
+    if(cfg.fixed)
+    {
+        printf("Q%d duty deviation:    max %.3g, rms %.3g\n", cfg.fixed,
+               dev_max, sqrt(dev_sq / n));
+    }
+
+    report_bench(cfg.bench_iters);
+    sos_mismatches = report_sos_check(cfg.bench_iters);
+
+    if(p_csv)
+    {
+        fclose(p_csv);
+    }
+    free(p_y);
+
+    return sos_mismatches ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file plant.c
+ * @brief Plant models for host simulation of control library
+ *
+ * @author agent
+ * @date 16/10/2026
+ *
+ */
+
+#include "plant.h"
+
+/**
+ * Initialization of plant model.
+ *
+ * @param p_plant
+ * @param type
+ * @param r
+ * @param l
+ * @param c
+ * @param r_load
+ * @param freq_sampling     control loop frequency [Hz]
+ * @param substeps          integration steps per control period
+ */
+void init_plant(plant_t *p_plant, plant_type_t type, double r, double l,
+                double c, double r_load, double freq_sampling,
+                unsigned int substeps)
+{
+    if(substeps == 0)
+    {
+        substeps = 1;
+    }
+
+    p_plant->type = type;
+    p_plant->r = r;
+    p_plant->l = l;
+    p_plant->c = c;
+    p_plant->r_load = r_load;
+    p_plant->substeps = substeps;
+    p_plant->dt = 1.0 / (freq_sampling * substeps);
+
+    reset_plant(p_plant);
+}
+
+/**
+ * Reset plant states.
+ *
+ * @param p_plant
+ */
+void reset_plant(plant_t *p_plant)
+{
+    p_plant->i = 0.0;
+    p_plant->v = 0.0;
+}
+
+/**
+ * Integrate plant over one control period, with input held constant.
+ *
+ * @param p_plant
+ * @param v_in      input voltage [V]
+ * @return measured output, current for RL load or voltage otherwise
+ */
+double run_plant(plant_t *p_plant, double v_in)
+{
+    unsigned int n;
+    double dt = p_plant->dt;
+
+    for(n = 0; n < p_plant->substeps; n++)
+    {
+        switch(p_plant->type)
+        {
+            case Plant_RL:
+            {
+                p_plant->i += dt * (v_in - p_plant->r * p_plant->i) / p_plant->l;
+                break;
+            }
+
+            case Plant_DCLink:
+            {
+                p_plant->i = (v_in - p_plant->v) / p_plant->r;
+                p_plant->v += dt * (p_plant->i - p_plant->v / p_plant->r_load) /
+                              p_plant->c;
+                break;
+            }
+
+            case Plant_LC:
+            {
+                p_plant->i += dt * (v_in - p_plant->r * p_plant->i - p_plant->v) /
+                              p_plant->l;
+                p_plant->v += dt * (p_plant->i - p_plant->v / p_plant->r_load) /
+                              p_plant->c;
+                break;
+            }
+        }
+    }
+
+    return (p_plant->type == Plant_RL) ? p_plant->i : p_plant->v;
+}
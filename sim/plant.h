@@ -0,0 +1,57 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file plant.h
+ * @brief Plant models for host simulation of control library
+ *
+ * Continuous-time models of typical power supply loads, integrated with
+ * semi-implicit Euler method on a number of sub-steps per control period:
+ *
+ *  - RL load:  L di/dt = v - R i                          (output: i)
+ *  - DC-link:  C dv/dt = (v_in - v)/R - v/R_load           (output: v)
+ *  - LC filter: L di/dt = v_in - R i - v
+ *               C dv/dt = i - v/R_load                     (output: v)
+ *
+ * @author agent
+ * @date 16/10/2026
+ *
+ */
+
+#ifndef PLANT_H_
+#define PLANT_H_
+
+typedef enum
+{
+    Plant_RL,
+    Plant_DCLink,
+    Plant_LC
+} plant_type_t;
+
+typedef struct
+{
+    plant_type_t    type;
+    double          r;          // Series resistance [ohm]
+    double          l;          // Inductance [H]
+    double          c;          // Capacitance [F]
+    double          r_load;     // Load resistance [ohm]
+    double          dt;         // Integration step [s]
+    unsigned int    substeps;   // Integration steps per control period
+    double          i;          // Inductor current [A]
+    double          v;          // Capacitor voltage [V]
+} plant_t;
+
+extern void init_plant(plant_t *p_plant, plant_type_t type, double r, double l,
+                       double c, double r_load, double freq_sampling,
+                       unsigned int substeps);
+extern void reset_plant(plant_t *p_plant);
+extern double run_plant(plant_t *p_plant, double v_in);
+
+#endif /* PLANT_H_ */
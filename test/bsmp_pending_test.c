@@ -0,0 +1,516 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file bsmp_pending_test.c
+ * @brief Host test of deferred BSMP responses to IPC commands
+ *
+ * Builds bsmp_lib.c and ipc_lib.c as ARM firmware does, with MTOC IPC
+ * registers in an array, and drives BSMP function requests through
+ * BSMPprocess(), as communication interfaces do. C28 is modelled by the test,
+ * which acknowledges commands by clearing their IPC flag or on the command
+ * ring, whenever it's told to. Checks that:
+ *  - requests return right away, leaving the response pending until C28
+ *    acknowledges the command, and then it's sent once;
+ *  - acknowledge callbacks run on acknowledge, and never on timeout;
+ *  - commands not acknowledged are answered with DSP_Timeout after
+ *    TIMEOUT_DSP_IPC_ACK ticks of global timer, however often they're
+ *    checked;
+ *  - with IPC flags, a second command gets DSP_Busy while one is pending,
+ *    and with command ring, commands from several interfaces are in flight
+ *    together, but a full ring gives DSP_Busy.
+ *
+ * Then reports how long a request takes to be processed, for several delays
+ * of C28 acknowledge, which used to be spent spinning on MTOCIPCFLG.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define READ_CYCLES()       __rdtsc()
+#else
+#define READ_CYCLES()       0
+#endif
+
+#include "inc/hw_ipc.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+
+#include "board_drivers/version.h"
+#include "communication_drivers/bsmp/bsmp_lib.h"
+#include "communication_drivers/control/control.h"
+#include "communication_drivers/ipc/ipc_lib.h"
+#include "communication_drivers/parameters/ps_parameters.h"
+#include "communication_drivers/rs485/rs485.h"
+#include "communication_drivers/timer/timer.h"
+
+/// As in bsmp_lib.c
+#define TIMEOUT_DSP_IPC_ACK     5
+
+#define BSMP_FUNC_EXECUTE       0x50
+#define BSMP_FUNC_RETURN        0x51
+#define BSMP_FUNC_ERROR         0x53
+
+#define FUNC_TURN_ON            0
+#define FUNC_TURN_OFF           1
+
+#define DIGITAL_POT_VALUE       42.0
+#define BENCH_ITERS             1000
+
+volatile unsigned int g_mtocipc_regs[8];
+
+volatile firmwares_version_t firmwares_version;
+const char * udc_arm_version = "";
+
+volatile control_framework_t g_controller_ctom;
+volatile control_framework_t g_controller_mtoc;
+volatile param_bank_t g_param_bank;
+volatile rs485_rx_stats_t g_rs485_rx_stats;
+volatile uint32_t global_timer_ticks;
+
+/**
+ * Request and response of a communication interface
+ */
+typedef struct
+{
+    uint8_t                 request_buf[16];
+    uint8_t                 response_buf[16];
+    struct bsmp_raw_packet  request;
+    struct bsmp_raw_packet  response;
+    uint32_t                sent;           // Responses transmitted
+} interface_t;
+
+static interface_t remote, local;
+
+static uint32_t turn_on_acks;
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+/* Firmware functions used by bsmp_lib.c and ipc_lib.c */
+
+void IntRegister(unsigned long ulInterrupt, void (*pfnHandler)(void)) {}
+void IntEnable(unsigned long ulInterrupt) {}
+void IPCCtoMFlagAcknowledge(unsigned long ulFlags) {}
+void SysCtlDelay(unsigned long ulCount) {}
+void SysCtlHoldSubSystemInReset(unsigned long ulSubSystem) {}
+void SysCtlReset(void) {}
+void TaskSetNew(uint8_t TaskNum) {}
+void hradc_rst_ctrl(uint8_t sts) {}
+void rs485_term_ctrl(uint8_t sts) {}
+bool rs485_propose_baudrate(uint32_t BaudRate) { return false; }
+
+float get_param(param_id_t id, uint16_t n) { return 0.0; }
+uint8_t set_param(param_id_t id, uint16_t n, float val) { return 0; }
+uint8_t save_param_eeprom(param_id_t id, uint16_t n,
+                          param_memory_t type_memory) { return 0; }
+uint8_t load_param_eeprom(param_id_t id, uint16_t n,
+                          param_memory_t type_memory) { return 0; }
+void save_param_bank(param_memory_t type_memory) {}
+void load_param_bank(param_memory_t type_memory) {}
+
+uint8_t save_dsp_coeffs_eeprom(dsp_class_t dsp_class, uint16_t id,
+                               param_memory_t type_memory) { return 0; }
+uint8_t load_dsp_coeffs_eeprom(dsp_class_t dsp_class, uint16_t id,
+                               param_memory_t type_memory) { return 0; }
+void save_dsp_modules_eeprom(param_memory_t type_memory) {}
+void load_dsp_modules_eeprom(param_memory_t type_memory) {}
+
+uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
+                       dsp_class_t dsp_class, uint16_t id, float *p_coeffs)
+{
+    return 0;
+}
+
+float get_dsp_coeff(volatile control_framework_t *p_controller,
+                    dsp_class_t dsp_class, uint16_t id, uint16_t coeff)
+{
+    return 0.0;
+}
+
+/**
+ * Turn on callback of FBP DC-Link reads the digital potentiometer, so it's
+ * counted here
+ */
+float get_digital_potentiometer(void)
+{
+    turn_on_acks++;
+    return DIGITAL_POT_VALUE;
+}
+
+void set_digital_potentiometer(float perc) {}
+
+static void c28_latch_flags(void);
+
+/* Communication interfaces */
+
+static void remote_send_response(void)
+{
+    remote.sent++;
+}
+
+static void local_send_response(void)
+{
+    local.sent++;
+}
+
+/**
+ * Process function execute request as a communication interface does,
+ * deferring its response if an IPC command is pending
+ */
+static void request_func(interface_t *p_if, uint8_t server, uint8_t func_id,
+                         uint16_t command_interface)
+{
+    p_if->request_buf[0] = BSMP_FUNC_EXECUTE;
+    p_if->request_buf[1] = 0;
+    p_if->request_buf[2] = 1;
+    p_if->request_buf[3] = func_id;
+
+    p_if->request.data = p_if->request_buf;
+    p_if->request.len = 4;
+    p_if->response.data = p_if->response_buf;
+    p_if->response.max_len = sizeof(p_if->response_buf);
+
+    BSMPprocess(&p_if->request, &p_if->response, server, command_interface);
+    c28_latch_flags();
+
+    if(bsmp_cmd_pending(NULL))
+    {
+        bsmp_defer_response(&p_if->response, (p_if == &remote) ?
+                                             remote_send_response :
+                                             local_send_response);
+    }
+    else
+    {
+        p_if->sent++;
+    }
+}
+
+/**
+ * Check that last response of interface is specified answer with command_ack
+ */
+static bool response_is(interface_t *p_if, uint8_t answer, uint8_t ack)
+{
+    return (p_if->response_buf[0] == answer) &&
+           (p_if->response_buf[1] == 0) && (p_if->response_buf[2] == 1) &&
+           (p_if->response_buf[3] == ack);
+}
+
+/* C28 */
+
+/**
+ * Messages raised by ARM on MTOCIPCSET are latched on MTOCIPCFLG, as IPC
+ * hardware does as soon as they're written
+ */
+static void c28_latch_flags(void)
+{
+    HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) |=
+                                    HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCSET);
+    HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCSET) = 0;
+}
+
+static void c28_ack_flags(void)
+{
+    HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &= IPC_MTOC_CMD_RING;
+}
+
+/**
+ * Acknowledge up to n commands queued on command ring. Returns number of
+ * commands acknowledged.
+ */
+static uint16_t c28_ack_ring(uint16_t n)
+{
+    uint16_t count = 0;
+    volatile ipc_cmd_ack_t *p_ack;
+
+    HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &= ~IPC_MTOC_CMD_RING;
+
+    while( (count < n) &&
+           (g_ipc_ctom_cmd_ring.read_idx != g_ipc_mtoc_cmd_ring.write_idx) )
+    {
+        p_ack = &g_ipc_ctom_cmd_ring.ack[g_ipc_ctom_cmd_ring.ack_write_idx &
+                                        IPC_CMD_RING_MASK];
+        p_ack->seq = g_ipc_ctom_cmd_ring.read_idx;
+        p_ack->result = No_Error_MtoC;
+
+        g_ipc_ctom_cmd_ring.ack_write_idx++;
+        g_ipc_ctom_cmd_ring.read_idx++;
+        count++;
+    }
+
+    return count;
+}
+
+static void c28_enable_ring(bool enable)
+{
+    g_ipc_ctom_cmd_ring.version = enable ? IPC_CMD_RING_VERSION : 0;
+}
+
+/**
+ * Run deferred task n times, as main loop does
+ */
+static void check_pending(uint16_t n)
+{
+    while(n--)
+    {
+        bsmp_check_pending_cmd();
+    }
+}
+
+/* Tests */
+
+static void test_flag_ack(void)
+{
+    uint32_t sent = remote.sent;
+
+    c28_enable_ring(false);
+    g_ipc_ctom.ps_module[0].ps_status.bit.model = FBP_DCLink;
+    g_ipc_mtoc.ps_module[0].ps_setpoint.f = 0.0;
+    turn_on_acks = 0;
+
+    request_func(&remote, 0, FUNC_TURN_ON, Remote);
+
+    CHECK(remote.sent == sent, "flag: response sent before acknowledge");
+    CHECK(HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
+          low_priority_msg_to_reg(Turn_On), "flag: Turn_On not raised");
+
+    check_pending(100);
+    CHECK(remote.sent == sent, "flag: response sent without acknowledge");
+    CHECK(!turn_on_acks, "flag: callback run without acknowledge");
+
+    c28_ack_flags();
+    check_pending(1);
+    CHECK(remote.sent == sent + 1, "flag: response not sent on acknowledge");
+    CHECK(response_is(&remote, BSMP_FUNC_RETURN, Ok),
+          "flag: response isn't Ok");
+    CHECK(turn_on_acks == 1, "flag: callback run %u times", turn_on_acks);
+    CHECK(g_ipc_mtoc.ps_module[0].ps_setpoint.f == DIGITAL_POT_VALUE,
+          "flag: callback didn't update setpoint");
+
+    check_pending(100);
+    CHECK(remote.sent == sent + 1, "flag: response sent again");
+    CHECK(turn_on_acks == 1, "flag: callback run again");
+}
+
+static void test_flag_busy(void)
+{
+    uint32_t sent = remote.sent;
+
+    c28_enable_ring(false);
+    g_ipc_ctom.ps_module[1].ps_status.bit.interface = Local;
+
+    request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+    request_func(&local, 1, FUNC_TURN_OFF, Local);
+
+    CHECK(response_is(&local, BSMP_FUNC_ERROR, DSP_Busy),
+          "flag busy: second command not refused");
+    CHECK(remote.sent == sent, "flag busy: first response sent");
+
+    c28_ack_flags();
+    check_pending(1);
+    CHECK(remote.sent == sent + 1, "flag busy: first response not sent");
+    CHECK(response_is(&remote, BSMP_FUNC_RETURN, Ok),
+          "flag busy: first response isn't Ok");
+}
+
+static void test_timeout(void)
+{
+    uint32_t sent = remote.sent;
+
+    c28_enable_ring(false);
+    g_ipc_mtoc.ps_module[0].ps_setpoint.f = 0.0;
+    turn_on_acks = 0;
+
+    request_func(&remote, 0, FUNC_TURN_ON, Remote);
+
+    /// Timeout doesn't depend on how often pending commands are checked
+    global_timer_ticks += TIMEOUT_DSP_IPC_ACK - 1;
+    check_pending(10000);
+    CHECK(remote.sent == sent, "timeout: response sent before timeout");
+
+    global_timer_ticks++;
+    check_pending(1);
+    CHECK(remote.sent == sent + 1, "timeout: response not sent on timeout");
+    CHECK(response_is(&remote, BSMP_FUNC_ERROR, DSP_Timeout),
+          "timeout: response isn't DSP_Timeout");
+    CHECK(!turn_on_acks, "timeout: callback run");
+    CHECK(g_ipc_mtoc.ps_module[0].ps_setpoint.f == 0.0,
+          "timeout: setpoint updated");
+
+    /// Flag is still raised, until C28 clears it late
+    request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+    CHECK(response_is(&remote, BSMP_FUNC_ERROR, DSP_Busy),
+          "timeout: command sent over flag not acknowledged");
+
+    c28_ack_flags();
+    request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+    c28_ack_flags();
+    check_pending(1);
+    CHECK(response_is(&remote, BSMP_FUNC_RETURN, Ok),
+          "timeout: command after late acknowledge isn't Ok");
+}
+
+static void test_ring(void)
+{
+    uint32_t sent_remote = remote.sent;
+    uint32_t sent_local = local.sent;
+    uint16_t seq;
+    uint8_t i;
+
+    c28_enable_ring(true);
+    g_ipc_ctom.ps_module[1].ps_status.bit.interface = Local;
+    turn_on_acks = 0;
+
+    request_func(&remote, 0, FUNC_TURN_ON, Remote);
+    request_func(&local, 1, FUNC_TURN_OFF, Local);
+
+    CHECK(remote.sent == sent_remote, "ring: first response sent");
+    CHECK(local.sent == sent_local, "ring: second command not in flight");
+    CHECK(g_ipc_mtoc_cmd_ring.cmd[(g_ipc_mtoc_cmd_ring.write_idx - 2) &
+                                  IPC_CMD_RING_MASK].msg == Turn_On,
+          "ring: Turn_On not queued");
+    CHECK(HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) & IPC_MTOC_CMD_RING,
+          "ring: doorbell not rung");
+    CHECK(!(HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCFLG) &
+            IPC_MTOC_LOWPRIORITY_MSG), "ring: IPC flag raised");
+
+    c28_ack_ring(1);
+    check_pending(1);
+    CHECK(remote.sent == sent_remote + 1, "ring: first response not sent");
+    CHECK(response_is(&remote, BSMP_FUNC_RETURN, Ok),
+          "ring: first response isn't Ok");
+    CHECK(turn_on_acks == 1, "ring: callback run %u times", turn_on_acks);
+    CHECK(local.sent == sent_local, "ring: second response sent early");
+
+    c28_ack_ring(1);
+    check_pending(1);
+    CHECK(local.sent == sent_local + 1, "ring: second response not sent");
+    CHECK(response_is(&local, BSMP_FUNC_RETURN, Ok),
+          "ring: second response isn't Ok");
+
+    /// Ring filled by commands of other sources
+    for(i = 0; i < IPC_CMD_RING_SIZE; i++)
+    {
+        ipc_cmd_ring_send(2, Reset_Counters, 0);
+    }
+    seq = ipc_cmd_ring_last_seq();
+
+    request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+    CHECK(response_is(&remote, BSMP_FUNC_ERROR, DSP_Busy),
+          "ring full: command not refused");
+    CHECK(ipc_cmd_ring_last_seq() == seq, "ring full: command queued");
+
+    c28_ack_ring(IPC_CMD_RING_SIZE);
+    request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+    c28_ack_ring(1);
+    check_pending(1);
+    CHECK(response_is(&remote, BSMP_FUNC_RETURN, Ok),
+          "ring full: command after acknowledges isn't Ok");
+
+    /// Timeout on ring, as on flags
+    request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+    global_timer_ticks += TIMEOUT_DSP_IPC_ACK;
+    check_pending(1);
+    CHECK(response_is(&remote, BSMP_FUNC_ERROR, DSP_Timeout),
+          "ring: response isn't DSP_Timeout");
+    c28_ack_ring(1);
+}
+
+/**
+ * Cycles taken by requests and by each run of deferred task, for C28
+ * acknowledge after several delays. Requests used to spin on MTOCIPCFLG until
+ * acknowledge, so they took the whole delay, up to TIMEOUT_DSP_IPC_ACK.
+ */
+static void bench_latency(void)
+{
+    static const uint8_t delays[] = {0, 1, 2, 4};
+    uint64_t t0, cycles_request, cycles_check;
+    uint32_t sent, checks;
+    uint16_t i, d;
+
+    printf("\nack delay   request   deferred task\n");
+    printf("[ticks]     [cycles]  [cycles/call]\n");
+
+    c28_enable_ring(true);
+
+    for(d = 0; d < sizeof(delays); d++)
+    {
+        cycles_request = cycles_check = checks = 0;
+
+        for(i = 0; i < BENCH_ITERS; i++)
+        {
+            sent = remote.sent;
+
+            t0 = READ_CYCLES();
+            request_func(&remote, 0, FUNC_TURN_OFF, Remote);
+            cycles_request += READ_CYCLES() - t0;
+
+            global_timer_ticks += delays[d];
+            c28_ack_ring(1);
+
+            t0 = READ_CYCLES();
+            while(remote.sent == sent)
+            {
+                bsmp_check_pending_cmd();
+                checks++;
+            }
+            cycles_check += READ_CYCLES() - t0;
+        }
+
+        printf("%-11u %-9.0f %.0f\n", delays[d],
+               (double) cycles_request / BENCH_ITERS,
+               (double) cycles_check / checks);
+    }
+}
+
+int main(void)
+{
+    uint8_t i;
+
+    init_ipc();
+
+    for(i = 0; i < NUMBER_OF_BSMP_SERVERS; i++)
+    {
+        bsmp_init(i);
+    }
+
+    test_flag_ack();
+    test_flag_busy();
+    test_timeout();
+    test_ring();
+    bench_latency();
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,379 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file bsmp_stream_test.c
+ * @brief Host test of scope stream curves
+ *
+ * Builds bsmp_lib.c and ipc_lib.c as ARM firmware does, and reads the scope
+ * stream curve through BSMPprocess(), as communication interfaces do. C28 is
+ * modelled by the test, which writes numbered frames on the scope buffer and
+ * drops them when the ring is full. Checks that:
+ *  - frames are released to C28 only when the next request acknowledges them;
+ *  - a request repeated after a lost answer gets the same frames again;
+ *  - requests acknowledging anything else are refused;
+ *  - along a random trace of frames written and answers lost, the client
+ *    receives every frame in order, and only frames counted as dropped by
+ *    C28 are missing.
+ *
+ * Then reports the frames received and dropped, and the answers lost, in that
+ * trace.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board_drivers/version.h"
+#include "communication_drivers/bsmp/bsmp_lib.h"
+#include "communication_drivers/control/control.h"
+#include "communication_drivers/ipc/ipc_lib.h"
+#include "communication_drivers/parameters/ps_parameters.h"
+#include "communication_drivers/rs485/rs485.h"
+
+#define BSMP_FUNC_EXECUTE       0x50
+#define BSMP_FUNC_RETURN        0x51
+#define BSMP_CURVE_BLOCK_REQ    0x40
+#define BSMP_CURVE_BLOCK        0x41
+
+#define FUNC_ENABLE_STREAM      45
+#define CURVE_STREAM            6       // 1 kB blocks
+
+#define SIZE_STREAM_HEADER      4
+#define SIZE_STREAM_FRAME       (STREAM_FRAME_SIZE * sizeof(float))
+#define MAX_FRAMES_PER_BLOCK    ((1024 - SIZE_STREAM_HEADER) / SIZE_STREAM_FRAME)
+
+#define NUMBER_OF_FRAMES        16      // Frames in scope buffer
+#define TRACE_READS             200000
+
+volatile unsigned int g_mtocipc_regs[8];
+
+volatile firmwares_version_t firmwares_version;
+const char * udc_arm_version = "";
+
+volatile control_framework_t g_controller_ctom;
+volatile control_framework_t g_controller_mtoc;
+volatile param_bank_t g_param_bank;
+volatile rs485_rx_stats_t g_rs485_rx_stats;
+volatile uint32_t global_timer_ticks;
+
+static float scope_buf[NUMBER_OF_FRAMES * STREAM_FRAME_SIZE];
+
+static uint8_t request_buf[16];
+static uint8_t response_buf[1024 + 7];
+
+/**
+ * C28 numbers every frame it writes, dropped or not
+ */
+static uint32_t c28_written;
+
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+/* Firmware functions used by bsmp_lib.c and ipc_lib.c */
+
+void IntRegister(unsigned long ulInterrupt, void (*pfnHandler)(void)) {}
+void IntEnable(unsigned long ulInterrupt) {}
+void IPCCtoMFlagAcknowledge(unsigned long ulFlags) {}
+void SysCtlDelay(unsigned long ulCount) {}
+void SysCtlHoldSubSystemInReset(unsigned long ulSubSystem) {}
+void SysCtlReset(void) {}
+void TaskSetNew(uint8_t TaskNum) {}
+void hradc_rst_ctrl(uint8_t sts) {}
+void rs485_term_ctrl(uint8_t sts) {}
+bool rs485_propose_baudrate(uint32_t BaudRate) { return false; }
+
+float get_param(param_id_t id, uint16_t n) { return 0.0; }
+uint8_t set_param(param_id_t id, uint16_t n, float val) { return 0; }
+uint8_t save_param_eeprom(param_id_t id, uint16_t n,
+                          param_memory_t type_memory) { return 0; }
+uint8_t load_param_eeprom(param_id_t id, uint16_t n,
+                          param_memory_t type_memory) { return 0; }
+void save_param_bank(param_memory_t type_memory) {}
+void load_param_bank(param_memory_t type_memory) {}
+
+uint8_t save_dsp_coeffs_eeprom(dsp_class_t dsp_class, uint16_t id,
+                               param_memory_t type_memory) { return 0; }
+uint8_t load_dsp_coeffs_eeprom(dsp_class_t dsp_class, uint16_t id,
+                               param_memory_t type_memory) { return 0; }
+void save_dsp_modules_eeprom(param_memory_t type_memory) {}
+void load_dsp_modules_eeprom(param_memory_t type_memory) {}
+
+uint8_t set_dsp_coeffs(volatile control_framework_t *p_controller,
+                       dsp_class_t dsp_class, uint16_t id, float *p_coeffs)
+{
+    return 0;
+}
+
+float get_dsp_coeff(volatile control_framework_t *p_controller,
+                    dsp_class_t dsp_class, uint16_t id, uint16_t coeff)
+{
+    return 0.0;
+}
+
+float get_digital_potentiometer(void) { return 0.0; }
+void set_digital_potentiometer(float perc) {}
+
+/* C28 */
+
+/**
+ * Restart indexes once ARM starts a new session, as C28 does
+ */
+static void c28_start_session(void)
+{
+    g_ipc_ctom_stream[0].head = 0;
+    g_ipc_ctom_stream[0].dropped = 0;
+    g_ipc_ctom_stream[0].session = g_ipc_mtoc_stream[0].session;
+}
+
+/**
+ * Write n frames, each filled with its number. A frame is dropped if it would
+ * make head reach tail.
+ */
+static void c28_write_frames(unsigned int n)
+{
+    uint16_t head;
+    unsigned int i;
+
+    while(n--)
+    {
+        head = g_ipc_ctom_stream[0].head;
+
+        if((head + 1) % NUMBER_OF_FRAMES == g_ipc_mtoc_stream[0].tail)
+        {
+            g_ipc_ctom_stream[0].dropped++;
+        }
+        else
+        {
+            for(i = 0; i < STREAM_FRAME_SIZE; i++)
+            {
+                scope_buf[head * STREAM_FRAME_SIZE + i] = c28_written;
+            }
+            g_ipc_ctom_stream[0].head = (head + 1) % NUMBER_OF_FRAMES;
+        }
+
+        c28_written++;
+    }
+}
+
+/* Client */
+
+static uint8_t process(uint8_t cmd, uint8_t b0, uint8_t b1, uint8_t b2,
+                       uint16_t size)
+{
+    struct bsmp_raw_packet request, response;
+
+    request_buf[0] = cmd;
+    request_buf[1] = 0;
+    request_buf[2] = size;
+    request_buf[3] = b0;
+    request_buf[4] = b1;
+    request_buf[5] = b2;
+
+    request.data = request_buf;
+    request.len = 3 + size;
+    response.data = response_buf;
+    response.max_len = sizeof(response_buf);
+
+    BSMPprocess(&request, &response, 0, Remote);
+
+    return response_buf[0];
+}
+
+static void enable_stream(void)
+{
+    CHECK(process(BSMP_FUNC_EXECUTE, FUNC_ENABLE_STREAM, 0, 0, 1) ==
+          BSMP_FUNC_RETURN,
+          "stream not enabled");
+    c28_start_session();
+}
+
+/**
+ * Request stream block, acknowledging frames before next_seq. Returns number
+ * of frames received, or -1 if request is refused.
+ */
+static int read_stream(uint16_t next_seq, uint16_t *p_seq,
+                       uint16_t *p_dropped, float *frames)
+{
+    uint16_t size;
+
+    if(process(BSMP_CURVE_BLOCK_REQ, CURVE_STREAM, 0, (uint8_t) next_seq, 3) !=
+       BSMP_CURVE_BLOCK)
+    {
+        return -1;
+    }
+
+    size = (response_buf[1] << 8) + response_buf[2] - 3;
+    memcpy(p_seq, &response_buf[6], 2);
+    memcpy(p_dropped, &response_buf[8], 2);
+    memcpy(frames, &response_buf[6 + SIZE_STREAM_HEADER],
+           size - SIZE_STREAM_HEADER);
+
+    return (size - SIZE_STREAM_HEADER) / SIZE_STREAM_FRAME;
+}
+
+static void test_ack(void)
+{
+    static float frames[MAX_FRAMES_PER_BLOCK * STREAM_FRAME_SIZE];
+    uint16_t seq, dropped;
+    int n;
+
+    c28_written = 0;
+    enable_stream();
+    c28_write_frames(5);
+
+    n = read_stream(0, &seq, &dropped, frames);
+    CHECK((n == MAX_FRAMES_PER_BLOCK) && (seq == 0) && (frames[0] == 0.0),
+          "first read: %d frames from %u", n, seq);
+    CHECK(g_ipc_mtoc_stream[0].tail == 0, "frames released before ack");
+
+    /// Answer lost: same request gets the same frames
+    n = read_stream(0, &seq, &dropped, frames);
+    CHECK((n == MAX_FRAMES_PER_BLOCK) && (seq == 0) && (frames[0] == 0.0),
+          "repeated read: %d frames from %u", n, seq);
+    CHECK(g_ipc_mtoc_stream[0].tail == 0, "frames released by repeated read");
+
+    n = read_stream(3, &seq, &dropped, frames);
+    CHECK((n == 2) && (seq == 3) && (frames[STREAM_FRAME_SIZE] == 4.0),
+          "acknowledging read: %d frames from %u", n, seq);
+    CHECK(g_ipc_mtoc_stream[0].tail == 3, "tail %u after ack, expected 3",
+          g_ipc_mtoc_stream[0].tail);
+
+    CHECK(read_stream(42, &seq, &dropped, frames) < 0,
+          "read acknowledging unknown frames not refused");
+    CHECK(read_stream(4, &seq, &dropped, frames) < 0,
+          "read acknowledging part of the frames not refused");
+
+    n = read_stream(5, &seq, &dropped, frames);
+    CHECK((n == 0) && (seq == 5) && (g_ipc_mtoc_stream[0].tail == 5),
+          "read of empty stream: %d frames from %u, tail %u", n, seq,
+          g_ipc_mtoc_stream[0].tail);
+
+    /// Frames not acknowledged still take room in the ring
+    c28_write_frames(NUMBER_OF_FRAMES + 2);
+    n = read_stream(5, &seq, &dropped, frames);
+    CHECK(dropped == 3, "%u frames dropped with full ring, expected 3",
+          dropped);
+}
+
+/**
+ * xorshift32
+ */
+static uint32_t random_next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void test_trace(void)
+{
+    static float frames[MAX_FRAMES_PER_BLOCK * STREAM_FRAME_SIZE];
+    uint32_t random_state = 0x57AE57AE;
+    uint32_t received = 0, lost = 0, last = 0, r;
+    uint16_t next_seq = 0, seq, dropped = 0;
+    unsigned int k;
+    int n, i;
+
+    c28_written = 0;
+    enable_stream();
+
+    for(k = 0; (k < TRACE_READS) && !failures; k++)
+    {
+        r = random_next(&random_state);
+        c28_write_frames(r % (MAX_FRAMES_PER_BLOCK + 2));
+
+        n = read_stream(next_seq, &seq, &dropped, frames);
+        if(n < 0)
+        {
+            CHECK(0, "read %u acknowledging %u refused", k, next_seq);
+            break;
+        }
+
+        /// Answer lost on the line: client asks for the same frames again
+        if((r >> 16) % 4 == 0)
+        {
+            lost++;
+            continue;
+        }
+
+        if(seq != next_seq)
+        {
+            CHECK(0, "read %u: frames from %u, expected %u", k, seq, next_seq);
+            break;
+        }
+
+        for(i = 0; i < n; i++)
+        {
+            if(received && (frames[i * STREAM_FRAME_SIZE] <= last))
+            {
+                CHECK(0, "frame %u out of order", received);
+            }
+            last = frames[i * STREAM_FRAME_SIZE];
+            received++;
+        }
+
+        next_seq = seq + n;
+    }
+
+    /// Drain ring
+    do
+    {
+        n = read_stream(next_seq, &seq, &dropped, frames);
+        received += (n > 0) ? n : 0;
+        next_seq += (n > 0) ? n : 0;
+    }
+    while(n > 0);
+
+    CHECK(received + dropped == c28_written, "%u frames received and %u "
+          "dropped, %u written", received, dropped, c28_written);
+
+    printf("%u frames written, %u received, %u dropped by C28; %u answers "
+           "lost\n", c28_written, received, dropped, lost);
+}
+
+int main(void)
+{
+    init_ipc();
+    bsmp_init(0);
+
+    g_ipc_mtoc.scope[0].buffer.p_buf_start.p_f = scope_buf;
+    g_ipc_mtoc.scope[0].buffer.p_buf_end.p_f =
+                        &scope_buf[NUMBER_OF_FRAMES * STREAM_FRAME_SIZE - 1];
+
+    test_ack();
+    test_trace();
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,296 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file csum_bench.c
+ * @brief Host reference vectors and throughput benchmark of checksum kernels
+ *
+ * Builds the MD5, CRC32 and MurmurHash3 kernels used for BSMP curve checksums
+ * and checks that:
+ *  - each digest matches published reference vectors;
+ *  - the digest doesn't depend on how the input is split into updates, nor on
+ *    the alignment of the input buffer.
+ *
+ * Then reports the throughput of each kernel over a 16 kB curve, in bytes per
+ * cycle and MB/s.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define READ_CYCLES()       __rdtsc()
+#else
+#define READ_CYCLES()       0
+#endif
+
+#include "md5/md5.h"
+#include "crc32/crc32.h"
+#include "murmur3/murmur3.h"
+
+#define SIZE_CURVE              16384
+
+#define BENCH_ITERS             200
+#define BENCH_ROUNDS            5
+
+typedef void (*csum_fn_t) (uint8_t *digest, uint8_t *data, unsigned int len,
+                           unsigned int chunk);
+
+typedef struct
+{
+    const char *name;
+    csum_fn_t fn;
+    uint8_t size;
+} kernel_t;
+
+typedef struct
+{
+    const char *input;
+    const char *digest;     // Hex, as sent on the protocol (big-endian)
+} vector_t;
+
+/// Word aligned, so offsets below exercise the bytewise head of each kernel
+static uint8_t curve[SIZE_CURVE + 4] __attribute__((aligned(4)));
+
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+/*
+ * Digest of len bytes of data, in updates of at most chunk bytes
+ */
+static void md5(uint8_t *digest, uint8_t *data, unsigned int len,
+                unsigned int chunk)
+{
+    MD5_CTX ctx;
+    unsigned int n;
+
+    MD5Init(&ctx);
+    for(; len; data += n, len -= n)
+    {
+        n = len < chunk ? len : chunk;
+        MD5Update(&ctx, data, n);
+    }
+    MD5Final(digest, &ctx);
+}
+
+static void crc32(uint8_t *digest, uint8_t *data, unsigned int len,
+                  unsigned int chunk)
+{
+    CRC32_CTX ctx;
+    unsigned int n;
+
+    CRC32Init(&ctx);
+    for(; len; data += n, len -= n)
+    {
+        n = len < chunk ? len : chunk;
+        CRC32Update(&ctx, data, n);
+    }
+    CRC32Final(digest, &ctx);
+}
+
+static void murmur3(uint8_t *digest, uint8_t *data, unsigned int len,
+                    unsigned int chunk)
+{
+    MURMUR3_CTX ctx;
+    unsigned int n;
+
+    MURMUR3Init(&ctx);
+    for(; len; data += n, len -= n)
+    {
+        n = len < chunk ? len : chunk;
+        MURMUR3Update(&ctx, data, n);
+    }
+    MURMUR3Final(digest, &ctx);
+}
+
+static const kernel_t kernels[] =
+{
+    {"md5",     md5,     16},
+    {"crc32",   crc32,   4},
+    {"murmur3", murmur3, 4},
+};
+
+#define NUMBER_OF_KERNELS   (sizeof(kernels) / sizeof(kernels[0]))
+
+static const vector_t md5_vectors[] =
+{
+    {"",    "d41d8cd98f00b204e9800998ecf8427e"},
+    {"abc", "900150983cd24fb0d6963f7d28e17f72"},
+    {"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+    {"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+            "57edf4a22be3c955ac49da2e2107b67a"},
+};
+
+static const vector_t crc32_vectors[] =
+{
+    {"",          "00000000"},
+    {"123456789", "cbf43926"},
+    {"The quick brown fox jumps over the lazy dog", "414fa339"},
+};
+
+static const vector_t murmur3_vectors[] =
+{
+    {"",      "00000000"},
+    {"hello", "248bfa47"},
+    {"The quick brown fox jumps over the lazy dog", "2e4ff723"},
+};
+
+static void to_hex(char *hex, const uint8_t *digest, uint8_t size)
+{
+    uint8_t i;
+
+    for(i = 0; i < size; i++)
+    {
+        sprintf(hex + 2*i, "%02x", digest[i]);
+    }
+}
+
+static void check_vectors(const kernel_t *k, const vector_t *v, unsigned int n)
+{
+    uint8_t digest[16];
+    char hex[33];
+    unsigned int i;
+
+    for(i = 0; i < n; i++)
+    {
+        k->fn(digest, (uint8_t *) v[i].input, strlen(v[i].input), ~0U);
+        to_hex(hex, digest, k->size);
+        CHECK(!strcmp(hex, v[i].digest), "%s(\"%s\") = %s, expected %s",
+              k->name, v[i].input, hex, v[i].digest);
+    }
+}
+
+/*
+ * Split and misaligned updates must give the one-shot digest over aligned
+ * memory
+ */
+static void check_updates(const kernel_t *k)
+{
+    static const unsigned int chunks[] = {1, 3, 4, 5, 63, 64, 1000, 1024};
+    uint8_t ref[16], digest[16];
+    unsigned int i, offset;
+
+    k->fn(ref, curve, SIZE_CURVE, SIZE_CURVE);
+
+    for(i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+    {
+        k->fn(digest, curve, SIZE_CURVE, chunks[i]);
+        CHECK(!memcmp(digest, ref, k->size), "%s: updates of %u bytes",
+              k->name, chunks[i]);
+    }
+
+    for(offset = 1; offset < 4; offset++)
+    {
+        memmove(curve + offset, curve, SIZE_CURVE);
+        k->fn(digest, curve + offset, SIZE_CURVE, 1000);
+        CHECK(!memcmp(digest, ref, k->size), "%s: input at offset %u",
+              k->name, offset);
+        memmove(curve, curve + offset, SIZE_CURVE);
+    }
+}
+
+static double elapsed_us(struct timespec *t0, struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) * 1e6 + (t1->tv_nsec - t0->tv_nsec) / 1e3;
+}
+
+static void bench(const kernel_t *k)
+{
+    uint8_t digest[16];
+    struct timespec t0, t1;
+    double best_us = 1e30, best_cycles = 0.0, us;
+    uint64_t c0, c1;
+    unsigned int round, i;
+
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        c0 = READ_CYCLES();
+
+        for(i = 0; i < BENCH_ITERS; i++)
+        {
+            curve[0] = i;
+            k->fn(digest, curve, SIZE_CURVE, SIZE_CURVE);
+        }
+
+        c1 = READ_CYCLES();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        us = elapsed_us(&t0, &t1) / BENCH_ITERS;
+        if(us < best_us)
+        {
+            best_us = us;
+            best_cycles = (c1 > c0) ? (double) (c1 - c0) / BENCH_ITERS : 0.0;
+        }
+    }
+
+    printf("%-8s %8.1f us  %8.0f cycles  %6.2f bytes/cycle  %8.1f MB/s\n",
+           k->name, best_us, best_cycles,
+           best_cycles ? SIZE_CURVE / best_cycles : 0.0,
+           SIZE_CURVE / best_us);
+}
+
+int main(void)
+{
+    unsigned int i;
+
+    srand(1);
+    for(i = 0; i < SIZE_CURVE; i++)
+    {
+        curve[i] = rand();
+    }
+
+    check_vectors(&kernels[0], md5_vectors,
+                  sizeof(md5_vectors) / sizeof(md5_vectors[0]));
+    check_vectors(&kernels[1], crc32_vectors,
+                  sizeof(crc32_vectors) / sizeof(crc32_vectors[0]));
+    check_vectors(&kernels[2], murmur3_vectors,
+                  sizeof(murmur3_vectors) / sizeof(murmur3_vectors[0]));
+
+    for(i = 0; i < NUMBER_OF_KERNELS; i++)
+    {
+        check_updates(&kernels[i]);
+    }
+
+    printf("%u bytes, best of %u rounds of %u:\n", SIZE_CURVE, BENCH_ROUNDS,
+           BENCH_ITERS);
+    for(i = 0; i < NUMBER_OF_KERNELS; i++)
+    {
+        bench(&kernels[i]);
+    }
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,820 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file curve_csum_test.c
+ * @brief Host test and benchmark of BSMP curve checksums and telemetry reads
+ *
+ * Runs the BSMP server on the host with curves laid out as on firmware: a
+ * 16 kB wfmref curve with per-block checksums, the same memory seen as a curve
+ * without them, a read-only scope curve and a view of wfmref with 8 kB blocks.
+ * Telemetry of a power supply is a group of 48 variables, of which a few
+ * change on every cycle. Requests go through bsmp_process_packet(), as
+ * received from a communication interface.
+ *
+ * Checks that:
+ *  - the checksum of a curve without per-block checksums is the MD5 of its
+ *    data, and CRC32 and MurmurHash3 match a direct computation;
+ *  - the checksum of a curve with per-block checksums is the MD5 of the MD5
+ *    of each block;
+ *  - after a block is written, both checksums follow the new data and only
+ *    the written block is read again on incremental recalculation;
+ *  - wfmref reads the same through 1 kB and 8 kB blocks, and 8 kB blocks are
+ *    refused to interfaces whose buffer only takes 1 kB;
+ *  - group read changed sends every change to each of two interfaces reading
+ *    the same group, and only the variables changed since the last read of
+ *    that interface.
+ *
+ * Then reports the cost of a full recalculation against an incremental one
+ * after a single block write, for wfmref curves, and the cost of a full
+ * recalculation of the scope curve. Last, it reports the transactions, bytes
+ * on line and time taken by reading the whole wfmref through each view, and
+ * the answer size and cost of group read against group read changed along a
+ * telemetry trace.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define READ_CYCLES()       __rdtsc()
+#else
+#define READ_CYCLES()       0
+#endif
+
+#include "server.h"
+#include "bsmp_priv.h"
+#include "md5/md5.h"
+#include "crc32/crc32.h"
+#include "murmur3/murmur3.h"
+
+#define SIZE_CURVE_BLOCK        1024
+#define NUMBER_OF_BLOCKS        16
+#define SIZE_CURVE              (SIZE_CURVE_BLOCK * NUMBER_OF_BLOCKS)
+
+#define CURVE_WFMREF            0       // With per-block checksums
+#define CURVE_WFMREF_FULL       1       // Same memory, without them
+#define CURVE_SCOPE             2
+#define CURVE_WFMREF_LARGE      3       // Same memory, with 8 kB blocks
+#define NUMBER_OF_CURVES        4
+
+#define SIZE_LARGE_CURVE_BLOCK  8192
+#define NUMBER_OF_LARGE_BLOCKS  (SIZE_CURVE / SIZE_LARGE_CURVE_BLOCK)
+
+#define BENCH_ITERS             200
+#define BENCH_ROUNDS            5
+
+/// RS485 frames add address and checksum bytes to BSMP messages, and take 10
+/// bits per byte on line
+#define RS485_FRAME_OVERHEAD    2
+#define RS485_BAUD              6000000.0
+
+#define NUMBER_OF_VARS          48
+#define NUMBER_OF_MEASUREMENTS  8       // Change on every cycle
+#define NUMBER_OF_STATUS        4       // Change every STATUS_PERIOD cycles
+#define STATUS_PERIOD           10
+#define TELEMETRY_CYCLES        1000
+#define SIZE_GROUP_BITMAP       ((NUMBER_OF_VARS + 7) / 8)
+#define SIZE_SHADOW_POOL        1024
+
+/// Shadow clients, numbered as the interfaces of ps_interface_t
+#define CLIENT_RS485            0
+#define CLIENT_ETHERNET         2
+
+/// Buffer of an interface which only takes 1 kB blocks, as IHM
+#define SMALL_BUFFER_SIZE       (BSMP_HEADER_SIZE + BSMP_CURVE_BLOCK_INFO + \
+                                 SIZE_CURVE_BLOCK)
+
+static uint32_t wfmref_data[SIZE_CURVE / 4];
+static uint32_t scope_data[SIZE_CURVE / 4];
+
+static uint8_t wfmref_block_csum[NUMBER_OF_BLOCKS][BSMP_CURVE_CSUM_SIZE];
+static uint32_t wfmref_block_dirty[(NUMBER_OF_BLOCKS + 31) / 32];
+
+/// Bytes read by read_block_part, so incremental recalculation is checked to
+/// read only written blocks
+static unsigned long read_part_bytes;
+
+static uint32_t var_data[NUMBER_OF_VARS];
+static struct bsmp_var vars[NUMBER_OF_VARS];
+
+static uint8_t shadow_data[SIZE_SHADOW_POOL];
+static struct bsmp_shadow_pool shadow_pool =
+{
+    .data = shadow_data,
+    .size = SIZE_SHADOW_POOL,
+};
+
+/// Client of the requests, given to the server as their context
+static uint8_t request_client = CLIENT_RS485;
+
+static uint8_t request_buf[BSMP_HEADER_SIZE + BSMP_CURVE_BLOCK_INFO +
+                           SIZE_CURVE_BLOCK];
+static uint8_t response_buf[BSMP_HEADER_SIZE + BSMP_CURVE_BLOCK_INFO +
+                            SIZE_LARGE_CURVE_BLOCK];
+
+static bsmp_server_t server;
+static int failures;
+
+static bool read_block(const struct bsmp_curve *curve,
+                       struct bsmp_curve_state *state, uint16_t block,
+                       uint8_t *data, uint16_t *len, void *ctx)
+{
+    memcpy(data, (uint8_t *) state->user + block * curve->info.block_size,
+           curve->info.block_size);
+    *len = curve->info.block_size;
+    return true;
+}
+
+static bool read_block_part(const struct bsmp_curve *curve,
+                            struct bsmp_curve_state *state, uint16_t block,
+                            uint16_t offset, uint8_t *data, uint16_t *len,
+                            void *ctx)
+{
+    if(offset + *len > curve->info.block_size)
+    {
+        *len = curve->info.block_size - offset;
+    }
+
+    memcpy(data, (uint8_t *) state->user + block * curve->info.block_size +
+           offset, *len);
+    read_part_bytes += *len;
+    return true;
+}
+
+static bool write_block(const struct bsmp_curve *curve,
+                        struct bsmp_curve_state *state, uint16_t block,
+                        uint8_t *data, uint16_t len, void *ctx)
+{
+    memcpy((uint8_t *) state->user + block * curve->info.block_size, data,
+           len);
+    return true;
+}
+
+static const struct bsmp_curve curve_wfmref = {
+    .info.id            = CURVE_WFMREF,
+    .info.writable      = true,
+    .info.nblocks       = NUMBER_OF_BLOCKS,
+    .info.block_size    = SIZE_CURVE_BLOCK,
+    .read_block         = read_block,
+    .read_block_part    = read_block_part,
+    .write_block        = write_block,
+};
+
+static const struct bsmp_curve curve_wfmref_full = {
+    .info.id            = CURVE_WFMREF_FULL,
+    .info.writable      = true,
+    .info.nblocks       = NUMBER_OF_BLOCKS,
+    .info.block_size    = SIZE_CURVE_BLOCK,
+    .read_block         = read_block,
+    .read_block_part    = read_block_part,
+    .write_block        = write_block,
+};
+
+static const struct bsmp_curve curve_scope = {
+    .info.id            = CURVE_SCOPE,
+    .info.writable      = false,
+    .info.nblocks       = NUMBER_OF_BLOCKS,
+    .info.block_size    = SIZE_CURVE_BLOCK,
+    .read_block         = read_block,
+    .read_block_part    = read_block_part,
+};
+
+static const struct bsmp_curve curve_wfmref_large = {
+    .info.id            = CURVE_WFMREF_LARGE,
+    .info.writable      = true,
+    .info.nblocks       = NUMBER_OF_LARGE_BLOCKS,
+    .info.block_size    = SIZE_LARGE_CURVE_BLOCK,
+    .read_block         = read_block,
+    .read_block_part    = read_block_part,
+    .write_block        = write_block,
+};
+
+static const struct bsmp_curve *const curves[NUMBER_OF_CURVES] =
+{
+    &curve_wfmref,
+    &curve_wfmref_full,
+    &curve_scope,
+    &curve_wfmref_large
+};
+
+static struct bsmp_curve_state curves_state[NUMBER_OF_CURVES];
+
+#define CHECK(cond, ...)                                                    \
+    do {                                                                    \
+        if(!(cond))                                                         \
+        {                                                                   \
+            printf("FAIL: " __VA_ARGS__);                                   \
+            printf("\n");                                                   \
+            failures++;                                                     \
+        }                                                                   \
+    } while(0)
+
+/**
+ * Process a request through the server, as received from an interface whose
+ * buffer takes max_len bytes, and return the command code of the answer. Its
+ * payload is left on response_buf.
+ */
+static uint8_t process_max(uint8_t cmd, const uint8_t *payload, uint16_t size,
+                           uint16_t max_len, uint16_t *p_answer_size)
+{
+    struct bsmp_raw_packet request, response;
+
+    request_buf[0] = cmd;
+    request_buf[1] = size >> 8;
+    request_buf[2] = size;
+    memcpy(&request_buf[BSMP_HEADER_SIZE], payload, size);
+
+    request.data = request_buf;
+    request.len = BSMP_HEADER_SIZE + size;
+    response.data = response_buf;
+    response.max_len = max_len;
+
+    bsmp_process_packet(&server, &request, &response, &request_client);
+
+    if(p_answer_size != NULL)
+    {
+        *p_answer_size = (response_buf[1] << 8) + response_buf[2];
+    }
+
+    return response_buf[0];
+}
+
+static uint8_t process(uint8_t cmd, const uint8_t *payload, uint16_t size,
+                       uint16_t *p_answer_size)
+{
+    return process_max(cmd, payload, size, sizeof(response_buf),
+                       p_answer_size);
+}
+
+static uint8_t shadow_client(void *ctx)
+{
+    return *(uint8_t *) ctx;
+}
+
+static uint8_t recalc_csum(uint8_t curve_id, int algo, uint8_t *csum)
+{
+    uint8_t payload[2] = {curve_id, (uint8_t) algo};
+    uint16_t size;
+    uint8_t cmd;
+
+    cmd = process(CMD_CURVE_RECALC_CSUM, payload, (algo < 0) ? 1 : 2, &size);
+    memcpy(csum, &response_buf[BSMP_HEADER_SIZE], size);
+
+    return cmd;
+}
+
+static uint8_t write_curve_block(uint8_t curve_id, uint16_t block,
+                                 const uint8_t *data)
+{
+    static uint8_t payload[BSMP_CURVE_BLOCK_INFO + SIZE_CURVE_BLOCK];
+
+    payload[0] = curve_id;
+    payload[1] = block >> 8;
+    payload[2] = block;
+    memcpy(&payload[BSMP_CURVE_BLOCK_INFO], data, SIZE_CURVE_BLOCK);
+
+    return process(CMD_CURVE_BLOCK, payload, sizeof(payload), NULL);
+}
+
+/**
+ * Read a whole curve block by block into dst, as an interface whose buffer
+ * takes max_len bytes. Returns the bytes of requests and answers on RS485
+ * line, or 0 if any block isn't answered.
+ */
+static unsigned long read_curve(uint8_t curve_id, uint16_t nblocks,
+                                uint16_t max_len, uint8_t *dst)
+{
+    uint8_t payload[BSMP_CURVE_BLOCK_INFO];
+    unsigned long wire_bytes = 0;
+    uint16_t block, size;
+
+    for(block = 0; block < nblocks; block++)
+    {
+        payload[0] = curve_id;
+        payload[1] = block >> 8;
+        payload[2] = block;
+
+        if(process_max(CMD_CURVE_BLOCK_REQUEST, payload, sizeof(payload),
+                       max_len, &size) != CMD_CURVE_BLOCK)
+        {
+            return 0;
+        }
+
+        size -= BSMP_CURVE_BLOCK_INFO;
+        memcpy(dst, &response_buf[BSMP_HEADER_SIZE + BSMP_CURVE_BLOCK_INFO],
+               size);
+        dst += size;
+
+        wire_bytes += 2 * (RS485_FRAME_OVERHEAD + BSMP_HEADER_SIZE) +
+                      sizeof(payload) + BSMP_CURVE_BLOCK_INFO + size;
+    }
+
+    return wire_bytes;
+}
+
+static void md5_whole(const void *data, unsigned int len, uint8_t *digest)
+{
+    MD5_CTX ctx;
+
+    MD5Init(&ctx);
+    MD5Update(&ctx, (uint8_t *) data, len);
+    MD5Final(digest, &ctx);
+}
+
+static void md5_of_blocks(const void *data, uint8_t *digest)
+{
+    uint8_t block_csum[NUMBER_OF_BLOCKS][BSMP_CURVE_CSUM_SIZE];
+    unsigned int i;
+
+    for(i = 0; i < NUMBER_OF_BLOCKS; i++)
+    {
+        md5_whole((const uint8_t *) data + i * SIZE_CURVE_BLOCK,
+                  SIZE_CURVE_BLOCK, block_csum[i]);
+    }
+
+    md5_whole(block_csum, sizeof(block_csum), digest);
+}
+
+/**
+ * Smooth ramp, as a wfmref, and noisy samples, as a scope buffer
+ */
+static void fill_curves(void)
+{
+    uint32_t seed = 1;
+    float f;
+    unsigned int i;
+
+    for(i = 0; i < SIZE_CURVE / 4; i++)
+    {
+        f = 0.001 * i;
+        memcpy(&wfmref_data[i], &f, 4);
+
+        seed = seed * 1664525 + 1013904223;
+        scope_data[i] = seed;
+    }
+}
+
+static void check_csums(const char *when)
+{
+    uint8_t csum[BSMP_CURVE_CSUM_SIZE], expected[BSMP_CURVE_CSUM_SIZE];
+    CRC32_CTX crc;
+    MURMUR3_CTX murmur;
+
+    md5_whole(wfmref_data, SIZE_CURVE, expected);
+    CHECK(recalc_csum(CURVE_WFMREF_FULL, -1, csum) == CMD_CURVE_CSUM,
+          "%s: full MD5 not answered", when);
+    CHECK(!memcmp(csum, expected, BSMP_CURVE_CSUM_SIZE),
+          "%s: full MD5 differs from MD5 of curve", when);
+
+    md5_of_blocks(wfmref_data, expected);
+    CHECK(recalc_csum(CURVE_WFMREF, BSMP_CURVE_CSUM_MD5, csum) ==
+          CMD_CURVE_CSUM, "%s: incremental MD5 not answered", when);
+    CHECK(!memcmp(csum, expected, BSMP_CURVE_CSUM_SIZE),
+          "%s: incremental MD5 differs from MD5 of block MD5s", when);
+
+    CRC32Init(&crc);
+    CRC32Update(&crc, (uint8_t *) wfmref_data, SIZE_CURVE);
+    CRC32Final(expected, &crc);
+    CHECK(recalc_csum(CURVE_WFMREF, BSMP_CURVE_CSUM_CRC32, csum) ==
+          CMD_CURVE_CSUM, "%s: CRC32 not answered", when);
+    CHECK(!memcmp(csum, expected, BSMP_CURVE_FAST_CSUM_SIZE),
+          "%s: CRC32 differs from CRC32 of curve", when);
+
+    MURMUR3Init(&murmur);
+    MURMUR3Update(&murmur, (uint8_t *) wfmref_data, SIZE_CURVE);
+    MURMUR3Final(expected, &murmur);
+    CHECK(recalc_csum(CURVE_WFMREF, BSMP_CURVE_CSUM_MURMUR3, csum) ==
+          CMD_CURVE_CSUM, "%s: MurmurHash3 not answered", when);
+    CHECK(!memcmp(csum, expected, BSMP_CURVE_FAST_CSUM_SIZE),
+          "%s: MurmurHash3 differs from MurmurHash3 of curve", when);
+}
+
+static void test_csums(void)
+{
+    uint8_t block[SIZE_CURVE_BLOCK];
+    uint8_t csum[BSMP_CURVE_CSUM_SIZE];
+    unsigned int i;
+
+    check_csums("initial");
+
+    /// Nothing written: incremental recalculation reads no block
+    read_part_bytes = 0;
+    recalc_csum(CURVE_WFMREF, -1, csum);
+    CHECK(read_part_bytes == 0, "clean curve: %lu bytes read", read_part_bytes);
+
+    for(i = 0; i < SIZE_CURVE_BLOCK; i++)
+    {
+        block[i] = i * 7;
+    }
+
+    CHECK(write_curve_block(CURVE_WFMREF, 5, block) == CMD_OK,
+          "block write not acknowledged");
+
+    read_part_bytes = 0;
+    recalc_csum(CURVE_WFMREF, -1, csum);
+    CHECK(read_part_bytes == SIZE_CURVE_BLOCK,
+          "one block written: %lu bytes read", read_part_bytes);
+
+    check_csums("after block write");
+
+    CHECK(write_curve_block(CURVE_SCOPE, 0, block) == CMD_ERR_READ_ONLY,
+          "write on read-only curve not rejected");
+}
+
+static void test_large_blocks(void)
+{
+    static uint8_t curve[SIZE_CURVE];
+    uint8_t payload[BSMP_CURVE_BLOCK_INFO] = {CURVE_WFMREF_LARGE, 0,
+                                              NUMBER_OF_LARGE_BLOCKS};
+
+    memset(curve, 0, sizeof(curve));
+    CHECK(read_curve(CURVE_WFMREF, NUMBER_OF_BLOCKS, sizeof(response_buf),
+                     curve) && !memcmp(curve, wfmref_data, SIZE_CURVE),
+          "wfmref read through 1 kB blocks differs");
+
+    memset(curve, 0, sizeof(curve));
+    CHECK(read_curve(CURVE_WFMREF_LARGE, NUMBER_OF_LARGE_BLOCKS,
+                     sizeof(response_buf), curve) &&
+          !memcmp(curve, wfmref_data, SIZE_CURVE),
+          "wfmref read through 8 kB blocks differs");
+
+    CHECK(process(CMD_CURVE_BLOCK_REQUEST, payload, sizeof(payload), NULL) ==
+          CMD_ERR_INVALID_VALUE, "block past 8 kB view not rejected");
+
+    CHECK(read_curve(CURVE_WFMREF, NUMBER_OF_BLOCKS, SMALL_BUFFER_SIZE, curve),
+          "1 kB blocks refused to 1 kB buffer");
+
+    payload[2] = 0;
+    CHECK(process_max(CMD_CURVE_BLOCK_REQUEST, payload, sizeof(payload),
+                      SMALL_BUFFER_SIZE, NULL) == CMD_ERR_INSUFFICIENT_MEMORY,
+          "8 kB block not refused to 1 kB buffer");
+}
+
+/**
+ * One cycle of telemetry: measurements are noisy and status changes now and
+ * then. Setpoints and parameters, the other variables, don't change.
+ */
+static void telemetry_step(uint32_t cycle, uint32_t *p_seed)
+{
+    unsigned int i;
+
+    for(i = 0; i < NUMBER_OF_MEASUREMENTS; i++)
+    {
+        *p_seed = *p_seed * 1664525 + 1013904223;
+        var_data[i] = *p_seed;
+    }
+
+    if(cycle % STATUS_PERIOD == 0)
+    {
+        for(i = NUMBER_OF_MEASUREMENTS;
+            i < NUMBER_OF_MEASUREMENTS + NUMBER_OF_STATUS; i++)
+        {
+            var_data[i]++;
+        }
+    }
+}
+
+/**
+ * Read all variables with group read changed, as client does, applying the
+ * values sent to its copy. Returns the answer size, or 0 if not answered.
+ */
+static uint16_t read_changed(uint8_t client, uint8_t flags, uint32_t *copy)
+{
+    uint8_t payload[2] = {GROUP_ALL_ID, flags};
+    const uint8_t *valuep = &response_buf[BSMP_HEADER_SIZE + SIZE_GROUP_BITMAP];
+    uint16_t size;
+    unsigned int i;
+
+    request_client = client;
+    if(process(CMD_GROUP_READ_CHANGED, payload, flags ? 2 : 1, &size) !=
+       CMD_GROUP_CHANGED_VALUES)
+    {
+        size = 0;
+    }
+    request_client = CLIENT_RS485;
+
+    for(i = 0; size && i < NUMBER_OF_VARS; i++)
+    {
+        if(response_buf[BSMP_HEADER_SIZE + i / 8] & (1 << (i % 8)))
+        {
+            memcpy(&copy[i], valuep, 4);
+            valuep += 4;
+        }
+    }
+
+    return size;
+}
+
+static void test_read_changed(void)
+{
+    static uint32_t rs485[NUMBER_OF_VARS], ethernet[NUMBER_OF_VARS];
+    const uint16_t changed_size = SIZE_GROUP_BITMAP + NUMBER_OF_MEASUREMENTS * 4;
+    const uint16_t all_size = SIZE_GROUP_BITMAP + sizeof(var_data);
+    uint32_t seed = 7;
+    uint8_t payload[1] = {GROUP_ALL_ID};
+    uint16_t size;
+
+    size = read_changed(CLIENT_RS485, 0, rs485);
+    CHECK(size == all_size, "first read: %u bytes, expected %u", size,
+          all_size);
+    CHECK(!memcmp(rs485, var_data, sizeof(var_data)), "first read differs");
+
+    size = read_changed(CLIENT_RS485, 0, rs485);
+    CHECK(size == SIZE_GROUP_BITMAP, "read without changes: %u bytes", size);
+
+    telemetry_step(1, &seed);
+    size = read_changed(CLIENT_RS485, 0, rs485);
+    CHECK(size == changed_size, "read after cycle: %u bytes, expected %u",
+          size, changed_size);
+    CHECK(!memcmp(rs485, var_data, sizeof(var_data)), "read after cycle "
+          "differs");
+
+    /// Another interface starts with all values, then both see each change
+    size = read_changed(CLIENT_ETHERNET, 0, ethernet);
+    CHECK(size == all_size, "first read by other interface: %u bytes", size);
+
+    telemetry_step(2, &seed);
+    size = read_changed(CLIENT_RS485, 0, rs485);
+    CHECK(size == changed_size, "concurrent read: %u bytes, expected %u",
+          size, changed_size);
+    size = read_changed(CLIENT_ETHERNET, 0, ethernet);
+    CHECK(size == changed_size, "concurrent read by other interface: %u "
+          "bytes, expected %u", size, changed_size);
+    CHECK(!memcmp(rs485, var_data, sizeof(var_data)) &&
+          !memcmp(ethernet, var_data, sizeof(var_data)),
+          "concurrent reads differ");
+
+    size = read_changed(CLIENT_ETHERNET, 0x01, ethernet);
+    CHECK(size == all_size, "read of all values: %u bytes", size);
+
+    request_client = BSMP_MAX_SHADOW_CLIENTS;
+    CHECK(process(CMD_GROUP_READ_CHANGED, payload, sizeof(payload), NULL) ==
+          CMD_ERR_OP_NOT_SUPPORTED, "unknown client not rejected");
+    request_client = CLIENT_RS485;
+}
+
+static double elapsed_us(const struct timespec *t0, const struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) * 1e6 + (t1->tv_nsec - t0->tv_nsec) / 1e3;
+}
+
+/**
+ * Cost of a checksum recalculation. With write_first, a block is written
+ * before each one, as when a wfmref block is updated.
+ */
+static double bench_recalc(uint8_t curve_id, int write_first,
+                           double *p_cycles)
+{
+    static uint8_t block[SIZE_CURVE_BLOCK];
+    uint8_t csum[BSMP_CURVE_CSUM_SIZE];
+    struct timespec t0, t1;
+    double best_us = 1e30, us;
+    uint64_t c0, c1;
+    unsigned int round, k;
+
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        /// Block writes are timed as well, they're part of the update
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        c0 = READ_CYCLES();
+
+        for(k = 0; k < BENCH_ITERS; k++)
+        {
+            if(write_first)
+            {
+                block[0] = k;
+                write_curve_block(curve_id, k % NUMBER_OF_BLOCKS, block);
+            }
+            recalc_csum(curve_id, -1, csum);
+        }
+
+        c1 = READ_CYCLES();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        us = elapsed_us(&t0, &t1) / BENCH_ITERS;
+        if(us < best_us)
+        {
+            best_us = us;
+            *p_cycles = (c1 > c0) ? (double) (c1 - c0) / BENCH_ITERS : 0.0;
+        }
+    }
+
+    return best_us;
+}
+
+/**
+ * Cost of reading the whole wfmref through one of its views, as RS485 does
+ */
+static double bench_read(uint8_t curve_id, uint16_t nblocks,
+                         unsigned long *p_wire_bytes, double *p_cycles)
+{
+    static uint8_t curve[SIZE_CURVE];
+    struct timespec t0, t1;
+    double best_us = 1e30, us;
+    uint64_t c0, c1;
+    unsigned int round, k;
+
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        c0 = READ_CYCLES();
+
+        for(k = 0; k < BENCH_ITERS; k++)
+        {
+            *p_wire_bytes = read_curve(curve_id, nblocks, sizeof(response_buf),
+                                       curve);
+        }
+
+        c1 = READ_CYCLES();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        us = elapsed_us(&t0, &t1) / BENCH_ITERS;
+        if(us < best_us)
+        {
+            best_us = us;
+            *p_cycles = (c1 > c0) ? (double) (c1 - c0) / BENCH_ITERS : 0.0;
+        }
+    }
+
+    return best_us;
+}
+
+static void report_read(const char *label, uint16_t nblocks,
+                        unsigned long wire_bytes, double us, double cycles)
+{
+    printf("%s %2u transactions, %lu bytes on line (%.0f us at 6 Mbaud), "
+           "%.1f us/read (%.0f MB/s)", label, nblocks, wire_bytes,
+           wire_bytes * 10 / RS485_BAUD * 1e6, us, SIZE_CURVE / us);
+    if(cycles > 0.0)
+    {
+        printf(", %.0f cycles", cycles);
+    }
+    printf("\n");
+}
+
+/**
+ * Cost of reading telemetry on every cycle of a trace with cmd, which is either
+ * group read or group read changed. Answer bytes per read are given in
+ * p_bytes.
+ */
+static double bench_telemetry(uint8_t cmd, double *p_bytes, double *p_cycles)
+{
+    uint8_t payload[1] = {GROUP_ALL_ID};
+    struct timespec t0, t1;
+    double best_us = 1e30, us;
+    unsigned long bytes;
+    uint64_t c0, c1;
+    uint32_t seed;
+    uint16_t size;
+    unsigned int round, k;
+
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        seed = 7;
+        bytes = 0;
+
+        /// Trace steps are timed as well, they're only a few stores
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        c0 = READ_CYCLES();
+
+        for(k = 0; k < TELEMETRY_CYCLES; k++)
+        {
+            telemetry_step(k, &seed);
+            process(cmd, payload, sizeof(payload), &size);
+            bytes += size;
+        }
+
+        c1 = READ_CYCLES();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        us = elapsed_us(&t0, &t1) / TELEMETRY_CYCLES;
+        if(us < best_us)
+        {
+            best_us = us;
+            *p_bytes = (double) bytes / TELEMETRY_CYCLES;
+            *p_cycles = (c1 > c0) ? (double) (c1 - c0) / TELEMETRY_CYCLES :
+                                    0.0;
+        }
+    }
+
+    return best_us;
+}
+
+static void report_telemetry(const char *label, double bytes, double us,
+                             double cycles)
+{
+    printf("%s %6.1f bytes/answer, %.2f us/read", label, bytes, us);
+    if(cycles > 0.0)
+    {
+        printf(", %.0f cycles", cycles);
+    }
+    printf("\n");
+}
+
+static void report_bench(const char *label, double us, double cycles)
+{
+    printf("%s %8.1f us/recalculation", label, us);
+    if(cycles > 0.0)
+    {
+        printf(", %.0f cycles", cycles);
+    }
+    printf("\n");
+}
+
+int main(void)
+{
+    double full_us, incr_us, scope_us, small_us, large_us, us, cycles;
+    double read_bytes, changed_bytes;
+    unsigned long small_bytes, large_bytes;
+    unsigned int i;
+
+    fill_curves();
+
+    bsmp_server_init(&server);
+
+    curves_state[CURVE_WFMREF].user = wfmref_data;
+    curves_state[CURVE_WFMREF].block_csum = wfmref_block_csum;
+    curves_state[CURVE_WFMREF].block_dirty = wfmref_block_dirty;
+    curves_state[CURVE_WFMREF_FULL].user = wfmref_data;
+    curves_state[CURVE_SCOPE].user = scope_data;
+    curves_state[CURVE_WFMREF_LARGE].user = wfmref_data;
+
+    if(bsmp_register_curve_table(&server, curves, curves_state,
+                                 NUMBER_OF_CURVES) != BSMP_SUCCESS)
+    {
+        printf("FAIL: curve table not registered\n");
+        return 1;
+    }
+
+    for(i = 0; i < NUMBER_OF_VARS; i++)
+    {
+        var_data[i] = i;
+        vars[i].info.size = 4;
+        vars[i].data = (uint8_t *) &var_data[i];
+
+        if(bsmp_register_variable(&server, &vars[i]) != BSMP_SUCCESS)
+        {
+            printf("FAIL: variable %u not registered\n", i);
+            return 1;
+        }
+    }
+
+    bsmp_register_group_shadow(&server, &shadow_pool, shadow_client);
+
+    test_csums();
+    test_large_blocks();
+    test_read_changed();
+
+    full_us = bench_recalc(CURVE_WFMREF_FULL, 1, &cycles);
+    report_bench("wfmref, full:          ", full_us, cycles);
+    incr_us = bench_recalc(CURVE_WFMREF, 1, &cycles);
+    report_bench("wfmref, incremental:   ", incr_us, cycles);
+    scope_us = bench_recalc(CURVE_SCOPE, 0, &cycles);
+    report_bench("scope, full:           ", scope_us, cycles);
+    printf("incremental speedup:    %.1fx\n", full_us / incr_us);
+
+    small_us = bench_read(CURVE_WFMREF, NUMBER_OF_BLOCKS, &small_bytes,
+                          &cycles);
+    report_read("wfmref, 1 kB blocks:   ", NUMBER_OF_BLOCKS, small_bytes,
+                small_us, cycles);
+    large_us = bench_read(CURVE_WFMREF_LARGE, NUMBER_OF_LARGE_BLOCKS,
+                          &large_bytes, &cycles);
+    report_read("wfmref, 8 kB blocks:   ", NUMBER_OF_LARGE_BLOCKS, large_bytes,
+                large_us, cycles);
+    printf("8 kB blocks save:       %lu bytes on line, %.1f us/read\n",
+           small_bytes - large_bytes, small_us - large_us);
+
+    us = bench_telemetry(CMD_GROUP_READ, &read_bytes, &cycles);
+    report_telemetry("telemetry, read:       ", read_bytes, us, cycles);
+    us = bench_telemetry(CMD_GROUP_READ_CHANGED, &changed_bytes, &cycles);
+    report_telemetry("telemetry, changed:    ", changed_bytes, us, cycles);
+    printf("read changed saves:     %.0f%% of answer bytes\n",
+           100.0 * (1.0 - changed_bytes / read_bytes));
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
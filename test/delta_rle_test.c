@@ -0,0 +1,519 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file delta_rle_test.c
+ * @brief Host round-trip test of encoded curve blocks
+ *
+ * Encodes waveforms with the host encoder, DeltaRLEEncode(), and checks that:
+ *  - they decode to the original words, for small and large blocks of ramps,
+ *    sines, constants and random data, which needs escapes;
+ *  - the encoder fails when the destination is too small, and the decoder
+ *    fails on malformed or truncated streams and on streams which don't fit
+ *    into the destination, either validating or decoding;
+ *  - a 16 kB wfmref uploaded through BSMP with encoded block commands ends up
+ *    the same as with plain block commands, and invalid blocks are rejected
+ *    before curve memory is touched.
+ *
+ * Then reports the size of each waveform when encoded, and the cost of
+ * decoding a block.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define READ_CYCLES()       __rdtsc()
+#else
+#define READ_CYCLES()       0
+#endif
+
+#include "server.h"
+#include "bsmp_priv.h"
+#include "delta_rle/delta_rle.h"
+
+#define SIZE_CURVE_BLOCK        1024
+#define SIZE_LARGE_CURVE_BLOCK  8192
+#define NUMBER_OF_BLOCKS        16
+#define SIZE_CURVE              (SIZE_CURVE_BLOCK * NUMBER_OF_BLOCKS)
+#define NWORDS_CURVE            (SIZE_CURVE / 4)
+
+/// Worst case of encoded size: an escape for every word
+#define SIZE_ENCODED(nwords)    (5 * (nwords))
+
+#define CURVE_WFMREF            0
+#define CURVE_PLAIN             1       // Without encoded block writes
+#define NUMBER_OF_CURVES        2
+
+#define BENCH_ITERS             2000
+#define BENCH_ROUNDS            5
+
+typedef enum
+{
+    Ramp,
+    Sine,
+    Constant,
+    Zeros,
+    Random,
+    NUMBER_OF_WAVEFORMS
+} waveform_t;
+
+static const char *waveform_names[NUMBER_OF_WAVEFORMS] =
+{
+    "ramp", "sine", "constant", "zeros", "random"
+};
+
+static uint32_t source[NWORDS_CURVE];
+/// One word more, to check the decoder doesn't write past the end
+static uint32_t decoded[NWORDS_CURVE + 1];
+static uint8_t encoded[SIZE_ENCODED(NWORDS_CURVE)];
+
+static uint32_t wfmref_data[NWORDS_CURVE];
+static uint32_t plain_data[NWORDS_CURVE];
+
+/// End of the written data, in bytes, kept as write_block_wfmref_encoded()
+/// keeps p_buf_end/p_buf_idx
+static uint32_t wfmref_end;
+
+static uint8_t request_buf[BSMP_HEADER_SIZE + BSMP_CURVE_BLOCK_INFO +
+                           SIZE_ENCODED(SIZE_CURVE_BLOCK / 4)];
+static uint8_t response_buf[BSMP_HEADER_SIZE + BSMP_CURVE_BLOCK_INFO +
+                            SIZE_CURVE_BLOCK];
+
+static bsmp_server_t server;
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+static bool read_block(const struct bsmp_curve *curve,
+                       struct bsmp_curve_state *state, uint16_t block,
+                       uint8_t *data, uint16_t *len, void *ctx)
+{
+    memcpy(data, (uint8_t *) state->user + block * curve->info.block_size,
+           curve->info.block_size);
+    *len = curve->info.block_size;
+    return true;
+}
+
+static bool write_block(const struct bsmp_curve *curve,
+                        struct bsmp_curve_state *state, uint16_t block,
+                        uint8_t *data, uint16_t len, void *ctx)
+{
+    memcpy((uint8_t *) state->user + block * curve->info.block_size, data,
+           len);
+    return true;
+}
+
+static bool write_block_encoded(const struct bsmp_curve *curve,
+                                struct bsmp_curve_state *state,
+                                uint16_t block, uint8_t *data, uint16_t len,
+                                void *ctx)
+{
+    uint32_t offset = block * curve->info.block_size;
+    int32_t decoded_len;
+
+    decoded_len = bsmp_curve_decode_block((uint8_t *) state->user + offset,
+                                          curve->info.block_size, data, len);
+
+    if(decoded_len <= 0)
+    {
+        return false;
+    }
+
+    wfmref_end = offset + decoded_len;
+    return true;
+}
+
+static const struct bsmp_curve curve_wfmref = {
+    .info.id             = CURVE_WFMREF,
+    .info.writable       = true,
+    .info.nblocks        = NUMBER_OF_BLOCKS,
+    .info.block_size     = SIZE_CURVE_BLOCK,
+    .read_block          = read_block,
+    .write_block         = write_block,
+    .write_block_encoded = write_block_encoded,
+};
+
+static const struct bsmp_curve curve_plain = {
+    .info.id             = CURVE_PLAIN,
+    .info.writable       = true,
+    .info.nblocks        = NUMBER_OF_BLOCKS,
+    .info.block_size     = SIZE_CURVE_BLOCK,
+    .read_block          = read_block,
+    .write_block         = write_block,
+};
+
+static const struct bsmp_curve *const curves[NUMBER_OF_CURVES] =
+{
+    &curve_wfmref,
+    &curve_plain
+};
+
+static struct bsmp_curve_state curves_state[NUMBER_OF_CURVES];
+
+/**
+ * Process a request through the server and return the command code of the
+ * answer.
+ */
+static uint8_t process(uint8_t cmd, const uint8_t *payload, uint16_t size)
+{
+    struct bsmp_raw_packet request, response;
+
+    request_buf[0] = cmd;
+    request_buf[1] = size >> 8;
+    request_buf[2] = size;
+    memcpy(&request_buf[BSMP_HEADER_SIZE], payload, size);
+
+    request.data = request_buf;
+    request.len = BSMP_HEADER_SIZE + size;
+    response.data = response_buf;
+    response.max_len = sizeof(response_buf);
+
+    bsmp_process_packet(&server, &request, &response, NULL);
+
+    return response_buf[0];
+}
+
+static uint8_t write_curve_block(uint8_t cmd, uint8_t curve_id,
+                                 uint16_t block, const uint8_t *data,
+                                 uint16_t len)
+{
+    static uint8_t payload[BSMP_CURVE_BLOCK_INFO +
+                           SIZE_ENCODED(SIZE_CURVE_BLOCK / 4)];
+
+    payload[0] = curve_id;
+    payload[1] = block >> 8;
+    payload[2] = block;
+    memcpy(&payload[BSMP_CURVE_BLOCK_INFO], data, len);
+
+    return process(cmd, payload, BSMP_CURVE_BLOCK_INFO + len);
+}
+
+static uint32_t float_word(float f)
+{
+    uint32_t u;
+
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static void fill_waveform(uint32_t *dst, uint32_t nwords, waveform_t wfm)
+{
+    uint32_t i;
+
+    for(i = 0; i < nwords; i++)
+    {
+        switch(wfm)
+        {
+            case Ramp:
+                dst[i] = float_word(-10.0 + 20.0 * i / nwords);
+                break;
+            case Sine:
+                dst[i] = float_word(10.0 * sin(2.0 * M_PI * i / nwords));
+                break;
+            case Constant:
+                dst[i] = float_word(3.1415926);
+                break;
+            case Zeros:
+                dst[i] = 0;
+                break;
+            default:
+                dst[i] = ((uint32_t) rand() << 16) ^ rand();
+                break;
+        }
+    }
+}
+
+/*
+ * Encode and decode nwords of a waveform, checking every failure mode which
+ * depends on sizes. Returns the encoded size.
+ */
+static int32_t check_round_trip(waveform_t wfm, uint32_t nwords)
+{
+    const char *name = waveform_names[wfm];
+    int32_t len, n;
+
+    fill_waveform(source, nwords, wfm);
+    memset(decoded, 0xA5, sizeof(decoded));
+
+    len = DeltaRLEEncode(encoded, sizeof(encoded), source, nwords);
+    CHECK(len > 0, "%s, %u words: not encoded", name, nwords);
+    if(len <= 0)
+    {
+        return len;
+    }
+
+    n = DeltaRLEDecode(decoded, nwords, encoded, len);
+    CHECK(n == (int32_t) nwords, "%s, %u words: decoded %d words", name,
+          nwords, n);
+    CHECK(!memcmp(decoded, source, nwords * 4),
+          "%s, %u words: decoded data differs", name, nwords);
+    CHECK(decoded[nwords] == 0xA5A5A5A5,
+          "%s, %u words: decoded past the end", name, nwords);
+
+    n = DeltaRLEDecode(NULL, nwords, encoded, len);
+    CHECK(n == (int32_t) nwords, "%s, %u words: validated %d words", name,
+          nwords, n);
+
+    n = DeltaRLEDecode(NULL, nwords - 1, encoded, len);
+    CHECK(n == -1, "%s, %u words: validated into one word less", name,
+          nwords);
+
+    n = DeltaRLEDecode(decoded, nwords - 1, encoded, len);
+    CHECK(n == -1, "%s, %u words: decoded into one word less", name, nwords);
+
+    n = DeltaRLEEncode(encoded, len - 1, source, nwords);
+    CHECK(n == -1, "%s, %u words: encoded into %d bytes", name, nwords,
+          len - 1);
+
+    return len;
+}
+
+static void test_codec(void)
+{
+    static const uint32_t sizes[] = {1, 2, SIZE_CURVE_BLOCK / 4,
+                                     SIZE_LARGE_CURVE_BLOCK / 4,
+                                     NWORDS_CURVE};
+    unsigned int i;
+    waveform_t wfm;
+    int32_t len;
+
+    for(wfm = 0; wfm < NUMBER_OF_WAVEFORMS; wfm++)
+    {
+        for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        {
+            check_round_trip(wfm, sizes[i]);
+        }
+    }
+
+    /// Step on a constant: a single large residual, followed by its negative
+    fill_waveform(source, 64, Constant);
+    source[32] = float_word(-1e30);
+    len = DeltaRLEEncode(encoded, sizeof(encoded), source, 64);
+    CHECK(DeltaRLEDecode(decoded, 64, encoded, len) == 64 &&
+          !memcmp(decoded, source, 64 * 4), "step: decoded data differs");
+}
+
+static void test_malformed(void)
+{
+    /// Varint without its last byte
+    static uint8_t truncated_varint[] = {0x04, 0x80};
+    /// Escape without its 4 bytes of residual
+    static uint8_t truncated_escape[] = {0x00, 0x01, 0x02, 0x03};
+    /// Varint longer than 5 bytes
+    static uint8_t long_varint[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    /// Run of 0x40 zero residuals
+    static uint8_t run[] = {0x7F};
+
+    CHECK(DeltaRLEDecode(NULL, 16, truncated_varint,
+                         sizeof(truncated_varint)) == -1,
+          "truncated varint validated");
+    CHECK(DeltaRLEDecode(decoded, 16, truncated_varint,
+                         sizeof(truncated_varint)) == -1,
+          "truncated varint decoded");
+    CHECK(DeltaRLEDecode(NULL, 16, truncated_escape,
+                         sizeof(truncated_escape)) == -1,
+          "truncated escape validated");
+    CHECK(DeltaRLEDecode(NULL, 16, long_varint, sizeof(long_varint)) == -1,
+          "long varint validated");
+    CHECK(DeltaRLEDecode(NULL, 0x40, run, sizeof(run)) == 0x40,
+          "run not validated");
+    CHECK(DeltaRLEDecode(NULL, 0x3F, run, sizeof(run)) == -1,
+          "run validated past the end");
+    CHECK(DeltaRLEDecode(NULL, 16, run, 0) == 0, "empty stream");
+}
+
+/*
+ * Upload a 16 kB ramp block by block, encoded to one curve and plain to the
+ * other, and check invalid encoded blocks
+ */
+static void test_server(void)
+{
+    uint32_t nwords = SIZE_CURVE_BLOCK / 4;
+    uint16_t block;
+    int32_t len;
+    uint8_t cmd;
+
+    fill_waveform(source, NWORDS_CURVE, Ramp);
+    memset(wfmref_data, 0, sizeof(wfmref_data));
+    memset(plain_data, 0, sizeof(plain_data));
+    wfmref_end = 0;
+
+    for(block = 0; block < NUMBER_OF_BLOCKS; block++)
+    {
+        /// Each block is encoded on its own, as decoder state starts at zero
+        len = DeltaRLEEncode(encoded, sizeof(encoded),
+                             &source[block * nwords], nwords);
+
+        cmd = write_curve_block(CMD_CURVE_BLOCK_ENCODED, CURVE_WFMREF, block,
+                                encoded, len);
+        CHECK(cmd == CMD_OK, "encoded block %u: answer 0x%02X", block, cmd);
+
+        cmd = write_curve_block(CMD_CURVE_BLOCK, CURVE_PLAIN, block,
+                                (uint8_t *) &source[block * nwords],
+                                SIZE_CURVE_BLOCK);
+        CHECK(cmd == CMD_OK, "plain block %u: answer 0x%02X", block, cmd);
+    }
+
+    CHECK(!memcmp(wfmref_data, source, SIZE_CURVE),
+          "encoded upload differs from source");
+    CHECK(!memcmp(wfmref_data, plain_data, SIZE_CURVE),
+          "encoded upload differs from plain upload");
+    CHECK(wfmref_end == SIZE_CURVE, "end of curve at %u", wfmref_end);
+
+    /// A block shorter than block size moves the end of the curve
+    len = DeltaRLEEncode(encoded, sizeof(encoded), source, 100);
+    cmd = write_curve_block(CMD_CURVE_BLOCK_ENCODED, CURVE_WFMREF, 3,
+                            encoded, len);
+    CHECK(cmd == CMD_OK && wfmref_end == 3 * SIZE_CURVE_BLOCK + 400,
+          "short block: answer 0x%02X, end at %u", cmd, wfmref_end);
+
+    /// Invalid blocks don't touch curve memory
+    fill_waveform(source, NWORDS_CURVE, Sine);
+    memcpy(plain_data, wfmref_data, SIZE_CURVE);
+
+    len = DeltaRLEEncode(encoded, sizeof(encoded), source, nwords + 1);
+    cmd = write_curve_block(CMD_CURVE_BLOCK_ENCODED, CURVE_WFMREF, 0,
+                            encoded, len);
+    CHECK(cmd == CMD_ERR_INVALID_VALUE, "oversized block: answer 0x%02X",
+          cmd);
+
+    len = DeltaRLEEncode(encoded, sizeof(encoded), source, nwords);
+    encoded[len++] = 0x00;
+    cmd = write_curve_block(CMD_CURVE_BLOCK_ENCODED, CURVE_WFMREF, 0,
+                            encoded, len);
+    CHECK(cmd == CMD_ERR_INVALID_VALUE, "truncated block: answer 0x%02X",
+          cmd);
+
+    CHECK(!memcmp(wfmref_data, plain_data, SIZE_CURVE),
+          "curve memory touched by invalid blocks");
+
+    cmd = write_curve_block(CMD_CURVE_BLOCK_ENCODED, CURVE_WFMREF,
+                            NUMBER_OF_BLOCKS, encoded, 1);
+    CHECK(cmd == CMD_ERR_INVALID_VALUE, "block out of range: answer 0x%02X",
+          cmd);
+
+    cmd = write_curve_block(CMD_CURVE_BLOCK_ENCODED, CURVE_PLAIN, 0,
+                            encoded, 1);
+    CHECK(cmd == CMD_ERR_OP_NOT_SUPPORTED,
+          "curve without encoded blocks: answer 0x%02X", cmd);
+}
+
+static double elapsed_us(struct timespec *t0, struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) * 1e6 + (t1->tv_nsec - t0->tv_nsec) / 1e3;
+}
+
+/*
+ * Size of a waveform encoded block by block, as uploaded, and cost of
+ * decoding one block
+ */
+static void report(waveform_t wfm)
+{
+    uint32_t nwords = SIZE_CURVE_BLOCK / 4;
+    uint32_t total = 0, block, round, k;
+    struct timespec t0, t1;
+    double best_us = 1e30, best_cycles = 0.0, us;
+    uint64_t c0, c1;
+    int32_t len = 0;
+
+    fill_waveform(source, NWORDS_CURVE, wfm);
+
+    for(block = 0; block < NUMBER_OF_BLOCKS; block++)
+    {
+        len = DeltaRLEEncode(encoded, sizeof(encoded),
+                             &source[block * nwords], nwords);
+        total += len;
+    }
+
+    /// Decode the last block
+    for(round = 0; round < BENCH_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        c0 = READ_CYCLES();
+
+        for(k = 0; k < BENCH_ITERS; k++)
+        {
+            DeltaRLEDecode(decoded, nwords, encoded, len);
+        }
+
+        c1 = READ_CYCLES();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        us = elapsed_us(&t0, &t1) / BENCH_ITERS;
+        if(us < best_us)
+        {
+            best_us = us;
+            best_cycles = (c1 > c0) ? (double) (c1 - c0) / BENCH_ITERS : 0.0;
+        }
+    }
+
+    printf("%-9s %6u bytes  %6.1fx  %6.2f us/block  %7.0f cycles/block\n",
+           waveform_names[wfm], total, (double) SIZE_CURVE / total, best_us,
+           best_cycles);
+}
+
+int main(void)
+{
+    waveform_t wfm;
+
+    srand(1);
+
+    bsmp_server_init(&server);
+
+    curves_state[CURVE_WFMREF].user = wfmref_data;
+    curves_state[CURVE_PLAIN].user = plain_data;
+
+    if(bsmp_register_curve_table(&server, curves, curves_state,
+                                 NUMBER_OF_CURVES) != BSMP_SUCCESS)
+    {
+        printf("FAIL: curve table not registered\n");
+        return 1;
+    }
+
+    test_codec();
+    test_malformed();
+    test_server();
+
+    printf("%u bytes encoded in blocks of %u:\n", SIZE_CURVE,
+           SIZE_CURVE_BLOCK);
+    for(wfm = 0; wfm < NUMBER_OF_WAVEFORMS; wfm++)
+    {
+        report(wfm);
+    }
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
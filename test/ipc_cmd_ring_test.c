@@ -0,0 +1,386 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file ipc_cmd_ring_test.c
+ * @brief Host stress test of IPC command ring
+ *
+ * Two threads model the two cores: main thread is ARM, running ipc_lib.c as
+ * built for firmware, and the other one is C28, which serves the command ring
+ * as C28 firmware does. MTOC IPC registers are an array, where ARM rings the
+ * doorbell and C28 acknowledges it before reading the ring. Both threads
+ * yield and stall at random points, so queueing, acknowledging and doorbells
+ * interleave in as many ways as possible. Checks that:
+ *  - C28 reads every command once, in order and intact, and never overwrites
+ *    an acknowledge not read by ARM yet;
+ *  - ARM sees every command acknowledged, only after C28 acknowledges it, and
+ *    with the result C28 gave it;
+ *  - no command is left in the ring without a doorbell.
+ *
+ * Then reports the rate of commands and how often ARM found the ring full.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "inc/hw_ipc.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+
+#include "board_drivers/version.h"
+#include "communication_drivers/ipc/ipc_lib.h"
+
+#define NUMBER_OF_CMDS          2000000
+#define STALL_TIMEOUT           5.0     // [s] without progress
+
+/// Command number n is fully given by its payload
+#define CMD_MSG(n)              ((ipc_mtoc_lowpriority_msg_t) (Turn_On + (n) % 28))
+#define CMD_PS_ID(n)            (((n) >> 5) % NUM_MAX_PS_MODULES)
+#define CMD_RESULT(n)           ((error_mtoc_t) (((n) * 7) % 5))
+
+volatile unsigned int g_mtocipc_regs[8];
+
+volatile firmwares_version_t firmwares_version;
+const char * udc_arm_version = "";
+
+/**
+ * Counters of C28 thread. Only C28 writes them, ARM only reads.
+ */
+static struct
+{
+    volatile uint32_t   acked;      // Commands acknowledged
+    volatile uint32_t   errors;
+    volatile bool       stop;
+} c28;
+
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+/* Firmware functions used by ipc_lib.c */
+
+float get_param(param_id_t id, uint16_t n)
+{
+    return 0.0;
+}
+
+void hradc_rst_ctrl(uint8_t sts)
+{
+}
+
+void IntRegister(unsigned long ulInterrupt, void (*pfnHandler)(void))
+{
+}
+
+void IntEnable(unsigned long ulInterrupt)
+{
+}
+
+void IPCCtoMFlagAcknowledge(unsigned long ulFlags)
+{
+}
+
+/**
+ * xorshift32, one state per thread
+ */
+static uint32_t random_next(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**
+ * Yield or spin at random, 1 in 2^bits calls
+ */
+static void random_stall(uint32_t *state, uint8_t bits)
+{
+    uint32_t r = random_next(state);
+    volatile uint32_t spin;
+
+    if(r & ((1 << bits) - 1))
+    {
+        return;
+    }
+
+    if(r & 0x80000000)
+    {
+        sched_yield();
+    }
+    else
+    {
+        for(spin = (r >> 16) & 0x3FF; spin; spin--);
+    }
+}
+
+/* C28 */
+
+static void c28_fail(const char *what, uint16_t idx)
+{
+    if(!c28.errors++)
+    {
+        printf("FAIL: C28: %s at read index %u\n", what, idx);
+    }
+}
+
+/**
+ * Serve command ring as C28 firmware does: acknowledge doorbell, then read
+ * every command queued and acknowledge it on the ack ring
+ */
+static void *c28_thread(void *arg)
+{
+    volatile uint32_t *p_doorbell = &HWREG(MTOCIPC_BASE + IPC_O_MTOCIPCSET);
+    uint32_t random_state = 0xC28C28;
+    uint32_t n = 0;
+    uint16_t idx;
+    volatile ipc_cmd_t *p_cmd;
+    volatile ipc_cmd_ack_t *p_ack;
+
+    g_ipc_ctom_cmd_ring.read_idx = 0;
+    g_ipc_ctom_cmd_ring.ack_write_idx = 0;
+    g_ipc_ctom_cmd_ring.version = IPC_CMD_RING_VERSION;
+
+    while(!c28.stop)
+    {
+        if(!(*p_doorbell & IPC_MTOC_CMD_RING))
+        {
+            sched_yield();
+            continue;
+        }
+
+        __atomic_and_fetch(p_doorbell, ~IPC_MTOC_CMD_RING, __ATOMIC_SEQ_CST);
+        random_stall(&random_state, 4);
+
+        idx = g_ipc_ctom_cmd_ring.read_idx;
+
+        while(idx != g_ipc_mtoc_cmd_ring.write_idx)
+        {
+            p_cmd = &g_ipc_mtoc_cmd_ring.cmd[idx & IPC_CMD_RING_MASK];
+
+            if( (p_cmd->seq != idx) || (p_cmd->payload.u32 != n) ||
+                (p_cmd->msg != CMD_MSG(n)) || (p_cmd->ps_id != CMD_PS_ID(n)) )
+            {
+                c28_fail("command lost, repeated or corrupted", idx);
+            }
+
+            random_stall(&random_state, 6);
+
+            if( (uint16_t) (g_ipc_ctom_cmd_ring.ack_write_idx -
+                            g_ipc_mtoc_cmd_ring.ack_read_idx) >=
+                IPC_CMD_RING_SIZE )
+            {
+                c28_fail("acknowledge not read by ARM overwritten", idx);
+            }
+
+            p_ack = &g_ipc_ctom_cmd_ring.ack[g_ipc_ctom_cmd_ring.ack_write_idx &
+                                            IPC_CMD_RING_MASK];
+            p_ack->seq    = idx;
+            p_ack->result = CMD_RESULT(n);
+
+            c28.acked = ++n;
+            g_ipc_ctom_cmd_ring.ack_write_idx++;
+            g_ipc_ctom_cmd_ring.read_idx = ++idx;
+        }
+    }
+
+    return NULL;
+}
+
+/* ARM */
+
+static double elapsed_s(struct timespec *t0, struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) + (t1->tv_nsec - t0->tv_nsec) / 1e9;
+}
+
+/**
+ * Commands sent and not checked yet. There are never more than
+ * IPC_CMD_RING_SIZE, so their results are still available.
+ */
+static struct
+{
+    uint16_t    seq[IPC_CMD_RING_SIZE];
+    uint32_t    n[IPC_CMD_RING_SIZE];
+    uint32_t    head;
+    uint32_t    tail;
+} pending;
+
+/**
+ * Check oldest pending command. Returns true if it's acknowledged.
+ */
+static bool check_oldest(void)
+{
+    uint32_t slot = pending.tail % IPC_CMD_RING_SIZE;
+    error_mtoc_t result;
+
+    if(!ipc_cmd_ring_acked(pending.seq[slot], &result))
+    {
+        return false;
+    }
+
+    if(c28.acked <= pending.n[slot])
+    {
+        CHECK(0, "ARM: command %u acknowledged before C28 did",
+              pending.n[slot]);
+    }
+
+    if(result != CMD_RESULT(pending.n[slot]))
+    {
+        CHECK(0, "ARM: command %u acknowledged with result %u, expected %u",
+              pending.n[slot], result, CMD_RESULT(pending.n[slot]));
+    }
+
+    pending.tail++;
+    return true;
+}
+
+/**
+ * Wait for progress of C28, failing after STALL_TIMEOUT. Yields, so it also
+ * works with both threads on a single CPU.
+ */
+static bool wait_c28(struct timespec *p_since, uint32_t *p_spins)
+{
+    struct timespec now;
+
+    sched_yield();
+
+    if(++(*p_spins) & 0xFF)
+    {
+        return true;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return elapsed_s(p_since, &now) < STALL_TIMEOUT;
+}
+
+int main(void)
+{
+    pthread_t thread;
+    struct timespec t0, t1, since;
+    uint32_t random_state = 0xA53A53;
+    uint32_t full = 0, spins, n, slot;
+    uint16_t seq;
+
+    init_ipc();
+
+    if(pthread_create(&thread, NULL, c28_thread, NULL))
+    {
+        printf("FAIL: C28 thread not created\n");
+        return 1;
+    }
+
+    while(!ipc_cmd_ring_enabled())
+    {
+        sched_yield();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for(n = 0; (n < NUMBER_OF_CMDS) && !failures && !c28.errors; n++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &since);
+        spins = 0;
+
+        /// Results are only kept for IPC_CMD_RING_SIZE commands, which is
+        /// also as many as the ring takes before they're acknowledged
+        while( (pending.head - pending.tail == IPC_CMD_RING_SIZE) &&
+               !check_oldest() )
+        {
+            full++;
+            if(!wait_c28(&since, &spins))
+            {
+                CHECK(0, "ARM: stalled on command %u, %u acknowledged by C28",
+                      n, c28.acked);
+                break;
+            }
+        }
+
+        if(failures)
+        {
+            break;
+        }
+
+        /// With less than IPC_CMD_RING_SIZE not acknowledged, ring takes it
+        if(!ipc_cmd_ring_send(CMD_PS_ID(n), CMD_MSG(n), n))
+        {
+            CHECK(0, "ARM: command %u refused with %u not acknowledged", n,
+                  pending.head - pending.tail);
+            break;
+        }
+
+        seq = ipc_cmd_ring_last_seq();
+        CHECK(seq == (uint16_t) n, "ARM: command %u queued as %u", n, seq);
+
+        slot = pending.head++ % IPC_CMD_RING_SIZE;
+        pending.seq[slot] = seq;
+        pending.n[slot] = n;
+
+        while( (pending.head != pending.tail) && check_oldest() );
+
+        random_stall(&random_state, 5);
+    }
+
+    /// Every command is acknowledged, without any further doorbell
+    clock_gettime(CLOCK_MONOTONIC, &since);
+    spins = 0;
+
+    while(pending.head != pending.tail)
+    {
+        if(!check_oldest() && !wait_c28(&since, &spins))
+        {
+            CHECK(0, "ARM: command %u left unacknowledged",
+                  pending.n[pending.tail % IPC_CMD_RING_SIZE]);
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    c28.stop = true;
+    pthread_join(thread, NULL);
+
+    CHECK(!c28.errors, "C28: %u errors", c28.errors);
+    CHECK(c28.acked == n, "C28: %u commands acknowledged, %u sent", c28.acked,
+          n);
+    CHECK(!ipc_cmd_ring_full(), "ARM: ring full after every acknowledge");
+
+    printf("%u commands in %.2f s: %.0f commands/s, ARM waited %u times on "
+           "full ring\n", n, elapsed_s(&t0, &t1), n / elapsed_s(&t0, &t1),
+           full);
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
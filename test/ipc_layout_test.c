@@ -0,0 +1,72 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file ipc_layout_test.c
+ * @brief Host check of shared memory layout schema
+ *
+ * Includes ipc_layout.h together with ipc_lib.h, with layout checks enabled,
+ * so a change on a structure shared with C28 which isn't mirrored on the
+ * schema fails a host build, not only the TI one. Host compiler must build
+ * with ARM type sizes: 32-bit pointers and packed enumerations. Checks, at
+ * compile time, that:
+ *  - the size of each shared structure and the offset of each of its fields
+ *    match the schema;
+ *  - each structure fits its shared RAM block.
+ *
+ * Then prints the schema, with sizes and offsets given by the compiler.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#define IPC_LAYOUT_CHECK
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "communication_drivers/ipc/ipc_lib.h"
+#include "communication_drivers/ipc/ipc_layout.h"
+
+typedef enum
+{
+    LAYOUT_ENUM_A,
+    LAYOUT_ENUM_B
+} layout_enum_t;
+
+/// Without ARM type sizes every check above would fail, so tell why instead
+LAYOUT_ASSERT(pointers_32_bit, sizeof(void *) == 4);
+LAYOUT_ASSERT(enums_packed, sizeof(layout_enum_t) == 1);
+
+#define LAYOUT_PRINT_SIZE(type, size)                                       \
+    printf("%-22s %6u\n", #type, (unsigned) LAYOUT_BYTES(sizeof(type)));
+
+#define LAYOUT_PRINT_FIELD(type, field, offset)                             \
+    printf("%-22s %-22s %6u\n", #type, #field,                             \
+           (unsigned) LAYOUT_BYTES(offsetof(type, field)));
+
+#define LAYOUT_PRINT_BLOCK(name, used, size)                                \
+    printf("%-22s %6u of %u\n", #name, (unsigned) LAYOUT_BYTES(used),      \
+           (unsigned) (size));
+
+int main(void)
+{
+    LAYOUT_SIZES(LAYOUT_PRINT_SIZE)
+    printf("\n");
+    LAYOUT_FIELDS(LAYOUT_PRINT_FIELD)
+    printf("\n");
+    LAYOUT_BLOCKS(LAYOUT_PRINT_BLOCK)
+
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1 @@
+/* Host stub of driverlib/debug.h: nothing needed by tested code */
@@ -0,0 +1,11 @@
+/* Host stub of driverlib/gpio.h, implemented by uart_model.c */
+
+#ifndef __GPIO_H__
+#define __GPIO_H__
+
+#define GPIO_PIN_2      0x00000004
+
+extern void GPIOPinWrite(unsigned long ulPort, unsigned char ucPins,
+                         unsigned char ucVal);
+
+#endif
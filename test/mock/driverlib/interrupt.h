@@ -0,0 +1,12 @@
+/* Host stub of driverlib/interrupt.h, implemented by uart_model.c */
+
+#ifndef __INTERRUPT_H__
+#define __INTERRUPT_H__
+
+extern void IntRegister(unsigned long ulInterrupt, void (*pfnHandler)(void));
+extern void IntEnable(unsigned long ulInterrupt);
+extern void IntDisable(unsigned long ulInterrupt);
+extern void IntPrioritySet(unsigned long ulInterrupt,
+                           unsigned char ucPriority);
+
+#endif
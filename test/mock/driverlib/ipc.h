@@ -0,0 +1,8 @@
+/* Host stub of driverlib/ipc.h, implemented by tests which use it */
+
+#ifndef __IPC_H__
+#define __IPC_H__
+
+extern void IPCCtoMFlagAcknowledge(unsigned long ulFlags);
+
+#endif
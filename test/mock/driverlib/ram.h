@@ -0,0 +1 @@
+/* Host stub of driverlib/ram.h: nothing needed by tested code */
@@ -0,0 +1,18 @@
+/* Host stub of driverlib/sysctl.h, implemented by uart_model.c and tests */
+
+#ifndef __SYSCTL_H__
+#define __SYSCTL_H__
+
+/// Defined by the CCS project on firmware builds
+#ifndef SYSTEM_CLOCK_SPEED
+#define SYSTEM_CLOCK_SPEED      150000000
+#endif
+
+#define SYSCTL_CONTROL_SYSTEM_RES_CNF   0x00000001
+
+extern unsigned long SysCtlClockGet(unsigned long u32ClockIn);
+extern void SysCtlDelay(unsigned long ulCount);
+extern void SysCtlHoldSubSystemInReset(unsigned long ulSubSystem);
+extern void SysCtlReset(void);
+
+#endif
@@ -0,0 +1 @@
+/* Host stub of driverlib/systick.h: nothing needed by tested code */
@@ -0,0 +1,41 @@
+/* Host stub of driverlib/uart.h, implemented by uart_model.c */
+
+#ifndef __UART_H__
+#define __UART_H__
+
+#include "inc/hw_types.h"
+
+#define UART_INT_RX             0x010
+#define UART_INT_TX             0x020
+#define UART_INT_RT             0x040
+
+#define UART_CONFIG_WLEN_8      0x00000060
+#define UART_CONFIG_STOP_ONE    0x00000000
+#define UART_CONFIG_PAR_NONE    0x00000000
+
+#define UART_FIFO_TX1_8         0x00000000
+#define UART_FIFO_RX4_8         0x00000010
+
+#define UART_DMA_RX             0x00000001
+#define UART_DMA_TX             0x00000002
+
+#define UART_TXINT_MODE_EOT     0x00000010
+
+extern void UARTConfigSetExpClk(unsigned long ulBase, unsigned long ulUARTClk,
+                                unsigned long ulBaud, unsigned long ulConfig);
+extern void UARTFIFOEnable(unsigned long ulBase);
+extern void UARTFIFOLevelSet(unsigned long ulBase, unsigned long ulTxLevel,
+                             unsigned long ulRxLevel);
+extern void UARTEnable(unsigned long ulBase);
+extern void UARTDMAEnable(unsigned long ulBase, unsigned long ulDMAFlags);
+extern void UARTIntEnable(unsigned long ulBase, unsigned long ulIntFlags);
+extern void UARTTxIntModeSet(unsigned long ulBase, unsigned long ulMode);
+extern unsigned long UARTIntStatus(unsigned long ulBase, tBoolean bMasked);
+extern void UARTIntClear(unsigned long ulBase, unsigned long ulIntFlags);
+extern unsigned long UARTRxErrorGet(unsigned long ulBase);
+extern void UARTRxErrorClear(unsigned long ulBase);
+extern tBoolean UARTCharsAvail(unsigned long ulBase);
+extern long UARTCharGet(unsigned long ulBase);
+extern tBoolean UARTBusy(unsigned long ulBase);
+
+#endif
@@ -0,0 +1 @@
+/* Host stub of inc/hw_gpio.h: nothing needed by tested code */
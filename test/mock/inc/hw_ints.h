@@ -0,0 +1,9 @@
+/* Host stub of inc/hw_ints.h */
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define INT_UART1       22
+#define INT_CTOMPIC1    136
+
+#endif
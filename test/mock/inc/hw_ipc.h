@@ -0,0 +1,12 @@
+/* Host stub of inc/hw_ipc.h */
+
+#ifndef __HW_IPC_H__
+#define __HW_IPC_H__
+
+#define IPC_O_CTOMIPCACK        0x00000000
+#define IPC_O_CTOMIPCSTS        0x00000004
+#define IPC_O_MTOCIPCSET        0x00000008
+#define IPC_O_MTOCIPCCLR        0x0000000C
+#define IPC_O_MTOCIPCFLG        0x00000010
+
+#endif
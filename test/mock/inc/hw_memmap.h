@@ -0,0 +1,13 @@
+/* Host stub of inc/hw_memmap.h */
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define UART1_BASE      0x4000D000
+#define GPIO_PORTP_BASE 0x40065000
+
+/// MTOC IPC registers are modelled by an array of the test which uses them
+extern volatile unsigned int g_mtocipc_regs[];
+#define MTOCIPC_BASE    ((unsigned long) g_mtocipc_regs)
+
+#endif
@@ -0,0 +1 @@
+/* Host stub of inc/hw_nvic.h: nothing needed by tested code */
@@ -0,0 +1 @@
+/* Host stub of inc/hw_sysctl.h: nothing needed by tested code */
@@ -0,0 +1,14 @@
+/* Host stub of inc/hw_types.h */
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef unsigned char tBoolean;
+
+/// Registers are 32-bit wide, as unsigned long on target
+#define HWREG(x)        (*((volatile uint32_t *)(x)))
+
+#endif
@@ -0,0 +1,8 @@
+/* Host stub of inc/hw_uart.h */
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#define UART_O_DR       0x00000000
+
+#endif
@@ -0,0 +1,11 @@
+/* Host wrapper of math.h
+ *
+ * TI compiler takes integer arguments on isinf() and isnan(), as done by
+ * config_rs485(). Host compilers only take floating-point ones. */
+
+#include_next <math.h>
+
+#undef isinf
+#undef isnan
+#define isinf(x)        __builtin_isinf((double) (x))
+#define isnan(x)        __builtin_isnan((double) (x))
@@ -0,0 +1,461 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file uart_model.c
+ * @brief Host model of RS485 UART and its uDMA channels
+ *
+ * Only UART1 and its uDMA channels are modelled. Interrupts are serviced as
+ * soon as they're raised, unless disabled or already being serviced, in which
+ * case they're left pending until IntEnable() or the end of the ISR.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+
+#include "uart_model.h"
+
+#define FIFO_SIZE               16
+#define FIFO_RX_LEVEL           8       // UART_FIFO_RX4_8
+#define DMA_ARB_SIZE            4       // UDMA_ARB_4
+#define DMA_MAX_TRANSFER        1024
+#define NUMBER_OF_DMA_CHANNELS  32
+
+#define DMA_CHANNEL(x)          ((x) & 0x1F)
+#define DMA_SELECT(x)           (((x) & UDMA_ALT_SELECT) ? 1 : 0)
+
+typedef struct
+{
+    unsigned long   mode;
+    uint8_t         *src;
+    uint8_t         *dst;
+    unsigned long   count;
+} dma_ctl_t;
+
+typedef struct
+{
+    dma_ctl_t   ctl[2];     // Primary and alternate control structures
+    bool        enabled;
+    uint8_t     active;     // Control structure used on next request
+} dma_channel_t;
+
+uart_model_t g_uart_model;
+
+static dma_channel_t dma_channels[NUMBER_OF_DMA_CHANNELS];
+
+static struct
+{
+    uint8_t     data[FIFO_SIZE];
+    uint8_t     head;
+    uint8_t     level;
+} rx_fifo;
+
+static unsigned long int_status;
+static unsigned long rx_error;
+static unsigned long dma_enabled;
+static bool int_enabled;
+static bool int_pending;
+static bool in_isr;
+static void (*p_isr)(void);
+
+static void misuse(const char *what)
+{
+    printf("uart_model: %s\n", what);
+    g_uart_model.misuses++;
+}
+
+static void service_int(void)
+{
+    if(!int_enabled || in_isr || !p_isr)
+    {
+        return;
+    }
+
+    in_isr = true;
+
+    while(int_pending)
+    {
+        int_pending = false;
+        g_uart_model.isr_calls++;
+        p_isr();
+    }
+
+    in_isr = false;
+}
+
+static void raise_int(unsigned long status)
+{
+    int_status |= status;
+    int_pending = true;
+    service_int();
+}
+
+/**
+ * Control structure is done: in ping-pong mode, channel switches to the other
+ * one, which must be already armed, otherwise channel stops
+ */
+static void dma_done(dma_channel_t *ch)
+{
+    dma_ctl_t *ctl = &ch->ctl[ch->active];
+    unsigned long mode = ctl->mode;
+
+    ctl->mode = UDMA_MODE_STOP;
+
+    ch->active ^= 1;
+    if( (mode != UDMA_MODE_PINGPONG) ||
+        (ch->ctl[ch->active].mode == UDMA_MODE_STOP) )
+    {
+        ch->enabled = false;
+    }
+
+    raise_int(0);
+}
+
+static void rx_dma_run(void)
+{
+    dma_channel_t *ch = &dma_channels[UDMA_CHANNEL_UART1RX];
+    dma_ctl_t *ctl;
+    unsigned long n;
+
+    while( ch->enabled && (dma_enabled & UART_DMA_RX) &&
+           (rx_fifo.level >= FIFO_RX_LEVEL) )
+    {
+        ctl = &ch->ctl[ch->active];
+
+        if(ctl->mode == UDMA_MODE_STOP)
+        {
+            ch->enabled = false;
+            break;
+        }
+
+        for(n = 0; (n < DMA_ARB_SIZE) && ctl->count; n++, ctl->count--)
+        {
+            *ctl->dst++ = rx_fifo.data[rx_fifo.head];
+            rx_fifo.head = (rx_fifo.head + 1) % FIFO_SIZE;
+            rx_fifo.level--;
+        }
+
+        if(!ctl->count)
+        {
+            dma_done(ch);
+        }
+    }
+}
+
+void uart_model_rx(const uint8_t *data, uint32_t len, uint32_t baudrate)
+{
+    uint8_t byte;
+
+    while(len--)
+    {
+        byte = *data++;
+
+        if(baudrate != g_uart_model.baudrate)
+        {
+            byte = ~byte;
+            rx_error |= 1;
+            g_uart_model.rx_errors++;
+        }
+
+        if(rx_fifo.level == FIFO_SIZE)
+        {
+            rx_error |= 8;
+            g_uart_model.overruns++;
+        }
+        else
+        {
+            rx_fifo.data[(rx_fifo.head + rx_fifo.level) % FIFO_SIZE] = byte;
+            rx_fifo.level++;
+        }
+
+        rx_dma_run();
+    }
+}
+
+void uart_model_rx_idle(void)
+{
+    if(rx_fifo.level)
+    {
+        raise_int(UART_INT_RT);
+    }
+}
+
+uint32_t uart_model_tx(uint8_t *data, uint32_t max_len)
+{
+    dma_channel_t *ch = &dma_channels[UDMA_CHANNEL_UART1TX];
+    dma_ctl_t *ctl;
+    uint32_t len = 0;
+
+    g_uart_model.tx_baudrate = g_uart_model.baudrate;
+
+    while(ch->enabled && (dma_enabled & UART_DMA_TX))
+    {
+        ctl = &ch->ctl[ch->active];
+
+        if(ctl->mode == UDMA_MODE_STOP)
+        {
+            ch->enabled = false;
+            break;
+        }
+
+        for(; ctl->count; ctl->count--, len++)
+        {
+            if(!g_uart_model.driver_on)
+            {
+                misuse("byte transmitted with RS485 driver off");
+            }
+
+            if(len < max_len)
+            {
+                data[len] = *ctl->src;
+            }
+            ctl->src++;
+        }
+
+        dma_done(ch);
+    }
+
+    // End of transmission
+    if(len)
+    {
+        raise_int(UART_INT_TX);
+    }
+
+    return len;
+}
+
+/* Driverlib */
+
+void GPIOPinWrite(unsigned long ulPort, unsigned char ucPins,
+                  unsigned char ucVal)
+{
+    if( (ulPort == GPIO_PORTP_BASE) && (ucPins & GPIO_PIN_2) )
+    {
+        g_uart_model.driver_on = (ucVal & GPIO_PIN_2) != 0;
+    }
+}
+
+unsigned long SysCtlClockGet(unsigned long u32ClockIn)
+{
+    return 75000000;
+}
+
+void IntRegister(unsigned long ulInterrupt, void (*pfnHandler)(void))
+{
+    if(ulInterrupt == INT_UART1)
+    {
+        p_isr = pfnHandler;
+    }
+}
+
+void IntEnable(unsigned long ulInterrupt)
+{
+    if(ulInterrupt == INT_UART1)
+    {
+        int_enabled = true;
+        service_int();
+    }
+}
+
+void IntDisable(unsigned long ulInterrupt)
+{
+    if(ulInterrupt == INT_UART1)
+    {
+        int_enabled = false;
+    }
+}
+
+void IntPrioritySet(unsigned long ulInterrupt, unsigned char ucPriority)
+{
+}
+
+void UARTConfigSetExpClk(unsigned long ulBase, unsigned long ulUARTClk,
+                         unsigned long ulBaud, unsigned long ulConfig)
+{
+    if(ulConfig != (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                    UART_CONFIG_PAR_NONE))
+    {
+        misuse("UART configured other than 8-N-1");
+    }
+
+    if(g_uart_model.driver_on)
+    {
+        misuse("baud-rate changed during transmission");
+    }
+
+    // UART is disabled meanwhile, which flushes FIFOs
+    g_uart_model.baudrate = ulBaud;
+    g_uart_model.baudrate_sets++;
+    rx_fifo.level = 0;
+}
+
+void UARTFIFOEnable(unsigned long ulBase)
+{
+}
+
+void UARTFIFOLevelSet(unsigned long ulBase, unsigned long ulTxLevel,
+                      unsigned long ulRxLevel)
+{
+    if(ulRxLevel != UART_FIFO_RX4_8)
+    {
+        misuse("RX FIFO level other than modelled");
+    }
+}
+
+void UARTEnable(unsigned long ulBase)
+{
+}
+
+void UARTDMAEnable(unsigned long ulBase, unsigned long ulDMAFlags)
+{
+    dma_enabled |= ulDMAFlags;
+}
+
+void UARTIntEnable(unsigned long ulBase, unsigned long ulIntFlags)
+{
+}
+
+void UARTTxIntModeSet(unsigned long ulBase, unsigned long ulMode)
+{
+}
+
+unsigned long UARTIntStatus(unsigned long ulBase, tBoolean bMasked)
+{
+    return int_status;
+}
+
+void UARTIntClear(unsigned long ulBase, unsigned long ulIntFlags)
+{
+    int_status &= ~ulIntFlags;
+}
+
+unsigned long UARTRxErrorGet(unsigned long ulBase)
+{
+    return rx_error;
+}
+
+void UARTRxErrorClear(unsigned long ulBase)
+{
+    rx_error = 0;
+}
+
+tBoolean UARTCharsAvail(unsigned long ulBase)
+{
+    return rx_fifo.level != 0;
+}
+
+long UARTCharGet(unsigned long ulBase)
+{
+    uint8_t byte;
+
+    if(!rx_fifo.level)
+    {
+        misuse("UARTCharGet() blocked on empty RX FIFO");
+        return 0;
+    }
+
+    byte = rx_fifo.data[rx_fifo.head];
+    rx_fifo.head = (rx_fifo.head + 1) % FIFO_SIZE;
+    rx_fifo.level--;
+
+    return byte;
+}
+
+tBoolean UARTBusy(unsigned long ulBase)
+{
+    return false;
+}
+
+void uDMAChannelEnable(unsigned long ulChannelNum)
+{
+    dma_channels[DMA_CHANNEL(ulChannelNum)].enabled = true;
+
+    if(DMA_CHANNEL(ulChannelNum) == UDMA_CHANNEL_UART1RX)
+    {
+        rx_dma_run();
+    }
+}
+
+void uDMAChannelDisable(unsigned long ulChannelNum)
+{
+    dma_channels[DMA_CHANNEL(ulChannelNum)].enabled = false;
+}
+
+void uDMAChannelAttributeEnable(unsigned long ulChannelNum,
+                                unsigned long ulAttr)
+{
+    if(ulAttr & UDMA_ATTR_ALTSELECT)
+    {
+        dma_channels[DMA_CHANNEL(ulChannelNum)].active = 1;
+    }
+}
+
+void uDMAChannelAttributeDisable(unsigned long ulChannelNum,
+                                 unsigned long ulAttr)
+{
+    if(ulAttr & UDMA_ATTR_ALTSELECT)
+    {
+        dma_channels[DMA_CHANNEL(ulChannelNum)].active = 0;
+    }
+}
+
+void uDMAChannelControlSet(unsigned long ulChannelStructIndex,
+                           unsigned long ulControl)
+{
+}
+
+void uDMAChannelTransferSet(unsigned long ulChannelStructIndex,
+                            unsigned long ulMode, void *pvSrcAddr,
+                            void *pvDstAddr, unsigned long ulTransferSize)
+{
+    dma_channel_t *ch = &dma_channels[DMA_CHANNEL(ulChannelStructIndex)];
+    dma_ctl_t *ctl = &ch->ctl[DMA_SELECT(ulChannelStructIndex)];
+
+    if(!ulTransferSize || (ulTransferSize > DMA_MAX_TRANSFER))
+    {
+        misuse("uDMA transfer size out of range");
+    }
+
+    if(ch->enabled && (ctl == &ch->ctl[ch->active]))
+    {
+        misuse("uDMA control structure in use set");
+    }
+
+    ctl->mode  = ulMode;
+    ctl->src   = pvSrcAddr;
+    ctl->dst   = pvDstAddr;
+    ctl->count = ulTransferSize;
+}
+
+unsigned long uDMAChannelSizeGet(unsigned long ulChannelStructIndex)
+{
+    dma_ctl_t *ctl = &dma_channels[DMA_CHANNEL(ulChannelStructIndex)].
+                     ctl[DMA_SELECT(ulChannelStructIndex)];
+
+    return (ctl->mode == UDMA_MODE_STOP) ? 0 : ctl->count;
+}
+
+unsigned long uDMAChannelModeGet(unsigned long ulChannelStructIndex)
+{
+    return dma_channels[DMA_CHANNEL(ulChannelStructIndex)].
+           ctl[DMA_SELECT(ulChannelStructIndex)].mode;
+}
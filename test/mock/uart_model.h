@@ -0,0 +1,64 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file uart_model.h
+ * @brief Host model of RS485 UART and its uDMA channels
+ *
+ * Implements the driverlib functions used by rs485.c over a model of UART1:
+ * 16-byte RX FIFO, burst requests at half FIFO, receive timeout and
+ * end-of-transmission interrupts, and ping-pong uDMA control structures which
+ * switch and stop as on hardware. The other end of the line is driven by the
+ * test, byte by byte.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#ifndef UART_MODEL_H_
+#define UART_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    uint32_t    baudrate;       // Set by UARTConfigSetExpClk()
+    uint32_t    baudrate_sets;  // Number of UARTConfigSetExpClk() calls
+    uint32_t    tx_baudrate;    // Baud-rate of last transmission
+    bool        driver_on;      // RS485 transceiver on transmission mode
+    uint32_t    isr_calls;      // Interrupts serviced
+    uint32_t    rx_errors;      // Bytes received at wrong baud-rate
+    uint32_t    overruns;       // Bytes lost on full RX FIFO
+    uint32_t    misuses;        // Driverlib misuse, reported as found
+} uart_model_t;
+
+extern uart_model_t g_uart_model;
+
+/**
+ * Bytes sent by the other end of the line at specified baud-rate. Bytes are
+ * garbled if it doesn't match the UART baud-rate.
+ */
+extern void uart_model_rx(const uint8_t *data, uint32_t len, uint32_t baudrate);
+
+/**
+ * Line idle after last byte, long enough for receive timeout
+ */
+extern void uart_model_rx_idle(void);
+
+/**
+ * Run TX uDMA until it stops, as the line is driven. Returns number of bytes
+ * transmitted, of which up to max_len are copied to data. They're received
+ * garbled by the other end if it's not at tx_baudrate.
+ */
+extern uint32_t uart_model_tx(uint8_t *data, uint32_t max_len);
+
+#endif /* UART_MODEL_H_ */
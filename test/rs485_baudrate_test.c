@@ -0,0 +1,383 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file rs485_baudrate_test.c
+ * @brief Host test of RS485 baud-rate negotiation
+ *
+ * Builds rs485.c against a model of UART1 and its uDMA channels (see
+ * mock/uart_model.c), connected to a simulated master with its own baud-rate.
+ * Bytes sent at a baud-rate other than the receiver's are garbled. The master
+ * proposes baud-rates with BSMP function 44, as bsmp_set_serial_baudrate()
+ * does on firmware. Checks that:
+ *  - the answer to a proposal is sent at the current baud-rate, and the new
+ *    one is applied once it's done, never during a transmission;
+ *  - a proposal by broadcast is applied right after it's processed;
+ *  - a valid frame at the new baud-rate confirms it, and the previous one is
+ *    restored if none arrives within the trial timeout, even if frames arrive
+ *    garbled meanwhile;
+ *  - baud-rates out of range are refused, and proposing the current one
+ *    changes nothing.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "communication_drivers/bsmp/bsmp_lib.h"
+#include "communication_drivers/bsmp/bsmp/src/bsmp_priv.h"
+#include "communication_drivers/i2c_onboard/exio.h"
+#include "communication_drivers/parameters/ps_parameters.h"
+#include "communication_drivers/rs485/rs485.h"
+#include "communication_drivers/system_task/system_task.h"
+
+#include "mock/uart_model.h"
+
+/// As in rs485.c
+#define SERIAL_BUF_SIZE             (1+3+3+16834+1)
+#define BAUDRATE_TRIAL_TIMEOUT      1000
+
+#define BSMP_FUNC_SET_BAUDRATE      44
+
+#define UDC_ADDRESS                 1
+#define BCAST_ADDRESS               255
+
+typedef struct
+{
+    uint8_t     data[SERIAL_BUF_SIZE];
+    uint16_t    len;
+} frame_t;
+
+/**
+ * Master side of the line
+ */
+static struct
+{
+    uint32_t    baudrate;
+    frame_t     request;
+    frame_t     answer;
+} master;
+
+static bool task_rs485;
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+/* Firmware functions used by rs485.c */
+
+void TaskSetNew(uint8_t TaskNum)
+{
+    if(TaskNum == PROCESS_RS485_MESSAGE)
+    {
+        task_rs485 = true;
+    }
+}
+
+float get_param(param_id_t id, uint16_t n)
+{
+    switch(id)
+    {
+        case RS485_Baudrate:
+            return 115200;
+        case RS485_Address:
+            return UDC_ADDRESS + n;
+        default:
+            return 0.0;
+    }
+}
+
+uint8_t set_param(param_id_t id, uint16_t n, float val)
+{
+    return 1;
+}
+
+void rs485_term_ctrl(uint8_t sts)
+{
+}
+
+bool bsmp_cmd_pending(struct bsmp_raw_packet *response)
+{
+    return false;
+}
+
+void bsmp_defer_response(struct bsmp_raw_packet *response,
+                         void (*p_send_response)(void))
+{
+}
+
+/**
+ * Answer function 44 as bsmp_set_serial_baudrate() does, and anything else
+ * with CMD_OK
+ */
+static void bsmp_answer(struct bsmp_raw_packet *recv_packet,
+                        struct bsmp_raw_packet *send_packet,
+                        uint16_t command_interface)
+{
+    uint8_t *req = recv_packet->data;
+    uint32_t baud;
+
+    if( (recv_packet->len == 3 + 5) && (req[0] == CMD_FUNC_EXECUTE) &&
+        (req[3] == BSMP_FUNC_SET_BAUDRATE) )
+    {
+        memcpy(&baud, &req[4], 4);
+
+        send_packet->data[0] = CMD_FUNC_RETURN;
+        send_packet->data[1] = 0;
+        send_packet->data[2] = 1;
+        send_packet->data[3] = ( (command_interface == Remote) &&
+                                 rs485_propose_baudrate(baud) ) ?
+                               Ok : Invalid_Command;
+        send_packet->len = 4;
+    }
+    else
+    {
+        send_packet->data[0] = CMD_OK;
+        send_packet->data[1] = 0;
+        send_packet->data[2] = 0;
+        send_packet->len = 3;
+    }
+}
+
+void BSMPprocess(struct bsmp_raw_packet *recv_packet,
+                 struct bsmp_raw_packet *send_packet, uint8_t server,
+                 uint16_t command_interface)
+{
+    bsmp_answer(recv_packet, send_packet, command_interface);
+}
+
+void BSMPprocess_broadcast(struct bsmp_raw_packet *recv_packet,
+                           struct bsmp_raw_packet *send_packet,
+                           uint16_t command_interface)
+{
+    bsmp_answer(recv_packet, send_packet, command_interface);
+}
+
+/* Simulated master */
+
+static void build_frame(frame_t *frame, uint8_t addr, const uint8_t *bsmp,
+                        uint16_t len)
+{
+    uint8_t csum = 0;
+    uint16_t i;
+
+    frame->data[0] = addr;
+    memcpy(&frame->data[1], bsmp, len);
+    frame->len = 1 + len + 1;
+
+    for(i = 0; i < frame->len - 1; i++)
+    {
+        csum += frame->data[i];
+    }
+    frame->data[frame->len - 1] = -csum;
+}
+
+/**
+ * Send request at master baud-rate and run main loop until it's done. Returns
+ * true if a valid answer is received by master.
+ */
+static bool master_request(uint8_t addr, const uint8_t *bsmp, uint16_t len)
+{
+    uint8_t csum = 0;
+    uint16_t i;
+
+    build_frame(&master.request, addr, bsmp, len);
+    uart_model_rx(master.request.data, master.request.len, master.baudrate);
+    uart_model_rx_idle();
+
+    master.answer.len = 0;
+
+    do
+    {
+        if(task_rs485)
+        {
+            task_rs485 = false;
+            rs485_process_data();
+        }
+        master.answer.len += uart_model_tx(&master.answer.data[master.answer.len],
+                                           SERIAL_BUF_SIZE - master.answer.len);
+    }while(task_rs485);
+
+    if( !master.answer.len ||
+        (g_uart_model.tx_baudrate != master.baudrate) )
+    {
+        return false;
+    }
+
+    for(i = 0; i < master.answer.len; i++)
+    {
+        csum += master.answer.data[i];
+    }
+
+    return (csum == 0) && (master.answer.data[0] == 0);
+}
+
+static bool master_read_var(uint8_t addr)
+{
+    static const uint8_t read_var[] = {CMD_VAR_READ, 0, 1, 0};
+
+    return master_request(addr, read_var, sizeof(read_var));
+}
+
+/**
+ * Propose baud-rate. Returns the answer of function 44, or -1 if there's no
+ * valid answer.
+ */
+static int master_propose(uint8_t addr, uint32_t baudrate)
+{
+    uint8_t func[3 + 5] = {CMD_FUNC_EXECUTE, 0, 5, BSMP_FUNC_SET_BAUDRATE};
+
+    memcpy(&func[4], &baudrate, 4);
+
+    if(!master_request(addr, func, sizeof(func)) ||
+       (master.answer.data[1] != CMD_FUNC_RETURN))
+    {
+        return -1;
+    }
+
+    return master.answer.data[4];
+}
+
+static void tick_ms(uint16_t ms)
+{
+    while(ms--)
+    {
+        rs485_baudrate_trial_tick();
+    }
+}
+
+/* Tests */
+
+static void test_confirmed(void)
+{
+    master.baudrate = 115200;
+
+    CHECK(master_propose(UDC_ADDRESS, 6000000) == Ok,
+          "proposal: not answered at current baud-rate");
+    CHECK(g_uart_model.baudrate == 6000000,
+          "proposal: not applied after answer");
+
+    master.baudrate = 6000000;
+    tick_ms(BAUDRATE_TRIAL_TIMEOUT / 2);
+    CHECK(master_read_var(UDC_ADDRESS), "new baud-rate: not answered");
+
+    tick_ms(10 * BAUDRATE_TRIAL_TIMEOUT);
+    CHECK(g_uart_model.baudrate == 6000000,
+          "confirmed baud-rate: restored to %u", g_uart_model.baudrate);
+    CHECK(master_read_var(UDC_ADDRESS),
+          "confirmed baud-rate: not answered");
+}
+
+static void test_fallback(void)
+{
+    /// Master misses the answer and stays at current baud-rate
+    master.baudrate = 6000000;
+
+    CHECK(master_propose(UDC_ADDRESS, 3000000) == Ok,
+          "fallback: proposal not answered");
+    CHECK(g_uart_model.baudrate == 3000000,
+          "fallback: proposal not applied after answer");
+
+    CHECK(!master_read_var(UDC_ADDRESS), "fallback: garbled request answered");
+    CHECK(g_uart_model.rx_errors, "fallback: garbled request not detected");
+
+    tick_ms(BAUDRATE_TRIAL_TIMEOUT - 1);
+    CHECK(g_uart_model.baudrate == 3000000,
+          "fallback: restored before trial timeout");
+    CHECK(!master_read_var(UDC_ADDRESS), "fallback: garbled request answered");
+
+    tick_ms(1);
+    CHECK(g_uart_model.baudrate == 6000000,
+          "fallback: not restored after trial timeout");
+    CHECK(master_read_var(UDC_ADDRESS),
+          "fallback: restored baud-rate not answered");
+
+    /// Without proposal, nothing is restored
+    tick_ms(10 * BAUDRATE_TRIAL_TIMEOUT);
+    CHECK(g_uart_model.baudrate == 6000000,
+          "fallback: baud-rate changed without proposal");
+}
+
+static void test_broadcast(void)
+{
+    master.baudrate = 6000000;
+
+    CHECK(master_propose(BCAST_ADDRESS, 115200) == -1,
+          "broadcast proposal: answered");
+    CHECK(g_uart_model.baudrate == 115200,
+          "broadcast proposal: not applied");
+
+    master.baudrate = 115200;
+    CHECK(master_read_var(UDC_ADDRESS),
+          "broadcast proposal: new baud-rate not answered");
+
+    tick_ms(10 * BAUDRATE_TRIAL_TIMEOUT);
+    CHECK(g_uart_model.baudrate == 115200,
+          "broadcast proposal: confirmed baud-rate restored");
+}
+
+static void test_refused(void)
+{
+    uint32_t sets;
+
+    master.baudrate = 115200;
+    sets = g_uart_model.baudrate_sets;
+
+    CHECK(master_propose(UDC_ADDRESS, 4800) == Invalid_Command,
+          "baud-rate below minimum: not refused");
+    CHECK(master_propose(UDC_ADDRESS, 12000000) == Invalid_Command,
+          "baud-rate above maximum: not refused");
+    CHECK(master_propose(UDC_ADDRESS, 115200) == Ok,
+          "current baud-rate: not accepted");
+
+    tick_ms(10 * BAUDRATE_TRIAL_TIMEOUT);
+    CHECK(g_uart_model.baudrate_sets == sets,
+          "refused proposals: baud-rate set %u times",
+          g_uart_model.baudrate_sets - sets);
+}
+
+int main(void)
+{
+    init_rs485();
+
+    CHECK(g_uart_model.baudrate == 115200, "initial baud-rate: %u",
+          g_uart_model.baudrate);
+
+    test_confirmed();
+    test_fallback();
+    test_broadcast();
+    test_refused();
+
+    CHECK(!g_uart_model.misuses, "%u driverlib misuses",
+          g_uart_model.misuses);
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,437 @@
+/******************************************************************************
+ * Copyright (C) 2026 by LNLS - Brazilian Synchrotron Light Laboratory
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. LNLS and
+ * the Brazilian Center for Research in Energy and Materials (CNPEM) are not
+ * liable for any misuse of this material.
+ *
+ *****************************************************************************/
+
+/**
+ * @file rs485_framing_test.c
+ * @brief Host framing test of RS485 reception
+ *
+ * Builds rs485.c against a model of UART1 and its uDMA channels (see
+ * mock/uart_model.c), driven by a simulated master byte by byte. BSMP requests
+ * are answered with an echo of the request, so every frame is checked end to
+ * end. Checks that:
+ *  - frames of any size up to the maximum are received, processed once, and
+ *    answered with a valid checksum, after which the bus is released;
+ *  - frames with bad checksum, for other addresses or broadcast aren't
+ *    answered;
+ *  - frames received before the main loop runs are queued and processed in
+ *    order, and those which don't fit into the queue or into recv_buffer are
+ *    dropped without disturbing queued ones;
+ *  - at low baud-rates, a pause within a frame doesn't end it.
+ *
+ * Then reports the number of interrupts serviced per frame.
+ *
+ * See README.md on this directory for build instructions.
+ *
+ * @author agent
+ * @date 17/10/2026
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "communication_drivers/bsmp/bsmp_lib.h"
+#include "communication_drivers/i2c_onboard/exio.h"
+#include "communication_drivers/parameters/ps_parameters.h"
+#include "communication_drivers/rs485/rs485.h"
+#include "communication_drivers/system_task/system_task.h"
+
+#include "mock/uart_model.h"
+
+/// As in rs485.c
+#define SERIAL_BUF_SIZE         (1+3+3+16834+1)
+#define RX_BUF_SIZE             (SERIAL_BUF_SIZE + 6144)
+#define RX_QUEUE_SIZE           8
+
+#define MAX_BSMP_PAYLOAD        (SERIAL_BUF_SIZE - 1 - 3 - 1)
+
+#define HIGH_SPEED_BAUD         6000000
+#define LOW_SPEED_BAUD          115200
+
+#define BCAST_ADDRESS           255
+#define OTHER_ADDRESS           7
+
+typedef struct
+{
+    uint8_t     data[SERIAL_BUF_SIZE];
+    uint16_t    len;
+} frame_t;
+
+static frame_t frames[RX_QUEUE_SIZE + 1];
+
+/// Bytes transmitted by the UDC while main loop runs
+static uint8_t tx_line[(RX_QUEUE_SIZE + 1) * SERIAL_BUF_SIZE];
+static uint32_t tx_len;
+
+static bool task_rs485;
+
+static struct
+{
+    uint32_t    count;
+    uint32_t    broadcasts;
+    uint8_t     server[RX_QUEUE_SIZE + 1];
+} bsmp_calls;
+
+static int failures;
+
+#define CHECK(cond, ...) \
+    do { \
+        if(!(cond)) \
+        { \
+            printf("FAIL: " __VA_ARGS__); \
+            printf("\n"); \
+            failures++; \
+        } \
+    } while(0)
+
+/* Firmware functions used by rs485.c */
+
+void TaskSetNew(uint8_t TaskNum)
+{
+    if(TaskNum == PROCESS_RS485_MESSAGE)
+    {
+        task_rs485 = true;
+    }
+}
+
+float get_param(param_id_t id, uint16_t n)
+{
+    switch(id)
+    {
+        case RS485_Baudrate:
+            return HIGH_SPEED_BAUD;
+        case RS485_Address:
+            return n + 1;
+        default:
+            return 0.0;
+    }
+}
+
+uint8_t set_param(param_id_t id, uint16_t n, float val)
+{
+    return 1;
+}
+
+void rs485_term_ctrl(uint8_t sts)
+{
+}
+
+bool bsmp_cmd_pending(struct bsmp_raw_packet *response)
+{
+    return false;
+}
+
+void bsmp_defer_response(struct bsmp_raw_packet *response,
+                         void (*p_send_response)(void))
+{
+}
+
+void BSMPprocess(struct bsmp_raw_packet *recv_packet,
+                 struct bsmp_raw_packet *send_packet, uint8_t server,
+                 uint16_t command_interface)
+{
+    if(bsmp_calls.count < sizeof(bsmp_calls.server))
+    {
+        bsmp_calls.server[bsmp_calls.count] = server;
+    }
+    bsmp_calls.count++;
+
+    memcpy(send_packet->data, recv_packet->data, recv_packet->len);
+    send_packet->len = recv_packet->len;
+}
+
+void BSMPprocess_broadcast(struct bsmp_raw_packet *recv_packet,
+                           struct bsmp_raw_packet *send_packet,
+                           uint16_t command_interface)
+{
+    bsmp_calls.broadcasts++;
+}
+
+/* Simulated master */
+
+/**
+ * Build frame with a BSMP request of specified payload size, filled with
+ * random data
+ */
+static void build_frame(frame_t *frame, uint8_t addr, uint16_t payload_size)
+{
+    uint8_t csum = 0;
+    uint16_t i;
+
+    frame->len = 1 + 3 + payload_size + 1;
+
+    frame->data[0] = addr;
+    frame->data[1] = 0x20;
+    frame->data[2] = payload_size >> 8;
+    frame->data[3] = payload_size;
+
+    for(i = 4; i < frame->len - 1; i++)
+    {
+        frame->data[i] = rand();
+    }
+
+    for(i = 0; i < frame->len - 1; i++)
+    {
+        csum += frame->data[i];
+    }
+    frame->data[frame->len - 1] = -csum;
+}
+
+static void send_frame(const frame_t *frame, uint32_t baudrate)
+{
+    uart_model_rx(frame->data, frame->len, baudrate);
+    uart_model_rx_idle();
+}
+
+/**
+ * Run main loop until there's nothing left to do. Answers are transmitted
+ * between loop iterations, as UART does meanwhile on firmware.
+ */
+static void run_main_loop(void)
+{
+    memset(&bsmp_calls, 0, sizeof(bsmp_calls));
+    tx_len = 0;
+
+    do
+    {
+        if(task_rs485)
+        {
+            task_rs485 = false;
+            rs485_process_data();
+        }
+        tx_len += uart_model_tx(&tx_line[tx_len], sizeof(tx_line) - tx_len);
+    }while(task_rs485);
+}
+
+/**
+ * Check that tx_line holds echoes of frames, in order, each one with a valid
+ * checksum
+ */
+static void check_answers(const char *label, const frame_t *frames,
+                          uint8_t count)
+{
+    uint32_t offset = 0;
+    uint8_t csum;
+    uint16_t i;
+    uint8_t n;
+
+    CHECK(bsmp_calls.count == count, "%s: %u frames processed, expected %u",
+          label, bsmp_calls.count, count);
+
+    for(n = 0; n < count; n++)
+    {
+        const frame_t *frame = &frames[n];
+
+        CHECK(bsmp_calls.server[n] == frame->data[0] - 1,
+              "%s, frame %u: processed by server %u", label, n,
+              bsmp_calls.server[n]);
+
+        if(offset + frame->len > tx_len)
+        {
+            CHECK(0, "%s, frame %u: answer missing", label, n);
+            return;
+        }
+
+        CHECK(tx_line[offset] == 0, "%s, frame %u: answer to address %u",
+              label, n, tx_line[offset]);
+        CHECK(!memcmp(&tx_line[offset + 1], &frame->data[1], frame->len - 2),
+              "%s, frame %u: answer differs from request", label, n);
+
+        csum = 0;
+        for(i = 0; i < frame->len; i++)
+        {
+            csum += tx_line[offset + i];
+        }
+        CHECK(csum == 0, "%s, frame %u: answer checksum", label, n);
+
+        offset += frame->len;
+    }
+
+    CHECK(offset == tx_len, "%s: %u bytes transmitted, expected %u", label,
+          tx_len, offset);
+    CHECK(!g_uart_model.driver_on, "%s: bus not released", label);
+}
+
+/* Tests */
+
+static void test_sizes(void)
+{
+    static const uint16_t sizes[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 13,
+                                     15, 16, 17, 100, 1017, 1018, 1019, 1020,
+                                     1021, 1024, 2043, 2044, 2045, 4096,
+                                     10000, MAX_BSMP_PAYLOAD};
+    char label[32];
+    uint8_t i;
+
+    for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        build_frame(&frames[0], 1 + (i % 4), sizes[i]);
+        send_frame(&frames[0], HIGH_SPEED_BAUD);
+        run_main_loop();
+
+        sprintf(label, "size %u", sizes[i]);
+        check_answers(label, frames, 1);
+    }
+
+    CHECK(!g_uart_model.overruns, "sizes: %u bytes lost on RX FIFO",
+          g_uart_model.overruns);
+}
+
+static void test_not_answered(void)
+{
+    uint32_t dropped = g_rs485_rx_stats.dropped.u32;
+
+    build_frame(&frames[0], 1, 10);
+    frames[0].data[5]++;
+    send_frame(&frames[0], HIGH_SPEED_BAUD);
+    run_main_loop();
+    CHECK(!bsmp_calls.count && !tx_len, "bad checksum: answered");
+
+    build_frame(&frames[0], OTHER_ADDRESS, 10);
+    send_frame(&frames[0], HIGH_SPEED_BAUD);
+    run_main_loop();
+    CHECK(!bsmp_calls.count && !tx_len, "other address: answered");
+
+    build_frame(&frames[0], BCAST_ADDRESS, 10);
+    send_frame(&frames[0], HIGH_SPEED_BAUD);
+    run_main_loop();
+    CHECK(bsmp_calls.broadcasts == 1, "broadcast: not processed");
+    CHECK(!bsmp_calls.count && !tx_len, "broadcast: answered");
+
+    /// Single byte, shorter than address and checksum
+    uart_model_rx(frames[0].data, 1, HIGH_SPEED_BAUD);
+    uart_model_rx_idle();
+    run_main_loop();
+    CHECK(!bsmp_calls.count && !tx_len, "single byte: answered");
+
+    CHECK(g_rs485_rx_stats.dropped.u32 == dropped,
+          "frames not answered counted as dropped");
+}
+
+static void test_queue(void)
+{
+    uint32_t dropped = g_rs485_rx_stats.dropped.u32;
+    uint8_t n;
+
+    /// Frames in excess of queue size are dropped
+    for(n = 0; n < RX_QUEUE_SIZE + 1; n++)
+    {
+        build_frame(&frames[n], 1 + (n % 4), 50 + 300*n);
+        send_frame(&frames[n], HIGH_SPEED_BAUD);
+    }
+    run_main_loop();
+
+    check_answers("queue", frames, RX_QUEUE_SIZE);
+    CHECK(g_rs485_rx_stats.peak_depth.u16 == RX_QUEUE_SIZE,
+          "queue: peak depth %u", g_rs485_rx_stats.peak_depth.u16);
+    CHECK(g_rs485_rx_stats.dropped.u32 == dropped + 1,
+          "queue: %u frames dropped", g_rs485_rx_stats.dropped.u32 - dropped);
+    CHECK(!g_uart_model.overruns, "queue: %u bytes lost on RX FIFO",
+          g_uart_model.overruns);
+
+    /**
+     * Frames fill recv_buffer, leaving less than one uDMA chunk free at its
+     * end. Frame which doesn't fit into it is dropped, without disturbing
+     * queued ones. Its bytes in excess are lost on RX FIFO.
+     */
+    dropped = g_rs485_rx_stats.dropped.u32;
+
+    build_frame(&frames[0], 1, 16000);
+    build_frame(&frames[1], 2, RX_BUF_SIZE - 16000 - 1000);
+    build_frame(&frames[2], 3, 2000);
+
+    for(n = 0; n < 3; n++)
+    {
+        send_frame(&frames[n], HIGH_SPEED_BAUD);
+    }
+    run_main_loop();
+
+    check_answers("full buffer", frames, 2);
+    CHECK(g_rs485_rx_stats.dropped.u32 == dropped + 1,
+          "full buffer: %u frames dropped",
+          g_rs485_rx_stats.dropped.u32 - dropped);
+
+    /// Once queue is empty, the whole recv_buffer is available again
+    send_frame(&frames[2], HIGH_SPEED_BAUD);
+    run_main_loop();
+    check_answers("after full buffer", &frames[2], 1);
+}
+
+static void test_pause(void)
+{
+    uint16_t half;
+
+    build_frame(&frames[0], 1, 300);
+    half = frames[0].len / 2;
+
+    /// At low baud-rates, frame goes on after a pause
+    config_rs485(LOW_SPEED_BAUD);
+
+    uart_model_rx(frames[0].data, half, LOW_SPEED_BAUD);
+    uart_model_rx_idle();
+    uart_model_rx(&frames[0].data[half], frames[0].len - half,
+                  LOW_SPEED_BAUD);
+    uart_model_rx_idle();
+    run_main_loop();
+    check_answers("pause at low speed", frames, 1);
+
+    /// At high baud-rates, a pause ends the frame
+    config_rs485(HIGH_SPEED_BAUD);
+
+    uart_model_rx(frames[0].data, half, HIGH_SPEED_BAUD);
+    uart_model_rx_idle();
+    uart_model_rx(&frames[0].data[half], frames[0].len - half,
+                  HIGH_SPEED_BAUD);
+    uart_model_rx_idle();
+    run_main_loop();
+    CHECK(!bsmp_calls.count && !tx_len, "pause at high speed: answered");
+}
+
+static void report_isr_calls(uint16_t payload_size)
+{
+    uint32_t isr_calls = g_uart_model.isr_calls;
+
+    build_frame(&frames[0], 1, payload_size);
+    send_frame(&frames[0], HIGH_SPEED_BAUD);
+    run_main_loop();
+
+    printf("%5u bytes frame and answer: %3u interrupts\n", frames[0].len,
+           g_uart_model.isr_calls - isr_calls);
+}
+
+int main(void)
+{
+    srand(1);
+
+    init_rs485();
+
+    test_sizes();
+    test_not_answered();
+    test_queue();
+    test_pause();
+
+    report_isr_calls(10);
+    report_isr_calls(1000);
+    report_isr_calls(MAX_BSMP_PAYLOAD);
+
+    CHECK(!g_uart_model.misuses, "%u driverlib misuses",
+          g_uart_model.misuses);
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}